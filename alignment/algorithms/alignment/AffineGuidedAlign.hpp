@@ -2,6 +2,56 @@
 #define _BLASR_AFFINE_GUIDE_ALIGNMENT_HPP_
 
 #include "GuidedAlign.hpp"
+
+//
+// The affine insertion and deletion scores of one cell of the guided
+// matrix, kept together so both are read from the same cache line.
+//
+class AffineGuideCell {
+public:
+    int ins, del;
+};
+
+//
+// The traceback arrows of the affine insertion and deletion states of
+// a cell packed in one byte, two bits each.  A zero field is NoArrow.
+//
+class AffineGuideArrows {
+public:
+    enum { GapOpen=1, GapExtend=2 };
+    enum { DelShift=2 };
+
+    static inline unsigned char Pack(int ins, int del) {
+        return (unsigned char) (ins | (del << DelShift));
+    }
+
+    static inline Arrow InsArrow(unsigned char cell) {
+        switch(cell & 3) {
+            case GapOpen:   return AffineInsOpen;
+            case GapExtend: return AffineInsUp;
+            default:        return NoArrow;
+        }
+    }
+
+    static inline Arrow DelArrow(unsigned char cell) {
+        switch((cell >> DelShift) & 3) {
+            case GapOpen:   return AffineDelOpen;
+            case GapExtend: return AffineDelLeft;
+            default:        return NoArrow;
+        }
+    }
+};
+
+//
+// Storage for the affine states of AffineGuidedAlign, which a caller
+// may keep between alignments so that it is not reallocated.
+//
+class AffineGuideBuffers {
+public:
+    std::vector<AffineGuideCell> gapScores;
+    std::vector<unsigned char> gapArrows;
+};
+
 template<typename QSequence, typename TSequence, typename T_ScoreFn>
 int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guideAlignment,
         T_ScoreFn &scoreFn,
@@ -16,7 +66,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         std::vector<float>  &lnDelPValueVect,
         std::vector<float>  &lnMatchPValueVect,
         AlignmentType alignType=Global, 
-        bool computeProb=false) {
+        bool computeProb=false,
+        AffineGuideBuffers *affineBuffers=NULL) {
 
     Guide guide;
     AlignmentToGuide(guideAlignment, guide, bandSize);
@@ -76,23 +127,24 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
     // 
     // Make sure the alignments can fit in the reused buffers.
     //
-    std::vector<int>    affineInsScoreMat, affineDelScoreMat;
-    std::vector<Arrow>  affineInsPathMat, affineDelPathMat;
-    affineInsScoreMat.resize(matrixNElem);
-    fill(affineInsScoreMat.begin(), affineInsScoreMat.end(), 0);
-    affineDelScoreMat.resize(matrixNElem);
-    fill(affineDelScoreMat.begin(), affineDelScoreMat.end(), 0);
-    affineInsPathMat.resize(matrixNElem);
-    fill(affineInsPathMat.begin(), affineInsPathMat.end(), NoArrow);
-    affineDelPathMat.resize(matrixNElem);
-    fill(affineDelPathMat.begin(), affineDelPathMat.end(), NoArrow);
+    AffineGuideBuffers localAffineBuffers;
+    if (affineBuffers == NULL) {
+        affineBuffers = &localAffineBuffers;
+    }
+    std::vector<AffineGuideCell> &gapScores = affineBuffers->gapScores;
+    std::vector<unsigned char> &gapArrows   = affineBuffers->gapArrows;
+    if (gapScores.size() < matrixNElem) {
+        gapScores.resize(matrixNElem);
+        gapArrows.resize(matrixNElem);
+    }
+    AffineGuideCell zeroCell = {0, 0};
+    std::fill(gapScores.begin(), gapScores.begin() + matrixNElem, zeroCell);
+    std::fill(gapArrows.begin(), gapArrows.begin() + matrixNElem, 0);
 
 
     if (scoreMat.size() < matrixNElem) {
         scoreMat.resize(matrixNElem);
         pathMat.resize(matrixNElem);
-        fill(scoreMat.begin(), scoreMat.end(), 0);
-        fill(pathMat.begin(), pathMat.end(), NoArrow);
     }
     if (computeProb) {
         if (probMat.size() < matrixNElem) {
@@ -166,10 +218,10 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             else if (alignType == Local) {
                 scoreMat[curIndex] = 0;
             }
-            affineDelScoreMat[curIndex] = scoreFn.del;
-            affineDelPathMat[curIndex] = AffineDelOpen;
-            affineInsPathMat[curIndex] = AffineInsOpen;
-            affineInsScoreMat[curIndex] = scoreFn.ins;
+            gapScores[curIndex].del = scoreFn.del;
+            gapScores[curIndex].ins = scoreFn.ins;
+            gapArrows[curIndex] = AffineGuideArrows::Pack(AffineGuideArrows::GapOpen,
+                                                          AffineGuideArrows::GapOpen);
             pathMat[curIndex] = Left;
             if (computeProb) {
                 if (qSeq.qual.Empty() == false) {
@@ -198,10 +250,10 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             else {
                 scoreMat[curIndex] = 0;
             }
-            affineInsScoreMat[curIndex] = scoreFn.ins;
-            affineInsPathMat[curIndex]  = AffineInsOpen;
-            affineDelScoreMat[curIndex] = scoreFn.del;
-            affineDelPathMat[curIndex] = AffineDelOpen;
+            gapScores[curIndex].ins = scoreFn.ins;
+            gapScores[curIndex].del = scoreFn.del;
+            gapArrows[curIndex] = AffineGuideArrows::Pack(AffineGuideArrows::GapOpen,
+                                                          AffineGuideArrows::GapOpen);
             pathMat[curIndex] = Up;
         }
     }
@@ -210,74 +262,51 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         affineInsOpenScore, affineInsExtScore, 
         affineDelOpenScore, affineDelExtScore;
 
+    int insArrow, delArrow;
+
     for (q = qStart; q < qEnd; q++) {
         int qi = q - qStart + 1;
-        int tp = guide[qi].t;
-        curIndex = matchIndex = insIndex = delIndex = -1;
+        GuideRow &row     = guide[qi];
+        GuideRow &prevRow = guide[qi-1];
 
         //
-        // Do some work that will help define when matchIndex and insIndex
-        // may be used.  Once delIndex is computed once, it is valid for
-        // all t positions.
+        // The cells of this row and the previous row are contiguous in
+        // the matrices, so the neighbors of a cell are found from the
+        // row offsets rather than searched for with GetBufferIndex.
         //
-        int prevRowTEnd = -1;
-        if ( qi > 0) { 
-            //
-            // Define the boundaries of the column which may access previously
-            // computed cells with a match.
-            //
-            prevRowTEnd = guide[qi-1].t + guide[qi-1].tPost;
-        }    
-
-        for (t = tp - guide[qi].tPre ; t < guide[qi].t + guide[qi].tPost +1; t++) {
-
-            if (q < qStart + bandSize and t == tp - guide[qi].tPre - 1) {
-                // On the boundary condition, don't access the 1st element;
-                t++;
-                continue;
-            }
-            // Make sure the index is not past the end of the sequence.
-            if (t < -1) continue;
-            if (t >= tEnd) continue;
-
-            //
-            // No cells are available to use for insertion cost
-            // computation. 
-            //
-            if (t > prevRowTEnd) {
-                insIndex = -1;
-            }
-            if (t > prevRowTEnd + 1) {
-                matchIndex = -1;
-            }
+        int rowTStart     = row.t - row.tPre;
+        int prevRowTStart = prevRow.t - prevRow.tPre;
+        int prevRowTEnd   = prevRow.t + prevRow.tPost;
+
+        // Make sure the index is not past the ends of the sequence.
+        int tFirst = std::max(rowTStart, -1);
+        int tLast  = std::min(row.t + row.tPost, tEnd - 1);
 
-            //
-            // Find the indices in the buffer.  Since the rows are of
-            // different sizes, one can't just use offsets from the buffer
-            // index. 
-            //
+        for (t = tFirst; t <= tLast; t++) {
+            curIndex = row.matrixOffset + (t - row.t);
 
-            if (GetBufferIndex(guide, q-1,t-1, matchIndex)) {
-                assert(matchIndex >= 0);
+            if (t - 1 >= prevRowTStart and t - 1 <= prevRowTEnd) {
+                matchIndex = prevRow.matrixOffset + (t - 1 - prevRow.t);
                 matchScore = scoreMat[matchIndex] + scoreFn.Match(tSeq, t, qSeq, q);
             }
             else {
                 matchScore = INF_INT;
             }
 
-            if (GetBufferIndex(guide, q-1, t, insIndex)) {
-                assert(insIndex >= 0);
+            if (t >= prevRowTStart and t <= prevRowTEnd) {
+                insIndex = prevRow.matrixOffset + (t - prevRow.t);
                 insScore = scoreMat[insIndex] + scoreFn.Insertion(tSeq,(DNALength) t, qSeq, (DNALength)q);
-                affineInsExtScore = affineInsScoreMat[insIndex] + scoreFn.affineExtend; // 0 extension 
+                affineInsExtScore = gapScores[insIndex].ins + scoreFn.affineExtend; // 0 extension 
             }
             else {
                 insScore = INF_INT;
                 affineInsExtScore = INF_INT;
             }
-            if (GetBufferIndex(guide, q, t-1, delIndex)) {
-                assert(delIndex >= 0);
+
+            if (t - 1 >= rowTStart) {
+                delIndex = curIndex - 1;
                 delScore = scoreMat[delIndex] + scoreFn.Deletion(tSeq, (DNALength) t, qSeq, (DNALength)q);
-                affineDelExtScore = affineDelScoreMat[delIndex] + scoreFn.affineExtend;
+                affineDelExtScore = gapScores[delIndex].del + scoreFn.affineExtend;
             }
             else {
                 delScore = INF_INT;
@@ -285,16 +314,11 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             }
 
             int minScore = MIN(matchScore, MIN(insScore, MIN(delScore, MIN(affineInsExtScore, affineDelExtScore))));
-            int result   = GetBufferIndex(guide, q, t, curIndex);
-            // This should only loop over valid cells.
-            assert(result);
-            assert(curIndex >= 0);
             scoreMat[curIndex] = minScore;
             if (minScore == INF_INT) {
                 pathMat[curIndex] = NoArrow;
             }
             else {
-                assert(result == 1);
                 if (minScore == matchScore) {
                     pathMat[curIndex] = Diagonal;
                 }
@@ -329,23 +353,25 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
                 cout << "the score mat here is : " << scoreMat[curIndex] << " and path " << pathMat[curIndex] << endl;
                 assert(0);
             }
+            AffineGuideCell &gapCell = gapScores[curIndex];
             if (affineInsOpenScore < affineInsExtScore) {
-                affineInsPathMat[curIndex] = AffineInsOpen;
-                affineInsScoreMat[curIndex] = affineInsOpenScore;
+                insArrow    = AffineGuideArrows::GapOpen;
+                gapCell.ins = affineInsOpenScore;
             }
             else {
-                affineInsPathMat[curIndex] = AffineInsUp;
-                affineInsScoreMat[curIndex] = affineInsExtScore;
+                insArrow    = AffineGuideArrows::GapExtend;
+                gapCell.ins = affineInsExtScore;
             }
 
             if (affineDelOpenScore < affineDelExtScore) {
-                affineDelPathMat[curIndex] = AffineDelOpen;
-                affineDelScoreMat[curIndex] = affineDelOpenScore;
+                delArrow    = AffineGuideArrows::GapOpen;
+                gapCell.del = affineDelOpenScore;
             }
             else {
-                affineDelPathMat[curIndex] = AffineDelLeft;
-                affineDelScoreMat[curIndex] = affineDelExtScore;
+                delArrow    = AffineGuideArrows::GapExtend;
+                gapCell.del = affineDelExtScore;
             }
+            gapArrows[curIndex] = AffineGuideArrows::Pack(insArrow, delArrow);
         }
     }		
     // Ok, for now just trace back from qend/tend
@@ -404,7 +430,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             }
         }
         else if (curMatrix == AffineIns) {
-            arrow = affineInsPathMat[bufferIndex];
+            arrow = AffineGuideArrows::InsArrow(gapArrows[bufferIndex]);
             if (arrow == AffineInsOpen) {
                 curMatrix = Match;
             }
@@ -419,7 +445,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         }
         else {
             assert(curMatrix == AffineDel);
-            arrow = affineDelPathMat[bufferIndex];
+            arrow = AffineGuideArrows::DelArrow(gapArrows[bufferIndex]);
             if (arrow == AffineDelOpen) {
                 curMatrix = Match;
             }
@@ -520,6 +546,16 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
             alignType, computeProb);
 }
 
+//
+// The affine gap buffers a buffer cache holds, or NULL when it has
+// none.  AlignmentWorkspace overloads this to lend its own.
+//
+template<typename T_BufferCache>
+AffineGuideBuffers *AffineGuideBuffersOf(T_BufferCache &buffers) {
+    PB_UNUSED(buffers);
+    return NULL;
+}
+
 //
 // Use case, guide exists, using buffers
 //
@@ -539,7 +575,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             buffers.lnSubPValueMat,
             buffers.lnInsPValueMat,
             buffers.lnDelPValueMat,
-            buffers.lnMatchPValueMat, alignType, computeProb);
+            buffers.lnMatchPValueMat, alignType, computeProb,
+            AffineGuideBuffersOf(buffers));
 }
 
 //
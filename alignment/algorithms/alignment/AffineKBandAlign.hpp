@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include "../../../pbdata/NucConversion.hpp"
 #include "../../../pbdata/defs.h"
@@ -10,17 +11,79 @@
 #include "../../datastructures/alignment/Alignment.hpp"
 #include "KBandAlign.hpp"
 
+//
+// The scores of the match, insertion and homopolymer insertion states
+// of one cell, kept together so that a row of the band is one
+// contiguous strip.
+//
+class AffineBandCell {
+public:
+    int match, ins, hpIns;
+};
+
+//
+// The traceback arrows of all three states of a cell packed in one
+// byte: the match state in the low 3 bits, the insertion state in the
+// next 2, and the homopolymer insertion state in the 2 above that.  A
+// zero field is NoArrow.
+//
+class AffineBandArrows {
+public:
+    enum { MatchDiagonal=1, MatchLeft=2, MatchInsClose=3, MatchHPInsClose=4 };
+    enum { GapOpen=1, GapUp=2 };
+    enum { InsShift=3, HPInsShift=5 };
+
+    static inline unsigned char Pack(int match, int ins, int hpIns) {
+        return (unsigned char) (match | (ins << InsShift) | (hpIns << HPInsShift));
+    }
+
+    static inline Arrow MatchArrow(unsigned char cell) {
+        switch(cell & 7) {
+            case MatchDiagonal:   return Diagonal;
+            case MatchLeft:       return Left;
+            case MatchInsClose:   return AffineInsClose;
+            case MatchHPInsClose: return AffineHPInsClose;
+            default:              return NoArrow;
+        }
+    }
+
+    static inline Arrow InsArrow(unsigned char cell) {
+        switch((cell >> InsShift) & 3) {
+            case GapOpen: return AffineInsOpen;
+            case GapUp:   return AffineInsUp;
+            default:      return NoArrow;
+        }
+    }
+
+    static inline Arrow HPInsArrow(unsigned char cell) {
+        switch((cell >> HPInsShift) & 3) {
+            case GapOpen: return AffineHPInsOpen;
+            case GapUp:   return AffineHPInsUp;
+            default:      return NoArrow;
+        }
+    }
+};
+
+//
+// Storage for AffineKBandAlign.  Only two rows of scores are kept, and
+// one byte of arrows per cell.  A caller that aligns many reads may
+// keep one of these so that nothing is reallocated between calls.
+//
+class AffineKBandBuffers {
+public:
+    std::vector<AffineBandCell> strip;
+    std::vector<unsigned char> arrows;
+    // The match score of each row at the cell the TargetFit end
+    // search examines.
+    std::vector<int> fitScore;
+};
+
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment>
 int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
         int matchMat[5][5], 
         int hpInsOpen, int hpInsExtend, int insOpen, int insExtend,
         int del, int k,
-        vector<int> &scoreMat,
-        vector<Arrow> & pathMat,
-        vector<int> &hpInsScoreMat,
-        vector<Arrow> &hpInsPathMat,
-        vector<int> &insScoreMat,
-        vector<Arrow> &insPathMat,
+        AffineKBandBuffers &buffers,
         T_Alignment &alignment, 
         AlignmentType alignType) {
 
@@ -32,8 +95,6 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
     int INF_SCORE = INF_INT - 1000;
     T_QuerySequence qSeq;
     T_TargetSequence tSeq;
-    //	CreateThreeBitSequence(pqSeq, qSeq);
-    //	CreateThreeBitSequence(ptSeq, tSeq);
     qSeq.seq = pqSeq.seq;
     qSeq.length= pqSeq.length;
     tSeq.seq = ptSeq.seq;
@@ -44,185 +105,158 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
     SetKBoundedLengths(tSeq.length, qSeq.length, k, tLen, qLen);
 
     //
-    //
-    // Allow for length up to diagonal + k + 1 for boundary.
-    // 
     // Allow for width:
     //   diagonal (1)
     //   up to k insertions (k)
     //   up to k deletions  (k)
-    //   boundary on left side of matrix (1)
-    // 
-    //	if (qLen + k > tLen and qLen < tLen) {
-    //		k = tLen - qLen +1;
-    //	}
-    DNALength nCols = 2*k + 1;
-    VectorIndex totalMatSize = (qLen + 1) * nCols;
-
-
     // 
-    // For now the scoreMat and path mat maintained outside this 
-    // function so that they may have different sizes from the affine
-    // matrices. 
+    // Row q of the band holds target positions q-k ... q+k, so a cell
+    // at row q, column c is target position t = q + c - k.  Only rows
+    // q-1 and q of the scores are needed to fill row q, and they are
+    // stored alternately in the two halves of the strip.
     //
+    int nCols = 2*k + 1;
+    VectorIndex totalMatSize = (qLen + 1) * nCols;
 
-    if (scoreMat.size() < totalMatSize) {
-        scoreMat.resize(totalMatSize);
-        pathMat.resize(totalMatSize);
+    std::vector<AffineBandCell> &strip = buffers.strip;
+    std::vector<unsigned char> &arrows = buffers.arrows;
+    std::vector<int> &fitScore = buffers.fitScore;
+    if (strip.size() < static_cast<VectorIndex>(2 * nCols)) {
+        strip.resize(2 * nCols);
     }
-
-    if (hpInsScoreMat.size() < totalMatSize) {
-        hpInsScoreMat.resize(totalMatSize);
-        hpInsPathMat.resize(totalMatSize);
-        insScoreMat.resize(totalMatSize);
-        insPathMat.resize(totalMatSize);
+    if (arrows.size() < totalMatSize) {
+        arrows.resize(totalMatSize);
     }
-
-    // 
-    // Initialze matrices
-    //
-    std::fill(scoreMat.begin(), scoreMat.begin() + totalMatSize, 0);
-    std::fill(pathMat.begin(), pathMat.begin() + totalMatSize, NoArrow);
-    std::fill(hpInsScoreMat.begin(), hpInsScoreMat.begin() + totalMatSize, 0);
-    std::fill(hpInsPathMat.begin(), hpInsPathMat.begin() + totalMatSize, NoArrow);
-    std::fill(insScoreMat.begin(), insScoreMat.begin() + totalMatSize, 0);
-    std::fill(insPathMat.begin(), insPathMat.begin() + totalMatSize, NoArrow);
-
-    //
-    // Initialize the boundaries of the DP matrix.
-    //
-    int q, t;
-
-    if (alignType != TargetFit) {
-        insScoreMat[rc2index(0, k, nCols)] = 0;
-        insPathMat[rc2index(0, k, nCols)] = AffineInsOpen;
-
-        for (q = 1; q <=k && q < static_cast<int>(qLen) + 1; q++ ){
-            insScoreMat[rc2index(q, k - q, nCols)] = q * insExtend + insOpen;
-            insPathMat[rc2index(q, k-q, nCols)] = AffineInsUp;
-        }
-    }
-    else if (alignType == TargetFit) {
-        // 
-        // Allow free gap penalties at the beginning of the alignment.
-        //
-        insScoreMat[rc2index(0, k, nCols)] = 0;
-        insPathMat[rc2index(0, k, nCols)]  = AffineInsOpen;
-        for (q = 1; q <= k && q < static_cast<int>(qLen) + 1; q++ ){
-            insScoreMat[rc2index(q, k - q, nCols)] = 0;
-            insPathMat[rc2index(q, k-q, nCols)]    = AffineInsUp;
-        }
+    if (fitScore.size() < qLen + 1) {
+        fitScore.resize(qLen + 1);
     }
-
+    std::fill(arrows.begin(), arrows.begin() + totalMatSize, 0);
 
     //
-    // Assign score for (0,0) position in matrix -- aligning a gap to a gap
-    // which should just be a finished alignment.  There is no cost for
-    // gap-gap alignment.
+    // The range of rows the TargetFit end search examines, and the
+    // cell of the first row it starts from.
     //
-    hpInsScoreMat[rc2index(0,k,nCols)] = 0;
-    hpInsPathMat[rc2index(0,k,nCols)]  = AffineHPInsOpen;
-
-    for (q = 1; q <= k && q < static_cast<int>(qLen) + 1; q++) {
-        hpInsScoreMat[rc2index(q, k - q, nCols)] = q * hpInsExtend + hpInsOpen;
-        hpInsPathMat[rc2index(q,k-q,nCols)] = AffineHPInsUp;
+    int fitQStart = 0, fitQEnd = 0, fitStartScore = 0;
+    if (alignType == TargetFit) {
+        fitQStart = std::max(0,std::min((int)qLen, (int)tLen) - std::max(0, k - std::max(((int)tLen) - ((int)qLen), 0)));
+        fitQEnd   = std::min(qLen, tLen + k) + 1;
     }
 
-    for (t = k+1; t < static_cast<int>(nCols); t++ ) {
-        hpInsScoreMat[rc2index(0, t, nCols)] = INF_SCORE;//  hpInsOpen + (t - k) * hpInsExtend;//; //INF_SCORE;
-        hpInsPathMat[t] = NoArrow; //AffineHPInsOpen ; //NoArrow;
-        insScoreMat[t] = INF_SCORE; //insOpen + (t - k) * insExtend; //INF_SCORE;
-        insPathMat[t] = NoArrow; //AffineInsOpen; //NoArrow;
-    }
-
-    for (q = 1; q <= k && q < static_cast<int>(qLen) + 1; q++) {
-        scoreMat[rc2index(q, k - q, nCols)] = insScoreMat[rc2index(q,k-q,nCols)];
-        pathMat[rc2index(q, k - q , nCols)] = AffineInsClose;
-    }
-    for (t = 1; t <= k; t++) {
-        scoreMat[rc2index(0, t + k , nCols)] = t * del;
-        pathMat[rc2index(0, t + k , nCols)] = Left;
-    }
-
-
-    //
-    // The recurrence relation here is a slight modification of the
-    // standard affine gap alignment.  Deletions are non-affine.  Insertions
-    // are affine with different scores for homopolymer insertions, and 
-    // an affine score for mixed insertions.
-    //
-
-
+    int q, t, c;
     int matchScore, delScore;
     int hpInsExtendScore, hpInsOpenScore, insOpenScore, insExtendScore;
     int minHpInsScore, minInsScore;
-    for (q = 1; q <= static_cast<int>(qLen); q++) {
-        for (t = q - k; t < static_cast<int>(q) + k + 1; t++) {
-            if (t < 1) {
-                continue;
+    int hpInsArrow, insArrow, matchArrow;
+    AffineBandCell *row = NULL, *prevRow = NULL;
+
+    for (q = 0; q <= static_cast<int>(qLen); q++) {
+        prevRow = row;
+        row     = &strip[(q % 2) * nCols];
+        unsigned char *rowArrows = &arrows[q * nCols];
+
+        //
+        // Initialize the row to the boundary conditions.  Cells that are
+        // not on the boundary and not filled below keep a score of 0.
+        //
+        for (c = 0; c < nCols; c++) {
+            row[c].match = row[c].ins = row[c].hpIns = 0;
+        }
+        if (q == 0) {
+            //
+            // Assign score for (0,0) position in matrix -- aligning a gap
+            // to a gap which should just be a finished alignment.  There
+            // is no cost for gap-gap alignment.
+            //
+            rowArrows[k] = AffineBandArrows::Pack(0, AffineBandArrows::GapOpen, 
+                                                  AffineBandArrows::GapOpen);
+            for (c = k+1; c < nCols; c++) {
+                row[c].hpIns = INF_SCORE;
+                row[c].ins   = INF_SCORE;
             }
-            if (static_cast<DNALength>(t) >  tLen) {
-                break;
+            for (t = 1; t <= k; t++) {
+                row[t + k].match = t * del;
+                rowArrows[t + k] = AffineBandArrows::Pack(AffineBandArrows::MatchLeft, 0, 0);
             }
+        }
+        else if (q <= k) {
+            if (alignType != TargetFit) {
+                row[k - q].ins = q * insExtend + insOpen;
+            }
+            else {
+                // 
+                // Allow free gap penalties at the beginning of the alignment.
+                //
+                row[k - q].ins = 0;
+            }
+            row[k - q].hpIns = q * hpInsExtend + hpInsOpen;
+            row[k - q].match = row[k - q].ins;
+            rowArrows[k - q] = AffineBandArrows::Pack(AffineBandArrows::MatchInsClose,
+                                                      AffineBandArrows::GapUp,
+                                                      AffineBandArrows::GapUp);
+        }
 
-            VectorIndex upper = rc2index(q-1, k + t - q + 1, nCols);
-            VectorIndex curIndex = rc2index(q, k + t - q, nCols);
+        //
+        // The recurrence relation here is a slight modification of the
+        // standard affine gap alignment.  Deletions are non-affine.  Insertions
+        // are affine with different scores for homopolymer insertions, and 
+        // an affine score for mixed insertions.
+        //
+        // The homopolymer insertion score is defined only when the previous nucleotide
+        // is the same as the current, in which case the homopolymer insertion score
+        // is used.  If the current and previous nucleotide in the query are different,
+        // the extension is not possible, and the best that can happen is a gap open.
+        //
+        bool hpExtends = (q > 1 and qSeq[q-1] == qSeq[q-2]);
+        int tFirst = std::max(q - k, 1);
+        int tLast  = std::min(q + k, static_cast<int>(tLen));
 
-            if (t < q + k)
-                hpInsOpenScore = scoreMat[upper] + hpInsOpen;
-            else
-                hpInsOpenScore = INF_SCORE;
+        for (t = tFirst; q > 0 and t <= tLast; t++) {
+            c = k + t - q;
+            AffineBandCell &cell = row[c];
 
             //
-            // The homopolymer insertion score is defined only when the previous nucleotide
-            // is the same as the current, in which case the homopolymer insertion score
-            // is used.  If the current and previous nucleotide in the query are different,
-            // the extension is not possible, and the best that can happen is a gap open.
+            // The cell above is one column to the right in the previous
+            // row.  On the right boundary of the band there is no cell
+            // above, so no insertion ends here.
             //
-            if (q > 1 and qSeq[q-1] == qSeq[q-2]) {
-                if (t < q + k) 
-                    hpInsExtendScore = hpInsScoreMat[upper] + hpInsExtend;
-                else 
+            if (t < q + k) {
+                AffineBandCell &upper = prevRow[c + 1];
+                hpInsOpenScore = upper.match + hpInsOpen;
+                if (hpExtends) {
+                    hpInsExtendScore = upper.hpIns + hpInsExtend;
+                }
+                else {
                     hpInsExtendScore = INF_SCORE;
+                }
+                insOpenScore   = upper.match + insOpen;
+                insExtendScore = upper.ins + insExtend;
             }
             else {
+                hpInsOpenScore   = INF_SCORE;
                 hpInsExtendScore = INF_SCORE;
+                insOpenScore     = INF_SCORE;
+                insExtendScore   = INF_SCORE;
             }
 
-            //
-            // Since this is only allowing insertions, this grid has only horizontal and 
-            // elevation arrows.
-            //
-
             if (hpInsOpenScore < hpInsExtendScore) {
-                hpInsPathMat[curIndex] = AffineHPInsOpen;
+                hpInsArrow    = AffineBandArrows::GapOpen;
                 minHpInsScore = hpInsOpenScore;
             }
             else {
-                hpInsPathMat[curIndex] = AffineHPInsUp;
+                hpInsArrow    = AffineBandArrows::GapUp;
                 minHpInsScore = hpInsExtendScore;
             }
-
-            hpInsScoreMat[curIndex] = minHpInsScore;
-            if (t < q + k) {
-                insOpenScore = scoreMat[upper] + insOpen;
-                insExtendScore = insScoreMat[upper] + insExtend;
-            }
-            else {
-                insOpenScore = INF_SCORE;
-                insExtendScore = INF_SCORE;
-            }
+            cell.hpIns = minHpInsScore;
 
             if (insOpenScore < insExtendScore) {
-                insPathMat[curIndex] = AffineInsOpen;
+                insArrow    = AffineBandArrows::GapOpen;
                 minInsScore = insOpenScore;
             }
             else {
-                insPathMat[curIndex] = AffineInsUp;
+                insArrow    = AffineBandArrows::GapUp;
                 minInsScore = insExtendScore;
             }
-            insScoreMat[curIndex] = minInsScore;
-
+            cell.ins = minInsScore;
 
             // On left boundary of k-band. 
             // do not allow deletions of t.
@@ -230,109 +264,82 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
                 delScore = INF_SCORE;
             }
             else {
-                // cur row = q
-                // cur col = t - q 
-                // prev col therefore t - q - 1
-                // and offset from diagonal is k + t - q - 1
-                delScore = scoreMat[rc2index(q, k + t - q - 1, nCols)] + del;
+                delScore = row[c - 1].match + del;
             }
 
-            // cur row = q
-            // cur col = t - q
-
-            // cur query index = q - 1
-            // cur target index = t - 1
-            // therefore match row (up) = q 
-            //           match col (left, but since up shifted right) = t - q
-            assert(rc2index(q - 1, k + t - q, nCols) < scoreMat.size());
-            assert(t-1 >= 0);
-            assert(q-1 >= 0);
-            matchScore = scoreMat[rc2index(q - 1, k + t - q, nCols)] + matchMat[ThreeBit[qSeq.seq[q-1]]][ThreeBit[tSeq.seq[t-1]]];
-
-            //
-            //  Possibly on right boundary of k-band, in which
-            //  case do not allow insertions from q.
+            matchScore = prevRow[c].match + matchMat[ThreeBit[qSeq.seq[q-1]]][ThreeBit[tSeq.seq[t-1]]];
 
             int minScore = MIN(matchScore, MIN(delScore, MIN(minInsScore, minHpInsScore)));
-            curIndex = rc2index(q, k + t - q, nCols);
-            assert(curIndex < scoreMat.size());
-            scoreMat[curIndex] = minScore;
+            cell.match = minScore;
             if (minScore == matchScore) {
-                pathMat[curIndex] = Diagonal;
+                matchArrow = AffineBandArrows::MatchDiagonal;
             }
             else if (minScore == delScore) {
-                pathMat[curIndex] = Left;
+                matchArrow = AffineBandArrows::MatchLeft;
             }
             else if (minScore == minInsScore) {
-                pathMat[curIndex] = AffineInsClose;
+                matchArrow = AffineBandArrows::MatchInsClose;
             }
             else {
-                pathMat[curIndex] = AffineHPInsClose;
+                matchArrow = AffineBandArrows::MatchHPInsClose;
+            }
+            rowArrows[c] = AffineBandArrows::Pack(matchArrow, insArrow, hpInsArrow);
+        }
+
+        if (alignType == TargetFit and q >= fitQStart and q < fitQEnd) {
+            fitScore[q] = row[k + (q - (int)tLen)].match;
+            if (q == fitQStart) {
+                fitStartScore = row[k - (q - (int)tLen)].match;
             }
         }
     }
-    /*
-       std::cout << "tracing back from: " << q << ", " << t << std::endl;
-       std::cout << "match score: " << std::endl;
-       PrintFlatMatrix(&scoreMat[0], qLen + 1, nCols, std::cout);
-       std::cout << " path: " << std::endl;
-       PrintFlatMatrix(pathMat, qLen + 1, nCols, std::cout);
-       std::cout << "hp  score: " << std::endl;
-       PrintFlatMatrix(&hpInsScoreMat[0], qLen + 1, nCols, std::cout);
-       std::cout << "hp  path: " << std::endl;
-       PrintFlatMatrix(hpInsPathMat, qLen + 1, nCols, std::cout);	
-       std::cout << "normal affine ins score: " << std::endl;
-       PrintFlatMatrix(&insScoreMat[0], qLen + 1, nCols, std::cout);
-       std::cout << "normal affine ins path: " << std::endl;
-       PrintFlatMatrix(&insPathMat[0], qLen + 1, nCols, std::cout);
-       */
-    vector<Arrow>  optAlignment;
+
+    //
+    // The last row of scores.
+    //
+    AffineBandCell *lastRow = &strip[(qLen % 2) * nCols];
+
+    std::vector<Arrow>  optAlignment;
     // First find the end position matrix.
 
     int minScoreTPos, minScore;
     int minScoreQPos;
+    int optScore = 0;
     if (alignType == Global) {
         q = qLen ;
         t = k - (static_cast<int>(qLen) - static_cast<int>(tLen));
+        optScore = lastRow[t].match;
     }
     else if (alignType == QueryFit) {
         q = qLen;
-        minScoreTPos = max(q-k,1);
-        DNALength index = rc2index(qLen, k + minScoreTPos - q, nCols);
-        minScore = scoreMat[index];
+        minScoreTPos = std::max(q-k,1);
+        minScore = lastRow[k + minScoreTPos - q].match;
         for (t = q - k; t < q + k + 1; t++) {
             if (t < 1) { continue;}
             if (t > static_cast<int>(tLen)) { break;}
-            int index = rc2index(qLen,k + t - q,nCols);
-            if (scoreMat[index] < minScore) {
+            if (lastRow[k + t - q].match < minScore) {
                 minScoreTPos = t;
-                minScore = scoreMat[index ];
+                minScore = lastRow[k + t - q].match;
             }
         }
         t = k - (static_cast<int>(qLen) - minScoreTPos);
+        optScore = lastRow[t].match;
     }
     else if (alignType == TargetFit) {
-        t = tLen;
-
-        int qStart = max(0,min((int)qLen, (int)tLen) - max(0, k - max(((int)tLen) - ((int)qLen), 0)));
-        int qEnd = min(qLen, tLen + k) + 1;
-
-        minScoreQPos = qStart;
-        int index = rc2index(minScoreQPos, k - (minScoreQPos - tLen), nCols);
-        minScore = scoreMat[index];
-        for (q = qStart; q < qEnd; q++) {
+        minScoreQPos = fitQStart;
+        minScore = fitStartScore;
+        for (q = fitQStart; q < fitQEnd; q++) {
             // add to k since this is going up.
-            index = rc2index(q, k + (q - tLen), nCols);
-            if (scoreMat[index] < minScore) {
+            if (fitScore[q] < minScore) {
                 minScoreQPos = q;
-                minScore     = scoreMat[index];
+                minScore     = fitScore[q];
             }
         }
         q = minScoreQPos;
         t = (k+((int)q-(int)tLen));
+        optScore = fitScore[q];
     }
 
-    int optScore = scoreMat[rc2index(q, t, nCols)];
     Arrow arrow;
     MatrixLabel curMatrix = Match;
 
@@ -340,8 +347,9 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
     while ((q > 0) or
             (q == 0 and t > k)) {
         assert(t < 2*k+1);
+        unsigned char cellArrows = arrows[rc2index(q, t, nCols)];
         if (curMatrix == Match) {
-            arrow = pathMat[rc2index(q,t, nCols)];
+            arrow = AffineBandArrows::MatchArrow(cellArrows);
             if (arrow == Diagonal) {
                 optAlignment.push_back(arrow);
                 q--;
@@ -365,7 +373,7 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
         else if (curMatrix == AffineHPIns) {
             //
             // The current
-            arrow = hpInsPathMat[rc2index(q,t,nCols)];
+            arrow = AffineBandArrows::HPInsArrow(cellArrows);
             if (arrow == AffineHPInsOpen) {
                 curMatrix = Match;
             }
@@ -378,7 +386,7 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
             t++;
         }
         else if (curMatrix == AffineIns) {
-            arrow = insPathMat[rc2index(q,t,nCols)];
+            arrow = AffineBandArrows::InsArrow(cellArrows);
             if (arrow == AffineInsOpen) {
                 curMatrix = Match;
             }
@@ -395,12 +403,40 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
             assert(0);
         }
     }
-    //	qSeq.Free();
-    //	tSeq.Free();
     std::reverse(optAlignment.begin(), optAlignment.end());
     alignment.ArrowPathToAlignment(optAlignment);
     return optScore;
 }
 
+//
+// Align using separate score and path matrices for each state.  The
+// matrices are no longer used; this forwards to the banded version
+// above with buffers that are local to the call.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment>
+int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
+        int matchMat[5][5], 
+        int hpInsOpen, int hpInsExtend, int insOpen, int insExtend,
+        int del, int k,
+        std::vector<int> &scoreMat,
+        std::vector<Arrow> & pathMat,
+        std::vector<int> &hpInsScoreMat,
+        std::vector<Arrow> &hpInsPathMat,
+        std::vector<int> &insScoreMat,
+        std::vector<Arrow> &insPathMat,
+        T_Alignment &alignment, 
+        AlignmentType alignType) {
+    PB_UNUSED(scoreMat);
+    PB_UNUSED(pathMat);
+    PB_UNUSED(hpInsScoreMat);
+    PB_UNUSED(hpInsPathMat);
+    PB_UNUSED(insScoreMat);
+    PB_UNUSED(insPathMat);
+    AffineKBandBuffers buffers;
+    return AffineKBandAlign(pqSeq, ptSeq, matchMat, 
+            hpInsOpen, hpInsExtend, insOpen, insExtend, del, k,
+            buffers, alignment, alignType);
+}
+
 
 #endif // _BLASR_AFFINE_KBAND_ALIGN_HPP_
@@ -0,0 +1,263 @@
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+#include "AlignmentBlockStats.hpp"
+
+static inline bool BasesMatch(Nucleotide q, Nucleotide t, BaseMatchRule rule) {
+    if (q == t) {
+        return true;
+    }
+    if (rule == MatchThreeBit) {
+        return ThreeBit[q] == ThreeBit[t];
+    }
+    else if (rule == MatchTwoBit) {
+        return TwoBit[q] == TwoBit[t];
+    }
+    return false;
+}
+
+DNALength MatchRunLength(const Nucleotide *query, const Nucleotide *target,
+    DNALength length, BaseMatchRule rule) {
+    DNALength i = 0;
+    uint64_t qWord, tWord;
+    while (i + sizeof(uint64_t) <= length) {
+        memcpy(&qWord, query + i, sizeof(uint64_t));
+        memcpy(&tWord, target + i, sizeof(uint64_t));
+        if (qWord != tWord) {
+            //
+            // Some byte differs; it may still match under rule, so
+            // resolve this word base by base and continue after it.
+            //
+            DNALength wordEnd = i + sizeof(uint64_t);
+            for (; i < wordEnd; i++) {
+                if (!BasesMatch(query[i], target[i], rule)) {
+                    return i;
+                }
+            }
+        }
+        else {
+            i += sizeof(uint64_t);
+        }
+    }
+    for (; i < length; i++) {
+        if (!BasesMatch(query[i], target[i], rule)) {
+            return i;
+        }
+    }
+    return length;
+}
+
+void AppendMatchRunOps(const Nucleotide *query, const Nucleotide *target,
+    DNALength length, BaseMatchRule rule,
+    std::vector<int> &opSize, std::vector<char> &opChar) {
+    DNALength i = 0;
+    bool started = false;
+    while (i < length) {
+        DNALength run = MatchRunLength(query + i, target + i, length - i, rule);
+        if (run > 0) {
+            opSize.push_back(run);
+            opChar.push_back('=');
+            started = true;
+            i += run;
+        }
+        if (i < length) {
+            if (started and opChar.back() == 'X') {
+                opSize.back()++;
+            }
+            else {
+                opSize.push_back(1);
+                opChar.push_back('X');
+                started = true;
+            }
+            i++;
+        }
+    }
+}
+
+AlignmentBlockStats::AlignmentBlockStats() {
+    Clear();
+}
+
+void AlignmentBlockStats::Clear() {
+    nMatch = nMismatch = nIns = nDel = 0;
+    score = 0;
+    opSize.clear();
+    opChar.clear();
+    mdString = "";
+}
+
+//
+// State shared by the steps of one ComputeAlignmentBlockStats pass.
+//
+class BlockStatsPass {
+public:
+    AlignmentBlockStats &stats;
+    int (*scoreMatrix)[5];
+    int ins, del;
+    bool createOps, createMD;
+    bool uniformMatch;
+    int matchScore;
+    int mdRun;
+    std::stringstream md;
+
+    BlockStatsPass(AlignmentBlockStats &statsP, int (*scoreMatrixP)[5],
+        int insP, int delP, bool createOpsP, bool createMDP) :
+        stats(statsP), scoreMatrix(scoreMatrixP), ins(insP), del(delP),
+        createOps(createOpsP), createMD(createMDP) {
+        uniformMatch = false;
+        matchScore = 0;
+        mdRun = 0;
+        if (scoreMatrix != NULL) {
+            matchScore = scoreMatrix[0][0];
+            uniformMatch = true;
+            for (int c = 1; c < 5; c++) {
+                if (scoreMatrix[c][c] != matchScore) {
+                    uniformMatch = false;
+                }
+            }
+        }
+    }
+
+    void AddOp(int length, char op) {
+        if (!stats.opChar.empty() and stats.opChar.back() == op) {
+            stats.opSize.back() += length;
+        }
+        else {
+            stats.opSize.push_back(length);
+            stats.opChar.push_back(op);
+        }
+    }
+
+    void FlushMDRun() {
+        md << mdRun;
+        mdRun = 0;
+    }
+
+    void AddBlock(const Nucleotide *q, const Nucleotide *t, DNALength length) {
+        DNALength i = 0;
+        while (i < length) {
+            DNALength run = MatchRunLength(q + i, t + i, length - i, MatchThreeBit);
+            if (run > 0) {
+                stats.nMatch += run;
+                if (scoreMatrix != NULL) {
+                    if (uniformMatch) {
+                        stats.score += run * matchScore;
+                    }
+                    else {
+                        for (DNALength r = i; r < i + run; r++) {
+                            stats.score += scoreMatrix[ThreeBit[q[r]]][ThreeBit[t[r]]];
+                        }
+                    }
+                }
+                if (createOps) {
+                    AddOp(run, '=');
+                }
+                mdRun += run;
+                i += run;
+            }
+            if (i < length) {
+                stats.nMismatch++;
+                if (scoreMatrix != NULL) {
+                    stats.score += scoreMatrix[ThreeBit[q[i]]][ThreeBit[t[i]]];
+                }
+                if (createOps) {
+                    AddOp(1, 'X');
+                }
+                if (createMD) {
+                    FlushMDRun();
+                    md << (char) toupper(t[i]);
+                }
+                i++;
+            }
+        }
+    }
+
+    void AddInsertion(int length) {
+        if (length <= 0) {
+            return;
+        }
+        stats.nIns += length;
+        stats.score += (scoreMatrix != NULL) ? length * ins : 0;
+        if (createOps) {
+            AddOp(length, 'I');
+        }
+    }
+
+    void AddDeletion(const Nucleotide *t, int length) {
+        if (length <= 0) {
+            return;
+        }
+        stats.nDel += length;
+        stats.score += (scoreMatrix != NULL) ? length * del : 0;
+        if (createOps) {
+            AddOp(length, 'D');
+        }
+        if (createMD) {
+            FlushMDRun();
+            md << '^';
+            for (int i = 0; i < length; i++) {
+                md << (char) toupper(t[i]);
+            }
+        }
+    }
+
+    void AddGapList(blasr::GapList &gapList, Nucleotide *tSeq,
+        DNALength &q, DNALength &t) {
+        for (VectorIndex g = 0; g < gapList.size(); g++) {
+            if (gapList[g].seq == blasr::Gap::Query) {
+                AddDeletion(&tSeq[t], gapList[g].length);
+                t += gapList[g].length;
+            }
+            else {
+                AddInsertion(gapList[g].length);
+                q += gapList[g].length;
+            }
+        }
+    }
+};
+
+void ComputeAlignmentBlockStats(blasr::Alignment &alignment,
+    Nucleotide *qSeq, Nucleotide *tSeq, AlignmentBlockStats &stats,
+    int scoreMatrix[5][5], int ins, int del,
+    bool createOps, bool createMD) {
+
+    stats.Clear();
+    BlockStatsPass pass(stats, scoreMatrix, ins, del, createOps, createMD);
+    VectorIndex b, nBlocks = alignment.blocks.size();
+    if (alignment.gaps.size() > 0) {
+        //
+        // Follow the gap list from the start of the alignment, as
+        // CreateAlignmentStrings does.
+        //
+        DNALength q = alignment.qPos, t = alignment.tPos;
+        pass.AddGapList(alignment.gaps[0], tSeq, q, t);
+        for (b = 0; b < nBlocks; b++) {
+            DNALength length = alignment.blocks[b].length;
+            pass.AddBlock(&qSeq[q], &tSeq[t], length);
+            q += length;
+            t += length;
+            if (b + 1 < nBlocks and b + 1 < alignment.gaps.size()) {
+                pass.AddGapList(alignment.gaps[b + 1], tSeq, q, t);
+            }
+        }
+    }
+    else {
+        for (b = 0; b < nBlocks; b++) {
+            blasr::Block &block = alignment.blocks[b];
+            DNALength q = alignment.qPos + block.qPos;
+            DNALength t = alignment.tPos + block.tPos;
+            if (b > 0) {
+                blasr::Block &prev = alignment.blocks[b - 1];
+                pass.AddInsertion(block.qPos - prev.QEnd());
+                pass.AddDeletion(&tSeq[alignment.tPos + prev.TEnd()],
+                    block.tPos - prev.TEnd());
+            }
+            pass.AddBlock(&qSeq[q], &tSeq[t], block.length);
+        }
+    }
+    if (createMD) {
+        pass.FlushMDRun();
+        stats.mdString = pass.md.str();
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef _BLASR_ALIGNMENT_BLOCK_STATS_HPP_
+#define _BLASR_ALIGNMENT_BLOCK_STATS_HPP_
+
+#include <string>
+#include <vector>
+// pbdata
+#include "../../../pbdata/Types.h"
+#include "../../../pbdata/NucConversion.hpp"
+
+#include "../../datastructures/alignment/Alignment.hpp"
+
+//
+// How two aligned bases are decided to match.
+//   MatchExactBase - the same byte, as the SAM =/X operations are.
+//   MatchThreeBit  - the same ThreeBit code, ignoring case, with all
+//                    ambiguous bases equal to each other, as the
+//                    alignment stats are.
+//   MatchTwoBit    - the same TwoBit code, as the alignment strings are.
+//
+enum BaseMatchRule {MatchExactBase, MatchThreeBit, MatchTwoBit};
+
+//
+// The number of bases at the start of query[0,length) and
+// target[0,length) that match under rule.  Bases are stored one per
+// byte, so the sequences are compared eight bases at a time with one
+// 64 bit xor; only a word with some differing byte is examined base
+// by base, since a byte that is equal matches under every rule.  In a
+// block of an alignment, which mostly matches, this skips the table
+// lookups of nearly every base.
+//
+DNALength MatchRunLength(const Nucleotide *query, const Nucleotide *target,
+    DNALength length, BaseMatchRule rule=MatchExactBase);
+
+//
+// Append the =/X operations of the block query[0,length),
+// target[0,length) to opSize and opChar.  The first run of the block
+// always starts a new operation.
+//
+void AppendMatchRunOps(const Nucleotide *query, const Nucleotide *target,
+    DNALength length, BaseMatchRule rule,
+    std::vector<int> &opSize, std::vector<char> &opChar);
+
+//
+// Everything that is counted from the columns of an alignment, so
+// that it can be computed in one pass over the blocks.
+//
+class AlignmentBlockStats {
+public:
+    int nMatch, nMismatch, nIns, nDel;
+    //
+    // The sum of the score matrix over aligned columns and ins/del
+    // over gap columns; only set when a score matrix is given.
+    //
+    int score;
+    // =/X/I/D operations, set when createOps is true.
+    std::vector<int> opSize;
+    std::vector<char> opChar;
+    //
+    // The SAM MD string against the forward target: match run
+    // lengths, the target base of each mismatch, and ^ followed by
+    // the target bases of each deletion.  Set when createMD is true.
+    //
+    std::string mdString;
+    AlignmentBlockStats();
+    void Clear();
+};
+
+//
+// Walk the blocks and gaps of alignment over qSeq and tSeq once,
+// computing the counts, and optionally the score, operations and MD
+// string, from runs of matches found by MatchRunLength with
+// ThreeBit equality.  Blocks are at qSeq + alignment.qPos + block.qPos
+// and likewise in the target.  The gaps of the gap list are counted
+// as in CreateAlignmentStrings: gaps before the first block and
+// between blocks, but not after the last block.  An alignment without
+// a gap list has the space between consecutive blocks counted as an
+// insertion of the query gap and a deletion of the target gap.
+//
+void ComputeAlignmentBlockStats(blasr::Alignment &alignment,
+    Nucleotide *qSeq, Nucleotide *tSeq, AlignmentBlockStats &stats,
+    int scoreMatrix[5][5]=NULL, int ins=0, int del=0,
+    bool createOps=false, bool createMD=false);
+
+#endif // _BLASR_ALIGNMENT_BLOCK_STATS_HPP_
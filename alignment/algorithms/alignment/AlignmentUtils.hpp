@@ -5,6 +5,7 @@
 #include "../../../pbdata/DNASequence.hpp"
 #include "../../datastructures/alignment/Alignment.hpp"
 #include "DistanceMatrixScoreFunction.hpp"
+#include "AlignmentBlockStats.hpp"
 
 enum AlignmentType { 
     Local,     // Standard Smith-Waterman
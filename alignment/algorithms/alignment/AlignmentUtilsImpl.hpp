@@ -408,6 +408,26 @@ void CreateAlignmentStrings(T_Alignment &alignment,
 template<typename T_Alignment, typename T_ScoreFn>
 void ComputeAlignmentStats(T_Alignment & alignment, Nucleotide* qSeq, Nucleotide * tSeq, T_ScoreFn & scoreFn, bool useAffineScore) {
     (void)(useAffineScore);
+    if (alignment.blocks.size() > 0 and alignment.gaps.size() > 0) {
+        //
+        // Count straight from the blocks and gap list rather than
+        // building the alignment strings.
+        //
+        AlignmentBlockStats stats;
+        ComputeAlignmentBlockStats(alignment, qSeq, tSeq, stats,
+            scoreFn.scoreMatrix, scoreFn.ins, scoreFn.del);
+        int alignLength = stats.nMatch + stats.nMismatch + stats.nIns + stats.nDel;
+        alignment.score = stats.score;
+        alignment.nMatch = stats.nMatch;
+        alignment.nMismatch = stats.nMismatch;
+        alignment.nDel = stats.nDel;
+        alignment.nIns = stats.nIns;
+        alignment.pctSimilarity = 0;
+        if (alignLength > 0) {
+            alignment.pctSimilarity = (stats.nMatch*2.0) / (alignLength * 2) * 100;
+        }
+        return;
+    }
     int qp = 0, tp = 0;
     int nMatch = 0, nMismatch = 0, nIns =0, nDel = 0;
     float pctSimilarity;
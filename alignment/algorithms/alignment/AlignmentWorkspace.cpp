@@ -0,0 +1,150 @@
+#include "AlignmentWorkspace.hpp"
+
+template<typename T>
+static size_t VectorBytes(const std::vector<T> &v) {
+    return v.capacity() * sizeof(T);
+}
+
+static size_t VectorBytes(const std::vector<bool> &v) {
+    return v.capacity() / 8;
+}
+
+template<typename T>
+static size_t MatrixBytes(const FlatMatrix2D<T> &m) {
+    return static_cast<size_t>(m.totalSize) * sizeof(T);
+}
+
+template<typename T>
+static void FreeVector(std::vector<T> &v) {
+    std::vector<T>().swap(v);
+}
+
+template<typename T>
+static void FreeMatrix(FlatMatrix2D<T> &m) {
+    if (m.matrix != NULL) {
+        delete[] m.matrix;
+    }
+    m.matrix = NULL;
+    m.nRows = m.nCols = m.totalSize = 0;
+}
+
+AlignmentWorkspace::AlignmentWorkspace() {
+    peakBytes = 0;
+}
+
+size_t AlignmentWorkspace::AllocatedBytes() const {
+    size_t bytes = 0;
+    bytes += VectorBytes(scoreMat);
+    bytes += VectorBytes(pathMat);
+    bytes += VectorBytes(probMat);
+    bytes += VectorBytes(optPathProbMat);
+    bytes += VectorBytes(lnSubPValueMat);
+    bytes += VectorBytes(lnInsPValueMat);
+    bytes += VectorBytes(lnDelPValueMat);
+    bytes += VectorBytes(lnMatchPValueMat);
+    bytes += MatrixBytes(affineScoreMat);
+    bytes += MatrixBytes(affinePathMat);
+    bytes += VectorBytes(sdpFragmentSet);
+    bytes += VectorBytes(sdpPrefixFragmentSet);
+    bytes += VectorBytes(sdpSuffixFragmentSet);
+    bytes += VectorBytes(sdpCachedTargetTupleList.tupleList);
+    bytes += VectorBytes(sdpCachedTargetPrefixTupleList.tupleList);
+    bytes += VectorBytes(sdpCachedTargetSuffixTupleList.tupleList);
+    bytes += VectorBytes(sdpCachedMaxFragmentChain);
+    bytes += MatrixBytes(graphPaper.bins);
+    bytes += MatrixBytes(graphPaper.scoreMat);
+    bytes += MatrixBytes(graphPaper.pathMat);
+    bytes += VectorBytes(graphPaper.onOptPath);
+    bytes += VectorBytes(affineKBand.strip);
+    bytes += VectorBytes(affineKBand.arrows);
+    bytes += VectorBytes(affineKBand.fitScore);
+    bytes += VectorBytes(affineGuide.gapScores);
+    bytes += VectorBytes(affineGuide.gapArrows);
+    bytes += VectorBytes(fullQV.prevRow);
+    bytes += VectorBytes(fullQV.curRow);
+    bytes += VectorBytes(oneGap.prefixScore);
+    bytes += VectorBytes(oneGap.prefixCol);
+    bytes += VectorBytes(oneGap.prevRow);
+    bytes += VectorBytes(oneGap.curRow);
+    bytes += VectorBytes(oneGap.bandLo);
+    bytes += VectorBytes(oneGap.bandHi);
+    bytes += VectorBytes(oneGap.bandOffset);
+    bytes += VectorBytes(oneGap.bandArrows);
+    bytes += VectorBytes(oneGap.path);
+    bytes += VectorBytes(myers.peq);
+    bytes += VectorBytes(myers.pv);
+    bytes += VectorBytes(myers.mv);
+    bytes += VectorBytes(myers.blockScore);
+    bytes += VectorBytes(swBatch.qCodes);
+    bytes += VectorBytes(swBatch.tCodes);
+    bytes += VectorBytes(swBatch.prevRow);
+    bytes += VectorBytes(swBatch.curRow);
+    bytes += VectorBytes(swBatch.arrows);
+    bytes += VectorBytes(swBatch.path);
+    bytes += VectorBytes(swBatch.order);
+    return bytes;
+}
+
+size_t AlignmentWorkspace::UpdatePeakBytes() {
+    size_t bytes = AllocatedBytes();
+    if (bytes > peakBytes) {
+        peakBytes = bytes;
+    }
+    return peakBytes;
+}
+
+size_t AlignmentWorkspace::PeakBytes() const {
+    return peakBytes;
+}
+
+void AlignmentWorkspace::Release() {
+    UpdatePeakBytes();
+    FreeVector(scoreMat);
+    FreeVector(pathMat);
+    FreeVector(probMat);
+    FreeVector(optPathProbMat);
+    FreeVector(lnSubPValueMat);
+    FreeVector(lnInsPValueMat);
+    FreeVector(lnDelPValueMat);
+    FreeVector(lnMatchPValueMat);
+    FreeMatrix(affineScoreMat);
+    FreeMatrix(affinePathMat);
+    FreeVector(sdpFragmentSet);
+    FreeVector(sdpPrefixFragmentSet);
+    FreeVector(sdpSuffixFragmentSet);
+    FreeVector(sdpCachedTargetTupleList.tupleList);
+    FreeVector(sdpCachedTargetPrefixTupleList.tupleList);
+    FreeVector(sdpCachedTargetSuffixTupleList.tupleList);
+    FreeVector(sdpCachedMaxFragmentChain);
+    FreeMatrix(graphPaper.bins);
+    FreeMatrix(graphPaper.scoreMat);
+    FreeMatrix(graphPaper.pathMat);
+    FreeVector(graphPaper.onOptPath);
+    FreeVector(affineKBand.strip);
+    FreeVector(affineKBand.arrows);
+    FreeVector(affineKBand.fitScore);
+    FreeVector(affineGuide.gapScores);
+    FreeVector(affineGuide.gapArrows);
+    FreeVector(fullQV.prevRow);
+    FreeVector(fullQV.curRow);
+    FreeVector(oneGap.prefixScore);
+    FreeVector(oneGap.prefixCol);
+    FreeVector(oneGap.prevRow);
+    FreeVector(oneGap.curRow);
+    FreeVector(oneGap.bandLo);
+    FreeVector(oneGap.bandHi);
+    FreeVector(oneGap.bandOffset);
+    FreeVector(oneGap.bandArrows);
+    FreeVector(oneGap.path);
+    FreeVector(myers.peq);
+    FreeVector(myers.pv);
+    FreeVector(myers.mv);
+    FreeVector(myers.blockScore);
+    FreeVector(swBatch.qCodes);
+    FreeVector(swBatch.tCodes);
+    FreeVector(swBatch.prevRow);
+    FreeVector(swBatch.curRow);
+    FreeVector(swBatch.arrows);
+    FreeVector(swBatch.path);
+    FreeVector(swBatch.order);
+}
@@ -0,0 +1,109 @@
+#ifndef _BLASR_ALIGNMENT_WORKSPACE_HPP_
+#define _BLASR_ALIGNMENT_WORKSPACE_HPP_
+
+#include <vector>
+#include <cstddef>
+// pbdata
+#include "../../../pbdata/matrix/FlatMatrix.hpp"
+
+#include "../../datastructures/alignment/Path.h"
+#include "../../tuples/DNATuple.hpp"
+#include "../../tuples/TupleList.hpp"
+#include "sdp/SDPFragment.hpp"
+#include "AffineKBandAlign.hpp"
+#include "AffineGuidedAlign.hpp"
+#include "FullQVAlign.hpp"
+#include "OneGapAlignment.hpp"
+#include "MyersAlign.hpp"
+#include "SWAlignBatch.hpp"
+#include "GraphPaper.hpp"
+
+//
+// All of the dynamic programming storage the pairwise aligners use,
+// kept in one object that a mapping thread owns for its lifetime.  The
+// members have the names the buffer cache versions of SDPAlign,
+// GuidedAlign, AffineGuidedAlign and OneGapAlign expect, so a
+// workspace may be passed wherever a buffer cache is taken (and
+// AffineGuidedAlign then also reuses affineGuide), and the
+// vector members may be passed to SWAlign, KBandAlign and
+// ExtendAlignmentForward/Reverse.
+//
+// Nothing is allocated until an aligner first needs it, and no buffer
+// is ever shrunk, so each one stays at the largest size any alignment
+// in the thread has used.  Each aligner initializes only the part of a
+// buffer it uses for the current alignment.
+//
+class AlignmentWorkspace {
+public:
+    // SWAlign, KBandAlign, GuidedAlign, ExtendAlignment.
+    std::vector<int>    scoreMat;
+    std::vector<Arrow>  pathMat;
+
+    // GuidedAlign and AffineGuidedAlign with probabilities.
+    std::vector<double> probMat;
+    std::vector<double> optPathProbMat;
+    std::vector<float>  lnSubPValueMat;
+    std::vector<float>  lnInsPValueMat;
+    std::vector<float>  lnDelPValueMat;
+    std::vector<float>  lnMatchPValueMat;
+
+    // OneGapAlign with full matrices.
+    FlatMatrix2D<int>   affineScoreMat;
+    FlatMatrix2D<Arrow> affinePathMat;
+
+    // SDPAlign.
+    std::vector<Fragment> sdpFragmentSet;
+    std::vector<Fragment> sdpPrefixFragmentSet;
+    std::vector<Fragment> sdpSuffixFragmentSet;
+    TupleList<PositionDNATuple> sdpCachedTargetTupleList;
+    TupleList<PositionDNATuple> sdpCachedTargetPrefixTupleList;
+    TupleList<PositionDNATuple> sdpCachedTargetSuffixTupleList;
+    std::vector<int> sdpCachedMaxFragmentChain;
+    GraphPaperBuffers graphPaper;
+
+    AffineKBandBuffers affineKBand;
+    AffineGuideBuffers affineGuide;
+    FullQVAlignBuffers fullQV;
+    OneGapAlignBuffers oneGap;
+    MyersBuffers myers;
+    SWAlignBatchBuffers swBatch;
+
+    AlignmentWorkspace();
+
+    //
+    // The number of bytes currently held by the workspace.
+    //
+    size_t AllocatedBytes() const;
+
+    //
+    // Record AllocatedBytes() if it is the largest seen so far, and
+    // return the peak.  Call this after an alignment to track the peak
+    // memory use of the thread that owns this.
+    //
+    size_t UpdatePeakBytes();
+
+    //
+    // The largest AllocatedBytes() recorded by UpdatePeakBytes or
+    // Release.
+    //
+    size_t PeakBytes() const;
+
+    //
+    // Free all buffers, for example after an unusually long read
+    // grew them.  The peak is kept.
+    //
+    void Release();
+
+private:
+    size_t peakBytes;
+};
+
+//
+// Lend the workspace's affine gap buffers to the buffer cache versions
+// of AffineGuidedAlign.
+//
+inline AffineGuideBuffers *AffineGuideBuffersOf(AlignmentWorkspace &workspace) {
+    return &workspace.affineGuide;
+}
+
+#endif // _BLASR_ALIGNMENT_WORKSPACE_HPP_
@@ -425,4 +425,240 @@ int ExtendAlignmentReverse(T_QuerySeq &querySeq, int queryPos,
 
 }
 
+//
+// Extend an alignment from an anchor with X-drop termination.  Rather
+// than a fixed band that is recomputed until enough rows drop in
+// score, each row of the matrix only spans the cells that are within
+// xDrop of the best score seen in the previous rows, so the band
+// follows the alignment and shrinks through low identity sequence.
+// The extension stops at the first row with no such cells.  k bounds
+// the distance of a cell from the diagonal, as in ExtendAlignment.
+//
+// The rows are stored back to back in scoreMat and pathMat, and
+// rowBounds holds the first cell, last cell, and matrix offset of each
+// row, so all three buffers may be reused across calls.  Scores are
+// minimized, and the alignment ends at the best scoring cell.  If no
+// cell scores better than the anchor, the alignment is empty and the
+// score is 0.
+//
+template<typename T_Alignment, 
+    typename T_ScoreFn, 
+    typename T_QuerySeq, 
+    typename T_RefSeq, 
+    typename T_Index>
+int ExtendAlignmentXDrop(T_QuerySeq &querySeq, T_RefSeq &refSeq,
+        int k, int xDrop,
+        std::vector<int>   &scoreMat,
+        std::vector<Arrow> &pathMat,
+        std::vector<int>   &rowBounds,
+        T_Alignment   &alignment,
+        T_ScoreFn     &scoreFn,
+        T_Index  &index,
+        int minExtendNBases=1) {
+
+    if (index.queryAlignLength  < minExtendNBases or
+            index.refAlignLength < minExtendNBases) {
+        return 0;
+    }
+
+    //
+    // Row q holds the cells [rowBounds[3*q], rowBounds[3*q+1]],
+    // starting at rowBounds[3*q+2] in the matrices.
+    //
+    rowBounds.clear();
+
+    int bestScore = 0, bestQ = 0, bestT = 0;
+    int dropScore = bestScore + xDrop;
+    int tMax = index.TAlignLength();
+
+    int q, t;
+    int rowEnd = std::min(tMax, k);
+    if (scoreMat.size() < static_cast<size_t>(rowEnd + 1)) {
+        scoreMat.resize(rowEnd + 1);
+        pathMat.resize(rowEnd + 1);
+    }
+
+    //
+    // The first row only has deletions from the anchor.
+    //
+    int qSeqPos = index.QuerySeqPos(0);
+    scoreMat[0] = 0;
+    pathMat[0]  = NoArrow;
+    for (t = 1; t <= rowEnd; t++) {
+        int score = scoreMat[t-1] + scoreFn.Deletion(querySeq, qSeqPos);
+        if (score > dropScore) {
+            break;
+        }
+        scoreMat[t] = score;
+        pathMat[t]  = Left;
+    }
+    rowBounds.push_back(0);
+    rowBounds.push_back(t-1);
+    rowBounds.push_back(0);
+
+    for (q = 1; index.QNotAtSeqBoundary(q-1); q++) {
+        int prevLo = rowBounds[3*(q-1)], prevHi = rowBounds[3*(q-1)+1];
+        int prevOffset = rowBounds[3*(q-1)+2];
+        int offset = prevOffset + prevHi - prevLo + 1;
+        int lo = std::max(prevLo, q - k);
+        rowEnd = std::min(tMax, q + k);
+        if (lo > rowEnd) {
+            break;
+        }
+        if (scoreMat.size() < static_cast<size_t>(offset + rowEnd - lo + 1)) {
+            scoreMat.resize(offset + rowEnd - lo + 1);
+            pathMat.resize(offset + rowEnd - lo + 1);
+        }
+
+        qSeqPos = index.QuerySeqPos(q-1);
+        int firstLive = -1, lastLive = -1;
+        int rowBestScore = INF_INT, rowBestT = 0;
+        for (t = lo; t <= rowEnd; t++) {
+            int insScore = INF_INT, delScore = INF_INT, matchScore = INF_INT;
+            int cur = offset + t - lo;
+
+            if (t == 0) {
+                insScore = scoreMat[prevOffset] + scoreFn.Insertion(querySeq, qSeqPos);
+            }
+            else {
+                int tSeqPos = index.RefSeqPos(t-1);
+                if (t <= prevHi and scoreMat[prevOffset + t - prevLo] != INF_INT) {
+                    insScore = scoreMat[prevOffset + t - prevLo] + 
+                        scoreFn.Insertion(refSeq, (DNALength) tSeqPos, querySeq, (DNALength) qSeqPos);
+                }
+                if (t - 1 >= prevLo and t - 1 <= prevHi and scoreMat[prevOffset + t - 1 - prevLo] != INF_INT) {
+                    matchScore = scoreMat[prevOffset + t - 1 - prevLo] + 
+                        scoreFn.Match(refSeq, (DNALength) tSeqPos, querySeq, (DNALength) qSeqPos);
+                }
+                if (t > lo and scoreMat[cur - 1] != INF_INT) {
+                    delScore = scoreMat[cur - 1] + 
+                        scoreFn.Deletion(refSeq, (DNALength) tSeqPos, querySeq, (DNALength) qSeqPos);
+                }
+            }
+
+            int minScore = std::min(matchScore, std::min(delScore, insScore));
+            if (minScore > dropScore) {
+                //
+                // This cell has dropped too far below the best score to be
+                // extended.  Past the end of the previous row only
+                // deletions reach a cell, so the row ends here.
+                //
+                scoreMat[cur] = INF_INT;
+                pathMat[cur]  = NoArrow;
+                if (t > prevHi) {
+                    break;
+                }
+                continue;
+            }
+            scoreMat[cur] = minScore;
+            if (minScore == matchScore) { pathMat[cur] = Diagonal; }
+            else if (minScore == delScore) { pathMat[cur] = Left; }
+            else { pathMat[cur] = Up; }
+
+            if (firstLive == -1) {
+                firstLive = t;
+            }
+            lastLive = t;
+            if (minScore < rowBestScore) {
+                rowBestScore = minScore;
+                rowBestT     = t;
+            }
+        }
+
+        if (firstLive == -1) {
+            break;
+        }
+
+        //
+        // Trim the dead cells from the ends of the row.  The next row
+        // is stored after the last live cell.
+        //
+        rowBounds.push_back(firstLive);
+        rowBounds.push_back(lastLive);
+        rowBounds.push_back(offset + firstLive - lo);
+
+        if (rowBestScore < bestScore) {
+            bestScore = rowBestScore;
+            bestQ     = q;
+            bestT     = rowBestT;
+            dropScore = bestScore + xDrop;
+        }
+    }
+
+    //
+    // Trace back from the best cell to the anchor.
+    //
+    std::vector<Arrow> optAlignment;
+    q = bestQ;
+    t = bestT;
+    while (q > 0 or t > 0) {
+        Arrow arrow = pathMat[rowBounds[3*q+2] + t - rowBounds[3*q]];
+        assert(arrow != NoArrow);
+        optAlignment.push_back(arrow);
+        if (arrow == Diagonal) {
+            q--;
+            t--;
+        }
+        else if (arrow == Left) {
+            t--;
+        }
+        else {
+            q--;
+        }
+    }
+
+    index.OrderArrowVector(optAlignment);
+    alignment.ArrowPathToAlignment(optAlignment);
+    alignment.qPos = index.GetQueryStartPos(q, bestQ);
+    alignment.tPos = index.GetRefStartPos(t, bestT);
+
+    return bestScore;
+}
+
+template<typename T_Alignment, typename T_ScoreFn, typename T_QuerySeq, typename T_RefSeq>
+int ExtendAlignmentForwardXDrop(T_QuerySeq &querySeq, int queryPos, 
+        T_RefSeq   &refSeq,   int refPos,
+        int k, int xDrop,
+        std::vector<int>   &scoreMat,
+        std::vector<Arrow> &pathMat,
+        std::vector<int>   &rowBounds,
+        T_Alignment   &alignment,
+        T_ScoreFn     &scoreFn,
+        int minExtendNBases=1) {
+
+    ForwardIndex forwardIndex;
+    forwardIndex.queryPos = queryPos;
+    forwardIndex.refPos   = refPos;
+    forwardIndex.queryAlignLength = querySeq.length - queryPos;
+    forwardIndex.refAlignLength   = refSeq.length - refPos;
+    int alignScore;
+    alignScore = ExtendAlignmentXDrop(querySeq, refSeq, k, xDrop,
+            scoreMat, pathMat, rowBounds,
+            alignment, scoreFn, forwardIndex, minExtendNBases);
+    alignment.qPos = queryPos;
+    alignment.tPos = refPos;
+    return alignScore;
+}
+
+template<typename T_Alignment, typename T_ScoreFn, typename T_QuerySeq, typename T_RefSeq>
+int ExtendAlignmentReverseXDrop(T_QuerySeq &querySeq, int queryPos, 
+        T_RefSeq   &refSeq,   int refPos,
+        int k, int xDrop,
+        std::vector<int>   &scoreMat,
+        std::vector<Arrow> &pathMat,
+        std::vector<int>   &rowBounds,
+        T_Alignment   &alignment,
+        T_ScoreFn     &scoreFn,
+        int minExtendNBases=1) {
+
+    ReverseIndex reverseIndex;
+    reverseIndex.queryPos = queryPos-1;
+    reverseIndex.refPos   = refPos-1;
+    reverseIndex.queryAlignLength = queryPos;
+    reverseIndex.refAlignLength   = refPos;
+    return ExtendAlignmentXDrop(querySeq, refSeq, k, xDrop,
+            scoreMat, pathMat, rowBounds,
+            alignment, scoreFn, reverseIndex, minExtendNBases);
+}
+
 #endif // _BLASR_EXTEND_ALIGN_HPP_
@@ -1,9 +1,15 @@
 #ifndef _BLASR_FULL_QV_ALIGN_HPP_
 #define _BLASR_FULL_QV_ALIGN_HPP_
+#include <vector>
+#include <cmath>
+#include <algorithm>
 // pbdata
 #include "../../../pbdata/matrix/Matrix.hpp"
 #include "../../../pbdata/FASTQSequence.hpp"
 #include "../../../pbdata/FASTASequence.hpp"
+#include "../../../pbdata/NucConversion.hpp"
+#include "../../utils/LogUtils.hpp"
+#include "GuidedAlign.hpp"
 
 template<typename T_Query, typename T_Reference>
 double FullQVAlign(T_Query       &query,
@@ -128,5 +134,243 @@ double FullQVAlign(T_Query       &query,
     return fullAlignProb;
 }
 
+//
+// The natural log probabilities of the events FullQVLogAlign scores at
+// each position of a sequence, computed once from its phred quality
+// values so the forward recursion does no transcendental math.
+//
+class FullQVLogProbs {
+public:
+    // log(1 - p_sub) and log(p_sub / 3).
+    std::vector<float> lnNoSub, lnSub;
+    std::vector<float> lnIns, lnDel;
+    //
+    // log(p_preBaseDel(b) * p_del) for the four bases b at each
+    // position that has a deletion tag.
+    //
+    std::vector<float> lnTaggedDel;
+    std::vector<unsigned char> hasDelTag;
+
+    static inline float PhredToLogP(QualityValue qv) {
+        return qv * (float) (-LOG10 / 10.0);
+    }
+
+    template<typename T_Sequence>
+    void Initialize(T_Sequence &seq) {
+        DNALength i;
+        int b;
+        lnNoSub.resize(seq.length);
+        lnSub.resize(seq.length);
+        lnIns.resize(seq.length);
+        lnDel.resize(seq.length);
+        lnTaggedDel.resize(seq.length * 4);
+        hasDelTag.resize(seq.length);
+        for (i = 0; i < seq.length; i++) {
+            float lnSubP = PhredToLogP(seq.GetSubstitutionQV(i));
+            lnNoSub[i] = log1p(-exp(lnSubP));
+            lnSub[i]   = lnSubP - log(3.0);
+            lnIns[i]   = PhredToLogP(seq.GetInsertionQV(i));
+            lnDel[i]   = PhredToLogP(seq.GetDeletionQV(i));
+            hasDelTag[i] = (seq.GetDeletionTag(i) != 'N');
+            for (b = 0; b < 4; b++) {
+                lnTaggedDel[i*4 + b] = PhredToLogP(seq.GetPreBaseDeletionQV(i, TwoBitToAscii[b])) + lnDel[i];
+            }
+        }
+    }
+};
+
+//
+// Two rows of forward probabilities, reused between calls when a
+// caller passes them in.
+//
+class FullQVAlignBuffers {
+public:
+    std::vector<float> prevRow, curRow;
+};
+
+//
+// Compute the log probability of all alignments of query[0,qEnd) to
+// target[0,tEnd) that start at (qStart, tStart), with the same
+// recursion as FullQVAlign.  Prefix row q only spans target prefixes
+// [rowTStart[q-qStart], rowTEnd[q-qStart]]; cells outside the rows
+// have probability 0.  
+//
+// A row is computed in two passes.  The match and insertion terms only
+// depend on the previous row, so the first pass has no loop carried
+// dependency.  The second pass adds the deletion term from the cell to
+// the left.
+//
+template<typename T_Query, typename T_Reference>
+float FullQVLogForward(T_Query &query, T_Reference &target,
+        FullQVLogProbs &queryProbs, FullQVLogProbs &targetProbs,
+        int qStart, int qEnd, int tStart, int tEnd,
+        std::vector<int> &rowTStart, std::vector<int> &rowTEnd,
+        FullQVAlignBuffers &buffers) {
+
+    const LogSumTable &logSum = LogSumTable::Get();
+    const float lnZero = -INFINITY;
+
+    int nCols = tEnd - tStart + 1;
+    std::vector<float> &prevRow = buffers.prevRow;
+    std::vector<float> &curRow  = buffers.curRow;
+    if (static_cast<int>(prevRow.size()) < nCols) {
+        prevRow.resize(nCols);
+        curRow.resize(nCols);
+    }
+
+    // 
+    // Rows are indexed by target prefix - tStart.  The first row may
+    // only grow by gaps in the query.
+    //
+    int t, q;
+    int lo = rowTStart[0], hi = rowTEnd[0];
+    curRow[lo - tStart] = 0;
+    for (t = lo + 1; t <= hi; t++) {
+        curRow[t - tStart] = curRow[t - 1 - tStart] + targetProbs.lnIns[t-1];
+    }
+
+    for (q = qStart + 1; q <= qEnd; q++) {
+        std::swap(prevRow, curRow);
+        int prevLo = lo, prevHi = hi;
+        lo = rowTStart[q - qStart];
+        hi = rowTEnd[q - qStart];
+        Nucleotide qBase = query.seq[q-1];
+        float qNoSub = queryProbs.lnNoSub[q-1];
+        float qSub   = queryProbs.lnSub[q-1];
+        float qIns   = queryProbs.lnIns[q-1];
+        float qDel   = queryProbs.lnDel[q-1];
+        int qPrevBase = (q > 1) ? TwoBit[query.seq[q-2]] : 0;
+
+        for (t = lo; t <= hi; t++) {
+            float matchProb = lnZero, insProb = lnZero;
+            if (t > tStart and t - 1 >= prevLo and t - 1 <= prevHi) {
+                float lnMatch;
+                if (qBase == target.seq[t-1]) {
+                    lnMatch = qNoSub + targetProbs.lnNoSub[t-1];
+                }
+                else {
+                    lnMatch = logSum.Sum(qSub + targetProbs.lnNoSub[t-1],
+                                         qNoSub + targetProbs.lnSub[t-1]);
+                }
+                matchProb = prevRow[t - 1 - tStart] + lnMatch;
+            }
+            if (t >= prevLo and t <= prevHi) {
+                //
+                // An insertion in the query is either an extra base in
+                // the query, or a deletion in the target.  A tagged
+                // deletion in the target is assumed to be of the
+                // previous query base, and is scored as untagged when
+                // that base is not ACGT.
+                //
+                float lnInserted;
+                if (t == tStart) {
+                    lnInserted = qIns;
+                }
+                else if (targetProbs.hasDelTag[t-1] and q == 1) {
+                    lnInserted = qIns;
+                }
+                else if (targetProbs.hasDelTag[t-1] and qPrevBase < 4) {
+                    lnInserted = logSum.Sum(targetProbs.lnTaggedDel[(t-1)*4 + qPrevBase], qIns);
+                }
+                else {
+                    lnInserted = logSum.Sum(qIns, targetProbs.lnDel[t-1]);
+                }
+                insProb = prevRow[t - tStart] + lnInserted;
+            }
+            curRow[t - tStart] = logSum.Sum(matchProb, insProb);
+        }
+
+        for (t = lo + 1; t <= hi; t++) {
+            //
+            // An insertion in the target is either an extra base in the
+            // target, or a deletion in the query.
+            //
+            float tIns = targetProbs.lnIns[t-1];
+            float lnDeleted;
+            int tPrevBase = (t > 1) ? TwoBit[target.seq[t-2]] : 0;
+            if (queryProbs.hasDelTag[q-1] and t == 1) {
+                lnDeleted = tIns;
+            }
+            else if (queryProbs.hasDelTag[q-1] and tPrevBase < 4) {
+                lnDeleted = logSum.Sum(queryProbs.lnTaggedDel[(q-1)*4 + tPrevBase], tIns);
+            }
+            else {
+                lnDeleted = logSum.Sum(tIns, qDel);
+            }
+            curRow[t - tStart] = logSum.Sum(curRow[t - tStart], 
+                                            curRow[t - 1 - tStart] + lnDeleted);
+        }
+    }
+
+    if (tEnd < lo or tEnd > hi) {
+        return lnZero;
+    }
+    return curRow[tEnd - tStart];
+}
+
+//
+// Compute the log probability of aligning all of query to all of
+// target, summed over every alignment, from precomputed log
+// probabilities.  This is FullQVAlign with phred quality values read as
+// probabilities, the error probabilities of the two sequences combined
+// as in FullQVAlign, and only two rows of the matrix kept.
+//
+template<typename T_Query, typename T_Reference>
+float FullQVLogAlign(T_Query &query, T_Reference &target,
+        FullQVLogProbs &queryProbs, FullQVLogProbs &targetProbs,
+        FullQVAlignBuffers *buffers=NULL) {
+
+    if (query.length == 0 or target.length == 0) { return 0; }
+
+    FullQVAlignBuffers localBuffers;
+    if (buffers == NULL) {
+        buffers = &localBuffers;
+    }
+    std::vector<int> rowTStart(query.length + 1, 0);
+    std::vector<int> rowTEnd(query.length + 1, target.length);
+    return FullQVLogForward(query, target, queryProbs, targetProbs,
+            0, query.length, 0, target.length, 
+            rowTStart, rowTEnd, *buffers);
+}
+
+//
+// Compute the same probability restricted to a band of bandSize around
+// guideAlignment, from the start to the end of the guide.  Most of the
+// probability of a good candidate lies within a narrow band, so this
+// is the version to use to rescore candidate alignments.
+//
+template<typename T_Query, typename T_Reference>
+float FullQVLogAlign(T_Query &query, T_Reference &target,
+        FullQVLogProbs &queryProbs, FullQVLogProbs &targetProbs,
+        blasr::Alignment &guideAlignment, int bandSize,
+        FullQVAlignBuffers *buffers=NULL) {
+
+    Guide guide;
+    AlignmentToGuide(guideAlignment, guide, bandSize);
+    if (guide.size() < 2) { return 0; }
+
+    FullQVAlignBuffers localBuffers;
+    if (buffers == NULL) {
+        buffers = &localBuffers;
+    }
+
+    //
+    // The guide is in sequence coordinates, with the first row before
+    // the start of the alignment.  Convert it to prefix lengths.
+    //
+    int qStart = guide[1].q;
+    int tStart = guide[1].t;
+    int qEnd   = guide[guide.size()-1].q + 1;
+    int tEnd   = guide[guide.size()-1].t + 1;
+    std::vector<int> rowTStart(guide.size()), rowTEnd(guide.size());
+    for (size_t r = 0; r < guide.size(); r++) {
+        rowTStart[r] = std::max(guide[r].t - guide[r].tPre + 1, tStart);
+        rowTEnd[r]   = std::min(guide[r].t + guide[r].tPost + 1, tEnd);
+    }
+    return FullQVLogForward(query, target, queryProbs, targetProbs,
+            qStart, qEnd, tStart, tEnd, 
+            rowTStart, rowTEnd, *buffers);
+}
+
 
 #endif // _BLASR_FULL_QV_ALIGN_HPP_
@@ -4,6 +4,19 @@
 #include "../../datastructures/alignment/Path.h"
 #include "../../../pbdata/matrix/FlatMatrix.hpp"
 
+//
+// Storage for the GraphPaper grids.  A caller that filters many
+// fragment sets, such as one mapping thread, may keep one of these so
+// the grids are only reallocated when a larger one is needed.
+//
+class GraphPaperBuffers {
+ public:
+  FlatMatrix2D<int> bins;
+  FlatMatrix2D<int> scoreMat;
+  FlatMatrix2D<Arrow> pathMat;
+  vector<bool> onOptPath;
+};
+
 template<typename T_Point>
 bool SetBounds(vector<T_Point> &points, 
                DNALength &minPos, 
@@ -15,6 +28,21 @@ inline int GetIndex(DNALength pos,
                     DNALength maxPos, 
                     int nBins);
 
+//
+// Pick the grid size for the points.  The cells are square in sequence
+// coordinates, and sized so that a cell on the optimal path holds about
+// fragmentsPerCell points if most points lie on the path, but are never
+// shorter than minCellLength.  Each side has from minBins to maxBins
+// cells.
+//
+template<typename T_Point>
+void GraphPaperDimensions(vector<T_Point> &points,
+                          int &nRows, int &nCols,
+                          int fragmentsPerCell=100,
+                          DNALength minCellLength=100,
+                          int minBins=10,
+                          int maxBins=1000);
+
 template<typename T_Point>
 int GraphPaper(vector<T_Point> &points, 
                int nRows, int nCols,
@@ -23,6 +51,11 @@ int GraphPaper(vector<T_Point> &points,
                FlatMatrix2D<Arrow> &pathMat,
                vector<bool> &onOptPath);
 
+template<typename T_Point>
+int GraphPaper(vector<T_Point> &points,
+               int nRows, int nCols,
+               GraphPaperBuffers &buffers);
+
 template<typename T_Point>
 void RemoveOffOpt(vector<T_Point> &points, vector<bool> &optPath);
 
@@ -42,6 +42,37 @@ inline int GetIndex(DNALength pos, DNALength minPos, DNALength maxPos, int nBins
                ((DNALength)(ratio * nBins)));
 }
 
+template<typename T_Point>
+void GraphPaperDimensions(vector<T_Point> &points,
+                          int &nRows, int &nCols,
+                          int fragmentsPerCell,
+                          DNALength minCellLength,
+                          int minBins,
+                          int maxBins) {
+  DNALength xMin, xMax, yMin, yMax;
+  xMin = xMax = yMin = yMax = 0;
+  SetBounds(points, xMin, xMax, 0);
+  SetBounds(points, yMin, yMax, 1);
+  DNALength xSpan = xMax - xMin + 1;
+  DNALength ySpan = yMax - yMin + 1;
+
+  //
+  // A path through the grid crosses about nRows + nCols cells, so
+  // spreading the points over that many cells gives the cell length.
+  //
+  DNALength cellLength = minCellLength;
+  if (points.size() > 0) {
+    float pathCellLength = ((float)(xSpan + ySpan)) * fragmentsPerCell / points.size();
+    if (pathCellLength > cellLength) {
+      cellLength = (DNALength) pathCellLength;
+    }
+  }
+  nRows = (int) min((DNALength) maxBins, (xSpan + cellLength - 1) / cellLength);
+  nCols = (int) min((DNALength) maxBins, (ySpan + cellLength - 1) / cellLength);
+  nRows = max(minBins, nRows);
+  nCols = max(minBins, nCols);
+}
+
 template<typename T_Point>
 int GraphPaper(vector<T_Point> &points, 
                int nRows, int nCols,
@@ -50,12 +81,16 @@ int GraphPaper(vector<T_Point> &points,
                FlatMatrix2D<Arrow> &pathMat,
                vector<bool> &onOptPath) {
 
+  //
+  // The matrices may be larger than needed when they are reused, so
+  // only clear the part that is used.
+  //
   bins.Resize(nRows, nCols);
-	bins.Fill(0);
+  fill(bins.matrix, bins.matrix + nRows * nCols, 0);
   scoreMat.Resize(nRows+1, nCols+1);
   pathMat.Resize(nRows+1, nCols+1);
-  scoreMat.Fill(0);
-  pathMat.Fill(NoArrow);
+  fill(scoreMat.matrix, scoreMat.matrix + (nRows+1) * (nCols+1), 0);
+  fill(pathMat.matrix, pathMat.matrix + (nRows+1) * (nCols+1), NoArrow);
   onOptPath.resize(points.size());
   fill(onOptPath.begin(), onOptPath.end(), false);
 
@@ -90,32 +125,37 @@ int GraphPaper(vector<T_Point> &points,
     pathMat[0][c]  = Left;
   }
   scoreMat[0][0] = 0;
+  //
+  // The bins are never negative, so the scores never decrease along a
+  // row or a column, and the diagonal score is never larger than the
+  // left or up score.  The diagonal is taken only when all three are
+  // equal; otherwise the larger of left and up is taken, preferring
+  // left on a tie.  The row pointers are hoisted out of the inner loop.
+  //
   for (r = 1; r < nRows + 1; r++) {
+    int *prevScoreRow = scoreMat[r-1];
+    int *scoreRow     = scoreMat[r];
+    int *binRow       = bins[r-1];
+    Arrow *pathRow    = pathMat[r];
+    int leftScore     = scoreRow[0];
     for (c = 1; c < nCols + 1; c++) {
-      int diagScore, leftScore, upScore;
-      diagScore = scoreMat[r-1][c-1];
-      leftScore = scoreMat[r][c-1];
-      upScore   = scoreMat[r-1][c];
+      int diagScore = prevScoreRow[c-1];
+      int upScore   = prevScoreRow[c];
       
       int optScore;
       Arrow optDir;
-      if (diagScore >= leftScore and
-          diagScore >= upScore) {
-        optScore = diagScore;
-        optDir   = Diagonal;
-      }
-      else if (leftScore >= diagScore and 
-               leftScore >= upScore) {
+      if (leftScore >= upScore) {
         optScore = leftScore;
-        optDir   = Left;
+        optDir   = (diagScore == leftScore) ? Diagonal : Left;
       }
       else {
         optScore = upScore;
         optDir   = Up;
       }
       
-      scoreMat[r][c] = optScore + bins[r-1][c-1];
-      pathMat[r][c]   = optDir;
+      leftScore   = optScore + binRow[c-1];
+      scoreRow[c] = leftScore;
+      pathRow[c]  = optDir;
     }
   }
 
@@ -148,7 +188,7 @@ int GraphPaper(vector<T_Point> &points,
     else if (pathMat[rowIndex+1][colIndex] == Star) {
       onOptPath[i] = true;
     }
-    else if (colIndex < nCols + 2  and pathMat[rowIndex+1][colIndex+2] == Star) {
+    else if (colIndex + 2 < nCols and pathMat[rowIndex+1][colIndex+2] == Star) {
       onOptPath[i] = true;
     }
     if (onOptPath[i]) {
@@ -159,6 +199,16 @@ int GraphPaper(vector<T_Point> &points,
 }
 
 
+template<typename T_Point>
+int GraphPaper(vector<T_Point> &points,
+               int nRows, int nCols,
+               GraphPaperBuffers &buffers) {
+  return GraphPaper(points, nRows, nCols,
+                    buffers.bins, buffers.scoreMat, buffers.pathMat,
+                    buffers.onOptPath);
+}
+
+
 template<typename T_Point>
 void RemoveOffOpt(vector<T_Point> &points, vector<bool> &optPath) {
   size_t i, c;
@@ -64,6 +64,83 @@ void QVToLogPScale(QualityValueVector<QualityValue> &qualVect, size_t phredVectL
 
 int AlignmentToGuide(blasr::Alignment &alignment, Guide &guide, int bandSize); 
 
+//
+// The match, insertion and deletion costs of each query base against
+// each of the reference bases A, C, G, T and N, computed once per read
+// and looked up in every cell of the guided matrix, rather than calling
+// the score function (and evaluating quality values) per cell.  Cells
+// against any other reference character are scored by the score
+// function.
+//
+// This requires that the Match, Insertion and Deletion of a score
+// function depend on the reference only through ref.seq[refPos]: the
+// tables are filled by calling them on the reference "ACGTN" at
+// positions 0 to 4, so a score function that reads neighboring
+// reference bases, the reference length, or refPos itself, would give
+// different scores here than when called per cell.  The score
+// functions in this directory all meet this; the Normalized* functions
+// used when computing probabilities are still called per cell.
+//
+class GuidedAlignCosts {
+public:
+    static const int nRefSlots = 5;
+    int qStart;
+    std::vector<int> match, ins, del;
+
+    //
+    // Return the slot of a reference base in the tables, or -1 if it
+    // is not tabulated.
+    //
+    static inline int RefSlot(Nucleotide base) {
+        switch(base) {
+            case 'A': return 0;
+            case 'C': return 1;
+            case 'G': return 2;
+            case 'T': return 3;
+            case 'N': return 4;
+            default:  return -1;
+        }
+    }
+
+    inline int Match(int q, int refSlot) {
+        return match[(q - qStart) * nRefSlots + refSlot];
+    }
+
+    inline int Insertion(int q, int refSlot) {
+        return ins[(q - qStart) * nRefSlots + refSlot];
+    }
+
+    inline int Deletion(int q, int refSlot) {
+        return del[(q - qStart) * nRefSlots + refSlot];
+    }
+
+    template<typename TSequence, typename QSequence, typename T_ScoreFn>
+    void Initialize(T_ScoreFn &scoreFn, QSequence &qSeq, 
+        int qStartP, int qEnd) {
+        qStart = qStartP;
+        int nCosts = std::max(0, qEnd - qStart) * nRefSlots;
+        match.resize(nCosts);
+        ins.resize(nCosts);
+        del.resize(nCosts);
+        TSequence refBases;
+        refBases.Copy(std::string("ACGTN"));
+        int q, r, i = 0;
+        for (q = qStart; q < qEnd; q++) {
+            for (r = 0; r < nRefSlots; r++, i++) {
+                match[i] = scoreFn.Match(refBases, r, qSeq, q);
+                ins[i]   = scoreFn.Insertion(refBases, (DNALength) r, qSeq, (DNALength) q);
+                del[i]   = scoreFn.Deletion(refBases, (DNALength) r, qSeq, (DNALength) q);
+            }
+        }
+        refBases.Free();
+    }
+};
+
+//
+// The costs of cells against A, C, G, T and N come from a
+// GuidedAlignCosts table, so scoreFn must meet the contract described
+// there.
+//
 template<typename QSequence, typename TSequence, typename T_ScoreFn>
 int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &guideAlignment,
         T_ScoreFn &scoreFn,
@@ -145,8 +222,6 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
     if (scoreMat.size() < matrixNElem) {
         scoreMat.resize(matrixNElem);
         pathMat.resize(matrixNElem);
-        fill(scoreMat.begin(), scoreMat.end(), 0);
-        fill(pathMat.begin(), pathMat.end(), NoArrow);
     }
     if (computeProb) {
         if (probMat.size() < matrixNElem) {
@@ -260,82 +335,77 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
 
     int matchScore, insScore, delScore;
 
+    GuidedAlignCosts costs;
+    costs.Initialize<TSequence>(scoreFn, qSeq, qStart, qEnd);
+
     for (q = qStart; q < qEnd; q++) {
         int qi = q - qStart + 1;
-        int tp = guide[qi].t;
-        curIndex = matchIndex = insIndex = delIndex = -1;
+        GuideRow &row     = guide[qi];
+        GuideRow &prevRow = guide[qi-1];
 
         //
-        // Do some work that will help define when matchIndex and insIndex
-        // may be used.  Once delIndex is computed once, it is valid for
-        // all t positions.
+        // The cells of this row and the previous row are contiguous in
+        // the matrices, so the neighbors of a cell are found from the
+        // row offsets rather than searched for with GetBufferIndex.
         //
-        int prevRowTEnd = -1;
-        if ( qi > 0) { 
-            //
-            // Define the boundaries of the column which may access previously
-            // computed cells with a match.
-            //
-            prevRowTEnd = guide[qi-1].t + guide[qi-1].tPost;
-        }    
-
-        for (t = tp - guide[qi].tPre ; t < guide[qi].t + guide[qi].tPost +1; t++) {
-
-
-            if (q < qStart + bandSize and t == tp - guide[qi].tPre - 1) {
-                // On the boundary condition, don't access the 1st element;
-                t++;
-                continue;
+        int rowTStart     = row.t - row.tPre;
+        int prevRowTStart = prevRow.t - prevRow.tPre;
+        int prevRowTEnd   = prevRow.t + prevRow.tPost;
+
+        // Make sure the index is not past the ends of the sequence.
+        int tFirst = std::max(rowTStart, -1);
+        int tLast  = std::min(row.t + row.tPost, tEnd - 1);
+
+        for (t = tFirst; t <= tLast; t++) {
+            curIndex = row.matrixOffset + (t - row.t);
+            int refSlot = -1;
+            if (t >= 0) {
+                refSlot = GuidedAlignCosts::RefSlot(tSeq.seq[t]);
             }
-            // Make sure the index is not past the end of the sequence.
-            if (t < -1) continue;
-            if (t >= tEnd) continue;
-
-            //
-            // No cells are available to use for insertion cost
-            // computation. 
-            //
-            if (t > prevRowTEnd) {
-                insIndex = -1;
-            }
-            if (t > prevRowTEnd + 1) {
-                matchIndex = -1;
-            }
-
-            //
-            // Find the indices in the buffer.  Since the rows are of
-            // different sizes, one can't just use offsets from the buffer
-            // index. 
-            //
 
-            if (GetBufferIndex(guide, q-1,t-1, matchIndex)) {
-                assert(matchIndex >= 0);
-                matchScore = scoreMat[matchIndex] + scoreFn.Match(tSeq, t, qSeq, q);
+            if (t - 1 >= prevRowTStart and t - 1 <= prevRowTEnd) {
+                matchIndex = prevRow.matrixOffset + (t - 1 - prevRow.t);
+                if (refSlot >= 0) {
+                    matchScore = scoreMat[matchIndex] + costs.Match(q, refSlot);
+                }
+                else {
+                    matchScore = scoreMat[matchIndex] + scoreFn.Match(tSeq, t, qSeq, q);
+                }
             }
             else {
+                matchIndex = -1;
                 matchScore = INF_INT;
             }
 
-            if (GetBufferIndex(guide, q-1, t, insIndex)) {
-                assert(insIndex >= 0);
-                insScore = scoreMat[insIndex] + scoreFn.Insertion(tSeq,(DNALength) t, qSeq, (DNALength)q);
+            if (t >= prevRowTStart and t <= prevRowTEnd) {
+                insIndex = prevRow.matrixOffset + (t - prevRow.t);
+                if (refSlot >= 0) {
+                    insScore = scoreMat[insIndex] + costs.Insertion(q, refSlot);
+                }
+                else {
+                    insScore = scoreMat[insIndex] + scoreFn.Insertion(tSeq,(DNALength) t, qSeq, (DNALength)q);
+                }
             }
             else {
+                insIndex = -1;
                 insScore = INF_INT;
             }
-            if (GetBufferIndex(guide, q, t-1, delIndex)) {
-                assert(delIndex >= 0);
-                delScore = scoreMat[delIndex] + scoreFn.Deletion(tSeq, (DNALength) t, qSeq, (DNALength)q);
+
+            if (t - 1 >= rowTStart) {
+                delIndex = curIndex - 1;
+                if (refSlot >= 0) {
+                    delScore = scoreMat[delIndex] + costs.Deletion(q, refSlot);
+                }
+                else {
+                    delScore = scoreMat[delIndex] + scoreFn.Deletion(tSeq, (DNALength) t, qSeq, (DNALength)q);
+                }
             }
             else {
+                delIndex = -1;
                 delScore = INF_INT;
             }
 
             int minScore = MIN(matchScore, MIN(insScore, delScore));
-            int result   = GetBufferIndex(guide, q, t, curIndex);
-            // This should only loop over valid cells.
-            assert(result);
-            assert(curIndex >= 0);
             scoreMat[curIndex] = minScore;
             if (minScore == INF_INT) {
                 pathMat[curIndex] = NoArrow;
@@ -345,7 +415,6 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
                 }
             }
             else {
-                assert(result == 1);
                 if (minScore == matchScore) {
                     pathMat[curIndex] = Diagonal;
                 }
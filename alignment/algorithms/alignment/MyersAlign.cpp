@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstdlib>
+#include "../../../pbdata/NucConversion.hpp"
+#include "MyersAlign.hpp"
+
+static const int MYERS_WORD_SIZE = 64;
+static const int MYERS_N_ROW = 4;
+
+static inline int MyersCode(Nucleotide nuc) {
+    int code = ThreeBit[nuc];
+    return (code < 4) ? code : MYERS_N_ROW;
+}
+
+//
+// Advance one block of the column by one target base.  hin is the
+// horizontal difference entering the top row of the block, and the
+// horizontal difference leaving the row marked by highBit is
+// returned.
+//
+static inline int MyersAdvanceBlock(uint64_t &pv, uint64_t &mv, uint64_t eq,
+    int hin, uint64_t highBit) {
+    uint64_t xv = eq | mv;
+    if (hin < 0) {
+        eq |= 1;
+    }
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    int hout = 0;
+    if (ph & highBit) {
+        hout = 1;
+    }
+    else if (mh & highBit) {
+        hout = -1;
+    }
+    ph <<= 1;
+    mh <<= 1;
+    if (hin < 0) {
+        mh |= 1;
+    }
+    else if (hin > 0) {
+        ph |= 1;
+    }
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return hout;
+}
+
+//
+// Compute the edit distance of all of pattern against text, charging
+// for gaps at the ends of text only when freeTextEnds is false.  When
+// maxDistance >= 0, blocks are dropped once all of their cells exceed
+// it, and maxDistance+1 is returned for any distance over it.
+//
+static int MyersPatternDistance(DNASequence &pattern, DNASequence &text,
+    bool freeTextEnds, int maxDistance, MyersBuffers &buffers) {
+
+    int m = pattern.length, n = text.length;
+    bool bounded = (maxDistance >= 0);
+    int result;
+    if (m == 0) {
+        result = freeTextEnds ? 0 : n;
+        return (bounded and result > maxDistance) ? maxDistance + 1 : result;
+    }
+    if (bounded and !freeTextEnds and std::abs(m - n) > maxDistance) {
+        return maxDistance + 1;
+    }
+
+    int nBlocks  = (m + MYERS_WORD_SIZE - 1) / MYERS_WORD_SIZE;
+    int lastRows = m - (nBlocks - 1) * MYERS_WORD_SIZE;
+    uint64_t wordHighBit = ((uint64_t) 1) << (MYERS_WORD_SIZE - 1);
+    uint64_t lastHighBit = ((uint64_t) 1) << (lastRows - 1);
+
+    buffers.peq.assign((MYERS_N_ROW + 1) * nBlocks, 0);
+    if ((int) buffers.pv.size() < nBlocks) {
+        buffers.pv.resize(nBlocks);
+        buffers.mv.resize(nBlocks);
+        buffers.blockScore.resize(nBlocks);
+    }
+    int i, j, b;
+    for (i = 0; i < m; i++) {
+        int code = MyersCode(pattern.seq[i]);
+        if (code != MYERS_N_ROW) {
+            buffers.peq[code * nBlocks + i / MYERS_WORD_SIZE] |=
+                ((uint64_t) 1) << (i % MYERS_WORD_SIZE);
+        }
+    }
+
+    //
+    // Column 0 is i for row i.  Only blocks whose first row may score
+    // at most maxDistance start out active.
+    //
+    int lastBlock = nBlocks - 1;
+    if (bounded) {
+        lastBlock = (maxDistance > 0) ? std::min(nBlocks - 1, (maxDistance - 1) / MYERS_WORD_SIZE) : 0;
+    }
+    for (b = 0; b <= lastBlock; b++) {
+        buffers.pv[b] = ~((uint64_t) 0);
+        buffers.mv[b] = 0;
+        buffers.blockScore[b] = std::min((b + 1) * MYERS_WORD_SIZE, m);
+    }
+
+    int minLastRow = m;
+    int topHin = freeTextEnds ? 0 : 1;
+    for (j = 0; j < n; j++) {
+        const uint64_t *eq = &buffers.peq[MyersCode(text.seq[j]) * nBlocks];
+        int carry = topHin;
+        for (b = 0; b <= lastBlock; b++) {
+            carry = MyersAdvanceBlock(buffers.pv[b], buffers.mv[b], eq[b], carry,
+                (b == nBlocks - 1) ? lastHighBit : wordHighBit);
+            buffers.blockScore[b] += carry;
+        }
+        if (bounded) {
+            if (lastBlock < nBlocks - 1 and
+                buffers.blockScore[lastBlock] - carry <= maxDistance and
+                ((eq[lastBlock + 1] & 1) or carry < 0)) {
+                //
+                // The block below may now hold a cell within the
+                // distance.  Its previous column is not known, but
+                // all of it exceeded maxDistance, so it may be taken
+                // to increase by one per row.
+                //
+                lastBlock++;
+                b = lastBlock;
+                int rows = (b == nBlocks - 1) ? lastRows : MYERS_WORD_SIZE;
+                buffers.pv[b] = ~((uint64_t) 0);
+                buffers.mv[b] = 0;
+                int prevScore = buffers.blockScore[b - 1] - carry + rows;
+                carry = MyersAdvanceBlock(buffers.pv[b], buffers.mv[b], eq[b], carry,
+                    (b == nBlocks - 1) ? lastHighBit : wordHighBit);
+                buffers.blockScore[b] = prevScore + carry;
+            }
+            else {
+                while (lastBlock > 0 and
+                    buffers.blockScore[lastBlock] >= maxDistance + MYERS_WORD_SIZE) {
+                    lastBlock--;
+                }
+            }
+        }
+        if (freeTextEnds and lastBlock == nBlocks - 1) {
+            minLastRow = std::min(minLastRow, buffers.blockScore[lastBlock]);
+        }
+    }
+
+    if (freeTextEnds) {
+        result = minLastRow;
+    }
+    else if (lastBlock == nBlocks - 1) {
+        result = buffers.blockScore[lastBlock];
+    }
+    else {
+        result = maxDistance + 1;
+    }
+    if (bounded and result > maxDistance) {
+        result = maxDistance + 1;
+    }
+    return result;
+}
+
+static int MyersDistance(DNASequence &query, DNASequence &target,
+    int maxDistance, AlignmentType alignType, MyersBuffers *buffers) {
+    MyersBuffers localBuffers;
+    if (buffers == NULL) {
+        buffers = &localBuffers;
+    }
+    if (alignType == Global or alignType == ScoreGlobal) {
+        return MyersPatternDistance(query, target, false, maxDistance, *buffers);
+    }
+    else if (alignType == QueryFit or alignType == ScoreQueryFit) {
+        return MyersPatternDistance(query, target, true, maxDistance, *buffers);
+    }
+    else if (alignType == TargetFit or alignType == ScoreTargetFit) {
+        return MyersPatternDistance(target, query, true, maxDistance, *buffers);
+    }
+    return -1;
+}
+
+int MyersEditDistance(DNASequence &query, DNASequence &target,
+    AlignmentType alignType, MyersBuffers *buffers) {
+    return MyersDistance(query, target, -1, alignType, buffers);
+}
+
+int MyersBandedEditDistance(DNASequence &query, DNASequence &target,
+    int maxDistance, AlignmentType alignType, MyersBuffers *buffers) {
+    if (maxDistance < 0) {
+        return -1;
+    }
+    return MyersDistance(query, target, maxDistance, alignType, buffers);
+}
@@ -0,0 +1,57 @@
+#ifndef _BLASR_MYERS_ALIGN_HPP_
+#define _BLASR_MYERS_ALIGN_HPP_
+
+#include <vector>
+#include <stdint.h>
+// pbdata
+#include "../../../pbdata/DNASequence.hpp"
+
+#include "AlignmentUtils.hpp"
+
+//
+// Unit cost edit distance computed with the bit-vector algorithm of
+// Myers (J. ACM 1999), in the block form that handles queries longer
+// than a machine word.  Each column of the dynamic programming matrix
+// is kept as vertical difference vectors of 64 query bases per word,
+// so a column costs one short sequence of word operations per block
+// rather than one cell update per base.
+//
+// These compute only a score, as a fast filter for candidates that
+// will be realigned with a full score function.  The alignment types
+// mirror those of SWAlign:
+//   Global, ScoreGlobal        - all of both sequences.
+//   QueryFit, ScoreQueryFit    - all of the query, gaps at the
+//                                beginning and end of the target free.
+//   TargetFit, ScoreTargetFit  - all of the target, gaps at the
+//                                beginning and end of the query free.
+// Other types are not supported, and return -1.
+//
+// Any base that is not A, C, G or T mismatches everything, including
+// another N.
+//
+
+class MyersBuffers {
+public:
+    // Match masks, one row of blocks for each of ACGT and one for N.
+    std::vector<uint64_t> peq;
+    // Vertical positive and negative differences of the current column.
+    std::vector<uint64_t> pv, mv;
+    // The score of the last row of each block in the current column.
+    std::vector<int> blockScore;
+};
+
+int MyersEditDistance(DNASequence &query, DNASequence &target,
+    AlignmentType alignType=ScoreGlobal, MyersBuffers *buffers=NULL);
+
+//
+// The banded version: returns the edit distance if it is at most
+// maxDistance, and maxDistance+1 otherwise.  Blocks of the query are
+// only computed while some cell in them may still score maxDistance
+// or less (Ukkonen's cutoff), so the work is proportional to
+// maxDistance/64 words per target base rather than the query length.
+//
+int MyersBandedEditDistance(DNASequence &query, DNASequence &target,
+    int maxDistance, AlignmentType alignType=ScoreGlobal,
+    MyersBuffers *buffers=NULL);
+
+#endif // _BLASR_MYERS_ALIGN_HPP_
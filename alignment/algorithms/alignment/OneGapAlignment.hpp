@@ -2,6 +2,8 @@
 #define _BLASR_ONEGAP_ALIGNMENT_HPP_
 
 #include <limits.h>
+#include <vector>
+#include <algorithm>
 // pbdata
 #include "../../../pbdata/Types.h"
 #include "../../../pbdata/FASTQSequence.hpp"
@@ -14,6 +16,13 @@
    Perform gapped alignment that aligns the entire query sequence to
    leftTarget, rightTarget, or between the two with a gap in between.
    The gap between leftTarget and rightTarget is an affine gap. 
+
+   The cell where the gap closes is a match of the query and the right
+   target.  Insertions in the first column of the right target add to
+   the score above them, as in any other column.  Target positions
+   after the gap are offset by distanceBetweenLeftAndRightTarget,
+   including when the gap closes on the first base of the right target
+   or runs along the first row because nothing aligns to leftTarget.
    */
 
 template<typename T_QuerySequence, typename T_RefSequence, typename T_ScoreFunction> 
@@ -22,7 +31,7 @@ int OneGapAlign(T_QuerySequence &query,
         T_RefSequence &rightTarget, 
         DNALength   distanceBetweenLeftAndRightTarget,
         T_ScoreFunction &scoreFn,
-        Alignment   &alignment, 
+        blasr::Alignment   &alignment, 
         FlatMatrix2D<int> & scoreMat, FlatMatrix2D<Arrow> & pathMat, 
         FlatMatrix2D<int> &affineScoreMat, FlatMatrix2D<Arrow> &affinePathMat) {
 
@@ -98,6 +107,13 @@ int OneGapAlign(T_QuerySequence &query,
         affineScoreMat[0][j] = 0;
         affinePathMat[0][j]  = Left;
     }
+    //
+    // A gap across the first row still spans the region between the
+    // targets.
+    //
+    if (nRightTargetCols > 0) {
+        affinePathMat[0][nLeftTargetCols] = AffineLongDelLeft;
+    }
 
 
     //  Now run the alignment.
@@ -124,7 +140,7 @@ int OneGapAlign(T_QuerySequence &query,
             insScore   = scoreMat[i][j+1] + scoreFn.Insertion(leftTarget, j, query, i);
             delScore   = scoreMat[i+1][j] + scoreFn.Deletion(leftTarget, j, query, i);
 
-            int minScore = min(matchScore, min(insScore, delScore));
+            int minScore = std::min(matchScore, std::min(insScore, delScore));
             scoreMat[i+1][j+1] = minScore;
 
 
@@ -168,12 +184,12 @@ int OneGapAlign(T_QuerySequence &query,
         // Cannot have a non-affine deletion here.
         delScore   = INT_MAX;
         //
-        // The insertion is a horizontal move, so that is all allowed.
+        // The insertion is a vertical move, so that is all allowed.
         //
-        insScore   = scoreFn.Insertion(rightTarget, j, query, i - 1);
+        insScore   = scoreMat[i][leftTarget.length+1] + scoreFn.Insertion(rightTarget, j, query, i);
 
 
-        minScore = min(matchScore, insScore);
+        minScore = std::min(matchScore, insScore);
         UInt targetCol = leftTarget.length;
 
         assert(scoreMat[i+1][targetCol+1] == 0);
@@ -202,7 +218,7 @@ int OneGapAlign(T_QuerySequence &query,
             delScore   = scoreMat[i+1][targetCol] + scoreFn.Deletion(rightTarget, j, query, i);
             affineCloseScore = affineScoreMat[i][targetCol] + scoreFn.Match(rightTarget, j, query, i);
 
-            minScore = min(matchScore, min(insScore, min(delScore, affineCloseScore)));
+            minScore = std::min(matchScore, std::min(insScore, std::min(delScore, affineCloseScore)));
 
             scoreMat[i+1][targetCol+1] = minScore;
             if (minScore == matchScore) {
@@ -233,7 +249,7 @@ int OneGapAlign(T_QuerySequence &query,
     //
     i = nQueryRows - 1;
     j = nTargetCols - 1;
-    vector<Arrow> optAlignment;
+    std::vector<Arrow> optAlignment;
 
     int REGULAR = 0;
     int AFFINE  = 1;
@@ -270,19 +286,42 @@ int OneGapAlign(T_QuerySequence &query,
                 i--;
             }
             else if (arrow == AffineLongDelClose) {
-                optAlignment.push_back(Left);
+                //
+                // The gap closes on a match of query[i-1] and the
+                // target.
+                //
+                optAlignment.push_back(Diagonal);
                 j--;
                 i--;
                 curMatrix = AFFINE;
+                //
+                // A close on the first base of the right target jumps
+                // straight to the end of the left target.
+                //
+                if (j == leftTarget.length and distanceBetweenLeftAndRightTarget > 0) {
+                    optAlignment.push_back(AffineLongDelLeft);
+                }
             }
         }
         else {
             // in affine matrix
             arrow = affinePathMat[i][j];
-            if (arrow == Left or arrow == AffineLongDelLeft) {
+            if (arrow == Left) {
                 optAlignment.push_back(arrow);
                 j--;
             }
+            else if (arrow == AffineLongDelLeft) {
+                //
+                // Step over the first base of the right target, and
+                // then the region between the two targets, which
+                // LongGapArrowPathToAlignment expands.
+                //
+                optAlignment.push_back(Left);
+                if (distanceBetweenLeftAndRightTarget > 0) {
+                    optAlignment.push_back(AffineLongDelLeft);
+                }
+                j--;
+            }
             else if (arrow == AffineDelOpen) {
                 //
                 // no change in i nor j, and this does not result in an
@@ -305,29 +344,349 @@ int OneGapAlign(T_QuerySequence &query,
 }
 
 //
-// Create a version that does not need reusable mapping buffers.
+// Storage for the linear space version of OneGapAlign: the best score
+// of each query prefix in the left target, the rolling score rows, and
+// the banded traceback of the two flanks around the gap.
+//
+class OneGapAlignBuffers {
+public:
+    std::vector<int> prefixScore;
+    std::vector<DNALength> prefixCol;
+    std::vector<int> prevRow, curRow;
+    std::vector<DNALength> bandLo, bandHi;
+    std::vector<size_t> bandOffset;
+    std::vector<Arrow> bandArrows;
+    std::vector<Arrow> path;
+};
+
+//
+// Globally align query[qStart,qEnd) to target[tStart,tEnd) within a
+// band of width 2*bandSize+1 about the diagonal of the rectangle, and
+// append the arrows of the optimal path to path.  Cells are scored as
+// in OneGapAlign.  When boundaryGaps is true the first row and column
+// cost scoreFn.del and scoreFn.ins per base, as the first row and
+// column of the left target do; otherwise they are scored like any
+// other cell, since the rectangle starts in the middle of the matrix.
+// Returns the score of the path, or INT_MAX when the band does not
+// connect the corners.
 //
+template<typename T_QuerySequence, typename T_RefSequence, typename T_ScoreFunction>
+int OneGapBandedFlank(T_QuerySequence &query, DNALength qStart, DNALength qEnd,
+        T_RefSequence &target, DNALength tStart, DNALength tEnd,
+        T_ScoreFunction &scoreFn, bool boundaryGaps, DNALength bandSize,
+        OneGapAlignBuffers &buffers, std::vector<Arrow> &path) {
+
+    DNALength nRows = qEnd - qStart, nCols = tEnd - tStart;
+    DNALength r, c;
+
+    buffers.bandLo.resize(nRows + 1);
+    buffers.bandHi.resize(nRows + 1);
+    buffers.bandOffset.resize(nRows + 2);
+    buffers.bandOffset[0] = 0;
+    DNALength maxWidth = 0;
+    for (r = 0; r <= nRows; r++) {
+        DNALength center = (nRows == 0) ? 0 : 
+            (DNALength) (((unsigned long long) nCols * r) / nRows);
+        buffers.bandLo[r] = (center > bandSize) ? center - bandSize : 0;
+        buffers.bandHi[r] = std::min(nCols, center + bandSize);
+        if (nRows == 0) { buffers.bandHi[r] = nCols; }
+        buffers.bandOffset[r+1] = buffers.bandOffset[r] + 
+            buffers.bandHi[r] - buffers.bandLo[r] + 1;
+        maxWidth = std::max(maxWidth, buffers.bandHi[r] - buffers.bandLo[r] + 1);
+    }
+    if (buffers.bandArrows.size() < buffers.bandOffset[nRows+1]) {
+        buffers.bandArrows.resize(buffers.bandOffset[nRows+1]);
+    }
+    if (buffers.prevRow.size() < maxWidth) {
+        buffers.prevRow.resize(maxWidth);
+        buffers.curRow.resize(maxWidth);
+    }
+
+    //
+    // Score rows are indexed from the start of the band on the row.
+    // Cells off the band score INT_MAX.
+    //
+    std::vector<int> &prev = buffers.prevRow, &cur = buffers.curRow;
+    DNALength prevLo = 0, prevHi = 0;
+    for (r = 0; r <= nRows; r++) {
+        DNALength lo = buffers.bandLo[r], hi = buffers.bandHi[r];
+        Arrow *arrows = &buffers.bandArrows[buffers.bandOffset[r]];
+        for (c = lo; c <= hi; c++) {
+            int best = INT_MAX;
+            Arrow arrow = NoArrow;
+            if (r == 0 and c == 0) {
+                best = 0;
+            }
+            if (r > 0 and c > 0 and c - 1 >= prevLo and c - 1 <= prevHi and
+                prev[c - 1 - prevLo] != INT_MAX) {
+                best  = prev[c - 1 - prevLo] + 
+                    scoreFn.Match(target, tStart + c - 1, query, qStart + r - 1);
+                arrow = Diagonal;
+            }
+            if (r > 0 and c >= prevLo and c <= prevHi and prev[c - prevLo] != INT_MAX) {
+                int insScore = prev[c - prevLo] + ((boundaryGaps and c == 0) ? scoreFn.ins :
+                    scoreFn.Insertion(target, tStart + c - 1, query, qStart + r - 1));
+                if (insScore < best) {
+                    best  = insScore;
+                    arrow = Up;
+                }
+            }
+            if (c > lo and cur[c - 1 - lo] != INT_MAX) {
+                int delScore = cur[c - 1 - lo] + ((boundaryGaps and r == 0) ? scoreFn.del :
+                    scoreFn.Deletion(target, tStart + c - 1, query, qStart + r - 1));
+                if (delScore < best) {
+                    best  = delScore;
+                    arrow = Left;
+                }
+            }
+            cur[c - lo] = best;
+            arrows[c - lo] = arrow;
+        }
+        prev.swap(cur);
+        prevLo = lo;
+        prevHi = hi;
+    }
+    int score = prev[nCols - prevLo];
+    if (score == INT_MAX) {
+        return score;
+    }
+
+    size_t pathStart = path.size();
+    r = nRows;
+    c = nCols;
+    while (r > 0 or c > 0) {
+        Arrow arrow = buffers.bandArrows[buffers.bandOffset[r] + c - buffers.bandLo[r]];
+        assert(arrow != NoArrow);
+        path.push_back(arrow);
+        if (arrow == Diagonal) { r--; c--; }
+        else if (arrow == Up) { r--; }
+        else { c--; }
+    }
+    std::reverse(path.begin() + pathStart, path.end());
+    return score;
+}
+
+//
+// Align one flank with OneGapBandedFlank, widening the band until the
+// path reaches the score the full matrix gives, optScore.  Returns
+// false if even the full rectangle does not reach optScore, which
+// happens only if the score function is not consistent between calls.
+//
+template<typename T_QuerySequence, typename T_RefSequence, typename T_ScoreFunction>
+bool OneGapAlignFlank(T_QuerySequence &query, DNALength qStart, DNALength qEnd,
+        T_RefSequence &target, DNALength tStart, DNALength tEnd,
+        T_ScoreFunction &scoreFn, bool boundaryGaps, DNALength bandSize,
+        int optScore, OneGapAlignBuffers &buffers, std::vector<Arrow> &path) {
+
+    DNALength nRows = qEnd - qStart, nCols = tEnd - tStart;
+    DNALength maxBand = std::max(nRows, nCols);
+    //
+    // The band must at least follow the slope of the rectangle.
+    //
+    if (nRows > 0) {
+        bandSize = std::max(bandSize, nCols / nRows + 1);
+    }
+    bandSize = std::min(std::max(bandSize, (DNALength) 1), maxBand);
+    size_t pathStart = path.size();
+    while (true) {
+        int score = OneGapBandedFlank(query, qStart, qEnd, target, tStart, tEnd,
+            scoreFn, boundaryGaps, bandSize, buffers, path);
+        if (score == optScore) {
+            return true;
+        }
+        path.resize(pathStart);
+        if (bandSize >= maxBand) {
+            return false;
+        }
+        bandSize = std::min(2 * bandSize, maxBand);
+    }
+}
 
+//
+// A linear space version of OneGapAlign.  The path is restricted to a
+// prefix of the query aligned globally from the start of leftTarget
+// and ending anywhere in it, one long gap, and the suffix of the query
+// aligned from anywhere in rightTarget to its end.  The prefix may be
+// empty, so that the query aligns to rightTarget alone.  
+//
+// Rather than keeping the full matrices, a forward pass over
+// leftTarget stores the best score of every query prefix, and a
+// reverse pass over rightTarget computes suffix scores one row at a
+// time, finding the cell where the gap closes on the optimal path.
+// Only the two flanks, query[0,i) against the left target before the
+// gap and query[i,n) against the right target after it, are then
+// traced back in bands of width 2*flankBandSize+1, which are widened
+// if they miss the optimal path.  The memory used is proportional to
+// the band area plus the target and query lengths.
+//
+// Returns the score of the alignment.  The long gap is recorded in
+// alignment with LongGapArrowPathToAlignment, so target positions
+// after it are offset by distanceBetweenLeftAndRightTarget.  If a
+// flank cannot be traced back to the score of the passes, alignment
+// is left empty and INT_MAX is returned.
+//
+// This gives the same score as the full matrix OneGapAlign above,
+// though ties between paths may be broken differently.
+//
 template<typename T_QuerySequence, typename T_RefSequence, typename T_ScoreFunction>
 int OneGapAlign(T_QuerySequence &query, 
         T_RefSequence &leftTarget, 
         T_RefSequence &rightTarget, 
         DNALength   distanceBetweenLeftAndRightTarget,
         T_ScoreFunction &scoreFn,
-        Alignment   &alignment) {
+        blasr::Alignment   &alignment, 
+        OneGapAlignBuffers &buffers,
+        DNALength flankBandSize=32) {
+
+    DNALength nQuery = query.length;
+    DNALength nLeft  = leftTarget.length, nRight = rightTarget.length;
+    DNALength i, j;
+    std::vector<Arrow> &path = buffers.path;
+    path.clear();
+
+    if (nQuery == 0) {
+        alignment.LongGapArrowPathToAlignment(path, distanceBetweenLeftAndRightTarget);
+        return 0;
+    }
+
+    //
+    // Forward pass over the left target.  Row 0 is free, since the
+    // path may jump straight into the right target.
+    //
+    buffers.prefixScore.resize(nQuery + 1);
+    buffers.prefixCol.resize(nQuery + 1);
+    if (buffers.prevRow.size() < std::max(nLeft, nRight) + 1) {
+        buffers.prevRow.resize(std::max(nLeft, nRight) + 1);
+        buffers.curRow.resize(std::max(nLeft, nRight) + 1);
+    }
+    std::vector<int> &prev = buffers.prevRow, &cur = buffers.curRow;
+    prev[0] = 0;
+    for (j = 0; j < nLeft; j++) {
+        prev[j+1] = prev[j] + scoreFn.del;
+    }
+    buffers.prefixScore[0] = 0;
+    buffers.prefixCol[0]   = 0;
+    for (i = 0; i < nQuery; i++) {
+        cur[0] = prev[0] + scoreFn.ins;
+        int rowMin = cur[0];
+        DNALength rowMinCol = 0;
+        for (j = 0; j < nLeft; j++) {
+            int matchScore = prev[j]   + scoreFn.Match(leftTarget, j, query, i);
+            int insScore   = prev[j+1] + scoreFn.Insertion(leftTarget, j, query, i);
+            int delScore   = cur[j]    + scoreFn.Deletion(leftTarget, j, query, i);
+            cur[j+1] = std::min(matchScore, std::min(insScore, delScore));
+            if (cur[j+1] < rowMin) {
+                rowMin    = cur[j+1];
+                rowMinCol = j + 1;
+            }
+        }
+        buffers.prefixScore[i+1] = rowMin;
+        buffers.prefixCol[i+1]   = rowMinCol;
+        prev.swap(cur);
+    }
 
-    FlatMatrix2D<int>   scoreMat;
-    FlatMatrix2D<int>   affineScoreMat;
-    FlatMatrix2D<Arrow> pathMat;
-    FlatMatrix2D<Arrow> affinePathMat;
+    if (nRight == 0) {
+        //
+        // There is nowhere for the gap to go, so this is a global
+        // alignment to the left target.
+        //
+        int optScore = prev[nLeft];
+        if (!OneGapAlignFlank(query, 0, nQuery, leftTarget, 0, nLeft, scoreFn, true,
+                flankBandSize, optScore, buffers, path)) {
+            alignment.blocks.clear();
+            alignment.gaps.clear();
+            return INT_MAX;
+        }
+        alignment.LongGapArrowPathToAlignment(path, distanceBetweenLeftAndRightTarget);
+        return optScore;
+    }
 
+    //
+    // Reverse pass over the right target.  Row i holds the score of
+    // aligning query[i,n) to rightTarget[j,nRight) for j in [1, nRight].
+    // Each row is checked for the gap closing on it, that is query[i-1]
+    // aligned to rightTarget[j-1] directly after the best alignment of
+    // query[0,i-1) to the left target.
+    //
+    int optScore = INT_MAX;
+    DNALength closeRow = 0, closeCol = 0;
+    prev[nRight] = 0;
+    for (j = nRight - 1; j > 0; j--) {
+        prev[j] = prev[j+1] + scoreFn.Deletion(rightTarget, j, query, nQuery - 1);
+    }
+    for (i = nQuery; i > 0; i--) {
+        if (i < nQuery) {
+            cur[nRight] = prev[nRight] + scoreFn.Insertion(rightTarget, nRight - 1, query, i);
+            for (j = nRight - 1; j > 0; j--) {
+                int matchScore = prev[j+1] + scoreFn.Match(rightTarget, j, query, i);
+                int insScore   = prev[j]   + scoreFn.Insertion(rightTarget, j - 1, query, i);
+                int delScore   = cur[j+1]  + scoreFn.Deletion(rightTarget, j, query, i - 1);
+                cur[j] = std::min(matchScore, std::min(insScore, delScore));
+            }
+            prev.swap(cur);
+        }
+        for (j = 1; j <= nRight; j++) {
+            int closeScore = buffers.prefixScore[i-1] + 
+                scoreFn.Match(rightTarget, j - 1, query, i - 1) + prev[j];
+            if (closeScore < optScore) {
+                optScore = closeScore;
+                closeRow = i;
+                closeCol = j;
+            }
+        }
+    }
+
+    //
+    // Trace the flank before the gap, step over the rest of the left
+    // target, the region between the targets and the right target up
+    // to the gap close, and trace the flank after it.  The region
+    // between the targets is stood in for by a single arrow that
+    // LongGapArrowPathToAlignment expands.
+    //
+    DNALength leftEnd = buffers.prefixCol[closeRow - 1];
+    int prefixScore   = buffers.prefixScore[closeRow - 1];
+    int closeScore    = scoreFn.Match(rightTarget, closeCol - 1, query, closeRow - 1);
+    if (!OneGapAlignFlank(query, 0, closeRow - 1, leftTarget, 0, leftEnd, scoreFn, true,
+            flankBandSize, prefixScore, buffers, path)) {
+        alignment.blocks.clear();
+        alignment.gaps.clear();
+        return INT_MAX;
+    }
+    path.insert(path.end(), nLeft - leftEnd, Left);
+    if (distanceBetweenLeftAndRightTarget > 0) {
+        path.push_back(AffineLongDelLeft);
+    }
+    path.insert(path.end(), closeCol - 1, Left);
+    path.push_back(Diagonal);
+    if (!OneGapAlignFlank(query, closeRow, nQuery, rightTarget, closeCol, nRight, scoreFn, false,
+            flankBandSize, optScore - prefixScore - closeScore, buffers, path)) {
+        alignment.blocks.clear();
+        alignment.gaps.clear();
+        return INT_MAX;
+    }
+
+    alignment.LongGapArrowPathToAlignment(path, distanceBetweenLeftAndRightTarget);
+    return optScore;
+}
+
+//
+// Create a version that does not need reusable mapping buffers.
+//
+
+template<typename T_QuerySequence, typename T_RefSequence, typename T_ScoreFunction>
+int OneGapAlign(T_QuerySequence &query, 
+        T_RefSequence &leftTarget, 
+        T_RefSequence &rightTarget, 
+        DNALength   distanceBetweenLeftAndRightTarget,
+        T_ScoreFunction &scoreFn,
+        blasr::Alignment   &alignment) {
 
+    OneGapAlignBuffers buffers;
     return OneGapAlign(query, leftTarget, rightTarget, 
             distanceBetweenLeftAndRightTarget,
             scoreFn,
             alignment,
-            scoreMat, pathMat,
-            affineScoreMat, affinePathMat);
+            buffers);
 }
 
 
@@ -338,11 +697,9 @@ int OneGapAlign(T_QuerySequence &query,
         DNALength   distanceBetweenLeftAndRightTarget,
         T_ScoreFunction &scoreFn,
         T_BufferList &buffers,
-        Alignment   &alignment) {
-    PB_UNUSED(scoreFn);
-    return OneGapAlign(query, leftTarget, rightTarget, distanceBetweenLeftAndRightTarget, alignment,
-            buffers.scoreMat, buffers.pathMat,
-            buffers.affineScoreMat, buffers.affinePathMat);
+        blasr::Alignment   &alignment) {
+    return OneGapAlign(query, leftTarget, rightTarget, distanceBetweenLeftAndRightTarget,
+            scoreFn, alignment, buffers.oneGap);
 
 }
 
@@ -351,14 +708,13 @@ int OneGapAlign(T_QuerySequence &query,
         T_RefSequence   &reference,
         T_ScoreFunction &scoreFunction,
         T_BufferList &buffers,
-        Alignment &alignment) {
-    (void)(buffers);
+        blasr::Alignment &alignment) {
 
     T_RefSequence leftReference, rightReference;
-    UInt leftReferenceLength = min(reference.length, query.length);
+    UInt leftReferenceLength = std::min(reference.length, query.length);
     leftReference.ReferenceSubstring(reference, 0, leftReferenceLength);
 
-    UInt rightReferenceLength = min(reference.length - leftReferenceLength, query.length);
+    UInt rightReferenceLength = std::min(reference.length - leftReferenceLength, query.length);
     rightReference.ReferenceSubstring(reference, reference.length - rightReferenceLength, rightReferenceLength);
 
     DNALength distanceBetweenLeftAndRight = reference.length - rightReferenceLength - leftReferenceLength;
@@ -369,7 +725,7 @@ int OneGapAlign(T_QuerySequence &query,
             leftReference, 
             rightReference, 
             distanceBetweenLeftAndRight,
-            scoreFunction, alignment);
+            scoreFunction, alignment, buffers.oneGap);
 }
 
 
@@ -7,6 +7,7 @@
 
 #include "../../tuples/TupleMatching.hpp"
 #include "sdp/SDPFragment.hpp"
+#include "GraphPaper.hpp"
 #include "DistanceMatrixScoreFunction.hpp"
 
 #define SDP_DETAILED_WORD_SIZE 5
@@ -23,7 +24,8 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool extendFrontByLocalAlignment=true,
         DNALength noRecurseUnder=10000,
         bool fastSDP=true,
-        unsigned int minFragmentsToUseGraphPaper=100000);
+        unsigned int minFragmentsToUseGraphPaper=100000,
+        GraphPaperBuffers *graphPaperBuffers=NULL);
 
 
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_BufferCache>
@@ -37,7 +39,8 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool extendFrontByLocalAlignment=true, 
         DNALength noRecurseUnder=10000,
         bool fastSDP=true,
-        unsigned int minFragmentsToUseGraphPaper=100000);
+        unsigned int minFragmentsToUseGraphPaper=100000,
+        GraphPaperBuffers *graphPaperBuffers=NULL);
 
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_TupleList>
 int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
@@ -58,7 +61,8 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool extendFrontByLocalAlignment=true, 
         DNALength noRecurseUnder=10000,
         bool fastSDP=true,
-        unsigned int minFragmentsToUseGraphPaper=100000);
+        unsigned int minFragmentsToUseGraphPaper=100000,
+        GraphPaperBuffers *graphPaperBuffers=NULL);
 
 #include "SDPAlignImpl.hpp"
 
@@ -32,7 +32,8 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool extendFrontByLocalAlignment,
         DNALength noRecurseUnder,
         bool fastSDP,
-        unsigned int minFragmentsToUseGraphPaper) {
+        unsigned int minFragmentsToUseGraphPaper,
+        GraphPaperBuffers *graphPaperBuffers) {
     /*
        Since SDP Align uses a large list of buffers, but none are
        provided with this mechanism of calling SDPAlign, allocate the
@@ -56,7 +57,8 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
             extendFrontByLocalAlignment,
             noRecurseUnder,
             fastSDP,
-            minFragmentsToUseGraphPaper);
+            minFragmentsToUseGraphPaper,
+            graphPaperBuffers);
 }
 
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_BufferCache>
@@ -70,7 +72,8 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool extendFrontByLocalAlignment, 
         DNALength noRecurseUnder,
         bool fastSDP,
-        unsigned int minFragmentsToUseGraphPaper) {
+        unsigned int minFragmentsToUseGraphPaper,
+        GraphPaperBuffers *graphPaperBuffers) {
 
     return SDPAlign(query, target, scoreFn, wordSize, 
             sdpIns, sdpDel, indelRate,
@@ -84,7 +87,7 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
             buffers.sdpCachedMaxFragmentChain,
             alignType, detailedAlignment, 
             extendFrontByLocalAlignment, noRecurseUnder,
-            fastSDP, minFragmentsToUseGraphPaper);
+            fastSDP, minFragmentsToUseGraphPaper, graphPaperBuffers);
 }
 
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_TupleList>
@@ -106,7 +109,8 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool extendFrontByLocalAlignment, 
         DNALength noRecurseUnder,
         bool fastSDP,
-        unsigned int minFragmentsToUseGraphPaper) {
+        unsigned int minFragmentsToUseGraphPaper,
+        GraphPaperBuffers *graphPaperBuffers) {
     // minFragmentsToUseGraphPaper: minimum number of fragments to 
     // use Graph Paper for speed up.
 
@@ -231,20 +235,21 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
     fragmentSet.insert(fragmentSet.begin(), prefixFragmentSet.begin(), prefixFragmentSet.end());
     fragmentSet.insert(fragmentSet.end(), suffixFragmentSet.begin(), suffixFragmentSet.end());
 
-    FlatMatrix2D<int> graphScoreMat;
-    FlatMatrix2D<Arrow> graphPathMat;
-    FlatMatrix2D<int> graphBins;
     if (fragmentSet.size() > minFragmentsToUseGraphPaper and fastSDP) {
-        int nCol = 50;
-        vector<bool> onOptPath(fragmentSet.size(), false);
-        GraphPaper<Fragment>(fragmentSet, nCol, nCol,
-                                      graphBins, graphScoreMat, 
-                                      graphPathMat, onOptPath);
-        RemoveOffOpt(fragmentSet, onOptPath);
+        //
+        // Use the caller's grids when given, otherwise allocate them
+        // for just this call.
+        //
+        GraphPaperBuffers localGraphPaperBuffers;
+        GraphPaperBuffers *graphPaperBuffersPtr = &localGraphPaperBuffers;
+        if (graphPaperBuffers != NULL) {
+            graphPaperBuffersPtr = graphPaperBuffers;
+        }
+        int nRows, nCols;
+        GraphPaperDimensions(fragmentSet, nRows, nCols);
+        GraphPaper<Fragment>(fragmentSet, nRows, nCols, *graphPaperBuffersPtr);
+        RemoveOffOpt(fragmentSet, graphPaperBuffersPtr->onOptPath);
     } 
-    graphScoreMat.Clear();
-    graphPathMat.Clear();
-    graphBins.Clear();
 
     //
     // Because there are fragments from multiple overlapping regions, remove
@@ -0,0 +1,64 @@
+#ifndef _BLASR_SW_ALIGN_BATCH_HPP_
+#define _BLASR_SW_ALIGN_BATCH_HPP_
+
+#include <vector>
+// pbdata
+#include "../../../pbdata/Types.h"
+
+#include "../../datastructures/alignment/Path.h"
+#include "AlignmentUtils.hpp"
+
+//
+// The number of pairs aligned together by SWAlignBatch.
+//
+#define SW_BATCH_LANES 16
+
+//
+// Storage for SWAlignBatch.  Everything is kept lane-interleaved, so
+// that the value of one cell for all pairs in a group is contiguous:
+// element [x * SW_BATCH_LANES + lane].
+//
+class SWAlignBatchBuffers {
+public:
+    std::vector<unsigned char> qCodes, tCodes;
+    std::vector<int> prevRow, curRow;
+    std::vector<unsigned char> arrows;
+    std::vector<Arrow> path;
+    std::vector<VectorIndex> order;
+};
+
+//
+// Align many independent pairs with the same recursion and score
+// matrix as SWAlign, SW_BATCH_LANES pairs at a time.  Pair p aligns
+// *qSeqs[p] to *tSeqs[p] with alignTypes[p], which may be Global,
+// Local, QueryFit, TargetFit, or the Score versions of these.  As in
+// SWAlign, a Local alignment is reported from the cell diagonally
+// before its best scoring cell, so its score and alignment stop one
+// base short of the best local alignment.
+//
+// Each group of pairs fills one matrix the size of its largest pair,
+// and each cell is computed for every pair in the group in one loop
+// over the lanes, so the per-cell work is a short loop with no
+// branches on the sequences that the compiler may vectorize, and the
+// setup of a call to SWAlign is paid once per group.  Pairs are
+// grouped by size, so it is best when the pairs are of similar length.
+//
+// scoreFn must have the scoreMatrix, ins and del of a
+// DistanceMatrixScoreFunction; position-dependent score functions
+// cannot be batched.  The score of pair p is stored in scores[p].
+// When alignments is not NULL, the alignment of each pair whose type
+// is not a Score type is stored in (*alignments)[p], with qPos and
+// tPos set as SWAlign sets them.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
+void SWAlignBatch(std::vector<T_QuerySequence*> &qSeqs,
+        std::vector<T_TargetSequence*> &tSeqs,
+        std::vector<AlignmentType> &alignTypes,
+        T_ScoreFn &scoreFn,
+        std::vector<int> &scores,
+        std::vector<T_Alignment> *alignments=NULL,
+        SWAlignBatchBuffers *buffers=NULL);
+
+#include "SWAlignBatchImpl.hpp"
+
+#endif // _BLASR_SW_ALIGN_BATCH_HPP_
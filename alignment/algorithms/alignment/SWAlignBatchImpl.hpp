@@ -0,0 +1,324 @@
+#ifndef _BLASR_SW_ALIGN_BATCH_IMPL_HPP_
+#define _BLASR_SW_ALIGN_BATCH_IMPL_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <vector>
+// pbdata
+#include "../../../pbdata/NucConversion.hpp"
+
+#include "../../datastructures/alignment/Path.h"
+#include "SWAlignBatch.hpp"
+
+//
+// Orders pairs by the size of their matrix, so that a group holds
+// pairs of similar size.
+//
+template<typename T_QuerySequence, typename T_TargetSequence>
+class SWBatchPairSizeLess {
+public:
+    std::vector<T_QuerySequence*> &qSeqs;
+    std::vector<T_TargetSequence*> &tSeqs;
+    SWBatchPairSizeLess(std::vector<T_QuerySequence*> &qSeqsP,
+        std::vector<T_TargetSequence*> &tSeqsP) : qSeqs(qSeqsP), tSeqs(tSeqsP) {}
+    bool operator()(VectorIndex a, VectorIndex b) const {
+        if (qSeqs[a]->length != qSeqs[b]->length) {
+            return qSeqs[a]->length < qSeqs[b]->length;
+        }
+        return tSeqs[a]->length < tSeqs[b]->length;
+    }
+};
+
+inline int SWBatchCode(Nucleotide nuc) {
+    int code = ThreeBit[nuc];
+    return (code < 4) ? code : 4;
+}
+
+//
+// Align the nLanes pairs listed in pairs, one per lane.  Lanes past
+// nLanes hold empty pairs.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
+void SWAlignBatchGroup(std::vector<T_QuerySequence*> &qSeqs,
+        std::vector<T_TargetSequence*> &tSeqs,
+        std::vector<AlignmentType> &alignTypes,
+        T_ScoreFn &scoreFn,
+        const VectorIndex *pairs, int nLanes,
+        std::vector<int> &scores,
+        std::vector<T_Alignment> *alignments,
+        SWAlignBatchBuffers &buffers) {
+
+    const int L = SW_BATCH_LANES;
+    DNALength qLen[L], tLen[L];
+    AlignmentType laneType[L];
+    int rowGap[L], colGap[L], floorScore[L];
+    bool trace[L];
+    int bestScore[L], cornerScore[L];
+    DNALength bestRow[L], bestCol[L];
+    bool anyTrace = false, anyLocal = false;
+    DNALength maxQ = 0, maxT = 0;
+    int l;
+
+    for (l = 0; l < L; l++) {
+        qLen[l] = tLen[l] = 0;
+        laneType[l] = ScoreGlobal;
+        trace[l] = false;
+        if (l < nLanes) {
+            VectorIndex p = pairs[l];
+            qLen[l] = qSeqs[p]->length;
+            tLen[l] = tSeqs[p]->length;
+            laneType[l] = alignTypes[p];
+            trace[l] = (alignments != NULL and
+                        alignTypes[p] != ScoreGlobal and alignTypes[p] != ScoreLocal and
+                        alignTypes[p] != ScoreQueryFit and alignTypes[p] != ScoreTargetFit);
+        }
+        AlignmentType t = laneType[l];
+        bool isLocal     = (t == Local or t == ScoreLocal);
+        bool isQueryFit  = (t == QueryFit or t == ScoreQueryFit);
+        bool isTargetFit = (t == TargetFit or t == ScoreTargetFit);
+        assert(isLocal or isQueryFit or isTargetFit or t == Global or t == ScoreGlobal);
+        rowGap[l]     = (isLocal or isQueryFit)  ? 0 : scoreFn.del;
+        colGap[l]     = (isLocal or isTargetFit) ? 0 : scoreFn.ins;
+        floorScore[l] = isLocal ? 0 : INT_MAX;
+        bestScore[l]  = isLocal ? 0 : INT_MAX;
+        cornerScore[l] = 0;
+        bestRow[l] = bestCol[l] = 0;
+        anyTrace = anyTrace or trace[l];
+        anyLocal = anyLocal or isLocal;
+        maxQ = std::max(maxQ, qLen[l]);
+        maxT = std::max(maxT, tLen[l]);
+    }
+
+    //
+    // Interleave the sequences.  Positions past the end of a pair are
+    // scored as N, and never reach the cells that score the pair.
+    //
+    buffers.qCodes.resize((VectorIndex) maxQ * L);
+    buffers.tCodes.resize((VectorIndex) maxT * L);
+    DNALength i, j;
+    for (l = 0; l < L; l++) {
+        for (i = 0; i < maxQ; i++) {
+            buffers.qCodes[i * L + l] = (i < qLen[l]) ? SWBatchCode(qSeqs[pairs[l]]->seq[i]) : 4;
+        }
+        for (j = 0; j < maxT; j++) {
+            buffers.tCodes[j * L + l] = (j < tLen[l]) ? SWBatchCode(tSeqs[pairs[l]]->seq[j]) : 4;
+        }
+    }
+    int matchTable[25];
+    int tc, qc;
+    for (tc = 0; tc < 5; tc++) {
+        for (qc = 0; qc < 5; qc++) {
+            matchTable[tc * 5 + qc] = scoreFn.scoreMatrix[tc][qc];
+        }
+    }
+
+    VectorIndex nCols = maxT + 1;
+    buffers.prevRow.resize(nCols * L);
+    buffers.curRow.resize(nCols * L);
+    if (anyTrace) {
+        buffers.arrows.resize((maxQ + 1) * nCols * L);
+    }
+    int *prev = &buffers.prevRow[0];
+    int *cur  = &buffers.curRow[0];
+    unsigned char *arrows = anyTrace ? &buffers.arrows[0] : NULL;
+    int ins = scoreFn.ins, del = scoreFn.del;
+
+    for (j = 0; j <= maxT; j++) {
+        for (l = 0; l < L; l++) {
+            prev[j * L + l] = j * rowGap[l];
+        }
+        if (anyTrace) {
+            for (l = 0; l < L; l++) {
+                arrows[j * L + l] = (j == 0) ? Diagonal : Left;
+            }
+        }
+    }
+
+    //
+    // Record the scores that end on row i, whose values are in row.
+    //
+    for (i = 0; i <= maxQ; i++) {
+        int *row = prev;
+        if (i > 0) {
+            const unsigned char *qCodes = &buffers.qCodes[(i - 1) * L];
+            unsigned char *rowArrows = anyTrace ? &arrows[i * nCols * L] : NULL;
+            for (l = 0; l < L; l++) {
+                cur[l] = i * colGap[l];
+            }
+            if (anyTrace) {
+                for (l = 0; l < L; l++) {
+                    rowArrows[l] = Up;
+                }
+            }
+            for (j = 1; j <= maxT; j++) {
+                const unsigned char *tCodes = &buffers.tCodes[(j - 1) * L];
+                const int *diagIn = &prev[(j - 1) * L];
+                const int *upIn   = &prev[j * L];
+                const int *leftIn = &cur[(j - 1) * L];
+                int *out = &cur[j * L];
+                if (anyTrace) {
+                    unsigned char *cellArrows = &rowArrows[j * L];
+                    for (l = 0; l < L; l++) {
+                        //
+                        // Written as selects rather than branches, so
+                        // the lanes may be computed together.
+                        //
+                        int best      = diagIn[l] + matchTable[tCodes[l] * 5 + qCodes[l]];
+                        int upScore   = upIn[l] + ins;
+                        int leftScore = leftIn[l] + del;
+                        unsigned char arrow = (upScore < best) ? (unsigned char) Up : (unsigned char) Diagonal;
+                        best  = std::min(best, upScore);
+                        arrow = (leftScore < best) ? (unsigned char) Left : arrow;
+                        best  = std::min(best, leftScore);
+                        arrow = (best > floorScore[l]) ? (unsigned char) NoArrow : arrow;
+                        out[l] = std::min(best, floorScore[l]);
+                        cellArrows[l] = arrow;
+                    }
+                }
+                else {
+                    for (l = 0; l < L; l++) {
+                        int best = diagIn[l] + matchTable[tCodes[l] * 5 + qCodes[l]];
+                        best = std::min(best, upIn[l] + ins);
+                        best = std::min(best, leftIn[l] + del);
+                        out[l] = std::min(best, floorScore[l]);
+                    }
+                }
+                if (anyLocal) {
+                    for (l = 0; l < L; l++) {
+                        if (floorScore[l] == 0 and out[l] < bestScore[l] and
+                            i <= qLen[l] and j <= tLen[l]) {
+                            bestScore[l] = out[l];
+                            bestRow[l] = i;
+                            bestCol[l] = j;
+                            cornerScore[l] = diagIn[l];
+                        }
+                    }
+                }
+            }
+            row = cur;
+        }
+
+        for (l = 0; l < L; l++) {
+            AlignmentType t = laneType[l];
+            if (t == TargetFit or t == ScoreTargetFit) {
+                //
+                // The best cell in the last column, from row 1 on.
+                //
+                if ((i <= qLen[l] and row[tLen[l] * L + l] < bestScore[l] and
+                     (i > 0 or qLen[l] == 0))) {
+                    bestScore[l] = row[tLen[l] * L + l];
+                    bestRow[l] = i;
+                    bestCol[l] = tLen[l];
+                }
+            }
+            else if (i == qLen[l] and (t == Global or t == ScoreGlobal)) {
+                bestScore[l] = row[tLen[l] * L + l];
+                bestRow[l] = i;
+                bestCol[l] = tLen[l];
+            }
+            else if (i == qLen[l] and (t == QueryFit or t == ScoreQueryFit)) {
+                //
+                // The best cell in the last row, from column 1 on.
+                //
+                bestRow[l] = i;
+                bestCol[l] = (tLen[l] > 0) ? 1 : 0;
+                bestScore[l] = row[bestCol[l] * L + l];
+                for (j = bestCol[l] + 1; j <= tLen[l]; j++) {
+                    if (row[j * L + l] < bestScore[l]) {
+                        bestScore[l] = row[j * L + l];
+                        bestCol[l] = j;
+                    }
+                }
+            }
+        }
+        if (i > 0) {
+            std::swap(prev, cur);
+        }
+    }
+
+    for (l = 0; l < nLanes; l++) {
+        VectorIndex p = pairs[l];
+        AlignmentType t = laneType[l];
+        //
+        // SWAlign reports a local alignment from the cell diagonally
+        // before the best one, so do the same.
+        //
+        bool isLocal = (t == Local or t == ScoreLocal);
+        if (isLocal and bestRow[l] > 0) {
+            bestRow[l]--;
+            bestCol[l]--;
+            bestScore[l] = cornerScore[l];
+        }
+        scores[p] = bestScore[l];
+        if (!trace[l]) {
+            continue;
+        }
+        T_Alignment &alignment = (*alignments)[p];
+        alignment = T_Alignment();
+        std::vector<Arrow> &path = buffers.path;
+        path.clear();
+        DNALength r = bestRow[l], c = bestCol[l];
+        while ((t == Global and (r > 0 or c > 0)) or
+               (t == QueryFit and r > 0) or
+               (t == TargetFit and c > 0) or
+               (t == Local and r > 0 and c > 0 and
+                arrows[(r * nCols + c) * L + l] != NoArrow)) {
+            Arrow arrow = (Arrow) arrows[(r * nCols + c) * L + l];
+            path.push_back(arrow);
+            if (arrow == Diagonal) { r--; c--; }
+            else if (arrow == Up) { r--; }
+            else { c--; }
+        }
+        std::reverse(path.begin(), path.end());
+        if (path.size() > 0) {
+            alignment.ArrowPathToAlignment(path);
+        }
+        if (t != Global) {
+            alignment.qPos = r;
+            alignment.tPos = c;
+        }
+        if (t == Local) {
+            alignment.qLength = bestRow[l] - r + 1;
+            alignment.tLength = bestCol[l] - c + 1;
+        }
+    }
+}
+
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
+void SWAlignBatch(std::vector<T_QuerySequence*> &qSeqs,
+        std::vector<T_TargetSequence*> &tSeqs,
+        std::vector<AlignmentType> &alignTypes,
+        T_ScoreFn &scoreFn,
+        std::vector<int> &scores,
+        std::vector<T_Alignment> *alignments,
+        SWAlignBatchBuffers *buffers) {
+
+    SWAlignBatchBuffers localBuffers;
+    if (buffers == NULL) {
+        buffers = &localBuffers;
+    }
+    VectorIndex nPairs = qSeqs.size();
+    assert(tSeqs.size() == nPairs and alignTypes.size() == nPairs);
+    scores.resize(nPairs);
+    if (alignments != NULL) {
+        alignments->resize(nPairs);
+    }
+
+    std::vector<VectorIndex> &order = buffers->order;
+    order.resize(nPairs);
+    VectorIndex p;
+    for (p = 0; p < nPairs; p++) {
+        order[p] = p;
+    }
+    std::sort(order.begin(), order.end(),
+        SWBatchPairSizeLess<T_QuerySequence, T_TargetSequence>(qSeqs, tSeqs));
+
+    for (p = 0; p < nPairs; p += SW_BATCH_LANES) {
+        int nLanes = (int) std::min((VectorIndex) SW_BATCH_LANES, nPairs - p);
+        SWAlignBatchGroup(qSeqs, tSeqs, alignTypes, scoreFn, &order[p], nLanes,
+            scores, alignments, *buffers);
+    }
+}
+
+#endif // _BLASR_SW_ALIGN_BATCH_IMPL_HPP_
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "BWTSearch.hpp"
 
 int MapReadToGenome(BWT & bwt,
@@ -15,6 +16,7 @@ int MapReadToGenome(BWT & bwt,
     }
     else {
         DNALength p;
+        std::vector<DNALength> matches;
         prefix.seq = seq.seq;
         for (p = subreadStart + params.minMatchLength; 
              p < subreadEnd; p++) {
@@ -37,7 +39,7 @@ int MapReadToGenome(BWT & bwt,
             }
 
             DNALength i;
-            std::vector<DNALength> matches;
+            matches.clear();
             while (matchLength >= params.minMatchLength) {
                 i = matchLength - 1;
 
@@ -83,3 +85,159 @@ int MapReadToGenome(BWT & bwt,
         params, numBasesAnchored, spv, epv);
 }
 
+
+class BiIntervalStartLess {
+public:
+    bool operator()(const BiInterval &a, const BiInterval &b) const {
+        if (a.qStart != b.qStart) {
+            return a.qStart < b.qStart;
+        }
+        return a.qEnd < b.qEnd;
+    }
+};
+
+//
+// Find the SMEMs that contain seq[x], appending those of at least
+// minMatchLength to smems, and return the end of the longest match
+// that starts at x, where the search continues.
+//
+static DNALength FindSMEMsAt(BidirectionalBWT &bwt, DNASequence &seq,
+    DNALength x, DNALength start, DNALength end, DNALength minMatchLength,
+    std::vector<BiInterval> &smems, SMEMBuffers &buffers) {
+
+    std::vector<BiInterval> &prev = buffers.prev;
+    std::vector<BiInterval> &curr = buffers.curr;
+    prev.clear();
+    BiInterval ik, ok;
+    bwt.Initialize(ThreeBit[seq[x]], ik);
+    if (ik.size == 0) {
+        return x + 1;
+    }
+    ik.qStart = x;
+    ik.qEnd   = x + 1;
+
+    //
+    // Extend to the right, keeping the longest match for each number
+    // of hits.
+    //
+    DNALength i;
+    bool pushLast = true;
+    for (i = x + 1; i < end; i++) {
+        Nucleotide c = ThreeBit[seq[i]];
+        if (c > 3) {
+            break;
+        }
+        bwt.ExtendRight(ik, c, ok);
+        if (ok.size != ik.size) {
+            prev.push_back(ik);
+            if (ok.size == 0) {
+                pushLast = false;
+                break;
+            }
+        }
+        ok.qStart = x;
+        ok.qEnd   = i + 1;
+        ik = ok;
+    }
+    if (pushLast) {
+        prev.push_back(ik);
+    }
+    std::reverse(prev.begin(), prev.end());
+    DNALength next = prev[0].qEnd;
+
+    //
+    // Extend all of them to the left together, longest first.  A
+    // match that cannot be extended is an SMEM when no longer match
+    // has been extended in the same step, and it does not start where
+    // the last one found did.
+    //
+    bool found = false;
+    DNALength lastStart = 0;
+    for (i = x; ; i--) {
+        Nucleotide c = (i == start) ? 4 : ThreeBit[seq[i - 1]];
+        curr.clear();
+        VectorIndex p;
+        for (p = 0; p < prev.size(); p++) {
+            bool extended = false;
+            if (c < 4) {
+                bwt.ExtendLeft(prev[p], c, ok);
+                extended = (ok.size > 0);
+            }
+            if (!extended) {
+                if (curr.empty() and (!found or prev[p].qStart < lastStart)) {
+                    found = true;
+                    lastStart = prev[p].qStart;
+                    if (prev[p].qEnd - prev[p].qStart >= minMatchLength) {
+                        smems.push_back(prev[p]);
+                    }
+                }
+            }
+            else if (curr.empty() or ok.size != curr.back().size) {
+                ok.qStart = prev[p].qStart - 1;
+                ok.qEnd   = prev[p].qEnd;
+                curr.push_back(ok);
+            }
+        }
+        if (curr.empty()) {
+            break;
+        }
+        prev.swap(curr);
+    }
+    return next;
+}
+
+int FindSMEMs(BidirectionalBWT &bwt, DNASequence &seq,
+    DNALength start, DNALength end, DNALength minMatchLength,
+    std::vector<BiInterval> &smems, SMEMBuffers *buffers) {
+    SMEMBuffers localBuffers;
+    if (buffers == NULL) {
+        buffers = &localBuffers;
+    }
+    smems.clear();
+    DNALength x = start;
+    while (x < end) {
+        if (ThreeBit[seq[x]] > 3) {
+            x++;
+        }
+        else {
+            x = FindSMEMsAt(bwt, seq, x, start, end, minMatchLength, smems, *buffers);
+        }
+    }
+    std::sort(smems.begin(), smems.end(), BiIntervalStartLess());
+    return smems.size();
+}
+
+int MapReadToGenome(BidirectionalBWT &bwt,
+    FASTASequence &seq,
+    DNALength start, DNALength end,
+    std::vector<ChainedMatchPos> &matchPosList,
+    AnchorParameters &params, int &numBasesAnchored,
+    SMEMBuffers *buffers) {
+    SMEMBuffers localBuffers;
+    if (buffers == NULL) {
+        buffers = &localBuffers;
+    }
+    numBasesAnchored = 0;
+    FindSMEMs(bwt, seq, start, end, params.minMatchLength, buffers->smems, buffers);
+
+    DNALength coveredEnd = start;
+    VectorIndex s, m;
+    for (s = 0; s < buffers->smems.size(); s++) {
+        BiInterval &smem = buffers->smems[s];
+        if (smem.size >= params.maxAnchorsPerPosition) {
+            continue;
+        }
+        buffers->positions.clear();
+        bwt.Locate(smem, buffers->positions);
+        DNALength matchLength = smem.qEnd - smem.qStart;
+        for (m = 0; m < buffers->positions.size(); m++) {
+            matchPosList.push_back(ChainedMatchPos(buffers->positions[m],
+                smem.qStart, matchLength, buffers->positions.size()));
+        }
+        if (smem.qEnd > coveredEnd) {
+            numBasesAnchored += smem.qEnd - std::max(smem.qStart, coveredEnd);
+            coveredEnd = smem.qEnd;
+        }
+    }
+    return matchPosList.size();
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include "../../../pbdata/FASTASequence.hpp"
 #include "../../bwt/BWT.hpp"
+#include "../../bwt/BidirectionalBWT.hpp"
 #include "../../datastructures/anchoring/MatchPos.hpp"
 #include "../../datastructures/anchoring/AnchorParameters.hpp"
 
@@ -23,6 +24,49 @@ int MapReadToGenome(BWT & bwt,
 	AnchorParameters  & params, int &numBasesAnchored);
 
 
+//
+// Storage for the SMEM search, reused between reads.
+//
+class SMEMBuffers {
+public:
+    std::vector<BiInterval> prev, curr, smems;
+    std::vector<DNALength> positions;
+};
+
+//
+// Find the super-maximal exact matches (SMEMs) of seq[start,end) in
+// the text of bwt that are at least minMatchLength long: the exact
+// matches that cannot be extended in either direction and that are
+// not contained in a longer exact match.  They are stored in smems in
+// order of their start in the read.
+//
+// This follows the algorithm of Li (Bioinformatics 2012).  From each
+// position, the longest match to the right is found while recording
+// the intervals where the number of hits drops, and then those are
+// extended to the left together.  The search for the next SMEM starts
+// after the end of the longest one, so a read is covered with a small
+// number of rank queries per base, rather than the backward search
+// from every end position done with a unidirectional index.  Bases
+// other than ACGT are never matched.
+//
+int FindSMEMs(BidirectionalBWT &bwt, DNASequence &seq,
+    DNALength start, DNALength end, DNALength minMatchLength,
+    std::vector<BiInterval> &smems, SMEMBuffers *buffers=NULL);
+
+//
+// Anchor a read with the SMEMs of seq[start,end).  Each SMEM that has
+// fewer than params.maxAnchorsPerPosition hits produces one anchor per
+// hit, with the position of the hit in the forward text.
+// numBasesAnchored is the number of read bases covered by these
+// anchors.
+//
+int MapReadToGenome(BidirectionalBWT &bwt,
+    FASTASequence &seq,
+    DNALength start, DNALength end,
+    std::vector<ChainedMatchPos> &matchPosList,
+    AnchorParameters &params, int &numBasesAnchored,
+    SMEMBuffers *buffers=NULL);
+
 template<typename T_MappingBuffers>
 int MapReadToGenome(BWT & bwt,
     FASTASequence & seq,
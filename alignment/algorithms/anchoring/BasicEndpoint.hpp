@@ -32,6 +32,18 @@ public:
             return lhs.p < rhs.p;
         }
     };
+    //
+    // The order of the priority search tree: by key (the y coordinate),
+    // then x, and the start of an empty fragment before its end.
+    //
+    class LessThanByKey {
+    public:
+        int operator()(const BasicEndpoint<T_ScoredFragment> & lhs, const BasicEndpoint<T_ScoredFragment> & rhs) const {
+            if (lhs.p.GetY() != rhs.p.GetY()) return lhs.p.GetY() < rhs.p.GetY();
+            else if (lhs.p.GetX() != rhs.p.GetX()) return lhs.p.GetX() < rhs.p.GetX();
+            else return lhs.side < rhs.side;
+        }
+    };
     BasicEndpoint();
 	WhichEnd GetSide();
 	void FragmentPtrToStart(T_ScoredFragment* fragment);
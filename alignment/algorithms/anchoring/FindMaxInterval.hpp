@@ -2,12 +2,15 @@
 #define _BLASR_FIND_MAX_INTERVAL_HPP_
 
 #include <semaphore.h>
+#include <pthread.h>
 #include <math.h>
 #include <fstream>
 #include <iostream>
 #include "LongestIncreasingSubsequence.hpp"
 #include "GlobalChain.hpp"
+#include "SlidingWindowChain.hpp"
 #include "BasicEndpoint.hpp"
+#include "../../../pbdata/Enumerations.h"
 #include "../../datastructures/anchoring/WeightedInterval.hpp"
 #include "../../datastructures/anchoring/MatchPos.hpp"
 #include "../../datastructures/anchoring/ClusterList.hpp"
@@ -23,12 +26,56 @@ public:
     float aboveCategoryPValue;
     bool  warp;
     bool  fastMaxInterval; 
+    // Chain the windows of the exhaustive search incrementally with
+    // SlidingWindowChain rather than calling GlobalChain on each one.
+    bool  slidingWindowChain;
     bool  aggressiveIntervalCut;
     int   verbosity;
     float ddPValueThreshold;
     IntervalSearchParameters();
 };
 
+//
+// An interval found by the interval search on one strand, along with
+// the p-value and weight that are accumulated for it.  When both
+// strands are searched concurrently the candidates are buffered per
+// strand, and stored afterwards in the order a serial search would
+// have stored them, so that the interval queue is the same.
+//
+class IntervalCandidate {
+public:
+    float pValue;
+    MatchWeight weight;
+    // True if the interval passed the p-value cutoff and is stored
+    // in the interval queue.
+    bool isSignificant;
+    WeightedInterval interval;
+
+    IntervalCandidate(float _pValue, MatchWeight _weight);
+};
+
+typedef std::vector<IntervalCandidate> IntervalCandidateList;
+
+void StoreIntervalCandidate(IntervalCandidate &candidate,
+    IntervalSearchParameters &params,
+    WeightedIntervalSet &intervalQueue,
+    ClusterList &clusterList,
+    VarianceAccumulator<float> &accumPValue, 
+    VarianceAccumulator<float> &accumWeight);
+
+void StoreIntervalCandidates(IntervalCandidateList &candidates,
+    IntervalSearchParameters &params,
+    WeightedIntervalSet &intervalQueue,
+    ClusterList &clusterList,
+    VarianceAccumulator<float> &accumPValue, 
+    VarianceAccumulator<float> &accumWeight);
+
+void AggressiveIntervalCut(IntervalSearchParameters &params,
+    WeightedIntervalSet &intervalQueue,
+    ClusterList &clusterList,
+    VarianceAccumulator<float> &accumPValue, 
+    VarianceAccumulator<float> &accumWeight);
+
 
 template<typename T_Sequence, typename T_AnchorList>
 class DefaultWeightFunction {
@@ -145,7 +192,10 @@ int FastFindMaxIncreasingInterval(
         std::vector<BasicEndpoint<ChainedMatchPos> > *chainEndpointBuffer,
         ClusterList &clusterList,
         VarianceAccumulator<float> &accumPValue, 
-        VarianceAccumulator<float> &accumWeight);
+        VarianceAccumulator<float> &accumWeight,
+        // When not NULL, found intervals are appended here rather than
+        // stored in intervalQueue, clusterList and the accumulators.
+        IntervalCandidateList *deferredCandidates = NULL);
 
 template<typename T_MatchList,
          typename T_PValueFunction, 
@@ -168,7 +218,87 @@ int ExhaustiveFindMaxIncreasingInterval(
         std::vector<BasicEndpoint<ChainedMatchPos> > *chainEndpointBuffer,
         ClusterList &clusterList,
         VarianceAccumulator<float> &accumPValue, 
-        VarianceAccumulator<float> &accumWeight);
+        VarianceAccumulator<float> &accumWeight,
+        // When not NULL, found intervals are appended here rather than
+        // stored in intervalQueue, clusterList and the accumulators.
+        IntervalCandidateList *deferredCandidates = NULL);
+
+//
+// The state of the interval search on one strand.  Each strand has
+// its own anchor list, query and chain endpoint buffer, so that the
+// strands may be searched on separate threads.  It also keeps its own
+// copy of the p-value and weight functions, so that neither is called
+// from two threads at once; they must be copyable, and anything they
+// point to, such as a tuple count table, is only read.
+//
+template<typename T_MatchList,
+         typename T_PValueFunction, 
+         typename T_WeightFunction,
+         typename T_SequenceBoundaryDB,
+         typename T_ReferenceSequence,
+         typename T_Sequence>
+class StrandIntervalSearch {
+public:
+    int readDir;
+    T_MatchList *pos;
+    DNALength intervalLength;
+    VectorIndex nBest;
+    T_SequenceBoundaryDB *contigStartPos;
+    T_PValueFunction matchPValueFunction;
+    T_WeightFunction matchWeightFunction;
+    T_ReferenceSequence *reference;
+    T_Sequence *query;
+    IntervalSearchParameters *params;
+    std::vector<BasicEndpoint<ChainedMatchPos> > *chainEndpointBuffer;
+
+    // Output
+    IntervalCandidateList candidates;
+    int maxLISSize;
+
+    StrandIntervalSearch(const T_PValueFunction &pValueFunction,
+        const T_WeightFunction &weightFunction);
+
+    void Run();
+    static void *RunThread(void *searchPtr);
+};
+
+//
+// Search for max increasing intervals on the forward and reverse
+// strands of a read, running the reverse strand on a separate thread.
+// The intervals are stored into intervalQueue in the same order as
+// calling FindMaxIncreasingInterval on the forward and then the
+// reverse strand, resetting the cluster coordinates in between, so
+// the result is identical to the serial search.  Because the strands
+// are chained concurrently, each must have its own endpoint buffer,
+// and each strand calls its own copy of MatchPValueFunction and
+// MatchWeightFunction.
+// Returns the largest LIS found on either strand.
+//
+template<typename T_MatchList,
+         typename T_PValueFunction, 
+         typename T_WeightFunction,
+         typename T_SequenceBoundaryDB,
+         typename T_ReferenceSequence,
+         typename T_Sequence>
+int FindMaxIncreasingIntervalOnBothStrands(
+        T_MatchList &forwardPos, 
+        T_MatchList &reversePos,
+        DNALength intervalLength,  
+        VectorIndex nBest, 
+        T_SequenceBoundaryDB & ContigStartPos,
+        T_PValueFunction &MatchPValueFunction,  
+        T_WeightFunction &MatchWeightFunction,  
+        WeightedIntervalSet &intervalQueue, 
+        T_ReferenceSequence &reference, 
+        T_Sequence &forwardQuery,
+        T_Sequence &reverseQuery,
+        IntervalSearchParameters &params,
+        std::vector<BasicEndpoint<ChainedMatchPos> > *forwardChainEndpointBuffer,
+        std::vector<BasicEndpoint<ChainedMatchPos> > *reverseChainEndpointBuffer,
+        ClusterList &clusterList,
+        VarianceAccumulator<float> &accumPValue, 
+        VarianceAccumulator<float> &accumWeight,
+        VarianceAccumulator<float> &accumNumAnchorBases);
 
 #include "FindMaxIntervalImpl.hpp"
 #endif
@@ -445,59 +445,8 @@ int FindMaxIncreasingInterval(
                 accumPValue, accumWeight);
     }
 
-    if (params.aggressiveIntervalCut and intervalQueue.size() >= 3) {
-        // aggressiveIntervalCut mode: 
-        // only pick up the most promising intervals if we can classify
-        // intervals into 'promising' and 'non-promising' clusters.
-        WeightedIntervalSet::iterator it = intervalQueue.begin();
-        int sz = intervalQueue.size();
-        vector<float> pValues, ddPValues;
-        pValues.resize(sz);
-        ddPValues.resize(sz);
-        float sumPValue = 0;
-        int i = 0;
-        for(; it != intervalQueue.end(); i++,it++) {
-            sumPValue += (*it).pValue;
-            pValues[i] = (*it).pValue;
-        }
-        //We will attemp to divide intervals into two clusters, promising 
-        //and non-promising.
-        float prevSumPValue = pValues[0];
-        // ddPValue[i], where i in [1...n-2] is the difference of 
-        //    (1) (mean pvalue of [0...i-1] minus pvalue[i])
-        // and 
-        //    (2) (pvalue[i] minus mean pvalue of [i+1...n-1])
-        // pValues are all negative, the lower the better.
-        // if ddPValue is negative, interval i is closer to cluster [i+1...n-1],
-        // otherwise, interval i is closer to cluster [0..i-1].
-        it = intervalQueue.begin();
-        it ++; //both it and i should point to the second interval in intervalQueue.
-        for(i = 1; i < sz - 1; i++,it++) {
-            ddPValues[i] = (prevSumPValue / i) +
-                           (sumPValue - prevSumPValue - pValues[i]) / (sz - i - 1) -
-                           2 * pValues[i];
-            if (ddPValues[i] <= params.ddPValueThreshold) {
-                // PValue of interval i is much closer to cluster [i+1...n-1] than
-                // to cluster [0...i-1]. Mean pValue of cluster [0..i-1] 
-                // minus mean pvalue of cluster [i+1...n-1] < 2 * -500
-                break;
-            }
-            prevSumPValue += pValues[i];
-        }
-        if (it != intervalQueue.end()) {
-            // Erase intervals in the non-promising cluster.
-            intervalQueue.erase(it, intervalQueue.end());
-            // Recompute accumPValue, accmWeight, clusterList;
-            accumPValue.Reset();
-            accumWeight.Reset();
-            clusterList.Clear();
-            for(it = intervalQueue.begin(); it != intervalQueue.end(); it++) {
-                accumPValue.Append((*it).pValue);
-                accumWeight.Append((*it).size);
-                clusterList.Store((*it).totalAnchorSize, (*it).start, (*it).end, (*it).nAnchors);
-            }
-        }
-    }
+    AggressiveIntervalCut(params, intervalQueue, clusterList, 
+        accumPValue, accumWeight);
     return maxLISSize;
 }
 
@@ -535,7 +484,8 @@ int FastFindMaxIncreasingInterval(
         vector<BasicEndpoint<ChainedMatchPos> > *chainEndpointBuffer,
         ClusterList &clusterList,
         VarianceAccumulator<float> &accumPValue, 
-        VarianceAccumulator<float> &accumWeight) {
+        VarianceAccumulator<float> &accumWeight,
+        IntervalCandidateList *deferredCandidates) {
     (void)(nBest); (void)(query); (void)(reference);
  
     WeightedIntervalSet sdpiq;
@@ -566,6 +516,7 @@ int FastFindMaxIncreasingInterval(
     (void)(curBoundary); (void)(nextBoundary); (void)(endOfCurrentInterval);
 
     vector<UInt> scores, prevOpt;
+    vector<PSTVertex<BasicEndpoint<ChainedMatchPos> > > chainTree;
     vector<DNALength> start, end;
 
     StoreLargestIntervals(pos, ContigStartPos, intervalLength, 30, start, end);
@@ -592,7 +543,7 @@ int FastFindMaxIncreasingInterval(
             //
             if (params.globalChainType == 0) {
                 lisSize = GlobalChain<ChainedMatchPos, BasicEndpoint<ChainedMatchPos> >(pos, cur, next, 
-                        lisIndices, chainEndpointBuffer);
+                        lisIndices, chainEndpointBuffer, &chainTree);
             }
             else {
                 //
@@ -629,23 +580,21 @@ int FastFindMaxIncreasingInterval(
         MatchWeight lisWeight = MatchWeightFunction(lis);
         VectorIndex lisEnd = lis.size() - 1;
 
-        accumPValue.Append(lisPValue);
-        accumWeight.Append(lisWeight);
-
+        IntervalCandidate candidate(lisPValue, lisWeight);
         if (lisPValue < params.maxPValue and lisSize > 0) {
-            WeightedInterval weightedInterval(lisWeight, noOvpLisSize, noOvpLisNBases, 
+            candidate.isSignificant = true;
+            candidate.interval = WeightedInterval(lisWeight, noOvpLisSize, noOvpLisNBases, 
                     lis[0].t, lis[lisEnd].t + lis[lisEnd].GetLength(), 
                     readDir, lisPValue, 
                     lis[0].q, lis[lisEnd].q + lis[lisEnd].GetLength(), 
                     lis);
-            intervalQueue.insert(weightedInterval);
-            if (weightedInterval.isOverlapping == false) {
-                clusterList.Store((float)noOvpLisNBases, lis[0].t, lis[lis.size()-1].t, noOvpLisSize);
-            }
-            if (params.verbosity > 1) {
-                cout << "Weighted Interval to insert:"<< endl << weightedInterval << endl;
-                cout << "Interval Queue:"<< endl << intervalQueue << endl;
-            }
+        }
+        if (deferredCandidates != NULL) {
+            deferredCandidates->push_back(candidate);
+        }
+        else {
+            StoreIntervalCandidate(candidate, params, intervalQueue, 
+                clusterList, accumPValue, accumWeight);
         }
     }
     return maxLISSize;
@@ -685,7 +634,8 @@ int ExhaustiveFindMaxIncreasingInterval(
         vector<BasicEndpoint<ChainedMatchPos> > *chainEndpointBuffer,
         ClusterList &clusterList,
         VarianceAccumulator<float> &accumPValue, 
-        VarianceAccumulator<float> &accumWeight) {
+        VarianceAccumulator<float> &accumWeight,
+        IntervalCandidateList *deferredCandidates) {
     (void)(nBest); (void)(query); (void)(reference);
 
     WeightedIntervalSet sdpiq;
@@ -718,6 +668,7 @@ int ExhaustiveFindMaxIncreasingInterval(
     curBoundary = ContigStartPos(pos[cur].t);
     nextBoundary = ContigStartPos(pos[next].t);  
     vector<UInt> scores, prevOpt;
+    vector<PSTVertex<BasicEndpoint<ChainedMatchPos> > > chainTree;
 
     //
     // Advance next until the anchor is outside the interval that
@@ -735,6 +686,17 @@ int ExhaustiveFindMaxIncreasingInterval(
     vector<VectorIndex> lisIndices;
     VectorIndex i;
 
+    //
+    // The windows searched below slide from left to right across pos,
+    // so they may be chained incrementally.
+    //
+    SlidingWindowChain<T_MatchList> windowChain;
+    bool useWindowChain = (params.globalChainType == 0 and 
+                           params.slidingWindowChain);
+    if (useWindowChain) {
+        windowChain.Initialize(pos);
+    }
+
     //
     // Do some preprocessing.  If the number of anchors considered for this hit is 1, 
     // the global chain is this sole ancor.  Don't bother calling GlobalChain
@@ -765,9 +727,12 @@ int ExhaustiveFindMaxIncreasingInterval(
             //
             // Find the largest set of increasing intervals that do not overlap.
             //
-            if (params.globalChainType == 0) {
+            if (useWindowChain) {
+                lisSize = windowChain.Chain(cur, next, lisIndices);
+            }
+            else if (params.globalChainType == 0) {
                 lisSize = GlobalChain<ChainedMatchPos, BasicEndpoint<ChainedMatchPos> >(pos, cur, next, 
-                        lisIndices, chainEndpointBuffer);
+                        lisIndices, chainEndpointBuffer, &chainTree);
             }
             else {
                 //
@@ -799,23 +764,21 @@ int ExhaustiveFindMaxIncreasingInterval(
         MatchWeight lisWeight = MatchWeightFunction(lis);
         VectorIndex lisEnd = lis.size() - 1;
 
-        accumPValue.Append(lisPValue);
-        accumWeight.Append(lisWeight);
-
+        IntervalCandidate candidate(lisPValue, lisWeight);
         if (lisPValue < params.maxPValue and lisSize > 0) {
-            WeightedInterval weightedInterval(lisWeight, noOvpLisSize, noOvpLisNBases, 
+            candidate.isSignificant = true;
+            candidate.interval = WeightedInterval(lisWeight, noOvpLisSize, noOvpLisNBases, 
                     lis[0].t, lis[lisEnd].t + lis[lisEnd].GetLength(), 
                     readDir, lisPValue, 
                     lis[0].q, lis[lisEnd].q + lis[lisEnd].GetLength(), 
                     lis);
-            intervalQueue.insert(weightedInterval);
-            if (weightedInterval.isOverlapping == false) {
-                clusterList.Store((float)noOvpLisNBases, lis[0].t, lis[lis.size()-1].t, noOvpLisSize);
-            }
-            if (params.verbosity > 1) {
-                cout << "Weighted Interval to insert:"<< endl << weightedInterval << endl;
-                cout << "Interval Queue:"<< endl << intervalQueue << endl;
-            }
+        }
+        if (deferredCandidates != NULL) {
+            deferredCandidates->push_back(candidate);
+        }
+        else {
+            StoreIntervalCandidate(candidate, params, intervalQueue, 
+                clusterList, accumPValue, accumWeight);
         }
 
         //
@@ -945,4 +908,158 @@ int ExhaustiveFindMaxIncreasingInterval(
     return  maxLISSize;
 }
 
+template<typename T_MatchList,
+         typename T_PValueFunction, 
+         typename T_WeightFunction,
+         typename T_SequenceBoundaryDB,
+         typename T_ReferenceSequence,
+         typename T_Sequence>
+StrandIntervalSearch<T_MatchList, T_PValueFunction, T_WeightFunction, 
+    T_SequenceBoundaryDB, T_ReferenceSequence, T_Sequence>::StrandIntervalSearch(
+    const T_PValueFunction &pValueFunction, const T_WeightFunction &weightFunction) :
+    matchPValueFunction(pValueFunction), matchWeightFunction(weightFunction) {
+    readDir        = Forward;
+    pos            = NULL;
+    intervalLength = 0;
+    nBest          = 0;
+    contigStartPos = NULL;
+    reference      = NULL;
+    query          = NULL;
+    params         = NULL;
+    chainEndpointBuffer = NULL;
+    maxLISSize     = 0;
+}
+
+template<typename T_MatchList,
+         typename T_PValueFunction, 
+         typename T_WeightFunction,
+         typename T_SequenceBoundaryDB,
+         typename T_ReferenceSequence,
+         typename T_Sequence>
+void StrandIntervalSearch<T_MatchList, T_PValueFunction, T_WeightFunction, 
+    T_SequenceBoundaryDB, T_ReferenceSequence, T_Sequence>::Run() {
+    //
+    // The shared outputs are not touched when the candidates are
+    // deferred, so these are only placeholders.
+    //
+    WeightedIntervalSet unusedQueue;
+    ClusterList unusedClusterList;
+    VarianceAccumulator<float> unusedPValue, unusedWeight;
+
+    candidates.clear();
+    if (params->fastMaxInterval) {
+        maxLISSize = FastFindMaxIncreasingInterval(
+                readDir, *pos, intervalLength,
+                nBest, *contigStartPos, 
+                matchPValueFunction, matchWeightFunction,
+                unusedQueue, *reference, *query,
+                *params, chainEndpointBuffer, unusedClusterList,
+                unusedPValue, unusedWeight, &candidates);
+    } else {
+        maxLISSize = ExhaustiveFindMaxIncreasingInterval(
+                readDir, *pos, intervalLength,
+                nBest, *contigStartPos, 
+                matchPValueFunction, matchWeightFunction,
+                unusedQueue, *reference, *query,
+                *params, chainEndpointBuffer, unusedClusterList,
+                unusedPValue, unusedWeight, &candidates);
+    }
+}
+
+template<typename T_MatchList,
+         typename T_PValueFunction, 
+         typename T_WeightFunction,
+         typename T_SequenceBoundaryDB,
+         typename T_ReferenceSequence,
+         typename T_Sequence>
+void *StrandIntervalSearch<T_MatchList, T_PValueFunction, T_WeightFunction, 
+    T_SequenceBoundaryDB, T_ReferenceSequence, T_Sequence>::RunThread(
+    void *searchPtr) {
+    ((StrandIntervalSearch*) searchPtr)->Run();
+    return NULL;
+}
+
+template<typename T_MatchList,
+         typename T_PValueFunction, 
+         typename T_WeightFunction,
+         typename T_SequenceBoundaryDB,
+         typename T_ReferenceSequence,
+         typename T_Sequence>
+int FindMaxIncreasingIntervalOnBothStrands(
+        T_MatchList &forwardPos, 
+        T_MatchList &reversePos,
+        DNALength intervalLength,  
+        VectorIndex nBest, 
+        T_SequenceBoundaryDB & ContigStartPos,
+        T_PValueFunction &MatchPValueFunction,  
+        T_WeightFunction &MatchWeightFunction,  
+        WeightedIntervalSet &intervalQueue, 
+        T_ReferenceSequence &reference, 
+        T_Sequence &forwardQuery,
+        T_Sequence &reverseQuery,
+        IntervalSearchParameters &params,
+        vector<BasicEndpoint<ChainedMatchPos> > *forwardChainEndpointBuffer,
+        vector<BasicEndpoint<ChainedMatchPos> > *reverseChainEndpointBuffer,
+        ClusterList &clusterList,
+        VarianceAccumulator<float> &accumPValue, 
+        VarianceAccumulator<float> &accumWeight,
+        VarianceAccumulator<float> &accumNumAnchorBases) {
+    (void)(accumNumAnchorBases);
+
+    typedef StrandIntervalSearch<T_MatchList, T_PValueFunction, 
+        T_WeightFunction, T_SequenceBoundaryDB, T_ReferenceSequence, 
+        T_Sequence> T_StrandSearch;
+
+    T_StrandSearch forward(MatchPValueFunction, MatchWeightFunction);
+    T_StrandSearch reverse(MatchPValueFunction, MatchWeightFunction);
+    T_StrandSearch *strands[2] = {&forward, &reverse};
+    T_MatchList *strandPos[2] = {&forwardPos, &reversePos};
+    T_Sequence *strandQuery[2] = {&forwardQuery, &reverseQuery};
+    vector<BasicEndpoint<ChainedMatchPos> > *strandBuffer[2] = 
+        {forwardChainEndpointBuffer, reverseChainEndpointBuffer};
+
+    int s;
+    for (s = Forward; s <= Reverse; s++) {
+        strands[s]->readDir             = s;
+        strands[s]->pos                 = strandPos[s];
+        strands[s]->intervalLength      = intervalLength;
+        strands[s]->nBest               = nBest;
+        strands[s]->contigStartPos      = &ContigStartPos;
+        strands[s]->reference           = &reference;
+        strands[s]->query               = strandQuery[s];
+        strands[s]->params              = &params;
+        strands[s]->chainEndpointBuffer = strandBuffer[s];
+    }
+
+    //
+    // Search the reverse strand on a separate thread while the forward
+    // strand is searched on this one.  If a thread cannot be created,
+    // fall back to searching the strands one after the other.
+    //
+    pthread_t reverseThread;
+    bool reverseThreadCreated = (pthread_create(&reverseThread, NULL, 
+        T_StrandSearch::RunThread, &reverse) == 0);
+    forward.Run();
+    if (reverseThreadCreated) {
+        pthread_join(reverseThread, NULL);
+    }
+    else {
+        reverse.Run();
+    }
+
+    //
+    // Merge in the same order as the serial search.
+    //
+    for (s = Forward; s <= Reverse; s++) {
+        if (s == Reverse) {
+            clusterList.ResetCoordinates();
+        }
+        StoreIntervalCandidates(strands[s]->candidates, params, intervalQueue,
+            clusterList, accumPValue, accumWeight);
+        AggressiveIntervalCut(params, intervalQueue, clusterList, 
+            accumPValue, accumWeight);
+    }
+    return max(forward.maxLISSize, reverse.maxLISSize);
+}
+
 #endif
@@ -22,7 +22,8 @@ template<typename T_Fragment, typename T_Endpoint>
 int GlobalChain( T_Fragment *fragments, 
 	DNALength nFragments, 
     std::vector<VectorIndex> &optFragmentChainIndices,
-	std::vector<T_Endpoint> *bufEndpointsPtr = NULL);
+	std::vector<T_Endpoint> *bufEndpointsPtr = NULL,
+    std::vector<PSTVertex<T_Endpoint> > *bufTreePtr = NULL);
 
 template<typename T_Fragment, typename T_Endpoint>
 int GlobalChain(std::vector<T_Fragment> &fragments, 
@@ -32,7 +33,8 @@ template<typename T_Fragment, typename T_Endpoint>
 int GlobalChain(std::vector<T_Fragment> &fragments, 
     DNALength start, DNALength end, 
     std::vector<VectorIndex> &optFragmentChainIndices,
-    std::vector<T_Endpoint> *bufEndpointsPtr = NULL);
+    std::vector<T_Endpoint> *bufEndpointsPtr = NULL,
+    std::vector<PSTVertex<T_Endpoint> > *bufTreePtr = NULL);
 
 #include "GlobalChainImpl.hpp"
 
@@ -10,6 +10,23 @@
 
 using namespace std;
 
+//
+// Orders indices of endpoints as T_Endpoint::LessThan orders the
+// endpoints, and equal endpoints by index.
+//
+template<typename T_Endpoint>
+class EndpointIndexLessThan {
+public:
+	std::vector<T_Endpoint> &endpoints;
+	EndpointIndexLessThan(std::vector<T_Endpoint> &endpointsP) : endpoints(endpointsP) {}
+	int operator()(VectorIndex a, VectorIndex b) const {
+		typename T_Endpoint::LessThan lessThan;
+		if (lessThan(endpoints[a], endpoints[b])) return 1;
+		if (lessThan(endpoints[b], endpoints[a])) return 0;
+		return a < b;
+	}
+};
+
 template<typename T_Fragment,typename T_Endpoint>
 void FragmentSetToEndpoints(T_Fragment* fragments, 
     int nFragments, std::vector<T_Endpoint>& endpoints) {
@@ -102,7 +119,8 @@ template<typename T_Fragment, typename T_Endpoint>
 int GlobalChain(T_Fragment *fragments, 
 	DNALength nFragments, 
     vector<VectorIndex> & optFragmentChainIndices,
-    vector<T_Endpoint> * bufEndpointsPtr) {
+    vector<T_Endpoint> * bufEndpointsPtr,
+    vector<PSTVertex<T_Endpoint> > * bufTreePtr) {
 
 	//
 	// Initialize the fragment score to be the length of each fragment.
@@ -134,22 +152,30 @@ int GlobalChain(T_Fragment *fragments,
         nFragments, *endpointsPtr);
 
 	//
-	// The Starting points of all the fragmements are in order, 
-	// but not necessarily all of the end endpoints, so
-	// the list must be resorted.
+	// The tree finds the best chain ending below a key, so it is built
+	// over the endpoints in order of key.  They are visited in order
+	// of x coordinate, through sweepOrder.
 	//
 	std::sort(endpointsPtr->begin(), endpointsPtr->end(), 
-        typename T_Endpoint::LessThan());
+        typename T_Endpoint::LessThanByKey());
+	vector<VectorIndex> sweepOrder(endpointsPtr->size());
+	VectorIndex p;
+	for (p = 0; p < sweepOrder.size(); p++) {
+		sweepOrder[p] = p;
+	}
+	std::sort(sweepOrder.begin(), sweepOrder.end(), 
+        EndpointIndexLessThan<T_Endpoint>(*endpointsPtr));
 	
 	PrioritySearchTree<T_Endpoint> pst;
 
-	pst.CreateTree(*endpointsPtr);
+	pst.CreateTree(*endpointsPtr, bufTreePtr);
 
-	VectorIndex p;
 	VectorIndex maxScoringEndpoint = 0;
 	bool maxScoringEndpointFound = false;
 	
-	for (p = 0; p < endpointsPtr->size(); p++) {
+	VectorIndex s;
+	for (s = 0; s < sweepOrder.size(); s++) {
+		p = sweepOrder[s];
 		if ((*endpointsPtr)[p].GetSide() == Start) {
 			int maxPointIndex;
 			if (pst.FindIndexOfMaxPoint((*endpointsPtr), (*endpointsPtr)[p].GetKey(), maxPointIndex)) {
@@ -215,9 +241,10 @@ template<typename T_Fragment, typename T_Endpoint>
 int GlobalChain(vector<T_Fragment> &fragments, 
     DNALength start, DNALength end, 
     vector<VectorIndex> &optFragmentChainIndices,
-    vector<T_Endpoint> *bufEndpointsPtr) {
+    vector<T_Endpoint> *bufEndpointsPtr,
+    vector<PSTVertex<T_Endpoint> > *bufTreePtr) {
 	return GlobalChain<T_Fragment, T_Endpoint>(&fragments[start], 
-        end - start, optFragmentChainIndices, bufEndpointsPtr);
+        end - start, optFragmentChainIndices, bufEndpointsPtr, bufTreePtr);
 }
 
 #endif
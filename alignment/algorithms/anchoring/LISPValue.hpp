@@ -10,6 +10,15 @@ template<typename T_MatchPos>
 void StoreNonOverlappingIndices(std::vector<T_MatchPos> &lis, 
     std::vector<T_MatchPos> &noOvpLis);
 
+//
+// As above, with scratch space for sorting that the caller keeps
+// between calls.
+//
+template<typename T_MatchPos>
+void StoreNonOverlappingIndices(std::vector<T_MatchPos> &lis, 
+    std::vector<T_MatchPos> &noOvpLis,
+    std::vector<KeyedIndex> &sortKeys, std::vector<KeyedIndex> &sortBuffer);
+
 template<typename T_TextSequence, 
          typename T_Sequence,
          typename T_MatchPos, 
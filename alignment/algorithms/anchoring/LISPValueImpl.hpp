@@ -4,6 +4,14 @@
 template<typename T_MatchPos>
 void StoreNonOverlappingIndices(std::vector<T_MatchPos> &lis, 
     std::vector<T_MatchPos> &noOvpLis) {
+	std::vector<KeyedIndex> sortKeys, sortBuffer;
+	StoreNonOverlappingIndices(lis, noOvpLis, sortKeys, sortBuffer);
+}
+
+template<typename T_MatchPos>
+void StoreNonOverlappingIndices(std::vector<T_MatchPos> &lis, 
+    std::vector<T_MatchPos> &noOvpLis,
+    std::vector<KeyedIndex> &sortKeys, std::vector<KeyedIndex> &sortBuffer) {
 	unsigned int i;
 
 	//
@@ -59,15 +67,14 @@ void StoreNonOverlappingIndices(std::vector<T_MatchPos> &lis,
 	// Now, the matches are found in order of size, but they need to
 	// be stored in order of text.
 	//
-	SortMatchPosList(noOvpLis);
+	SortMatchPosList(noOvpLis, sortKeys, sortBuffer);
 
 	//
 	// The match pos list was sorted in order of weight. 
-	// Just in case it causes problems down the line, re-sort it 
-	// according to query pos.
+	// Just in case it causes problems down the line, replace it
+	// with the non-overlapping matches, which are now in order.
 	//
 	lis = noOvpLis;
-	SortMatchPosList(lis);
 }
 
 
@@ -4,6 +4,10 @@
 #include "LISPValue.hpp"
 #include "../../tuples/TupleMetrics.hpp"
 
+//
+// The weightors below keep the non-overlapping list and sort scratch
+// between calls, so each thread needs its own copy.
+//
 template<typename T_RefSequence, typename T_MatchList>
 class LISSumOfLogPWeightor {
 public:
@@ -12,6 +16,9 @@ public:
     float ComputePValue(T_MatchList &matchList, 
         int &noOvpLisNBases, int &noOvpLisSize);
     float operator()(T_MatchList &matchList);
+private:
+    T_MatchList noOvpLis;
+    std::vector<KeyedIndex> sortKeys, sortBuffer;
 };
 
 
@@ -23,6 +30,9 @@ public:
     float ComputePValue(T_MatchList &lis, 
         int &noOvpLisNBases, int &noOvpLisSize);
     float operator() (T_MatchList &lis);
+private:
+    T_MatchList noOvpLis;
+    std::vector<KeyedIndex> sortKeys, sortBuffer;
 };	
 
 
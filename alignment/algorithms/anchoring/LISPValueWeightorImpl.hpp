@@ -15,8 +15,8 @@ float LISSumOfLogPWeightor<T_RefSequence, T_MatchList>::ComputePValue(
     T_MatchList &matchList, int &noOvpLisNBases, int &noOvpLisSize) {
     float pMatch = 0;
     size_t i;
-    T_MatchList noOvpLis;
-    StoreNonOverlappingIndices(matchList, noOvpLis);
+    noOvpLis.clear();
+    StoreNonOverlappingIndices(matchList, noOvpLis, sortKeys, sortBuffer);
     noOvpLisSize = noOvpLis.size();
     noOvpLisNBases = 0;
     for (i = 0; i < noOvpLis.size(); i++) {
@@ -53,8 +53,8 @@ LISSMatchFrequencyPValueWeightor<T_RefSequence, T_Tuple, T_MatchList>::LISSMatch
 template<typename T_RefSequence, typename T_Tuple, typename T_MatchList>
 float LISSMatchFrequencyPValueWeightor<T_RefSequence, T_Tuple, T_MatchList>::ComputePValue(
     T_MatchList &lis, int &noOvpLisNBases, int &noOvpLisSize) {
-    T_MatchList noOvpLis;
-    StoreNonOverlappingIndices(lis, noOvpLis);
+    noOvpLis.clear();
+    StoreNonOverlappingIndices(lis, noOvpLis, sortKeys, sortBuffer);
     noOvpLisSize = noOvpLis.size();
     size_t i;
     noOvpLisNBases = 0;
@@ -0,0 +1,42 @@
+#ifndef _BLASR_MAP_BY_HOMOPOLYMER_COMPRESSION_HPP_
+#define _BLASR_MAP_BY_HOMOPOLYMER_COMPRESSION_HPP_
+
+#include <vector>
+#include "../../../pbdata/SMRTSequence.hpp"
+#include "../../../pbdata/HomopolymerCompressedSequence.hpp"
+#include "../../datastructures/anchoring/AnchorParameters.hpp"
+#include "MapBySuffixArray.hpp"
+
+/*
+ * Anchor a read against a homopolymer compressed reference.
+ *
+ * reference - the compressed reference, which sa was built on.
+ * sa        - a SuffixArray or CompressedSuffixArray of reference.
+ * read      - the read, which is compressed here, from SubreadStart()
+ *             to SubreadEnd().
+ * Out:
+ *   matchPosList - the anchors found by MapReadToGenome on the
+ *              compressed read, appended with the positions of their
+ *              first runs in the original reference and read.  Since
+ *              the runs of a match may have different lengths in the
+ *              two, an anchor is given the shorter of its two
+ *              uncompressed lengths.
+ *
+ * Homopolymer indels do not end a match in compressed space, so the
+ * anchors of a read with many of them are longer and fewer.  Lengths
+ * in anchorParameters, such as minMatchLength, are in compressed
+ * bases.  compressedRead may be given to reuse its storage between
+ * reads.
+ */
+template<typename T_SuffixArray,
+         typename T_Sequence,
+         typename T_MatchPos>
+int MapCompressedReadToGenome(HomopolymerCompressedSequence &reference,
+    T_SuffixArray &sa, T_Sequence &read,
+    unsigned int minPrefixMatchLength,
+    std::vector<T_MatchPos> &matchPosList,
+    AnchorParameters &anchorParameters,
+    HomopolymerCompressedSequence *compressedRead=NULL);
+
+#include "MapByHomopolymerCompressionImpl.hpp"
+#endif
@@ -0,0 +1,52 @@
+#ifndef _BLASR_MAP_BY_HOMOPOLYMER_COMPRESSION_IMPL_HPP_
+#define _BLASR_MAP_BY_HOMOPOLYMER_COMPRESSION_IMPL_HPP_
+#include <algorithm>
+#include "MapByHomopolymerCompression.hpp"
+
+template<typename T_SuffixArray,
+         typename T_Sequence,
+         typename T_MatchPos>
+int MapCompressedReadToGenome(HomopolymerCompressedSequence &reference,
+    T_SuffixArray &sa, T_Sequence &read,
+    unsigned int minPrefixMatchLength,
+    std::vector<T_MatchPos> &matchPosList,
+    AnchorParameters &anchorParameters,
+    HomopolymerCompressedSequence *compressedRead) {
+
+    HomopolymerCompressedSequence localCompressedRead;
+    if (compressedRead == NULL) {
+        compressedRead = &localCompressedRead;
+    }
+    if (read.SubreadLength() == 0) {
+        return matchPosList.size();
+    }
+
+    //
+    // Every position of a read is kept in its reverse index, since a
+    // read is short and each anchor looks up two of them.
+    //
+    compressedRead->Compress(read, read.SubreadStart(), read.SubreadLength(), 1);
+    SMRTSequence hpcRead;
+    hpcRead.DNASequence::ReferenceSubstring(*compressedRead);
+    hpcRead.SubreadStart(0).SubreadEnd(compressedRead->length);
+
+    std::vector<T_MatchPos> hpcMatches;
+    MapReadToGenome(reference, sa, hpcRead, minPrefixMatchLength,
+        hpcMatches, anchorParameters);
+
+    VectorIndex m;
+    for (m = 0; m < hpcMatches.size(); m++) {
+        T_MatchPos match = hpcMatches[m];
+        DNALength refStart  = reference.LookupSequencePos(match.t);
+        DNALength refEnd    = reference.LookupSequencePos(match.t + match.l);
+        DNALength readStart = compressedRead->LookupSequencePos(match.q);
+        DNALength readEnd   = compressedRead->LookupSequencePos(match.q + match.l);
+        match.t = refStart;
+        match.q = readStart;
+        match.l = std::min(refEnd - refStart, readEnd - readStart);
+        matchPosList.push_back(match);
+    }
+    return matchPosList.size();
+}
+
+#endif
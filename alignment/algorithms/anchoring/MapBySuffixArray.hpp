@@ -2,9 +2,11 @@
 #define _BLASR_MAP_BY_SUFFIX_ARRAY_HPP_
 
 #include <algorithm>
+#include <vector>
 #include "../../suffixarray/SuffixArray.hpp"
 #include "../../datastructures/anchoring/MatchPos.hpp"
 #include "../../datastructures/anchoring/AnchorParameters.hpp"
+#include "../../algorithms/alignment/AlignmentUtils.hpp"
 #include "../../algorithms/alignment/SWAlign.hpp"
 #include "../../algorithms/alignment/ScoreMatrices.hpp"
 
@@ -37,7 +39,7 @@ template<typename T_SuffixArray,
 int MapReadToGenome(T_RefSequence &reference,
 	T_SuffixArray &sa, T_Sequence &read, 
 	unsigned int minPrefixMatchLength,
-	vector<T_MatchPos> &matchPosList,
+	std::vector<T_MatchPos> &matchPosList,
 	AnchorParameters &anchorParameters);
 
 #include "MapBySuffixArrayImpl.hpp"
@@ -46,7 +46,7 @@ int LocateAnchorBoundsInSuffixArray(T_RefSequence &reference,
     std::fill(matchLength.begin(), matchLength.end(), 0);
     std::fill(matchLow.begin(), matchLow.end(), 0);
     std::fill(matchHigh.begin(), matchHigh.end(), 0);
-    vector<SAIndex> lowMatchBound, highMatchBound;	
+    std::vector<SAIndex> lowMatchBound, highMatchBound;	
 
     for (m = 0, p = read.SubreadStart(); p < matchEnd; p++, m++) {
         lowMatchBound.clear(); highMatchBound.clear();
@@ -72,7 +72,7 @@ int LocateAnchorBoundsInSuffixArray(T_RefSequence &reference,
                     *params.lcpBoundsOutPtr << " ";
                 }  
             }
-            *params.lcpBoundsOutPtr << endl;
+            *params.lcpBoundsOutPtr << std::endl;
         }
 
         //
@@ -210,10 +210,10 @@ template<typename T_SuffixArray,
 int MapReadToGenome(T_RefSequence &reference,
     T_SuffixArray &sa, T_Sequence &read, 
     unsigned int minPrefixMatchLength,
-    vector<T_MatchPos> &matchPosList,
+    std::vector<T_MatchPos> &matchPosList,
     AnchorParameters &anchorParameters) {
 
-    vector<DNALength> matchLow, matchHigh, matchLength;
+    std::vector<DNALength> matchLow, matchHigh, matchLength;
 
     DNALength minMatchLen = anchorParameters.minMatchLength;
     if (read.SubreadLength() < minMatchLen) {
@@ -232,8 +232,8 @@ int MapReadToGenome(T_RefSequence &reference,
     assert(matchLow.size() == matchHigh.size());
 
     DNASequence evalQrySeq, evalRefSeq;
-    vector<Arrow> pathMat;
-    vector<int> scoreMat;
+    std::vector<Arrow> pathMat;
+    std::vector<int> scoreMat;
     Alignment alignment;
 
     //
@@ -241,7 +241,7 @@ int MapReadToGenome(T_RefSequence &reference,
     // if there are any.
     //
     if (anchorParameters.removeEncompassedMatches) {
-        vector<bool> removed;
+        std::vector<bool> removed;
         removed.resize(read.length);
         std::fill(removed.begin(), removed.end(), false);
         size_t i;
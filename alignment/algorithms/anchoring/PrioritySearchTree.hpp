@@ -20,17 +20,23 @@
  * This class implements a query FindMax(key), which returns
  * the index of the point with greatest value of all points with key [0...key).
  *
- * 
+ * The tree is stored implicitly in preorder.  The vertex over points
+ * [start, end) splits them at median = (start+end)/2; its left child is
+ * the next vertex, and its right child follows the 2*(median-start)-1
+ * vertices of the left subtree.  A vertex is a leaf when it covers one
+ * point.  Child indices and leaf flags are computed while descending,
+ * so each vertex only stores its median key and best point.
+ *
+ * The best point of a vertex is the highest scoring active point
+ * beneath it that is not already held by a vertex above.  Activating
+ * a point walks down the path to its leaf, so the points must not be
+ * activated twice, and their scores must not change once active.
+ *
  */
 template<typename T_Point>
 class PSTVertex {
 public: 
-    unsigned int leftChildIndex;
-    unsigned int rightChildIndex;
-    unsigned int isALeaf;
     KeyType medianKey;
-    KeyType maxKey;
-    unsigned int pointIndex;
     int maxScoreNode;
     PSTVertex();
 };
@@ -40,23 +46,27 @@ class PrioritySearchTree {
 private:
     std::vector<PSTVertex<T_Point> > tree;
     std::vector<PSTVertex<T_Point> > * treePtr;
-	int GetMedianIndex(int start, int end);
+    unsigned int nPoints;
 
-	inline KeyType CreateTree(std::vector<T_Point> &points, 
-        int start, int end, unsigned int &iterativeIndex);
+	int GetMedianIndex(int start, int end);
 
-	int FindIndexOfMaxPoint(int curVertexIndex, std::vector<T_Point> &points, 
+	int FindIndexOfMaxPoint(int curVertexIndex, int start, int end,
+        std::vector<T_Point> &points,
         KeyType maxKey, int &maxPointValue, 
         int &maxPointIndex);
 
-public:
+public: 
     PrioritySearchTree();
 
+    //
+    // Build the tree over points, which must be sorted.  When bufTreePtr
+    // is given, the vertices are stored there, so that a caller that
+    // builds many trees may reuse the space.
+    //
 	void CreateTree(std::vector<T_Point> &points, 
         std::vector<PSTVertex<T_Point> > *bufTreePtr=NULL);
 
-	int FindPoint(KeyType pointKey, 
-        int curVertexIndex, int &pointVertexIndex);
+	int FindPoint(KeyType pointKey, int &pointVertexIndex);
 
 	void Activate(std::vector<T_Point> &points, int pointIndex);
 
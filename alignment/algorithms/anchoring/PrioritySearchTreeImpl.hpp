@@ -17,22 +17,20 @@
  * This class implements a query FindMax(key), which returns
  * the index of the point with greatest value of all points with key [0...key).
  *
- * 
+ *
  */
 template<typename T_Point>
 PSTVertex<T_Point>::PSTVertex() {
-    isALeaf         = 0;
-    leftChildIndex  = 0;
-    rightChildIndex = 0;
     maxScoreNode = -1;
-    maxKey = 0;
     medianKey = 0;
-    pointIndex = 0;
 }
 
 
 template<typename T_Point>
-PrioritySearchTree<T_Point>::PrioritySearchTree() {treePtr = NULL;}
+PrioritySearchTree<T_Point>::PrioritySearchTree() {
+    treePtr = NULL;
+    nPoints = 0;
+}
 
 template<typename T_Point>
 int PrioritySearchTree<T_Point>::
@@ -40,72 +38,10 @@ GetMedianIndex(int start, int end) {
     return (end + start) / 2;
 }
 
-template<typename T_Point>
-inline 
-KeyType PrioritySearchTree<T_Point>::
-CreateTree(std::vector<T_Point> &points, 
-    int start, int end, unsigned int &iterativeIndex) {
-    assert(iterativeIndex < (*treePtr).size());
-
-    //
-    // Look to see if this vertex is the parent of a leaf 
-    // -- when there are only two points below.
-    //
-    int medianIndex    = GetMedianIndex(start, end);
-    int curVertexIndex = iterativeIndex;
-    (*treePtr)[curVertexIndex].medianKey = points[medianIndex].GetKey();
-
-    if (end == start) {
-        // No children for this node, done.
-        (*treePtr)[curVertexIndex].pointIndex = start;
-        return (*treePtr)[curVertexIndex].medianKey;
-    }
-
-    // 
-    // Check to see if the current
-    // node is a leaf node.  No recursion on this node.
-    //
-    if (end - start == 1) {
-        (*treePtr)[curVertexIndex].isALeaf    = 1;
-        (*treePtr)[curVertexIndex].medianKey  = points[start].GetKey();
-        (*treePtr)[curVertexIndex].pointIndex = start;
-        //
-        // Return the key of this vertex.  The parent
-        // will know what to do with it.  If this is
-        // a left child, the parent will use the key to
-        // distinguish what is on the left side of the branches.
-        // If it is the right side of a (*treePtr), it is ignored.
-        //
-        return (*treePtr)[curVertexIndex].medianKey;
-    }
-    else {
-        //
-        // This vertex contains at least two children, so it is not 
-        // a leaf.  Recurse assigning leaves.
-        //
-        (*treePtr)[curVertexIndex].isALeaf = 0;
-        (*treePtr)[curVertexIndex].leftChildIndex = ++iterativeIndex;
-        KeyType leftTreeKey, rightTreeKey;
-        leftTreeKey  = CreateTree(points, start, medianIndex, iterativeIndex);
-
-        //
-        // The leftTreeKey separates the branches BELOW this vertex.
-        //
-        (*treePtr)[curVertexIndex].medianKey = leftTreeKey;
-
-        (*treePtr)[curVertexIndex].rightChildIndex = ++iterativeIndex;
-        rightTreeKey = CreateTree(points, medianIndex, end, iterativeIndex);
-        //
-        // The rightTreeKey will separate the parent's left tree from the right.
-        //
-        (*treePtr)[curVertexIndex].maxKey = rightTreeKey;
-        return rightTreeKey;
-    }
-}
-	
 template<typename T_Point>
 int PrioritySearchTree<T_Point>::
-FindIndexOfMaxPoint(int curVertexIndex, std::vector<T_Point> &points, 
+FindIndexOfMaxPoint(int curVertexIndex, int start, int end,
+    std::vector<T_Point> &points,
     KeyType maxKey, int &maxPointValue, 
     int &maxPointIndex) {
     //
@@ -118,7 +54,7 @@ FindIndexOfMaxPoint(int curVertexIndex, std::vector<T_Point> &points,
     //      maxPointValue is the score of the maximum point.
     //      maxPointIndex the index of the point in 'points' that has
     //      the maximum score.
-    //   
+    //
 
     //
     // The vertex at curVertexIndex has a max score node beneath it, 
@@ -128,14 +64,15 @@ FindIndexOfMaxPoint(int curVertexIndex, std::vector<T_Point> &points,
     // range in the rage maximum query.
     // That means that there is no need to continue the search below here.
     //
-    if ((*treePtr)[curVertexIndex].maxScoreNode == -1) {
+    int maxScoreNode = (*treePtr)[curVertexIndex].maxScoreNode;
+    if (maxScoreNode == -1) {
         return 0;
     }
-    T_Point thisPoint = points[(*treePtr)[curVertexIndex].maxScoreNode];
+    T_Point &thisPoint = points[maxScoreNode];
     if (thisPoint.GetKey() < maxKey) {
         if (thisPoint.GetScore() >= maxPointValue) {
             maxPointValue = thisPoint.GetScore();
-            maxPointIndex = (*treePtr)[curVertexIndex].maxScoreNode;
+            maxPointIndex = maxScoreNode;
             return 1;
         }
         else {
@@ -157,20 +94,22 @@ FindIndexOfMaxPoint(int curVertexIndex, std::vector<T_Point> &points,
     // a maximum key.  Search both to the left and right.
     //
     else {
-        if (!(*treePtr)[curVertexIndex].isALeaf) {
+        if (end - start > 1) {
+            int medianIndex = GetMedianIndex(start, end);
+            int leftChildIndex  = curVertexIndex + 1;
+            int rightChildIndex = curVertexIndex + 2 * (medianIndex - start);
             if (maxKey <= (*treePtr)[curVertexIndex].medianKey) {
-                return FindIndexOfMaxPoint(
-                        (*treePtr)[curVertexIndex].leftChildIndex,
+                return FindIndexOfMaxPoint(leftChildIndex, start, medianIndex,
                         points, maxKey, maxPointValue, maxPointIndex);
             }
             else {
                 int foundValueLeft, foundValueRight;
-                foundValueLeft = FindIndexOfMaxPoint(
-                        (*treePtr)[curVertexIndex].leftChildIndex, 
+                foundValueLeft = FindIndexOfMaxPoint(leftChildIndex,
+                        start, medianIndex,
                         points, maxKey, maxPointValue, maxPointIndex);
 
-                foundValueRight = FindIndexOfMaxPoint(
-                        (*treePtr)[curVertexIndex].rightChildIndex, 
+                foundValueRight = FindIndexOfMaxPoint(rightChildIndex,
+                        medianIndex, end,
                         points, maxKey, maxPointValue, maxPointIndex);
                 return (foundValueLeft or foundValueRight);
             }
@@ -187,7 +126,7 @@ FindIndexOfMaxPoint(int curVertexIndex, std::vector<T_Point> &points,
         }
     }
 }
-	
+
 
 template<typename T_Point>
 void PrioritySearchTree<T_Point>::
@@ -196,7 +135,7 @@ CreateTree(std::vector<T_Point> &points,
     //
     // Precondition: points is sorted according to key.
     //
-    // 
+    //
     // The tree is a binary tree containing all the points.  The 
     // perfectly balanced tree is of maximum size points.size()-1,
     // so go ahead and preallocate that now.
@@ -207,70 +146,112 @@ CreateTree(std::vector<T_Point> &points,
     else {
         treePtr = &tree;
     }
-    treePtr->resize((points.size() * 2) - 1);
-    unsigned int curVertexIndex = 0;
-    CreateTree(points, 0, points.size(), curVertexIndex);
+    nPoints = points.size();
+    if (nPoints == 0) {
+        treePtr->clear();
+        return;
+    }
+    treePtr->resize((nPoints * 2) - 1);
+
+    //
+    // Fill in the vertices in preorder, which is the order they are
+    // stored in.  The right child of a vertex is pushed before the
+    // left, so the stack never holds more than one pending subtree
+    // per level, and the tree depth is at most 33.
+    //
+    int stackVertex[64], stackStart[64], stackEnd[64];
+    int stackSize = 0;
+    stackVertex[0] = 0; stackStart[0] = 0; stackEnd[0] = nPoints;
+    stackSize = 1;
+    while (stackSize > 0) {
+        --stackSize;
+        int curVertexIndex = stackVertex[stackSize];
+        int start = stackStart[stackSize];
+        int end   = stackEnd[stackSize];
+        PSTVertex<T_Point> &vertex = (*treePtr)[curVertexIndex];
+        vertex.maxScoreNode = -1;
+        if (end - start == 1) {
+            vertex.medianKey = points[start].GetKey();
+        }
+        else {
+            // 
+            // The key of the last point on the left side separates the
+            // branches below this vertex.
+            // 
+            int medianIndex = GetMedianIndex(start, end);
+            vertex.medianKey = points[medianIndex-1].GetKey();
+            assert(stackSize + 2 <= 64);
+            stackVertex[stackSize] = curVertexIndex + 2 * (medianIndex - start);
+            stackStart[stackSize]  = medianIndex;
+            stackEnd[stackSize]    = end;
+            ++stackSize;
+            stackVertex[stackSize] = curVertexIndex + 1;
+            stackStart[stackSize]  = start;
+            stackEnd[stackSize]    = medianIndex;
+            ++stackSize;
+        }
+    }
 }
 
 
-//
-// Implement the tree as an array of interior nodes.
-// Since there is already space allocated for the 
-//
 template<typename T_Point>
 int PrioritySearchTree<T_Point>::
-FindPoint(KeyType pointKey, 
-    int curVertexIndex, int &pointVertexIndex) {
-
-    if ((*treePtr)[curVertexIndex].isALeaf) {
-        pointVertexIndex = curVertexIndex;
-        return (*treePtr)[curVertexIndex].medianKey == pointKey;
-    }
-    else {
+FindPoint(KeyType pointKey, int &pointVertexIndex) {
+    int curVertexIndex = 0;
+    int start = 0, end = nPoints;
+    while (end - start > 1) {
+        int medianIndex = GetMedianIndex(start, end);
         if (pointKey <= (*treePtr)[curVertexIndex].medianKey) {
-            return FindPoint(pointKey, 
-                    (*treePtr)[curVertexIndex].leftChildIndex, 
-                    pointVertexIndex);
+            curVertexIndex = curVertexIndex + 1;
+            end = medianIndex;
         }
         else {
-            return FindPoint(pointKey, 
-                    (*treePtr)[curVertexIndex].rightChildIndex, 
-                    pointVertexIndex);
+            curVertexIndex = curVertexIndex + 2 * (medianIndex - start);
+            start = medianIndex;
         }
     }
+    pointVertexIndex = curVertexIndex;
+    return (*treePtr)[curVertexIndex].medianKey == pointKey;
 }
 
 
 template<typename T_Point>
 void PrioritySearchTree<T_Point>::
 Activate(std::vector<T_Point> &points, int pointIndex) {
-
-    int pointScore = points[pointIndex].GetScore();
-    // Now, update the pMax scores in the (*treePtr).
-
+    //
+    // Each vertex holds the best active point beneath it that is not
+    // held higher up.  Walk down from the root, and where the point
+    // scores higher than the one held, take its place and carry the
+    // displaced point further down.  A point is routed by its index,
+    // and the vertices holding it are always on the path to its own
+    // leaf, so it is stored at the latest there.
+    //
     int curVertexIndex = 0;
-    KeyType pointKey = points[pointIndex].GetKey();
-    unsigned int itIndex = 0;
-    while (pointIndex != -1 and
-           (*treePtr)[curVertexIndex].isALeaf == 0) {
-        assert(itIndex < (*treePtr).size());
-        int nodeIndex = (*treePtr)[curVertexIndex].maxScoreNode;
-        if (nodeIndex == -1 or 
-            points[nodeIndex].GetScore() < pointScore) {
-            (*treePtr)[curVertexIndex].maxScoreNode = pointIndex;
+    int start = 0, end = nPoints;
+    while (true) {
+        PSTVertex<T_Point> &vertex = (*treePtr)[curVertexIndex];
+        int nodeIndex = vertex.maxScoreNode;
+        if (nodeIndex == -1) {
+            vertex.maxScoreNode = pointIndex;
+            return;
+        }
+        if (points[nodeIndex].GetScore() < points[pointIndex].GetScore()) {
+            vertex.maxScoreNode = pointIndex;
             pointIndex = nodeIndex; 
         }
-
-        if (pointKey <= (*treePtr)[curVertexIndex].medianKey) {
-            curVertexIndex = (*treePtr)[curVertexIndex].leftChildIndex;
+        //
+        // Only an already active point reaches a full leaf.
+        //
+        assert(end - start > 1);
+        int medianIndex = GetMedianIndex(start, end);
+        if (pointIndex < medianIndex) {
+            curVertexIndex = curVertexIndex + 1;
+            end = medianIndex;
         }
         else {
-            curVertexIndex = (*treePtr)[curVertexIndex].rightChildIndex;
+            curVertexIndex = curVertexIndex + 2 * (medianIndex - start);
+            start = medianIndex;
         }
-
-        // Keep track of the number of times this loop is executed... an 
-        // infinite loop will bomb.
-        ++itIndex;
     }
 }
 
@@ -280,8 +261,7 @@ FindIndexOfMaxPoint(std::vector<T_Point> &points,
     KeyType maxPointKey, int &maxPointIndex) {
 
     // start at the root
-    int curVertexIndex = 0;
-    if ((*treePtr)[curVertexIndex].maxScoreNode == -1) {
+    if (nPoints == 0 or (*treePtr)[0].maxScoreNode == -1) {
         //
         // This case can only be hit if none of the points have been
         // activated. 
@@ -289,7 +269,7 @@ FindIndexOfMaxPoint(std::vector<T_Point> &points,
         return 0;
     }
     int maxPointValue = 0;
-    return FindIndexOfMaxPoint(0, points, maxPointKey, 
+    return FindIndexOfMaxPoint(0, 0, nPoints, points, maxPointKey,
             maxPointValue, maxPointIndex);
 }
 
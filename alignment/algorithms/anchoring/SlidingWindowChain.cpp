@@ -0,0 +1,81 @@
+#include "SlidingWindowChain.hpp"
+
+MaxScoreTree::MaxScoreTree() {
+    nLeaves = 0;
+}
+
+void MaxScoreTree::Initialize(int nSlots) {
+    nLeaves = 1;
+    while (nLeaves < nSlots) {
+        nLeaves *= 2;
+    }
+    score.assign(2 * nLeaves, -1);
+    item.assign(2 * nLeaves, -1);
+}
+
+void MaxScoreTree::Update(int vertex) {
+    int left  = 2 * vertex;
+    int right = left + 1;
+    if (score[right] > score[left]) {
+        score[vertex] = score[right];
+        item[vertex]  = item[right];
+    }
+    else {
+        score[vertex] = score[left];
+        item[vertex]  = item[left];
+    }
+}
+
+void MaxScoreTree::Set(int slot, int slotScore, int slotItem) {
+    int vertex = slot + nLeaves;
+    score[vertex] = slotScore;
+    item[vertex]  = slotItem;
+    for (vertex /= 2; vertex > 0; vertex /= 2) {
+        Update(vertex);
+    }
+}
+
+void MaxScoreTree::Clear(int slot) {
+    Set(slot, -1, -1);
+}
+
+bool MaxScoreTree::FindMax(int start, int end, int &maxItem) const {
+    //
+    // Walk up from both ends of the range.  Vertices on the left side
+    // are visited in increasing order of slot and those on the right
+    // in decreasing order, so ties keep the lower slot.
+    //
+    int maxScore = -1;
+    int maxSlotItem = -1;
+    int rightScore = -1;
+    int rightItem = -1;
+    int left  = start + nLeaves;
+    int right = end + nLeaves;
+    while (left < right) {
+        if (left & 1) {
+            if (score[left] > maxScore) {
+                maxScore = score[left];
+                maxSlotItem = item[left];
+            }
+            left++;
+        }
+        if (right & 1) {
+            right--;
+            if (score[right] >= rightScore and score[right] >= 0) {
+                rightScore = score[right];
+                rightItem = item[right];
+            }
+        }
+        left /= 2;
+        right /= 2;
+    }
+    if (rightScore > maxScore) {
+        maxScore = rightScore;
+        maxSlotItem = rightItem;
+    }
+    if (maxScore < 0) {
+        return false;
+    }
+    maxItem = maxSlotItem;
+    return true;
+}
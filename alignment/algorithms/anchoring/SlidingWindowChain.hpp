@@ -0,0 +1,106 @@
+#ifndef _BLASR_SLIDING_WINDOW_CHAIN_HPP_
+#define _BLASR_SLIDING_WINDOW_CHAIN_HPP_
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+// pbdata
+#include "../../../pbdata/Types.h"
+#include "../../../pbdata/DNASequence.hpp"
+
+//
+// A binary tree over a fixed number of slots that stores the maximum
+// score beneath each vertex, for range maximum queries on slots that
+// are set and cleared over time.  Ties are resolved to the slot with
+// the lowest index.
+//
+class MaxScoreTree {
+private:
+    int nLeaves;
+    std::vector<int> score;
+    std::vector<int> item;
+    void Update(int vertex);
+
+public:
+    MaxScoreTree();
+
+    void Initialize(int nSlots);
+
+    void Set(int slot, int slotScore, int slotItem);
+
+    void Clear(int slot);
+
+    //
+    // Find the item with the maximum score in slots [start, end).
+    // Returns false if none of those slots are set.
+    //
+    bool FindMax(int start, int end, int &maxItem) const;
+};
+
+//
+// Computes the maximum weight chain of anchors inside a window
+// pos[start...end) of an anchor list sorted by target position, where
+// the window slides from left to right across the list as it does in
+// ExhaustiveFindMaxIncreasingInterval.  
+//
+// Anchors are weighted by their length, and an anchor g may precede f
+// in a chain when g ends before f starts in the target and no later
+// than f starts in the query; this is the same rule GlobalChain uses.  
+// Rather than chaining every window from scratch, the chain score of
+// each anchor is kept as the window slides.  An anchor entering on the
+// right is scored in logarithmic time against the anchors already in
+// the window.  An anchor leaving on the left only invalidates the
+// scores of anchors whose chain starts with it, and the window is
+// rescored only when one of those scores would be used.
+//
+// When several chains have the maximum weight, the one ending at the
+// lowest index is returned, so this may select a different chain than
+// GlobalChain does on ties.
+//
+template<typename T_MatchList>
+class SlidingWindowChain {
+private:
+    T_MatchList *pos;
+    // Query end positions of all anchors in sorted order, and the slot
+    // of each anchor in that order.
+    std::vector<DNALength> sortedQEnd;
+    std::vector<int> qEndSlot;
+    std::vector<int> score;
+    std::vector<int> prev;
+    // The first anchor in the chain ending at each anchor.
+    std::vector<int> root;
+    // Anchors that may be chained to, by query end.
+    MaxScoreTree chainEnds;
+    // Chain scores of all anchors in the window, by index.
+    MaxScoreTree windowScores;
+    // Anchors that have been scored, but do not end before the target
+    // position of the last anchor added, ordered by target end.
+    typedef std::pair<DNALength, VectorIndex> PendingAnchor;
+    std::priority_queue<PendingAnchor, std::vector<PendingAnchor>, 
+        std::greater<PendingAnchor> > pending;
+    VectorIndex windowStart, windowEnd;
+
+    void Reset(VectorIndex start);
+    bool IsStale(int index);
+    bool Append(VectorIndex index);
+    void Remove(VectorIndex index);
+
+public:
+    SlidingWindowChain();
+
+    void Initialize(T_MatchList &pos);
+
+    //
+    // Store in chainIndices the indices, relative to start, of the
+    // maximum weight chain in pos[start...end), and return its size.
+    // The window is updated incrementally when start and end do not
+    // decrease from the previous call.
+    //
+    int Chain(VectorIndex start, VectorIndex end, 
+        std::vector<VectorIndex> &chainIndices);
+};
+
+#include "SlidingWindowChainImpl.hpp"
+
+#endif
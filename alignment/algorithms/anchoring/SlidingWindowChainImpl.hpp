@@ -0,0 +1,160 @@
+#ifndef _BLASR_SLIDING_WINDOW_CHAIN_IMPL_HPP_
+#define _BLASR_SLIDING_WINDOW_CHAIN_IMPL_HPP_
+
+#include <algorithm>
+#include <assert.h>
+
+template<typename T_MatchList>
+SlidingWindowChain<T_MatchList>::SlidingWindowChain() {
+    pos = NULL;
+    windowStart = windowEnd = 0;
+}
+
+template<typename T_MatchList>
+void SlidingWindowChain<T_MatchList>::Initialize(T_MatchList &_pos) {
+    pos = &_pos;
+    VectorIndex nPos = pos->size();
+
+    //
+    // Order the anchors by where they end in the query so that all
+    // anchors that may precede an anchor in a chain occupy a prefix of
+    // the slots in chainEnds.
+    //
+    std::vector<std::pair<DNALength, int> > qEnds(nPos);
+    VectorIndex i;
+    for (i = 0; i < nPos; i++) {
+        qEnds[i].first  = (*pos)[i].q + (*pos)[i].l;
+        qEnds[i].second = i;
+    }
+    std::sort(qEnds.begin(), qEnds.end());
+    sortedQEnd.resize(nPos);
+    qEndSlot.resize(nPos);
+    for (i = 0; i < nPos; i++) {
+        sortedQEnd[i] = qEnds[i].first;
+        qEndSlot[qEnds[i].second] = i;
+    }
+
+    score.resize(nPos);
+    prev.resize(nPos);
+    root.resize(nPos);
+    chainEnds.Initialize(nPos);
+    windowScores.Initialize(nPos);
+    pending = std::priority_queue<PendingAnchor, std::vector<PendingAnchor>, 
+        std::greater<PendingAnchor> >();
+    windowStart = windowEnd = 0;
+}
+
+template<typename T_MatchList>
+void SlidingWindowChain<T_MatchList>::Reset(VectorIndex start) {
+    VectorIndex i;
+    for (i = windowStart; i < windowEnd; i++) {
+        chainEnds.Clear(qEndSlot[i]);
+        windowScores.Clear(i);
+    }
+    pending = std::priority_queue<PendingAnchor, std::vector<PendingAnchor>, 
+        std::greater<PendingAnchor> >();
+    windowStart = windowEnd = start;
+}
+
+template<typename T_MatchList>
+bool SlidingWindowChain<T_MatchList>::IsStale(int index) {
+    return (VectorIndex) root[index] < windowStart;
+}
+
+template<typename T_MatchList>
+bool SlidingWindowChain<T_MatchList>::Append(VectorIndex index) {
+    assert(index == windowEnd);
+    DNALength t = (*pos)[index].t;
+    DNALength q = (*pos)[index].q;
+    DNALength l = (*pos)[index].l;
+
+    //
+    // Anchors that end before this one starts in the target may now
+    // be chained to.  Since anchors are added in order of target
+    // start, they stay that way.
+    //
+    while (pending.empty() == false and pending.top().first < t) {
+        VectorIndex ended = pending.top().second;
+        pending.pop();
+        if (ended >= windowStart) {
+            chainEnds.Set(qEndSlot[ended], score[ended], ended);
+        }
+    }
+
+    int nPreceding = std::upper_bound(sortedQEnd.begin(), sortedQEnd.end(), q) 
+        - sortedQEnd.begin();
+    int maxPrev;
+    if (chainEnds.FindMax(0, nPreceding, maxPrev)) {
+        if (IsStale(maxPrev)) {
+            return false;
+        }
+        score[index] = l + score[maxPrev];
+        prev[index]  = maxPrev;
+        root[index]  = root[maxPrev];
+    }
+    else {
+        score[index] = l;
+        prev[index]  = -1;
+        root[index]  = index;
+    }
+    windowScores.Set(index, score[index], index);
+    pending.push(PendingAnchor(t + l, index));
+    windowEnd++;
+    return true;
+}
+
+template<typename T_MatchList>
+void SlidingWindowChain<T_MatchList>::Remove(VectorIndex index) {
+    assert(index == windowStart);
+    chainEnds.Clear(qEndSlot[index]);
+    windowScores.Clear(index);
+    windowStart++;
+}
+
+template<typename T_MatchList>
+int SlidingWindowChain<T_MatchList>::Chain(VectorIndex start, VectorIndex end,
+    std::vector<VectorIndex> &chainIndices) {
+    assert(pos != NULL);
+    assert(end <= pos->size());
+
+    if (start < windowStart or start >= windowEnd or end < windowEnd) {
+        Reset(start);
+    }
+    while (windowStart < start) {
+        Remove(windowStart);
+    }
+
+    //
+    // Scores stored for anchors whose chain started with an anchor
+    // that has left the window are too high.  Such a score is only
+    // used if it is a maximum, and then the window is rescored;
+    // otherwise the exact maximum is no lower than it anyway.
+    //
+    int chainEnd;
+    bool isScored = false;
+    while (isScored == false) {
+        while (windowEnd < end and Append(windowEnd)) {
+        }
+        if (windowEnd < end) {
+            Reset(start);
+            continue;
+        }
+        if (windowScores.FindMax(start, end, chainEnd) == false) {
+            return 0;
+        }
+        if (IsStale(chainEnd)) {
+            Reset(start);
+            continue;
+        }
+        isScored = true;
+    }
+
+    int index;
+    for (index = chainEnd; index != -1; index = prev[index]) {
+        chainIndices.push_back(index - start);
+    }
+    std::reverse(chainIndices.begin(), chainIndices.end());
+    return chainIndices.size();
+}
+
+#endif
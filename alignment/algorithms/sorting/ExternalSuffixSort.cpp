@@ -0,0 +1,173 @@
+#include <algorithm>
+#include "ExternalSuffixSort.hpp"
+
+//
+// The rank of the character at pos, with 0 past the end of the text
+// so that shorter suffixes sort first.
+//
+static inline UInt CharacterRank(std::vector<UInt> &rank, unsigned char text[],
+                                 UInt textLength, UInt pos) {
+    if (pos < textLength) {
+        return rank[text[pos]];
+    }
+    return 0;
+}
+
+ExternalSuffixSort::ExternalSuffixSort() {
+    maxBlockLength = 0;
+    prefixLength = 0;
+    nBlocks = 0;
+    nRanks = 0;
+    verbose = false;
+}
+
+void ExternalSuffixSort::RankCharacters(unsigned char text[], UInt textLength) {
+    std::vector<bool> present(256, false);
+    UInt i;
+    for (i = 0; i < textLength; i++) {
+        present[text[i]] = true;
+    }
+    rank.assign(256, 0);
+    nRanks = 1;
+    UInt c;
+    for (c = 1; c < 256; c++) {
+        if (present[c]) {
+            rank[c] = nRanks;
+            nRanks++;
+        }
+    }
+}
+
+UInt ExternalSuffixSort::SelectPrefixLength() {
+    UInt nBuckets = nRanks;
+    UInt k = 1;
+    while (nBuckets * nRanks <= EXTERNAL_SORT_MAX_BUCKETS) {
+        nBuckets *= nRanks;
+        k++;
+    }
+    return k;
+}
+
+void ExternalSuffixSort::CountBuckets(unsigned char text[], UInt textLength,
+                                      std::vector<UInt> &counts) {
+    UInt nBuckets = 1, highRadix = 1;
+    UInt j;
+    for (j = 0; j < prefixLength; j++) {
+        nBuckets *= nRanks;
+    }
+    highRadix = nBuckets / nRanks;
+    counts.assign(nBuckets, 0);
+    UInt key = 0;
+    for (j = 0; j < prefixLength; j++) {
+        key = key * nRanks + CharacterRank(rank, text, textLength, j);
+    }
+    UInt i;
+    for (i = 0; i < textLength; i++) {
+        counts[key]++;
+        key = (key % highRadix) * nRanks + CharacterRank(rank, text, textLength, i + prefixLength);
+    }
+}
+
+void ExternalSuffixSort::CollectBlock(unsigned char text[], UInt textLength,
+                                      UInt firstBucket, UInt endBucket,
+                                      std::vector<UInt> &block) {
+    UInt highRadix = 1;
+    UInt j;
+    for (j = 1; j < prefixLength; j++) {
+        highRadix *= nRanks;
+    }
+    block.clear();
+    UInt key = 0;
+    for (j = 0; j < prefixLength; j++) {
+        key = key * nRanks + CharacterRank(rank, text, textLength, j);
+    }
+    UInt i;
+    for (i = 0; i < textLength; i++) {
+        if (key >= firstBucket and key < endBucket) {
+            block.push_back(i);
+        }
+        key = (key % highRadix) * nRanks + CharacterRank(rank, text, textLength, i + prefixLength);
+    }
+}
+
+bool ExternalSuffixSort::Sort(unsigned char text[], UInt textLength, std::ostream &out,
+                              UInt maxBlockLengthP, int diffCoverSize, int nThreads) {
+    maxBlockLength = std::max(maxBlockLengthP, (UInt) 1);
+    nBlocks = 0;
+    if (textLength == 0) {
+        return out.good();
+    }
+
+    //
+    // The sample order is computed once for the whole text; its
+    // scratch space is released before any block is collected.
+    //
+    DiffCoverSuffixOrder order;
+    order.nThreads = nThreads;
+    if (order.SelectCover(diffCoverSize) == false) {
+        return false;
+    }
+    {
+        std::vector<UInt> scratch(order.ScratchSize(textLength));
+        order.SortSample(text, textLength, &scratch[0]);
+    }
+
+    RankCharacters(text, textLength);
+    prefixLength = SelectPrefixLength();
+    std::vector<UInt> counts;
+    CountBuckets(text, textLength, counts);
+
+    std::vector<UInt> block;
+    UInt nBuckets = counts.size();
+    UInt firstBucket = 0, nSorted = 0;
+    while (firstBucket < nBuckets) {
+        UInt endBucket = firstBucket;
+        UInt blockLength = 0;
+        while (endBucket < nBuckets and
+               (blockLength == 0 or blockLength + counts[endBucket] <= maxBlockLength)) {
+            blockLength += counts[endBucket];
+            endBucket++;
+        }
+        if (blockLength > 0) {
+            block.reserve(blockLength);
+            CollectBlock(text, textLength, firstBucket, endBucket, block);
+            order.SortSuffixes(text, textLength, &block[0], block.size());
+            out.write((char*) &block[0], sizeof(UInt) * block.size());
+            nSorted += blockLength;
+            nBlocks++;
+            if (verbose) {
+                std::cerr << "Wrote block " << nBlocks << ", " << nSorted << " of "
+                          << textLength << " suffixes sorted." << std::endl;
+            }
+        }
+        firstBucket = endBucket;
+    }
+    return out.good();
+}
+
+SuffixArrayFileReader::SuffixArrayFileReader() {
+    arrayOffset = 0;
+    length = 0;
+    bufferStart = bufferEnd = 0;
+}
+
+bool SuffixArrayFileReader::Initialize(std::string &fileName, std::streamoff arrayOffsetP,
+                                       UInt lengthP, UInt bufferLength) {
+    in.open(fileName.c_str(), std::ios::binary);
+    arrayOffset = arrayOffsetP;
+    length = lengthP;
+    buffer.resize(std::max(bufferLength, (UInt) 1));
+    bufferStart = bufferEnd = 0;
+    return in.good();
+}
+
+UInt SuffixArrayFileReader::operator[](UInt i) {
+    if (i < bufferStart or i >= bufferEnd) {
+        bufferStart = i;
+        bufferEnd = std::min(length, (UInt) (i + buffer.size()));
+        in.clear();
+        in.seekg(arrayOffset + (std::streamoff) i * sizeof(UInt));
+        in.read((char*) &buffer[0], sizeof(UInt) * (bufferEnd - bufferStart));
+    }
+    return buffer[i - bufferStart];
+}
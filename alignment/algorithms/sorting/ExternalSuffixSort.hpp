@@ -0,0 +1,84 @@
+#ifndef _BLASR_EXTERNAL_SUFFIX_SORT_HPP_
+#define _BLASR_EXTERNAL_SUFFIX_SORT_HPP_
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "LightweightSuffixArray.hpp"
+#include "../../../pbdata/Types.h"
+
+//
+// The largest number of buckets the suffixes are counted into before
+// being split into blocks.
+//
+#define EXTERNAL_SORT_MAX_BUCKETS (1 << 22)
+
+//
+// Sorts the suffixes of a text that fits in memory when its suffix
+// array does not, writing the array to a stream a block at a time.
+//
+// The suffixes are counted by their first few characters, and runs of
+// consecutive prefixes are grouped into blocks of at most
+// maxBlockLength suffixes.  Since every suffix in a block sorts before
+// every suffix of the next block, each block is collected by a scan
+// of the text, sorted with the difference cover order of the whole
+// text (see DiffCoverSuffixOrder), and written out in turn; no merge
+// is needed.  Memory beyond the text is the difference cover sample
+// (one UInt per 39 text positions for a cover of size 2281), the
+// bucket counts, and one block.  A single prefix shared by more than
+// maxBlockLength suffixes, such as a long run of N, is still sorted
+// as one block.
+//
+// As with LightweightSuffixSort, text must be followed by at least
+// diffCoverSize zeros, and contain no zeros itself.
+//
+class ExternalSuffixSort {
+public:
+    UInt maxBlockLength;
+    UInt prefixLength;
+    UInt nBlocks;
+    bool verbose;
+
+    ExternalSuffixSort();
+
+    bool Sort(unsigned char text[], UInt textLength, std::ostream &out,
+              UInt maxBlockLengthP, int diffCoverSize=2281, int nThreads=1);
+
+private:
+    std::vector<UInt> rank;
+    UInt nRanks;
+
+    void RankCharacters(unsigned char text[], UInt textLength);
+
+    UInt SelectPrefixLength();
+
+    void CountBuckets(unsigned char text[], UInt textLength, std::vector<UInt> &counts);
+
+    void CollectBlock(unsigned char text[], UInt textLength, UInt firstBucket,
+                      UInt endBucket, std::vector<UInt> &block);
+};
+
+//
+// Reads an array of UInt stored in a file, such as the suffix array
+// written by ExternalSuffixSort, through a fixed size buffer.  Any
+// entry may be read, but each one outside the buffer refills it, so
+// this is meant for a forward pass over the array.
+//
+class SuffixArrayFileReader {
+public:
+    std::ifstream in;
+    std::streamoff arrayOffset;
+    UInt length;
+    std::vector<UInt> buffer;
+    UInt bufferStart, bufferEnd;
+
+    SuffixArrayFileReader();
+
+    bool Initialize(std::string &fileName, std::streamoff arrayOffsetP, UInt lengthP,
+                    UInt bufferLength=65536);
+
+    UInt operator[](UInt i);
+};
+
+#endif // _BLASR_EXTERNAL_SUFFIX_SORT_HPP_
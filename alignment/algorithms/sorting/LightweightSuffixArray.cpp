@@ -20,13 +20,16 @@ void BuildDiffCoverReverseLookup(UInt diffCover[], UInt diffCoverLength,
 }
 
 UInt DiffCoverFindH(UInt diffCover[], UInt diffCoverLength, UInt diffCoverSize, UInt textSize) {
-    (void)(diffCoverLength);
     UInt h;
-    for (h = 0; h < diffCoverSize; h++) {
+    //
+    // h indexes the cover, so it is bounded by the cover length rather
+    // than its modulus.
+    //
+    for (h = 0; h < diffCoverLength; h++) {
         UInt rem = textSize % diffCoverSize ;
         if (rem == 0) return 0;
-        if ((h < diffCoverSize -1 and (diffCover[h] <= rem and rem < diffCover[h+1])) or
-                (h == diffCoverSize-1 and (diffCover[h] <= rem and rem < diffCoverSize))) {
+        if ((h < diffCoverLength -1 and (diffCover[h] <= rem and rem < diffCover[h+1])) or
+                (h == diffCoverLength-1 and (diffCover[h] <= rem and rem < diffCoverSize))) {
             return h;
         }
     }
@@ -238,34 +241,55 @@ int DiffCoverCompareSuffices::operator()(UInt a, UInt b) {
     return (lOrder[aDCIndex] < lOrder[bDCIndex]);
 }
 
-bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize) {
-    //
-    // index is an array of length textLength that contains all
-    // suffices.
-    //
+//
+// Called by the quicksort, possibly from several threads, with the
+// suffixes that share a diffCoverSize prefix.
+//
+static void SortDiffCoverGroup(UInt group[], UInt groupLength, void *comparatorPtr) {
+    DiffCoverCompareSuffices *comparator = (DiffCoverCompareSuffices*) comparatorPtr;
+    std::sort(group, group + groupLength, *comparator);
+}
+
+DiffCoverSuffixOrder::DiffCoverSuffixOrder() {
+    diffCover = NULL;
+    diffCoverLength = diffCoverSize = 0;
+    lexOrder = NULL;
+    nThreads = 1;
+}
+
+DiffCoverSuffixOrder::~DiffCoverSuffixOrder() {
+    // diffCover was allocated in DifferenceCovers.cpp -> 
+    // InitializeDifferenceCover(...). Deallocate it. 
+    if (diffCover) {delete [] diffCover; diffCover = NULL;}
+    if (lexOrder) {delete [] lexOrder; lexOrder = NULL;}
+}
 
+UInt DiffCoverSuffixOrder::ScratchSize(UInt textLength) {
     //
-    // Phase 0. Compute delta function for difference cover.
+    // The sample is ordered by mu, which may leave gaps of up to one
+    // entry per cover element.
     //
+    return (textLength / diffCoverSize + 2) * diffCoverLength + 1;
+}
 
-    //  For now, use a very small hard wired diff cover for testing
-    UInt *diffCover;
-    UInt diffCoverLength;
+bool DiffCoverSuffixOrder::SelectCover(int diffCoverSizeP) {
+    diffCoverSize = diffCoverSizeP;
     if (InitializeDifferenceCover(diffCoverSize, diffCoverLength, diffCover) == 0) {
         std::cout << "ERROR! There is no difference cover of size " << diffCoverSize << " that is precomputed." << std::endl;
-        exit(1);
+        return false;
     }
-
-    DiffCoverDelta delta;
-
     delta.Initialize(diffCover, diffCoverLength, diffCoverSize);
+    return true;
+}
 
+void DiffCoverSuffixOrder::SortSample(unsigned char text[], UInt textLength, UInt *scratch) {
     //
     // Phase 1. Sort suffices whose starting position modulo v is in D.
     //
 
     // The set d is given by 
     // Step 1.1 v-sort D-sample suffices
+    UInt *index = scratch;
     UInt dIndex = 0; // index in D-sample
     UInt tIndex = 0; // index in text
     UInt nDiffCover;
@@ -287,7 +311,8 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
     }
     UInt dSetSize = dIndex;
     std::cerr << "Sorting " << diffCoverSize << "-prefixes of the genome." << std::endl;
-    MediankeyBoundedQuicksort(text, index, dIndex, 0, dSetSize, 0, diffCoverSize);
+    WordBoundedQuicksort sampleSorter;
+    sampleSorter.Sort(text, textLength, index, dSetSize, diffCoverSize, nThreads);
     UInt i;
 
     //
@@ -297,7 +322,6 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
     //
     UInt *lexVNaming;
     lexVNaming = ProtectedNew<UInt>(dSetSize+1);
-    DiffCoverMu mu;
     mu.Initialize(diffCover, diffCoverLength, diffCoverSize, textLength);
     UInt largestLexName;
     std::cerr << "Enumerating " << diffCoverSize << "-prefixes." << std::endl;
@@ -308,7 +332,6 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
     // Step 1.3 Compute ISA' of lex-order.
     //
 
-    UInt *lexOrder;
     //
     // lexVNaming is allocated space.  The suffix sorting needs an
     // auxiliary array.  Since the index is not being used right now,
@@ -342,24 +365,30 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
             lexOrder[diffCoverIndex] = tmpLexOrder[lexOrderIndex];
         }
     }
+}
 
+bool DiffCoverSuffixOrder::Initialize(unsigned char text[], UInt textLength, int diffCoverSizeP, UInt *scratch) {
+    if (SelectCover(diffCoverSizeP) == false) {
+        return false;
+    }
+    SortSample(text, textLength, scratch);
+    return true;
+}
+
+void DiffCoverSuffixOrder::SortSuffixes(unsigned char text[], UInt textLength, UInt *index, UInt nSuffixes) {
     //
     // Phase 2. Construct SA by exploiting the fact that for any i,j\in
     // [0,n-v], the relative order of the suffixes starting at
     // i+\delta(,j) and j+\delta(i,j) is already known.
     //
-    std::cerr << "Sorting suffices." << std::endl;
     // Step 2.1 v-order suffices using multikey quicksort
-    for (i = 0; i < textLength; i++ ){
-        index[i] = i;
-    }
-    MediankeyBoundedQuicksort(text, index, textLength, 0, textLength, 0, diffCoverSize);
-
+    //
     // Step 2.2. For each group of suffixes that remains unsorted
     // (shares a prefix of length diffCoverSize, complete the sorting
     // with a comparison based on the sorting algorithm using
     // l(i+\delta(i,j)) nad l(j+\delta(i,j)) as keys when comparing
-    // suffixes S_i and S_j.
+    // suffixes S_i and S_j.  The quicksort hands each such group to
+    // SortDiffCoverGroup as it finds it.
     //
     DiffCoverCompareSuffices lOrderComparator;
     lOrderComparator.lOrder = lexOrder;
@@ -367,30 +396,35 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
     lOrderComparator.diffCoverSize = diffCoverSize;
     lOrderComparator.diffCoverLength=diffCoverLength;
     lOrderComparator.diffCoverReverseLookup = mu.diffCoverReverseLookup;
-    UInt setBegin, setEnd;
-    setBegin = setEnd = 0;
-    std::cerr << "Sorting buckets." << std::endl;
-    int percentDone = 0;
-    int curPercentage = 0;
-    while(setBegin < textLength) {
-        setEnd = setBegin;
-        percentDone = (int)(((1.0*setBegin) / textLength) * 100);
-        if ( percentDone > curPercentage) {
-            std::cerr << " " << percentDone << "% of buckets sorted."  << std::endl;
-            curPercentage = percentDone;
-        }
-        while(setEnd < textLength and
-                NCompareSuffices(text, index[setBegin], index[setEnd], diffCoverSize) == 0) {
-            setEnd++;
-        }
-        std::sort(&index[setBegin], &index[setEnd], lOrderComparator);
-        setBegin = setEnd;
+    WordBoundedQuicksort sorter;
+    sorter.Sort(text, textLength, index, nSuffixes, diffCoverSize, nThreads,
+                SortDiffCoverGroup, &lOrderComparator);
+}
+
+bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize,
+        int nThreads) {
+    //
+    // index is an array of length textLength that contains all
+    // suffices.
+    //
+
+    //
+    // Phase 0. Compute delta function for difference cover.
+    // Phase 1 uses the index as its scratch space.
+    //
+    DiffCoverSuffixOrder order;
+    order.nThreads = nThreads;
+    if (order.Initialize(text, textLength, diffCoverSize, index) == false) {
+        exit(1);
     }
 
-    // diffCover was allocated in DifferenceCovers.cpp -> 
-    // InitializeDifferenceCover(...). Deallocate it. 
-    if (diffCover) {delete [] diffCover; diffCover = NULL;}
-    if (lexVNaming) {delete [] lexVNaming; lexVNaming = NULL;}
+    std::cerr << "Sorting suffices." << std::endl;
+    UInt i;
+    for (i = 0; i < textLength; i++ ){
+        index[i] = i;
+    }
+    std::cerr << "Sorting buckets." << std::endl;
+    order.SortSuffixes(text, textLength, index, textLength);
     return true;
     // DONE!!!!!
 
@@ -97,6 +97,41 @@ public:
     int operator()(UInt a, UInt b); 
 };
 
-bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize); 
+/*
+ * The two phases of the lightweight suffix sort, kept apart so that
+ * the suffixes may be sorted a block at a time.  Initialize sorts the
+ * difference cover sample of the text, which takes about
+ * diffCoverLength/diffCoverSize of the text length in scratch space
+ * (ScratchSize() entries) and keeps as many ranks.  SortSuffixes then
+ * sorts any set of suffixes of the text into their suffix array order.
+ * Both sorts use nThreads threads.
+ */
+class DiffCoverSuffixOrder {
+public:
+    UInt *diffCover;
+    UInt diffCoverLength;
+    UInt diffCoverSize;
+    DiffCoverDelta delta;
+    DiffCoverMu mu;
+    UInt *lexOrder;
+    int nThreads;
+
+    DiffCoverSuffixOrder();
+
+    ~DiffCoverSuffixOrder();
+
+    bool SelectCover(int diffCoverSizeP);
+
+    UInt ScratchSize(UInt textLength);
+
+    void SortSample(unsigned char text[], UInt textLength, UInt *scratch);
+
+    bool Initialize(unsigned char text[], UInt textLength, int diffCoverSizeP, UInt *scratch);
+
+    void SortSuffixes(unsigned char text[], UInt textLength, UInt *index, UInt nSuffixes);
+};
+
+bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize,
+        int nThreads=1); 
 
 #endif
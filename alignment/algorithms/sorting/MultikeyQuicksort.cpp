@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <cassert>
 #include "MultikeyQuicksort.hpp"
 
@@ -193,3 +194,230 @@ void MediankeyBoundedQuicksort(unsigned char text[], UInt index[], UInt length,
 
     if (deleteFreq) {delete [] freq; freq = NULL;}
 }
+
+//
+// The characters of a suffix from word depth on, most significant
+// first so that words compare as strings do.
+//
+inline uint64_t WordBoundedQuicksort::Word(UInt pos, UInt depth) {
+    UInt start = pos + depth * WordSortChars;
+    uint64_t word = 0;
+    UInt c;
+    if (start + WordSortChars <= textLength) {
+        for (c = 0; c < WordSortChars; c++) {
+            word = (word << 8) | text[start + c];
+        }
+    }
+    else {
+        for (c = 0; c < WordSortChars; c++) {
+            word <<= 8;
+            if (start + c < textLength) {
+                word |= text[start + c];
+            }
+        }
+    }
+    return word;
+}
+
+int WordBoundedQuicksort::CompareWords(UInt a, UInt b, UInt depth) {
+    UInt d;
+    for (d = depth; d < nWords; d++) {
+        uint64_t aWord = Word(a, d);
+        uint64_t bWord = Word(b, d);
+        if (aWord != bWord) {
+            return (aWord < bWord) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+void WordBoundedQuicksort::InsertionSort(UInt low, UInt high, UInt depth) {
+    UInt i, j;
+    for (i = low + 1; i < high; i++) {
+        UInt suffix = index[i];
+        for (j = i; j > low and CompareWords(index[j-1], suffix, depth) > 0; j--) {
+            index[j] = index[j-1];
+        }
+        index[j] = suffix;
+    }
+    if (groupFunction == NULL) {
+        return;
+    }
+    UInt groupStart = low;
+    for (i = low + 1; i <= high; i++) {
+        if (i == high or CompareWords(index[groupStart], index[i], depth) != 0) {
+            if (i - groupStart > 1) {
+                groupFunction(&index[groupStart], i - groupStart, groupData);
+            }
+            groupStart = i;
+        }
+    }
+}
+
+#define WORD_KEY(i) (cached ? thread.keys[(i) - thread.cacheLow] : Word(index[i], range.depth))
+
+void WordBoundedQuicksort::PartitionRange(Thread &thread, Range range) {
+    UInt low = range.low, high = range.high;
+    bool cached = range.cached;
+    UInt i;
+    if (cached == false and high - low <= WORD_SORT_CACHE_LENGTH) {
+        //
+        // The ranges pushed while this one is sorted lie inside it, so
+        // the buffer is only moved once they are all done.
+        //
+        if (low < thread.cacheLow or high > thread.cacheHigh) {
+            thread.cacheLow  = low;
+            thread.cacheHigh = high;
+        }
+        for (i = low; i < high; i++) {
+            thread.keys[i - thread.cacheLow] = Word(index[i], range.depth);
+        }
+        cached = true;
+    }
+
+    uint64_t a = WORD_KEY(low), b = WORD_KEY(low + (high - low) / 2), c = WORD_KEY(high - 1);
+    uint64_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+    //
+    // Three way partition into keys below, equal to, and above the
+    // pivot: [low, lessEnd), [lessEnd, greaterStart), [greaterStart, high).
+    //
+    UInt lessEnd = low, greaterStart = high;
+    i = low;
+    while (i < greaterStart) {
+        uint64_t key = WORD_KEY(i);
+        if (key < pivot) {
+            std::swap(index[lessEnd], index[i]);
+            if (cached) {
+                std::swap(thread.keys[lessEnd - thread.cacheLow], thread.keys[i - thread.cacheLow]);
+            }
+            lessEnd++;
+            i++;
+        }
+        else if (key > pivot) {
+            greaterStart--;
+            std::swap(index[greaterStart], index[i]);
+            if (cached) {
+                std::swap(thread.keys[greaterStart - thread.cacheLow], thread.keys[i - thread.cacheLow]);
+            }
+        }
+        else {
+            i++;
+        }
+    }
+
+    //
+    // The equal range is pushed first so that the ranges whose keys
+    // are in the buffer are partitioned before it is overwritten.
+    //
+    Range next;
+    next.low    = lessEnd;
+    next.high   = greaterStart;
+    next.depth  = range.depth + 1;
+    next.cached = false;
+    thread.stack.push_back(next);
+    next.depth  = range.depth;
+    next.cached = cached;
+    next.low    = low;
+    next.high   = lessEnd;
+    thread.stack.push_back(next);
+    next.low    = greaterStart;
+    next.high   = high;
+    thread.stack.push_back(next);
+}
+
+void WordBoundedQuicksort::SortRanges(Thread &thread, UInt deferLength) {
+    while (thread.stack.size() > 0) {
+        Range range = thread.stack.back();
+        thread.stack.pop_back();
+        UInt rangeLength = range.high - range.low;
+        if (rangeLength <= 1) {
+            continue;
+        }
+        if (range.depth >= nWords) {
+            if (groupFunction != NULL) {
+                groupFunction(&index[range.low], rangeLength, groupData);
+            }
+        }
+        else if (rangeLength <= deferLength) {
+            range.cached = false;
+            deferred.push_back(range);
+        }
+        else if (rangeLength <= WORD_SORT_INSERTION_LENGTH) {
+            InsertionSort(range.low, range.high, range.depth);
+        }
+        else {
+            PartitionRange(thread, range);
+        }
+    }
+}
+
+static bool LongerRange(const WordBoundedQuicksort::Range &a, const WordBoundedQuicksort::Range &b) {
+    return a.high - a.low > b.high - b.low;
+}
+
+void *WordBoundedQuicksort::RunThread(void *threadPtr) {
+    Thread *thread = (Thread*) threadPtr;
+    WordBoundedQuicksort *sorter = thread->sorter;
+    UInt r;
+    for (r = thread->index; r < sorter->deferred.size(); r += sorter->nThreads) {
+        thread->stack.push_back(sorter->deferred[r]);
+        sorter->SortRanges(*thread, 0);
+    }
+    return NULL;
+}
+
+void WordBoundedQuicksort::Sort(unsigned char textP[], UInt textLengthP, UInt indexP[],
+                                UInt length, UInt bound, int nThreadsP,
+                                SuffixGroupFunction groupFunctionP, void *groupDataP) {
+    text          = textP;
+    textLength    = textLengthP;
+    index         = indexP;
+    nWords        = (bound + WordSortChars - 1) / WordSortChars;
+    nThreads      = std::max(1, nThreadsP);
+    groupFunction = groupFunctionP;
+    groupData     = groupDataP;
+    deferred.clear();
+    UInt keysLength = std::min(length, (UInt) WORD_SORT_CACHE_LENGTH);
+
+    std::vector<Thread> threads(nThreads);
+    int t;
+    for (t = 0; t < nThreads; t++) {
+        threads[t].sorter    = this;
+        threads[t].index     = t;
+        threads[t].cacheLow  = threads[t].cacheHigh = 0;
+        threads[t].keys.resize(keysLength);
+    }
+    Range all;
+    all.low    = 0;
+    all.high   = length;
+    all.depth  = 0;
+    all.cached = false;
+    threads[0].stack.push_back(all);
+    if (nThreads == 1) {
+        SortRanges(threads[0], 0);
+        return;
+    }
+
+    //
+    // Split the large ranges here, and hand out what is left longest
+    // first.
+    //
+    SortRanges(threads[0], std::max(length / (nThreads * 16), (UInt) WORD_SORT_INSERTION_LENGTH));
+    std::sort(deferred.begin(), deferred.end(), LongerRange);
+    std::vector<pthread_t> threadIds(nThreads);
+    std::vector<bool> created(nThreads, false);
+    for (t = 1; t < nThreads; t++) {
+        created[t] = (pthread_create(&threadIds[t], NULL, RunThread, &threads[t]) == 0);
+    }
+    RunThread(&threads[0]);
+    for (t = 1; t < nThreads; t++) {
+        if (created[t]) {
+            pthread_join(threadIds[t], NULL);
+        }
+        else {
+            RunThread(&threads[t]);
+        }
+    }
+    deferred.clear();
+}
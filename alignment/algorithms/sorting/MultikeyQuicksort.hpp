@@ -14,6 +14,7 @@
  */
 
 #include <limits.h>
+#include <stdint.h>
 #include <vector>
 #include <algorithm>
 // pbdata
@@ -46,4 +47,81 @@ void TransformBackSequence(Nucleotide text[], UInt textLength);
 void MediankeyBoundedQuicksort(unsigned char text[], UInt index[], UInt length,
         UInt low, UInt high, int depth, int bound, UInt maxChar= 0, UInt *freq=NULL); 
 
+//
+// Ranges of at most this many suffixes are sorted by insertion sort.
+//
+#define WORD_SORT_INSERTION_LENGTH 16
+
+//
+// Ranges of at most this many suffixes have their keys copied into a
+// buffer that stays in cache while the range is partitioned.
+//
+#define WORD_SORT_CACHE_LENGTH (1 << 16)
+
+//
+// Called with a run of suffixes that share at least their first bound
+// characters, which are left in no particular order.
+//
+typedef void (*SuffixGroupFunction)(UInt group[], UInt groupLength, void *data);
+
+/*
+ * A multikey quicksort that compares suffixes a word of
+ * WordSortChars characters at a time rather than one character at a
+ * time, so that a run of suffixes is split in one pass where the
+ * character at a time sort needs up to eight.  The keys of ranges of
+ * up to WORD_SORT_CACHE_LENGTH suffixes are read from the text once
+ * per word and then partitioned in place with the index, and the
+ * recursion is kept on an explicit stack.
+ *
+ * Characters past textLength are taken to be zero, so unlike
+ * MediankeyBoundedQuicksort the text needs no padding.  With
+ * nThreads > 1, the ranges left after the large ones are partitioned
+ * are sorted in separate threads, and groupFunction must be safe to
+ * call from them.
+ */
+class WordBoundedQuicksort {
+public:
+    static const UInt WordSortChars = 8;
+
+    void Sort(unsigned char text[], UInt textLength, UInt index[], UInt length, UInt bound,
+              int nThreads=1, SuffixGroupFunction groupFunction=NULL, void *groupData=NULL);
+
+    class Range {
+    public:
+        UInt low, high, depth;
+        bool cached;
+    };
+
+    class Thread {
+    public:
+        WordBoundedQuicksort *sorter;
+        int index;
+        std::vector<Range> stack;
+        std::vector<uint64_t> keys;
+        UInt cacheLow, cacheHigh;
+    };
+
+private:
+    unsigned char *text;
+    UInt textLength;
+    UInt *index;
+    UInt nWords;
+    int nThreads;
+    SuffixGroupFunction groupFunction;
+    void *groupData;
+    std::vector<Range> deferred;
+
+    static void *RunThread(void *threadPtr);
+
+    uint64_t Word(UInt pos, UInt depth);
+
+    int CompareWords(UInt a, UInt b, UInt depth);
+
+    void InsertionSort(UInt low, UInt high, UInt depth);
+
+    void SortRanges(Thread &thread, UInt deferLength);
+
+    void PartitionRange(Thread &thread, Range range);
+};
+
 #endif // _BLASR_MULTIKEY_QUICKSORT_HPP_
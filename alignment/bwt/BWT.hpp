@@ -9,6 +9,11 @@
 #include "../../pbdata/PackedDNASequence.hpp"
 #include "../../pbdata/FASTASequence.hpp"
 
+//
+// The number of rows walked together by Bwt::LocateRows.
+//
+#define BWT_LOCATE_BATCH 32
+
 /*
  * Define an Occurrence table appropriate for Gb sized genomes.
  * Probably everything will end up using this.
@@ -135,16 +140,72 @@ class Bwt {
 		return seqPos + offset;
 	}
 	
+	//
+	// Append the text positions of rows [sp, ep] to positions, in row
+	// order.  This gives the same positions as calling Locate on each
+	// row, but the rows are walked back in lockstep, BWT_LOCATE_BATCH
+	// at a time, and the memory each one needs for its next step is
+	// prefetched while the others take theirs.  The many independent
+	// cache misses of a repetitive match then overlap rather than
+	// being paid one after another.
+	//
+	void LocateRows(DNALength sp, DNALength ep, std::vector<DNALength> &positions) {
+		DNALength rows[BWT_LOCATE_BATCH], offsets[BWT_LOCATE_BATCH];
+		int active[BWT_LOCATE_BATCH];
+		DNALength batchStart, seqPos;
+		for (batchStart = sp; batchStart <= ep; batchStart += BWT_LOCATE_BATCH) {
+			int nRows = BWT_LOCATE_BATCH;
+			if (ep - batchStart + 1 < (DNALength) BWT_LOCATE_BATCH) {
+				nRows = ep - batchStart + 1;
+			}
+			VectorIndex first = positions.size();
+			positions.resize(first + nRows);
+			int i, nActive = nRows;
+			for (i = 0; i < nRows; i++) {
+				rows[i]    = batchStart + i;
+				offsets[i] = 0;
+				active[i]  = i;
+			}
+			while (nActive > 0) {
+				int a, nStillActive = 0;
+				for (a = 0; a < nActive; a++) {
+					i = active[a];
+					if (pos.Lookup(rows[i], seqPos)) {
+						positions[first + i] = seqPos + offsets[i];
+						continue;
+					}
+					rows[i] = LFBacktrack(rows[i]);
+					++offsets[i];
+					if (rows[i] == firstCharPos) {
+						//
+						// Boundary condition at the beginning of the bwt string.
+						//
+						positions[first + i] = offsets[i];
+						continue;
+					}
+					pos.Prefetch(rows[i]);
+					occ.Prefetch(rows[i]);
+					active[nStillActive++] = i;
+				}
+				nActive = nStillActive;
+			}
+		}
+	}
+
 	DNALength Locate(DNALength sp, DNALength ep, std::vector<DNALength> &positions, 
         DNALength maxCount = 0) {
-		DNALength bwtPos;
-		DNALength seqPos;
 		if (sp <= ep and (maxCount == 0 or ep - sp < maxCount)) {
-			for (bwtPos = sp; bwtPos <= ep; bwtPos++) {
-				if ((seqPos = Locate(bwtPos))) {
-					positions.push_back(seqPos);
+			VectorIndex first = positions.size(), p, kept = first;
+			LocateRows(sp, ep, positions);
+			//
+			// A position of 0 has always been left out here.
+			//
+			for (p = first; p < positions.size(); p++) {
+				if (positions[p]) {
+					positions[kept++] = positions[p];
 				}
 			}
+			positions.resize(kept);
 		}
 		return ep - sp + 1;
 	}
@@ -298,14 +359,19 @@ class Bwt {
 		}
 	}										
 
-	void InitializeFromSuffixArray(T_DNASequence &dnaSeq, DNALength saIndex[], int buildDebug=0) {
+	//
+	// posStride is the sampling rate of the suffix array used by
+	// Locate: a larger one makes the index smaller and Locate slower.
+	//
+	void InitializeFromSuffixArray(T_DNASequence &dnaSeq, DNALength saIndex[], int buildDebug=0,
+		DNALength posStride=POS_DEFAULT_STRIDE) {
 		useDebugData = buildDebug;
 		InitializeBWTStringFromSuffixArray(dnaSeq, saIndex);
 		InitializeDNACharacterCount();
 
 		// sequence, major, minor bin sizes.
 		occ.Initialize(bwtSequence, 4096, 64, buildDebug);
-		pos.InitializeFromSuffixArray(saIndex, dnaSeq.length);
+		pos.InitializeFromSuffixArray(saIndex, dnaSeq.length, posStride);
 	}
 };
 
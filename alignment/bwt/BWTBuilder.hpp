@@ -0,0 +1,385 @@
+#ifndef _BLASR_BWT_BUILDER_HPP_
+#define _BLASR_BWT_BUILDER_HPP_
+
+#include <pthread.h>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "BWT.hpp"
+
+//
+// The occurrence bin sizes of a built BWT, the same as
+// Bwt::InitializeFromSuffixArray uses.
+//
+#define BWT_BUILD_MAJOR_BIN 4096
+#define BWT_BUILD_MINOR_BIN 64
+
+//
+// The rows of the BWT are built in chunks of BWT_BUILD_CHUNK_ROWS,
+// which is a multiple of both the major bin size and the number of
+// nucleotides in a packed word, so that the chunks share no bin or
+// word and may be built at the same time.  The suffix array entries
+// of a chunk are read BWT_BUILD_READ_BLOCK at a time.
+//
+#define BWT_BUILD_CHUNK_ROWS (20480 * 50)
+#define BWT_BUILD_READ_BLOCK 65536
+
+//
+// Where a BWTBuilder reads the suffix array from: either an array in
+// memory, or the array component of a file written by
+// SuffixArray::Write.  A file is read in blocks by each thread, so the
+// suffix array and the BWT are never in memory at the same time.
+//
+class SuffixArrayBlockSource {
+public:
+    DNALength *array;
+    std::string fileName;
+    std::streamoff arrayOffset;
+    DNALength length;
+
+    SuffixArrayBlockSource() {
+        array = NULL;
+        arrayOffset = 0;
+        length = 0;
+    }
+
+    bool InFile() const {
+        return !fileName.empty();
+    }
+
+    void SetArray(DNALength *arrayP, DNALength lengthP) {
+        array  = arrayP;
+        length = lengthP;
+        fileName = "";
+    }
+
+    //
+    // Read the header of a suffix array file.  Returns 0 if the file
+    // is not a suffix array or does not contain the array itself.
+    //
+    int OpenFile(std::string fileNameP) {
+        std::ifstream in;
+        CrucialOpen(fileNameP, in, std::ios::binary|std::ios::in);
+        SuffixArray<Nucleotide, std::vector<int> > header;
+        if (!header.ReadMagicNumber(in)) {
+            return 0;
+        }
+        header.ReadComponentList(in);
+        if (!header.componentList[header.CompArray]) {
+            return 0;
+        }
+        int arrayLength;
+        in.read((char*) &arrayLength, sizeof(arrayLength));
+        if (!in.good()) {
+            return 0;
+        }
+        array       = NULL;
+        fileName    = fileNameP;
+        length      = arrayLength;
+        arrayOffset = in.tellg();
+        return 1;
+    }
+};
+
+//
+// A reader of blocks of a SuffixArrayBlockSource, one per thread.
+//
+class SuffixArrayBlockReader {
+public:
+    SuffixArrayBlockSource *source;
+    std::ifstream in;
+    std::vector<DNALength> buffer;
+
+    void Initialize(SuffixArrayBlockSource &sourceP) {
+        source = &sourceP;
+        if (source->InFile()) {
+            CrucialOpen(source->fileName, in, std::ios::binary|std::ios::in);
+        }
+    }
+
+    //
+    // Return entries [start, start+n) of the suffix array, which are
+    // valid until the next call, or NULL if the file is shorter than
+    // its header says.
+    //
+    DNALength *Read(DNALength start, DNALength n) {
+        if (!source->InFile()) {
+            return &source->array[start];
+        }
+        buffer.resize(std::max(n, (DNALength) 1));
+        std::streamsize nBytes = (std::streamsize) sizeof(DNALength) * n;
+        in.seekg(source->arrayOffset + (std::streamoff) start * sizeof(DNALength));
+        in.read((char*) &buffer[0], nBytes);
+        if (!in.good() or in.gcount() != nBytes) {
+            return NULL;
+        }
+        return &buffer[0];
+    }
+};
+
+//
+// What one chunk of the BWT contributes to the parts that are
+// assembled serially: its character counts, the position of the '$'
+// if it holds it, and its suffix array samples in row order.
+//
+class BWTBuildChunk {
+public:
+    DNALength start, end;
+    DNALength count[GbOcc::AlphabetSize];
+    DNALength firstCharPos;
+    bool hasFirstChar;
+    std::vector<DNALength> sampleIndex, sampleValue;
+};
+
+//
+// Builds a BWT, its occurrence bins and its suffix array samples from
+// a text and its suffix array, giving the same index as
+// Bwt::InitializeFromSuffixArray.  Every part is filled in one pass
+// over the suffix array: each chunk of rows writes its packed words
+// and minor bins directly, and its major bins relative to the start
+// of the chunk.  The chunks are divided among threads, and the major
+// bins, character counts and samples are then joined in a pass over
+// the chunks.  The debugging suffix array copy is not built.
+//
+class BWTBuilder {
+public:
+    BWT *bwt;
+    FASTASequence *seq;
+    SuffixArrayBlockSource *source;
+    DNALength posStride;
+    int nThreads;
+    std::vector<BWTBuildChunk> chunks;
+
+    class Thread {
+    public:
+        BWTBuilder *builder;
+        int index;
+        bool failed;
+        SuffixArrayBlockReader reader;
+    };
+
+    //
+    // source must have seq.length entries.  Returns 0 if it does not,
+    // or if a block of it could not be read, in which case bwt is not
+    // valid.
+    //
+    int Build(FASTASequence &seqP, SuffixArrayBlockSource &sourceP, BWT &bwtP,
+        int nThreadsP=1, DNALength posStrideP=POS_DEFAULT_STRIDE) {
+        if (sourceP.length != seqP.length) {
+            return 0;
+        }
+        bwt       = &bwtP;
+        seq       = &seqP;
+        source    = &sourceP;
+        posStride = posStrideP;
+        nThreads  = std::max(nThreadsP, 1);
+
+        DNALength nRows = seq->length + 1;
+        bwt->useDebugData = 0;
+        bwt->saCopy.clear();
+        bwt->firstCharPos = 0;
+        bwt->bwtSequence.Allocate(nRows);
+        bwt->occ.AllocateBins(bwt->bwtSequence, BWT_BUILD_MAJOR_BIN, BWT_BUILD_MINOR_BIN);
+
+        DNALength c, nChunks = CeilOfFraction(nRows, (DNALength) BWT_BUILD_CHUNK_ROWS);
+        chunks.resize(nChunks);
+        for (c = 0; c < nChunks; c++) {
+            chunks[c].start = c * BWT_BUILD_CHUNK_ROWS;
+            chunks[c].end   = std::min(nRows, chunks[c].start + BWT_BUILD_CHUNK_ROWS);
+        }
+        if ((DNALength) nThreads > nChunks) {
+            nThreads = nChunks;
+        }
+
+        //
+        // Thread 0 runs on this one.  If a thread cannot be created,
+        // its chunks are built here after the others finish.
+        //
+        std::vector<Thread> threads(nThreads);
+        std::vector<pthread_t> threadIds(nThreads);
+        std::vector<bool> created(nThreads, false);
+        int t;
+        for (t = 0; t < nThreads; t++) {
+            threads[t].builder = this;
+            threads[t].index   = t;
+            threads[t].failed  = false;
+            threads[t].reader.Initialize(*source);
+        }
+        for (t = 1; t < nThreads; t++) {
+            created[t] = (pthread_create(&threadIds[t], NULL, RunThread, &threads[t]) == 0);
+        }
+        RunThread(&threads[0]);
+        for (t = 1; t < nThreads; t++) {
+            if (created[t]) {
+                pthread_join(threadIds[t], NULL);
+            }
+            else {
+                RunThread(&threads[t]);
+            }
+        }
+        for (t = 0; t < nThreads; t++) {
+            if (threads[t].failed) {
+                chunks.clear();
+                return 0;
+            }
+        }
+
+        JoinChunks();
+        chunks.clear();
+        return 1;
+    }
+
+    static void *RunThread(void *threadPtr) {
+        Thread *thread = (Thread*) threadPtr;
+        BWTBuilder *builder = thread->builder;
+        VectorIndex c;
+        for (c = thread->index; c < builder->chunks.size(); c += builder->nThreads) {
+            if (!builder->BuildChunk(builder->chunks[c], thread->reader)) {
+                thread->failed = true;
+                break;
+            }
+        }
+        return NULL;
+    }
+
+    //
+    // Returns false if the suffix array entries of the chunk could not
+    // be read.
+    //
+    bool BuildChunk(BWTBuildChunk &chunk, SuffixArrayBlockReader &reader) {
+        GbOcc &occ = bwt->occ;
+        PackedDNAWord *words = bwt->bwtSequence.seq;
+        const DNALength nucsPerWord = PackedDNASequence::NucsPerWord;
+        DNALength majorTotal[GbOcc::AlphabetSize];
+        unsigned int n;
+        std::fill(chunk.count, chunk.count + GbOcc::AlphabetSize, 0);
+        std::fill(majorTotal, majorTotal + GbOcc::AlphabetSize, 0);
+        chunk.hasFirstChar = false;
+        chunk.sampleIndex.clear();
+        chunk.sampleValue.clear();
+
+        PackedDNAWord word = 0;
+        DNALength blockStart, row;
+        for (blockStart = chunk.start; blockStart < chunk.end; blockStart += BWT_BUILD_READ_BLOCK) {
+            DNALength blockEnd = std::min(chunk.end, blockStart + BWT_BUILD_READ_BLOCK);
+            //
+            // Row r is the suffix at suffix array index r-1; row 0 is the
+            // suffix holding only the '$'.
+            //
+            DNALength saStart = (blockStart == 0) ? 0 : blockStart - 1;
+            DNALength *sa = reader.Read(saStart, blockEnd - 1 - saStart);
+            if (sa == NULL) {
+                return false;
+            }
+            for (row = blockStart; row < blockEnd; row++) {
+                Nucleotide nuc;
+                if (row == 0) {
+                    nuc = (seq->length > 0) ? ThreeBit[seq->seq[seq->length - 1]] : ThreeBit[(int)'$'];
+                }
+                else {
+                    DNALength suffix = sa[row - 1 - saStart];
+                    if (suffix > 0) {
+                        nuc = ThreeBit[seq->seq[suffix - 1]];
+                    }
+                    else {
+                        nuc = ThreeBit[(int)'$'];
+                        chunk.firstCharPos = row;
+                        chunk.hasFirstChar = true;
+                    }
+                    if (suffix % posStride == 0) {
+                        chunk.sampleIndex.push_back(row - 1);
+                        chunk.sampleValue.push_back(suffix);
+                    }
+                }
+                if (row % BWT_BUILD_MAJOR_BIN == 0) {
+                    for (n = 0; n < GbOcc::AlphabetSize; n++) {
+                        occ.major[row / BWT_BUILD_MAJOR_BIN][n] = chunk.count[n];
+                    }
+                    std::fill(majorTotal, majorTotal + GbOcc::AlphabetSize, 0);
+                }
+                if (row % BWT_BUILD_MINOR_BIN == 0) {
+                    for (n = 0; n < GbOcc::AlphabetSize; n++) {
+                        occ.minor[row / BWT_BUILD_MINOR_BIN][n] = majorTotal[n];
+                    }
+                }
+                word |= ((PackedDNAWord) nuc) << (3 * (row % nucsPerWord));
+                if (row % nucsPerWord == nucsPerWord - 1) {
+                    words[row / nucsPerWord] = word;
+                    word = 0;
+                }
+                //
+                // Only ACGTN are counted, not '$'.
+                //
+                if (nuc < GbOcc::AlphabetSize) {
+                    chunk.count[nuc]++;
+                    majorTotal[nuc]++;
+                }
+            }
+        }
+        if (chunk.end % nucsPerWord != 0) {
+            words[(chunk.end - 1) / nucsPerWord] = word;
+        }
+        return true;
+    }
+
+    //
+    // Offset the major bins of each chunk by the counts of the chunks
+    // before it, and build the character counts and samples.
+    //
+    void JoinChunks() {
+        GbOcc &occ = bwt->occ;
+        DNALength total[GbOcc::AlphabetSize];
+        std::fill(total, total + GbOcc::AlphabetSize, 0);
+        DNALength nSamples = 0;
+        VectorIndex c;
+        unsigned int n;
+        for (c = 0; c < chunks.size(); c++) {
+            BWTBuildChunk &chunk = chunks[c];
+            DNALength bin;
+            for (bin = chunk.start / BWT_BUILD_MAJOR_BIN; bin < occ.numMajorBins and
+                     bin * BWT_BUILD_MAJOR_BIN < chunk.end; bin++) {
+                for (n = 0; n < GbOcc::AlphabetSize; n++) {
+                    occ.major[bin][n] += total[n];
+                }
+            }
+            for (n = 0; n < GbOcc::AlphabetSize; n++) {
+                total[n] += chunk.count[n];
+            }
+            if (chunk.hasFirstChar) {
+                bwt->firstCharPos = chunk.firstCharPos;
+            }
+            nSamples += chunk.sampleIndex.size();
+        }
+
+        //
+        // charCount[c] is the number of characters less than c, with
+        // the '$' less than all others.
+        //
+        DNALength nChars = 0;
+        for (n = 0; n < GbOcc::AlphabetSize; n++) {
+            nChars += total[n];
+        }
+        bwt->charCount[0] = bwt->bwtSequence.length - nChars;
+        for (n = 0; n < GbOcc::AlphabetSize; n++) {
+            bwt->charCount[n + 1] = bwt->charCount[n] + total[n];
+        }
+        bwt->charCount[6] = bwt->bwtSequence.length;
+
+        Pos<PackedDNASequence> &pos = bwt->pos;
+        pos.stride = posStride;
+        pos.sampled.Allocate(seq->length);
+        pos.values.clear();
+        pos.values.reserve(nSamples);
+        for (c = 0; c < chunks.size(); c++) {
+            VectorIndex s;
+            for (s = 0; s < chunks[c].sampleIndex.size(); s++) {
+                pos.sampled.Set(chunks[c].sampleIndex[s]);
+                pos.values.push_back(chunks[c].sampleValue[s]);
+            }
+        }
+        pos.sampled.BuildRank();
+    }
+};
+
+#endif // _BLASR_BWT_BUILDER_HPP_
@@ -0,0 +1,120 @@
+#ifndef _BLASR_BIDIRECTIONAL_BWT_HPP_
+#define _BLASR_BIDIRECTIONAL_BWT_HPP_
+
+#include <string>
+#include <vector>
+#include "BWT.hpp"
+
+//
+// The rows of a pattern P in a bidirectional index: P is the prefix
+// of the suffixes in rows [forwardStart, forwardStart+size) of the
+// forward BWT, and the reverse of P is the prefix of the suffixes in
+// rows [reverseStart, reverseStart+size) of the reverse BWT.
+// qStart and qEnd record the bases of a read that P is made of.
+//
+class BiInterval {
+public:
+    DNALength forwardStart, reverseStart, size;
+    DNALength qStart, qEnd;
+    BiInterval() {
+        forwardStart = reverseStart = size = 0;
+        qStart = qEnd = 0;
+    }
+};
+
+//
+// A BWT of a text together with a BWT of the text reversed (not
+// complemented), built with the same InitializeFromSuffixArray and
+// read and written as two ordinary BWT files.  The pair allows a
+// match to be extended one base at a time in either direction with a
+// constant number of rank queries per base, which is what super
+// maximal exact match search needs.  Positions are always reported
+// in the forward text.
+//
+class BidirectionalBWT {
+public:
+    BWT forward, reverse;
+
+    int Read(std::string forwardName, std::string reverseName) {
+        return forward.Read(forwardName) and reverse.Read(reverseName);
+    }
+
+    void Write(std::string forwardName, std::string reverseName) {
+        forward.Write(forwardName);
+        reverse.Write(reverseName);
+    }
+
+    //
+    // reverseSeq must be seq reversed, and forwardSA and reverseSA the
+    // suffix arrays of each.
+    //
+    void InitializeFromSuffixArrays(FASTASequence &seq, DNALength forwardSA[],
+        FASTASequence &reverseSeq, DNALength reverseSA[]) {
+        forward.InitializeFromSuffixArray(seq, forwardSA);
+        reverse.InitializeFromSuffixArray(reverseSeq, reverseSA);
+    }
+
+    //
+    // The interval of the single base nuc (a ThreeBit code of ACGT).
+    //
+    void Initialize(Nucleotide nuc, BiInterval &interval) {
+        interval.forwardStart = forward.charCount[nuc];
+        interval.reverseStart = reverse.charCount[nuc];
+        interval.size = forward.charCount[nuc + 1] - forward.charCount[nuc];
+    }
+
+    //
+    // Set extended to the interval of nuc followed by the pattern of
+    // interval; only its size is meaningful when that is 0.
+    //
+    void ExtendLeft(const BiInterval &interval, Nucleotide nuc, BiInterval &extended) {
+        Extend(forward, interval.forwardStart, interval.reverseStart, interval.size, nuc,
+            extended.forwardStart, extended.reverseStart, extended.size);
+    }
+
+    //
+    // Set extended to the interval of the pattern of interval followed
+    // by nuc.
+    //
+    void ExtendRight(const BiInterval &interval, Nucleotide nuc, BiInterval &extended) {
+        Extend(reverse, interval.reverseStart, interval.forwardStart, interval.size, nuc,
+            extended.reverseStart, extended.forwardStart, extended.size);
+    }
+
+    //
+    // Append the positions in the forward text of the pattern of
+    // interval to positions.
+    //
+    void Locate(const BiInterval &interval, std::vector<DNALength> &positions) {
+        if (interval.size > 0) {
+            forward.LocateRows(interval.forwardStart,
+                interval.forwardStart + interval.size - 1, positions);
+        }
+    }
+
+private:
+    //
+    // Extend by backward search in index, and place the result in the
+    // other index by counting the rows of the patterns that are
+    // extended by a smaller base, or that are at the start of the
+    // text and so are followed by the sentinel in the other.
+    //
+    void Extend(BWT &index, DNALength start, DNALength otherStart, DNALength size,
+        Nucleotide nuc, DNALength &newStart, DNALength &newOtherStart, DNALength &newSize) {
+        DNALength end = start + size - 1;
+        DNALength smaller = 0;
+        if (start <= index.firstCharPos and index.firstCharPos <= end) {
+            smaller = 1;
+        }
+        Nucleotide c;
+        for (c = 0; c < nuc; c++) {
+            smaller += index.occ.Count(c, end) - index.occ.Count(c, start - 1);
+        }
+        DNALength before = index.occ.Count(nuc, start - 1);
+        newStart = index.charCount[nuc] + before;
+        newSize  = index.occ.Count(nuc, end) - before;
+        newOtherStart = otherStart + smaller;
+    }
+};
+
+#endif // _BLASR_BIDIRECTIONAL_BWT_HPP_
@@ -9,6 +9,7 @@
 #include "../../pbdata/utils.hpp"
 #include "../../pbdata/matrix/Matrix.hpp"
 #include "../../pbdata/matrix/FlatMatrix.hpp"
+#include "RankBitVector.hpp"
 
 template<typename T_BWTSequence, typename T_Major, typename T_Minor>
 class Occ {
@@ -65,39 +66,60 @@ public:
         }
     }
 
+    //
+    // Size the bins for bwtSeq without filling them, for a builder
+    // that computes the counts itself.  Every bin is then written, so
+    // they are not cleared.
+    //
+    void AllocateBins(T_BWTSequence &bwtSeq,
+            int _majorBinSize=4096,
+            int _minorBinSize=64) {
+        bwtSeqRef    = &bwtSeq;
+        majorBinSize = _majorBinSize;
+        minorBinSize = _minorBinSize;
+        hasDebugInformation = 0;
+        numMajorBins = CeilOfFraction(bwtSeq.length, (DNALength) majorBinSize);
+        numMinorBins = CeilOfFraction(bwtSeq.length, (DNALength) minorBinSize);
+        major.Allocate(numMajorBins, AlphabetSize);
+        minor.Allocate(numMinorBins, AlphabetSize);
+    }
+
     void InitializeMajorBins(T_BWTSequence &bwtSeq) {
         numMajorBins = CeilOfFraction(bwtSeq.length, (DNALength) majorBinSize);
         major.Allocate(numMajorBins, AlphabetSize);
         std::vector<DNALength> runningTotal;
         runningTotal.resize(AlphabetSize);
-        fill(runningTotal.begin(), runningTotal.end(), 0);
-        fill(&major.matrix[0], &major.matrix[numMajorBins*AlphabetSize], 0);
+        std::fill(runningTotal.begin(), runningTotal.end(), 0);
+        std::fill(&major.matrix[0], &major.matrix[numMajorBins*AlphabetSize], 0);
         DNALength p;
         DNALength binIndex = 0;
         for (p = 0; p < bwtSeq.length; p++) {
-            Nucleotide nuc = ThreeBit[bwtSeq[p]];
-            // only handle ACTGN, $==6, so skip counting that.
-            if (nuc > AlphabetSize) continue;
             if (p % majorBinSize == 0) { //majorBinSize-1) {
                 //				cout << "storing at " << p<< " " << binIndex << std::endl;
-                int n;
+                unsigned int n;
                 for (n = 0; n < AlphabetSize; n++ ) {
                     major[binIndex][n] = runningTotal[n];
                 }
                 binIndex++;
             }
+            //
+            // Only handle ACTGN, $ is not counted.  The bin is stored
+            // first so that a $ at a bin boundary does not skip it.
+            //
+            Nucleotide nuc = ThreeBit[bwtSeq[p]];
+            if (nuc >= AlphabetSize) continue;
             runningTotal[nuc]++;
         }
     }
 
     void InitializeTestBins(T_BWTSequence &bwtSeq) {
         full.Allocate(bwtSeq.length, AlphabetSize);
-        fill(full.matrix, &full.matrix[bwtSeq.length * AlphabetSize],0);
+        std::fill(full.matrix, &full.matrix[bwtSeq.length * AlphabetSize],0);
         DNALength p;
-        int n;
+        unsigned int n;
         for (p = 0; p < bwtSeq.length; p++) {
             Nucleotide nuc = ThreeBit[bwtSeq[p]];
-            if (nuc > AlphabetSize) {
+            if (nuc >= AlphabetSize) {
                 for (n = 0; n < AlphabetSize; n++ ) {
                     full[p][n] = full[p-1][n];
                 }
@@ -125,23 +147,23 @@ public:
         DNALength p;
         DNALength minorBinIndex = 0;
         for (p = 0; p < bwtSeq.length; p++ ){
-            Nucleotide nuc = ThreeBit[bwtSeq[p]];
-            if (nuc > AlphabetSize) continue;
             //
             //  The minor bins are running totals inside each major
             //  bin. When the count hits a bin offset, reset the bin
             //  counter. 
             //  
             if (p % majorBinSize == 0) {
-                fill(majorRunningTotal.begin(), majorRunningTotal.end(), 0);				
+                std::fill(majorRunningTotal.begin(), majorRunningTotal.end(), 0);				
             }
             if (p % minorBinSize == 0) {
-                int n;
+                unsigned int n;
                 for (n = 0; n < AlphabetSize; n++ ) {
                     minor[minorBinIndex][n] = majorRunningTotal[n];
                 }
                 minorBinIndex++;
             }
+            Nucleotide nuc = ThreeBit[bwtSeq[p]];
+            if (nuc >= AlphabetSize) continue;
             majorRunningTotal[nuc]++;
         }
     }
@@ -156,11 +178,35 @@ public:
         //
         Nucleotide smallNuc = ThreeBit[nuc];
         //assert(smallNuc < 5);
+        //
+        // Scan from whichever end of the minor bin is closer to p.
+        //
+        DNALength nextBinnedIndex = lastBinnedIndex + minorBinSize;
+        if (p + 1 - lastBinnedIndex > (DNALength) minorBinSize / 2 and
+            nextBinnedIndex < bwtSeqRef->length) {
+            DNALength nextCount;
+            if (nextBinnedIndex % majorBinSize == 0) {
+                nextCount = major[nextBinnedIndex / majorBinSize][smallNuc];
+            }
+            else {
+                nextCount = major[majorIndex][smallNuc] + minor[minorIndex + 1][smallNuc];
+            }
+            return nextCount - bwtSeqRef->CountNuc(p + 1, nextBinnedIndex, nuc);
+        }
         DNALength nocc = major[majorIndex][smallNuc] + minor[minorIndex][smallNuc] + bwtSeqRef->CountNuc(lastBinnedIndex, p+1, nuc);
         //		assert(full.matrix == NULL or full[p][smallNuc] == nocc);
         return nocc;
     }
 
+    //
+    // Prefetch the bins and sequence that Count(nuc, p) reads.
+    //
+    void Prefetch(DNALength p) {
+        BWT_PREFETCH(minor[p / minorBinSize]);
+        BWT_PREFETCH(major[p / majorBinSize]);
+        BWT_PREFETCH(&bwtSeqRef->seq[p / T_BWTSequence::NucsPerWord]);
+    }
+
     void Write(std::ostream &out) {
         out.write((char*) &majorBinSize, sizeof(majorBinSize));
         out.write((char*) &minorBinSize, sizeof(minorBinSize));
@@ -328,8 +328,18 @@ public:
     }
 
     void Read(std::istream &in) {
+        DNALength tableLengthP;
+        in.read((char*)&tableLengthP, sizeof(tableLengthP));
+        ReadTables(in, tableLengthP);
+    }
+
+    //
+    // Read everything after the table length, which the caller has
+    // already read.
+    //
+    void ReadTables(std::istream &in, DNALength tableLengthP) {
         Free();
-        in.read((char*)&tableLength, sizeof(tableLength));
+        tableLength = tableLengthP;
         if (tableLength > 0) {
             table  = ProtectedNew<uint32_t>(tableLength);
             values = ProtectedNew<uint64_t>(tableLength);
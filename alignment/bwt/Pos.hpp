@@ -5,42 +5,120 @@
 #include <vector>
 
 #include "PackedHash.hpp"
+#include "RankBitVector.hpp"
 
 #include "../../pbdata/DNASequence.hpp"
 #include "../../pbdata/Types.h"
 #include "../../pbdata/utils/BitUtils.hpp"
 
+//
+// The sampled suffix array of a BWT: the text position of every
+// suffix that starts at a multiple of stride.  A larger stride uses
+// proportionally less space, and makes a locate take up to stride LF
+// steps.  Whether a row is sampled is a bit in a rank bit vector, and
+// the rank of that bit indexes the positions, which are stored in row
+// order.
+//
+// Older files store the samples in a PackedHash with a fixed stride of
+// 8; these are converted when read.  Files are written in the new
+// format, which begins with PosFormatTag where the PackedHash began
+// with its table length.
+//
+#define POS_DEFAULT_STRIDE 8
+
 template< typename T_BWT_Sequence>
 class Pos {
 public:
-    static const unsigned int stride=8;
-    PackedHash packedHash;
+    static const DNALength PosFormatTag = (DNALength) -1;
+    DNALength stride;
+    RankBitVector sampled;
+    std::vector<DNALength> values;
     std::vector<int> hashCount;
     std::vector<int> fullPos;
     int hasDebugInformation;
+
+    Pos() {
+        stride = POS_DEFAULT_STRIDE;
+        hasDebugInformation = 0;
+    }
+
     void Write(std::ostream &out) {
-        packedHash.Write(out);
+        DNALength tag = PosFormatTag;
+        DNALength nValues = values.size();
+        out.write((char*) &tag, sizeof(tag));
+        out.write((char*) &stride, sizeof(stride));
+        sampled.Write(out);
+        out.write((char*) &nValues, sizeof(nValues));
+        if (nValues > 0) {
+            out.write((char*) &values[0], sizeof(DNALength) * nValues);
+        }
     }
 
     void Read(std::istream &in) {
-        packedHash.Read(in);
+        DNALength tag;
+        in.read((char*) &tag, sizeof(tag));
+        if (tag != PosFormatTag) {
+            ReadPackedHash(in, tag);
+            return;
+        }
+        DNALength nValues;
+        in.read((char*) &stride, sizeof(stride));
+        sampled.Read(in);
+        in.read((char*) &nValues, sizeof(nValues));
+        values.resize(nValues);
+        if (nValues > 0) {
+            in.read((char*) &values[0], sizeof(DNALength) * nValues);
+        }
     }
 
-    void InitializeFromSuffixArray(DNALength suffixArray[], DNALength suffixArrayLength) {
+    void InitializeFromSuffixArray(DNALength suffixArray[], DNALength suffixArrayLength,
+        DNALength strideP=POS_DEFAULT_STRIDE) {
         DNALength p;
-        packedHash.Allocate(suffixArrayLength);
-        std::fill(hashCount.begin(), hashCount.end(), 0);
+        stride = strideP;
+        sampled.Allocate(suffixArrayLength);
+        values.clear();
         for (p = 0; p < suffixArrayLength; p++ ){
             if (suffixArray[p] % stride==0){
-                packedHash.AddValue(p,suffixArray[p]);
+                sampled.Set(p);
+                values.push_back(suffixArray[p]);
             }
         }
+        sampled.BuildRank();
     }
 
     int Lookup(DNALength bwtPos, DNALength &seqPos) {
-        return packedHash.LookupValue(bwtPos-1, seqPos);
+        if (!sampled.Get(bwtPos - 1)) {
+            return 0;
+        }
+        seqPos = values[sampled.Rank(bwtPos - 1)];
+        return 1;
+    }
+
+    void Prefetch(DNALength bwtPos) const {
+        sampled.Prefetch(bwtPos - 1);
     }
 
+private:
+    //
+    // Read the PackedHash of an older file, whose table length has
+    // already been read, into the bit vector and values.
+    //
+    void ReadPackedHash(std::istream &in, DNALength tableLength) {
+        PackedHash packedHash;
+        packedHash.ReadTables(in, tableLength);
+        stride = POS_DEFAULT_STRIDE;
+        sampled.Allocate(tableLength * PackedHash::BinSize);
+        values.clear();
+        DNALength p, value;
+        for (p = 0; p < sampled.length; p++) {
+            if (packedHash.LookupBinAtPos(p)) {
+                packedHash.LookupValue(p, value);
+                sampled.Set(p);
+                values.push_back(value);
+            }
+        }
+        sampled.BuildRank();
+    }
 };
 
 
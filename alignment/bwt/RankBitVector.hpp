@@ -0,0 +1,109 @@
+#ifndef _BLASR_RANK_BIT_VECTOR_HPP_
+#define _BLASR_RANK_BIT_VECTOR_HPP_
+
+#include <bitset>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "../../pbdata/Types.h"
+
+//
+// Hint that addr will be read soon.  Used to overlap the cache misses
+// of many independent lookups.
+//
+#if defined(__GNUC__)
+#define BWT_PREFETCH(addr) __builtin_prefetch((const void*) (addr))
+#else
+#define BWT_PREFETCH(addr)
+#endif
+
+//
+// A bit vector with constant time rank.  The number of set bits before
+// each block of RankBlockWords words is stored in full, and the number
+// before each word relative to its block in 16 bits, so rank is two
+// table lookups and one popcount, for 1/32 extra space over the bits.
+//
+class RankBitVector {
+public:
+    static const DNALength RankBlockWords = 1024;
+    DNALength length;
+    std::vector<uint64_t> words;
+    std::vector<DNALength> blockRank;
+    std::vector<uint16_t> wordRank;
+
+    RankBitVector() {
+        length = 0;
+    }
+
+    void Allocate(DNALength lengthP) {
+        length = lengthP;
+        words.assign((length + 63) / 64, 0);
+        blockRank.clear();
+        wordRank.clear();
+    }
+
+    void Set(DNALength pos) {
+        words[pos / 64] |= ((uint64_t) 1) << (pos % 64);
+    }
+
+    bool Get(DNALength pos) const {
+        return (words[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    //
+    // Build the rank tables; call once all bits are set.
+    //
+    void BuildRank() {
+        DNALength nWords = words.size();
+        blockRank.resize(nWords / RankBlockWords + 1);
+        wordRank.resize(nWords);
+        DNALength total = 0, inBlock = 0, w;
+        for (w = 0; w < nWords; w++) {
+            if (w % RankBlockWords == 0) {
+                blockRank[w / RankBlockWords] = total;
+                inBlock = 0;
+            }
+            wordRank[w] = inBlock;
+            DNALength nSet = std::bitset<64>(words[w]).count();
+            inBlock += nSet;
+            total   += nSet;
+        }
+    }
+
+    //
+    // The number of set bits in [0, pos).
+    //
+    DNALength Rank(DNALength pos) const {
+        DNALength w = pos / 64;
+        uint64_t below = words[w] & ((((uint64_t) 1) << (pos % 64)) - 1);
+        return blockRank[w / RankBlockWords] + wordRank[w] +
+            std::bitset<64>(below).count();
+    }
+
+    void Prefetch(DNALength pos) const {
+        BWT_PREFETCH(&words[pos / 64]);
+        BWT_PREFETCH(&wordRank[pos / 64]);
+    }
+
+    void Write(std::ostream &out) {
+        DNALength nWords = words.size();
+        out.write((char*) &length, sizeof(length));
+        out.write((char*) &nWords, sizeof(nWords));
+        if (nWords > 0) {
+            out.write((char*) &words[0], sizeof(uint64_t) * nWords);
+        }
+    }
+
+    void Read(std::istream &in) {
+        DNALength nWords;
+        in.read((char*) &length, sizeof(length));
+        in.read((char*) &nWords, sizeof(nWords));
+        words.resize(nWords);
+        if (nWords > 0) {
+            in.read((char*) &words[0], sizeof(uint64_t) * nWords);
+        }
+        BuildRank();
+    }
+};
+
+#endif // _BLASR_RANK_BIT_VECTOR_HPP_
@@ -57,3 +57,68 @@ std::ostream& operator<<(std::ostream & out, ChainedMatchPos &p) {
     out << p.q << "\t" << p.t <<"\t"<< p.l << "\t"<< p.m;
     return out;
 }
+
+void RadixSortByKey(std::vector<KeyedIndex> &keys, 
+    std::vector<KeyedIndex> &buffer) {
+    const int digitBits = 8;
+    const VectorIndex nBuckets = 1 << digitBits;
+    VectorIndex n = keys.size();
+    if (n < 2) {
+        return;
+    }
+    //
+    // The passes over the buckets cost more than a comparison sort
+    // on short lists, such as the anchors of one LIS, and those are
+    // sorted without allocating.
+    //
+    VectorIndex i;
+    if (n <= 32) {
+        for (i = 1; i < n; i++) {
+            KeyedIndex cur = keys[i];
+            VectorIndex j = i;
+            while (j > 0 and cur.key < keys[j-1].key) {
+                keys[j] = keys[j-1];
+                j--;
+            }
+            keys[j] = cur;
+        }
+        return;
+    }
+    if (n < nBuckets) {
+        std::stable_sort(keys.begin(), keys.end());
+        return;
+    }
+    //
+    // Bits that differ between any two keys are set in varying.
+    //
+    uint64_t allSet = ~((uint64_t)0), anySet = 0;
+    for (i = 0; i < n; i++) {
+        allSet &= keys[i].key;
+        anySet |= keys[i].key;
+    }
+    uint64_t varying = allSet ^ anySet;
+
+    VectorIndex count[nBuckets];
+    buffer.resize(n);
+    int shift;
+    for (shift = 0; shift < 64; shift += digitBits) {
+        if (((varying >> shift) & (nBuckets - 1)) == 0) {
+            continue;
+        }
+        std::fill(count, count + nBuckets, 0);
+        for (i = 0; i < n; i++) {
+            count[(keys[i].key >> shift) & (nBuckets - 1)]++;
+        }
+        VectorIndex total = 0, c;
+        VectorIndex b;
+        for (b = 0; b < nBuckets; b++) {
+            c = count[b];
+            count[b] = total;
+            total += c;
+        }
+        for (i = 0; i < n; i++) {
+            buffer[count[(keys[i].key >> shift) & (nBuckets - 1)]++] = keys[i];
+        }
+        keys.swap(buffer);
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <stdint.h>
 #include <ostream>
 #include "../../../pbdata/Types.h"
 #include "../../../pbdata/DNASequence.hpp"
@@ -169,9 +170,67 @@ class CompareMatchPosIndexByTextPos {
 };
 
 
+//
+// A sort key along with the index of the anchor it belongs to.
+//
+class KeyedIndex {
+public:
+    uint64_t key;
+    VectorIndex index;
+    int operator<(const KeyedIndex &rhs) const {
+        return key < rhs.key;
+    }
+};
+
+//
+// Stable LSD radix sort of keys, 8 bits per pass.  Passes over digits
+// that are the same in all keys are skipped.
+//
+void RadixSortByKey(std::vector<KeyedIndex> &keys, 
+    std::vector<KeyedIndex> &buffer);
+
+//
+// Sort by target then query position, in place.  The positions are
+// radix sorted as one 64 bit key, and the anchors are then moved
+// along the cycles of the permutation; anchors at the same position
+// keep their order.  keys and buffer are scratch space that callers
+// sorting many lists may keep between calls.
+//
+template<typename T_MatchPos>
+void SortMatchPosList(std::vector<T_MatchPos> &mpl, 
+    std::vector<KeyedIndex> &keys, std::vector<KeyedIndex> &buffer) {
+    VectorIndex n = mpl.size();
+    keys.resize(n);
+    VectorIndex i;
+    for (i = 0; i < n; i++) {
+        keys[i].key   = (((uint64_t) mpl[i].t) << 32) | mpl[i].q;
+        keys[i].index = i;
+    }
+    RadixSortByKey(keys, buffer);
+    //
+    // Anchor i is to be what is now anchor keys[i].index.  Each index
+    // is set to its own position once its anchor is in place.
+    //
+    for (i = 0; i < n; i++) {
+        if (keys[i].index == i) {
+            continue;
+        }
+        T_MatchPos first = mpl[i];
+        VectorIndex cur = i, next;
+        while ((next = keys[cur].index) != i) {
+            mpl[cur] = mpl[next];
+            keys[cur].index = cur;
+            cur = next;
+        }
+        mpl[cur] = first;
+        keys[cur].index = cur;
+    }
+}
+
 template<typename T_MatchPos>
 void SortMatchPosList(std::vector<T_MatchPos> &mpl) {
-    std::sort(mpl.begin(), mpl.end(), CompareMatchPos<T_MatchPos>());
+    std::vector<KeyedIndex> keys, buffer;
+    SortMatchPosList(mpl, keys, buffer);
 }
 
 template<typename T_MatchPos>
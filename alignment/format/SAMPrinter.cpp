@@ -1,5 +1,6 @@
 #include "SAMPrinter.hpp"
 #include <algorithm> //reverse
+#include "../algorithms/alignment/AlignmentBlockStats.hpp"
 
 using namespace SAMOutput; 
 
@@ -80,22 +81,8 @@ void SAMOutput::AddMatchBlockCigarOps(DNASequence & qSeq, DNASequence & tSeq,
         blasr::Block & b, DNALength & qSeqPos, DNALength & tSeqPos,
         std::vector<int> & opSize, std::vector<char> & opChar) {
     DNALength qPos = qSeqPos + b.qPos, tPos = tSeqPos + b.tPos;
-    bool started = false, prevSeqMatch = false;
-    for(DNALength i = 0; i < b.length; i++) {
-        bool curSeqMatch = (qSeq[qPos + i] == tSeq[tPos + i]);
-        if (started) {
-            if (curSeqMatch == prevSeqMatch) opSize[opSize.size()-1]++;
-            else {
-                opSize.push_back(1);
-                opChar.push_back(curSeqMatch?'=':'X');
-            }
-        } else {
-            started = true;
-            opSize.push_back(1);
-            opChar.push_back(curSeqMatch?'=':'X');
-        }
-        prevSeqMatch = curSeqMatch;
-    }
+    AppendMatchRunOps(&qSeq.seq[qPos], &tSeq.seq[tPos], b.length,
+        MatchExactBase, opSize, opChar);
 }
 
 void SAMOutput::MergeAdjacentIndels(std::vector<int> &opSize, 
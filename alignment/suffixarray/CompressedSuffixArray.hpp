@@ -0,0 +1,282 @@
+#ifndef _BLASR_COMPRESSED_SUFFIX_ARRAY_HPP_
+#define _BLASR_COMPRESSED_SUFFIX_ARRAY_HPP_
+
+#include <string>
+#include <vector>
+#include "../../pbdata/defs.h"
+#include "../../pbdata/Types.h"
+#include "../../pbdata/FASTASequence.hpp"
+#include "../../pbdata/NucConversion.hpp"
+#include "../bwt/BidirectionalBWT.hpp"
+#include "../bwt/BWTBuilder.hpp"
+#include "SuffixArray.hpp"
+
+//
+// The default suffix array sampling rate of a CompressedSuffixArray,
+// and the default length of the prefixes in its lookup table.
+//
+#define CSA_DEFAULT_STRIDE 32
+#define CSA_DEFAULT_LOOKUP_LENGTH 8
+
+//
+// A suffix array of a reference stored as an FM index, which can be
+// searched by the same anchoring code as a SuffixArray
+// (LocateAnchorBoundsInSuffixArray and MapReadToGenome) with a
+// fraction of the memory.
+//
+// Row r of the suffix array is row r+1 of the BWT of the reference.
+// A match is extended one base to the right by a rank query on a BWT
+// of the reversed reference (see BidirectionalBWT), so the bounds
+// stored by StoreLCPBounds are those a SuffixArray stores.  index[r]
+// is not stored but found by LF steps from row r to the nearest row
+// whose text position is a multiple of posStride.
+//
+// The index takes about 1.25 + 4/posStride bytes per base, against
+// 4 bytes per base for a SuffixArray: each BWT packs 10 bases into 32
+// bits with occurrence bins beside them, and only the forward BWT
+// holds samples.  For a human genome that is 4.2 GB with the default
+// stride of 32 and 3.9 GB with a stride of 64; each doubling of the
+// stride roughly doubles the time to look up an anchor position.
+//
+// The rows are in the order of the BWT, with N after T, which differs
+// from a SuffixArray sorted by ascii where the reference has N's.  The
+// anchors found are the same.
+//
+class CompressedSuffixArray {
+public:
+    //
+    // The text positions of the rows, looked up in the forward BWT.
+    //
+    class SampledIndex {
+    public:
+        BWT *bwt;
+        SampledIndex() {
+            bwt = NULL;
+        }
+        DNALength operator[](SAIndex row) {
+            return bwt->Locate(row + 1);
+        }
+    };
+
+    BidirectionalBWT bwt;
+    SampledIndex index;
+    SAIndex length;
+    SAIndex lookupPrefixLength;
+    //
+    // The interval of each prefix of lookupPrefixLength bases, indexed
+    // by its two bit code with the first base most significant.
+    //
+    std::vector<BiInterval> lookupTable;
+
+    CompressedSuffixArray() {
+        index.bwt = &bwt.forward;
+        length = 0;
+        lookupPrefixLength = 0;
+    }
+
+    //
+    // Build both BWTs from seq, which must contain only ACGTN, sorting
+    // the suffixes of each direction in turn.  Building holds one
+    // suffix array at a time.
+    //
+    void Build(FASTASequence &seq, DNALength posStride=CSA_DEFAULT_STRIDE,
+        int lookupPrefixLengthP=CSA_DEFAULT_LOOKUP_LENGTH, int nThreads=1,
+        int diffCoverSize=2281) {
+        FASTASequence reverseSeq;
+        reverseSeq.Allocate(seq.length);
+        DNALength i;
+        for (i = 0; i < seq.length; i++) {
+            reverseSeq.seq[i] = seq.seq[seq.length - 1 - i];
+        }
+        BuildBWT(seq, bwt.forward, posStride, nThreads, diffCoverSize);
+        BuildBWT(reverseSeq, bwt.reverse, reverseSeq.length + 1, nThreads, diffCoverSize);
+        reverseSeq.Free();
+        //
+        // Positions are only looked up in the forward BWT.
+        //
+        bwt.reverse.pos.sampled.Allocate(0);
+        bwt.reverse.pos.sampled.BuildRank();
+        bwt.reverse.pos.values.clear();
+        length = seq.length;
+        BuildLookupTable(lookupPrefixLengthP);
+    }
+
+    void Write(std::string forwardName, std::string reverseName) {
+        bwt.Write(forwardName, reverseName);
+    }
+
+    int Read(std::string forwardName, std::string reverseName,
+        int lookupPrefixLengthP=CSA_DEFAULT_LOOKUP_LENGTH) {
+        if (!bwt.Read(forwardName, reverseName)) {
+            return 0;
+        }
+        length = bwt.forward.bwtSequence.length - 1;
+        BuildLookupTable(lookupPrefixLengthP);
+        return 1;
+    }
+
+    //
+    // Fill the lookup table by extending every prefix of up to
+    // prefixLength bases; it holds 4^prefixLength intervals.
+    //
+    void BuildLookupTable(int prefixLength) {
+        lookupPrefixLength = prefixLength;
+        lookupTable.clear();
+        if (lookupPrefixLength == 0) {
+            return;
+        }
+        lookupTable.resize(((VectorIndex) 1) << (2 * lookupPrefixLength));
+        Nucleotide nuc;
+        for (nuc = 0; nuc < 4; nuc++) {
+            BiInterval interval;
+            bwt.Initialize(nuc, interval);
+            FillLookupTable(interval, nuc, 1);
+        }
+    }
+
+    //
+    // Set [low, high) to the rows whose suffixes begin with query, and
+    // return their number.
+    //
+    template<typename T_Text>
+    int Search(const T_Text &target, Nucleotide *query, DNALength queryLength,
+        SAIndex &low, SAIndex &high) {
+        PB_UNUSED(target);
+        BiInterval interval;
+        DNALength q;
+        low = high = 0;
+        for (q = 0; q < queryLength; q++) {
+            if (!Extend(interval, q, query[q])) {
+                return 0;
+            }
+        }
+        if (queryLength > 0) {
+            low  = interval.forwardStart - 1;
+            high = low + interval.size;
+        }
+        return high - low;
+    }
+
+    //
+    // The same search as SuffixArray::StoreLCPBounds: append the rows
+    // [lcpLeftBounds[i], lcpRightBounds[i]) that match each prefix of
+    // query that is found, and return the length of the last one.  The
+    // reference is not read.
+    //
+    template<typename T_Text>
+    int StoreLCPBounds(const T_Text &target, long targetLength,
+        Nucleotide *query, DNALength queryLength,
+        bool useLookupTable, DNALength maxMatchLength,
+        std::vector<SAIndex> &lcpLeftBounds, std::vector<SAIndex> &lcpRightBounds,
+        bool stopOnceUnique=false) {
+        PB_UNUSED(target);
+        PB_UNUSED(targetLength);
+        BiInterval interval;
+        DNALength lcpLength = 0;
+
+        if (useLookupTable and lookupPrefixLength > 0) {
+            VectorIndex key = 0;
+            if (queryLength < lookupPrefixLength) {
+                return 0;
+            }
+            for (lcpLength = 0; lcpLength < lookupPrefixLength; lcpLength++) {
+                Nucleotide nuc = ThreeBit[query[lcpLength]];
+                if (nuc >= 4) {
+                    return 0;
+                }
+                key = (key << 2) + nuc;
+            }
+            interval = lookupTable[key];
+            if (interval.size == 0) {
+                return 0;
+            }
+            PushBounds(interval, lcpLeftBounds, lcpRightBounds);
+        }
+
+        while (lcpLength < queryLength) {
+            if (stopOnceUnique and interval.size == 1) {
+                break;
+            }
+            if (maxMatchLength and lcpLength >= maxMatchLength) {
+                break;
+            }
+            //
+            // An N in the read, or only N's in the reference, ends the
+            // match as in a SuffixArray.
+            //
+            if (!Extend(interval, lcpLength, query[lcpLength])) {
+                break;
+            }
+            PushBounds(interval, lcpLeftBounds, lcpRightBounds);
+            lcpLength++;
+        }
+        return lcpLength;
+    }
+
+private:
+    //
+    // Extend interval, the match of the first depth bases of a query,
+    // by c.  Returns false if c is not ACGT or the match ends.
+    //
+    bool Extend(BiInterval &interval, DNALength depth, Nucleotide c) {
+        Nucleotide nuc = ThreeBit[c];
+        if (nuc >= 4) {
+            return false;
+        }
+        BiInterval extended;
+        if (depth == 0) {
+            bwt.Initialize(nuc, extended);
+        }
+        else {
+            bwt.ExtendRight(interval, nuc, extended);
+        }
+        if (extended.size == 0) {
+            return false;
+        }
+        interval = extended;
+        return true;
+    }
+
+    void PushBounds(BiInterval &interval, std::vector<SAIndex> &lcpLeftBounds,
+        std::vector<SAIndex> &lcpRightBounds) {
+        lcpLeftBounds.push_back(interval.forwardStart - 1);
+        lcpRightBounds.push_back(interval.forwardStart - 1 + interval.size);
+    }
+
+    void FillLookupTable(BiInterval &interval, VectorIndex key, SAIndex depth) {
+        if (depth == lookupPrefixLength) {
+            lookupTable[key] = interval;
+            return;
+        }
+        Nucleotide nuc;
+        for (nuc = 0; nuc < 4; nuc++) {
+            BiInterval extended;
+            if (interval.size > 0) {
+                bwt.ExtendRight(interval, nuc, extended);
+            }
+            FillLookupTable(extended, (key << 2) + nuc, depth + 1);
+        }
+    }
+
+    //
+    // The suffix array is sorted on the ThreeBit codes of the text,
+    // which order N after T as the BWT does.
+    //
+    void BuildBWT(FASTASequence &seq, BWT &index, DNALength posStride, int nThreads,
+        int diffCoverSize) {
+        std::vector<Nucleotide> codes(seq.length + diffCoverSize + 1, 0);
+        DNALength i;
+        for (i = 0; i < seq.length; i++) {
+            codes[i] = ThreeBit[seq.seq[i]];
+        }
+        SuffixArray<Nucleotide, std::vector<int> > sa;
+        sa.LightweightBuildSuffixArray(&codes[0], seq.length, diffCoverSize, nThreads);
+        std::vector<Nucleotide>().swap(codes);
+        SuffixArrayBlockSource source;
+        source.SetArray(sa.index, seq.length);
+        BWTBuilder builder;
+        builder.Build(seq, source, index, nThreads, posStride);
+    }
+};
+
+#endif // _BLASR_COMPRESSED_SUFFIX_ARRAY_HPP_
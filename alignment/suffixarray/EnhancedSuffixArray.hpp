@@ -0,0 +1,249 @@
+#ifndef _BLASR_ENHANCED_SUFFIX_ARRAY_HPP_
+#define _BLASR_ENHANCED_SUFFIX_ARRAY_HPP_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../../pbdata/Types.h"
+#include "../../pbdata/utils.hpp"
+#include "LCPTable.hpp"
+
+//
+// LCP values of at least ESA_LCP_OVERFLOW are stored in the exception
+// table of an EnhancedSuffixArray rather than in its byte array.
+//
+#define ESA_LCP_OVERFLOW 255
+
+//
+// Characters are equal when Compare orders them the same, so that
+// the LCPs of a suffix array sorted in that order break where the
+// array does.
+//
+template<typename T, typename Compare>
+class CompareByOrder : public Compare {
+public:
+    static int Equal(T a, T b) {
+        return Compare::Compare(a, b) == 0;
+    }
+};
+
+//
+// The LCP array and child table of a suffix array (Abouelhoda, Kurtz
+// and Ohlebusch, 2004), which together describe the suffix tree: the
+// rows of every internal node form an lcp-interval [i..j], and its
+// children can be listed in time proportional to their number.  This
+// lets a pattern be matched top down in O(m) character comparisons
+// instead of a binary search per character.
+//
+// Row i of lcp is the LCP of the suffixes in rows i-1 and i; rows 0
+// and length are taken to be -1.  The up, down and next l-index values
+// of the child table are kept in one array: up[i+1] in child[i] when
+// lcp[i] > lcp[i+1], otherwise next l-index[i] when it exists, and
+// down[i] if not.  Each slot is needed for at most one of them.
+//
+// Build takes the Compare of the suffix array, and the array must be
+// sorted in its order, as the binary search and lookup table of
+// SuffixArray expect.  For DNA this is the order of the ThreeBit
+// codes, which puts N after T and lowercase with uppercase.
+//
+// The arrays are written to their own file next to the suffix array,
+// and are only used by a SuffixArray that reads one.
+//
+class EnhancedSuffixArray {
+public:
+    static const unsigned int MagicNumber = 0xacac0e5a;
+    DNALength length;
+    std::vector<unsigned char> lcp;
+    LongPrefixTable longLCP;
+    std::vector<DNALength> child;
+
+    EnhancedSuffixArray() {
+        length = 0;
+    }
+
+    bool IsLoaded() const {
+        return length > 0;
+    }
+
+    void Free() {
+        length = 0;
+        std::vector<unsigned char>().swap(lcp);
+        std::vector<DNALength>().swap(child);
+        longLCP.Clear();
+    }
+
+    long LCP(DNALength i) const {
+        if (i == 0 or i >= length) {
+            return -1;
+        }
+        if (lcp[i] == ESA_LCP_OVERFLOW) {
+            return longLCP.Find(i);
+        }
+        return lcp[i];
+    }
+
+    //
+    // The first row after i of the next child of the lcp-interval
+    // holding i as an l-index, if i is not in its last child.
+    //
+    bool NextLIndex(DNALength i, DNALength &next) const {
+        next = child[i];
+        return next > i and next < length and LCP(next) == LCP(i);
+    }
+
+    //
+    // The first row of the second child of the lcp-interval [i..j],
+    // which also splits it at its lcp value.
+    //
+    DNALength FirstLIndex(DNALength i, DNALength j) const {
+        DNALength up = child[j];
+        if (i < up and up <= j) {
+            return up;
+        }
+        return child[i];
+    }
+
+    //
+    // The length of the prefix shared by the suffixes of the
+    // lcp-interval [i..j], i < j.
+    //
+    DNALength IntervalLCP(DNALength i, DNALength j) const {
+        return LCP(FirstLIndex(i, j));
+    }
+
+    //
+    // Append the first row of each child of the lcp-interval [i..j],
+    // i < j, to starts.  Child k covers rows starts[k] up to the next
+    // start, or to j for the last one.
+    //
+    void ChildIntervals(DNALength i, DNALength j, std::vector<DNALength> &starts) const {
+        starts.push_back(i);
+        DNALength next = FirstLIndex(i, j);
+        starts.push_back(next);
+        while (NextLIndex(next, next)) {
+            starts.push_back(next);
+        }
+    }
+
+    template<typename T, typename Compare>
+    void Build(T *text, DNALength textLength, unsigned int *index, int nThreads=1) {
+        Free();
+        if (textLength == 0) {
+            return;
+        }
+        std::vector<DNALength> fullLCP(textLength);
+        LCPArrayBuilder<T, CompareByOrder<T, Compare> > lcpBuilder;
+        lcpBuilder.Build(text, textLength, index, &fullLCP[0], nThreads);
+
+        length = textLength;
+        lcp.resize(length);
+        DNALength i;
+        for (i = 0; i < length; i++) {
+            if (fullLCP[i] >= ESA_LCP_OVERFLOW) {
+                lcp[i] = ESA_LCP_OVERFLOW;
+                longLCP.Add(i, fullLCP[i]);
+            }
+            else {
+                lcp[i] = fullLCP[i];
+            }
+        }
+        longLCP.Sort();
+        BuildChildTable(fullLCP);
+    }
+
+    int Write(std::string fileName) {
+        std::ofstream out;
+        CrucialOpen(fileName, out, std::ios::binary|std::ios::out);
+        unsigned int magic = MagicNumber;
+        out.write((char*) &magic, sizeof(magic));
+        out.write((char*) &length, sizeof(length));
+        if (length > 0) {
+            out.write((char*) &lcp[0], sizeof(unsigned char) * length);
+            out.write((char*) &child[0], sizeof(DNALength) * length);
+        }
+        longLCP.Write(out);
+        return out.good();
+    }
+
+    int Read(std::string fileName) {
+        std::ifstream in;
+        CrucialOpen(fileName, in, std::ios::binary|std::ios::in);
+        Free();
+        unsigned int magic;
+        DNALength fileLength;
+        in.read((char*) &magic, sizeof(magic));
+        if (magic != MagicNumber) {
+            return 0;
+        }
+        in.read((char*) &fileLength, sizeof(fileLength));
+        if (fileLength > 0) {
+            lcp.resize(fileLength);
+            child.resize(fileLength);
+            in.read((char*) &lcp[0], sizeof(unsigned char) * fileLength);
+            in.read((char*) &child[0], sizeof(DNALength) * fileLength);
+        }
+        longLCP.Read(in);
+        if (!in.good()) {
+            Free();
+            return 0;
+        }
+        length = fileLength;
+        return 1;
+    }
+
+private:
+    static long FullLCP(std::vector<DNALength> &fullLCP, DNALength i) {
+        if (i == 0 or i >= fullLCP.size()) {
+            return -1;
+        }
+        return fullLCP[i];
+    }
+
+    //
+    // The stack based constructions of the up/down and next l-index
+    // values, each written to the slot that holds it.  A next l-index
+    // overwrites a down value, which is then never needed.
+    //
+    void BuildChildTable(std::vector<DNALength> &fullLCP) {
+        child.assign(length, 0);
+        std::vector<DNALength> stack;
+        DNALength i, last;
+        bool hasLast = false;
+        stack.push_back(0);
+        for (i = 1; i <= length; i++) {
+            long iLCP = FullLCP(fullLCP, i);
+            while (iLCP < FullLCP(fullLCP, stack.back())) {
+                last = stack.back();
+                stack.pop_back();
+                hasLast = true;
+                long topLCP = FullLCP(fullLCP, stack.back());
+                if (iLCP <= topLCP and topLCP != FullLCP(fullLCP, last)) {
+                    child[stack.back()] = last;
+                }
+            }
+            if (hasLast) {
+                child[i - 1] = last;
+                hasLast = false;
+            }
+            stack.push_back(i);
+        }
+
+        stack.clear();
+        stack.push_back(0);
+        for (i = 1; i <= length; i++) {
+            long iLCP = FullLCP(fullLCP, i);
+            while (iLCP < FullLCP(fullLCP, stack.back())) {
+                stack.pop_back();
+            }
+            if (iLCP == FullLCP(fullLCP, stack.back())) {
+                if (stack.back() > 0 and i < length) {
+                    child[stack.back()] = i;
+                }
+                stack.pop_back();
+            }
+            stack.push_back(i);
+        }
+    }
+};
+
+#endif // _BLASR_ENHANCED_SUFFIX_ARRAY_HPP_
@@ -1,100 +1,317 @@
 #ifndef _BLASR_LCP_TABLE_HPP_
 #define _BLASR_LCP_TABLE_HPP_
 
-#include <map>
+#include <pthread.h>
+#include <assert.h>
+#include <algorithm>
 #include <fstream>
+#include <utility>
+#include <vector>
+#include "../../pbdata/defs.h"
 #include "../../pbdata/utils.hpp"
+#include "../../pbdata/Types.h"
+#include "../../pbdata/NucConversion.hpp"
+#include "../algorithms/compare/CompareStrings.hpp"
 
-template <typename T>
+//
+// The number of text positions given to a thread at a time when
+// computing an LCP array.
+//
+#define LCP_ARRAY_BLOCK_SIZE (1 << 20)
+
+//
+// Computes the LCP array of a suffix array in linear time with the
+// permuted LCP (Phi) formulation of Kasai's algorithm: Phi[i] is the
+// suffix before suffix i in the suffix array, the LCP of each suffix
+// with that one is computed in text order, where it falls by at most
+// one from one position to the next, and the result is permuted into
+// suffix array order.  Phi and the permuted LCP share one array.
+//
+// Text positions are processed in blocks that may be given to
+// separate threads; a block starts its first comparison from zero,
+// which costs one extra match length per block.  The suffix array must
+// be sorted consistently with Compare::Equal.
+//
+template<typename T, typename Compare = DefaultCompareStrings<T> >
+class LCPArrayBuilder {
+public:
+    T *text;
+    DNALength textLength;
+    unsigned int *index;
+    DNALength *lcp;
+    std::vector<DNALength> plcp;
+    DNALength nBlocks;
+    int nThreads;
+
+    class Thread {
+    public:
+        LCPArrayBuilder *builder;
+        int index;
+        bool permute;
+    };
+
+    //
+    // Set lcp[i] to the length of the longest common prefix of the
+    // suffixes at index[i-1] and index[i], and lcp[0] to 0.
+    //
+    void Build(T *textP, DNALength textLengthP, unsigned int *indexP, DNALength *lcpP,
+        int nThreadsP=1) {
+        lcp = lcpP;
+        BuildPermuted(textP, textLengthP, indexP, nThreadsP);
+        if (textLength == 0) {
+            return;
+        }
+        RunThreads(true);
+        lcp[0] = 0;
+        std::vector<DNALength>().swap(plcp);
+    }
+
+    //
+    // Only compute the permuted array: plcp[index[i]] is the LCP of
+    // the suffixes at index[i-1] and index[i], and plcp[index[0]] is 0.
+    // A caller that reads the LCPs once in any order may use it in
+    // place of the LCP array and save a second array of textLength.
+    //
+    void BuildPermuted(T *textP, DNALength textLengthP, unsigned int *indexP,
+        int nThreadsP=1) {
+        text       = textP;
+        textLength = textLengthP;
+        index      = indexP;
+        if (textLength == 0) {
+            return;
+        }
+        nBlocks  = CeilOfFraction(textLength, (DNALength) LCP_ARRAY_BLOCK_SIZE);
+        nThreads = std::max(1, std::min(nThreadsP, (int) nBlocks));
+
+        //
+        // textLength marks the first suffix, which has no predecessor.
+        //
+        plcp.resize(textLength);
+        plcp[index[0]] = textLength;
+        DNALength i;
+        for (i = 1; i < textLength; i++) {
+            plcp[index[i]] = index[i-1];
+        }
+        RunThreads(false);
+    }
+
+    void RunThreads(bool permute) {
+        std::vector<Thread> threads(nThreads);
+        std::vector<pthread_t> threadIds(nThreads);
+        std::vector<bool> created(nThreads, false);
+        int t;
+        for (t = 0; t < nThreads; t++) {
+            threads[t].builder = this;
+            threads[t].index   = t;
+            threads[t].permute = permute;
+        }
+        for (t = 1; t < nThreads; t++) {
+            created[t] = (pthread_create(&threadIds[t], NULL, RunThread, &threads[t]) == 0);
+        }
+        RunThread(&threads[0]);
+        for (t = 1; t < nThreads; t++) {
+            if (created[t]) {
+                pthread_join(threadIds[t], NULL);
+            }
+            else {
+                RunThread(&threads[t]);
+            }
+        }
+    }
+
+    static void *RunThread(void *threadPtr) {
+        Thread *thread = (Thread*) threadPtr;
+        LCPArrayBuilder *builder = thread->builder;
+        DNALength b;
+        for (b = thread->index; b < builder->nBlocks; b += builder->nThreads) {
+            DNALength start = b * LCP_ARRAY_BLOCK_SIZE;
+            DNALength end   = std::min(builder->textLength, start + LCP_ARRAY_BLOCK_SIZE);
+            if (thread->permute) {
+                builder->PermuteBlock(start, end);
+            }
+            else {
+                builder->ComputePLCPBlock(start, end);
+            }
+        }
+        return NULL;
+    }
+
+    void ComputePLCPBlock(DNALength start, DNALength end) {
+        DNALength pos, h = 0;
+        for (pos = start; pos < end; pos++) {
+            DNALength prev = plcp[pos];
+            if (prev == textLength) {
+                plcp[pos] = 0;
+                h = 0;
+                continue;
+            }
+            while (pos + h < textLength and prev + h < textLength and
+                   Compare::Equal(text[pos + h], text[prev + h])) {
+                h++;
+            }
+            plcp[pos] = h;
+            if (h > 0) {
+                h--;
+            }
+        }
+    }
+
+    void PermuteBlock(DNALength start, DNALength end) {
+        DNALength i;
+        for (i = std::max(start, (DNALength) 1); i < end; i++) {
+            lcp[i] = plcp[index[i]];
+        }
+    }
+};
+
+//
+// Prefix lengths that do not fit in the 16 bit entries of an
+// LCPTable, as (index, length) pairs sorted by index so that a lookup
+// is a binary search over one flat array.
+//
+class LongPrefixTable {
+public:
+    std::vector<std::pair<int, int> > entries;
+
+    void Clear() {
+        entries.clear();
+    }
+
+    void Add(int index, int length) {
+        entries.push_back(std::pair<int, int>(index, length));
+    }
+
+    //
+    // Call once all entries are added.
+    //
+    void Sort() {
+        std::sort(entries.begin(), entries.end());
+    }
+
+    int Find(int index) const {
+        std::vector<std::pair<int, int> >::const_iterator it;
+        it = std::lower_bound(entries.begin(), entries.end(), std::pair<int, int>(index, 0));
+        assert(it != entries.end() and it->first == index);
+        return it->second;
+    }
+
+    void Write(std::ofstream &out) {
+        int size = entries.size();
+        out.write((char*) &size, sizeof(size));
+        int i;
+        for (i = 0; i < size; i++) {
+            out.write((char*) &entries[i].first, sizeof(int));
+            out.write((char*) &entries[i].second, sizeof(int));
+        }
+    }
+
+    void Read(std::ifstream &in) {
+        int size;
+        in.read((char*) &size, sizeof(size));
+        entries.resize(size);
+        int i;
+        for (i = 0; i < size; i++) {
+            in.read((char*) &entries[i].first, sizeof(int));
+            in.read((char*) &entries[i].second, sizeof(int));
+        }
+    }
+};
+
+//
+// The longest common prefixes used by an LCP accelerated (Manber and
+// Myers) binary search over a suffix array: for the midpoint M of
+// each interval (L, R) the search can visit, llcp[M] is the LCP of the
+// suffixes at L and M, and rlcp[M] that of the suffixes at M and R.
+// Both are derived from the LCP array in linear time.
+//
+// SuffixArray::SearchLCP reads the table through LCPSearch when it is
+// built or read with the suffix array.
+//
+template <typename T, typename Compare = DefaultCompareStrings<T> >
 class LCPTable {
     //
-    // Change the following TWO type defs if 
+    // Change the following TWO type defs if
     // the max LCP is changed.
     //
     typedef short SignedPrefixLength;
     typedef unsigned short PrefixLength;
-    typedef std::map<int, int> LongPrefixMap;
     PrefixLength maxPrefixLength;
-    LongPrefixMap llongPrefixMap, rlongPrefixMap;
+    LongPrefixTable llongPrefixTable, rlongPrefixTable;
     int tableLength;
     public:
     PrefixLength *llcp, *rlcp;
     LCPTable() {
         tableLength =0;
+        maxPrefixLength = (PrefixLength) (SignedPrefixLength(-1));
         llcp = rlcp = NULL;
     }
 
-    LCPTable(T* data, unsigned int pTableLength) {
-        Init(data, pTableLength);
-    }
-
-    inline	int LengthLongestCommonPrefix(T* a, int alen, T* b, int blen) {
-        int i;
-        for (i = 0 ; i < alen and i < blen; i++ ) 
-            if (a[i] != b[i])
-                break;
-        return i;
+    LCPTable(T* data, unsigned int pTableLength, unsigned int *index, int nThreads=1) {
+        llcp = rlcp = NULL;
+        Init(data, pTableLength, index, nThreads);
     }
 
-    void Init(T* data, unsigned int pTableLength, unsigned int *index) {
+    //
+    // data is the text of length pTableLength, and index its suffix
+    // array.
+    //
+    void Init(T* data, unsigned int pTableLength, unsigned int *index, int nThreads=1) {
+        Free();
         tableLength = pTableLength;
         maxPrefixLength = (PrefixLength) (SignedPrefixLength(-1));
         llcp = ProtectedNew<PrefixLength>(tableLength);
         rlcp = ProtectedNew<PrefixLength>(tableLength);
         std::fill(llcp, llcp + tableLength, 0);
         std::fill(rlcp, rlcp + tableLength, 0);
-        FillTable(data, index);
+        FillTable(data, index, nThreads);
     }
 
     int SetL(int index, int length) {
         assert(index >= 0);
         assert(index < tableLength);
-        if (index >= maxPrefixLength) {
+        if (length >= maxPrefixLength) {
             llcp[index] = maxPrefixLength;
-            llongPrefixMap[index] = length;
+            llongPrefixTable.Add(index, length);
         }
         else {
             llcp[index] = length;
         }
-        return llcp[index];
+        return length;
     }
 
     int SetR(int index, int length) {
         assert(index >= 0);
         assert(index < tableLength);
-        if (index >= maxPrefixLength) {
+        if (length >= maxPrefixLength) {
             rlcp[index] = maxPrefixLength;
-            rlongPrefixMap[index] = length;
+            rlongPrefixTable.Add(index, length);
         }
         else {
             rlcp[index] = length;
         }
-        return rlcp[index];
+        return length;
     }
 
 
-    int GetL(int index) {
+    int GetL(int index) const {
         if (llcp[index] == maxPrefixLength) {
-            assert(llongPrefixMap.find(index) != llongPrefixMap.end());
-            return llongPrefixMap[index];
+            return llongPrefixTable.Find(index);
         }
         else {
             return llcp[index];
         }
     }
 
-    int GetR(int index) {
+    int GetR(int index) const {
         if (rlcp[index] == maxPrefixLength) {
-            assert(rlongPrefixMap.find(index) != llongPrefixMap.end());
-            return rlongPrefixMap[index];
+            return rlongPrefixTable.Find(index);
         }
         else {
             return rlcp[index];
         }
     }
 
-
-    ~LCPTable() {
+    void Free() {
         if (llcp != NULL) {
             delete[] llcp;
             llcp = NULL;
@@ -103,79 +320,64 @@ class LCPTable {
             delete[] rlcp;
             rlcp = NULL;
         }
-        // the two maps automatically go away.
+        llongPrefixTable.Clear();
+        rlongPrefixTable.Clear();
+        tableLength = 0;
+    }
+
+    ~LCPTable() {
+        Free();
     }
 
     void WriteLCPTable(std::ofstream &out) {
         out.write((char*) &tableLength, sizeof(tableLength));
         out.write((char*) llcp, sizeof(PrefixLength)*tableLength);
         out.write((char*) rlcp, sizeof(PrefixLength)*tableLength);
-        typename LongPrefixMap::iterator llcpTableIt, llcpTableEnd;
-        int llongPrefixMapSize = llongPrefixMap.size();
-        out.write((char*) &llongPrefixMapSize, sizeof(llongPrefixMapSize));
-        for((llcpTableIt = llongPrefixMap.begin(),
-                    llcpTableEnd = llongPrefixMap.end());
-                llcpTableIt != llcpTableEnd;
-                ++llcpTableIt) {
-            out.write((char*) &llcpTableIt->first, sizeof(typename LongPrefixMap::key_type));
-            out.write((char*) &llcpTableIt->second, sizeof(typename LongPrefixMap::mapped_type));
-        }
-        typename LongPrefixMap::iterator rlcpTableIt, rlcpTableEnd;
-        int rlongPrefixMapSize = rlongPrefixMap.size();
-        out.write((char*) &rlongPrefixMapSize, sizeof(rlongPrefixMapSize));
-        for((rlcpTableIt = rlongPrefixMap.begin(),
-                    rlcpTableEnd = rlongPrefixMap.end());
-                rlcpTableIt != rlcpTableEnd;
-                ++rlcpTableIt) {
-            out.write((char*) &rlcpTableIt->first, sizeof(typename LongPrefixMap::key_type));
-            out.write((char*) &rlcpTableIt->second, sizeof(typename LongPrefixMap::mapped_type));
-        }
+        llongPrefixTable.Write(out);
+        rlongPrefixTable.Write(out);
     }
 
     void ReadLCPTables(std::ifstream &in) {
+        Free();
         in.read((char*) &tableLength, sizeof(tableLength));
-        in.read((char*) &llcp, sizeof(PrefixLength)*tableLength);
-        in.read((char*) &rlcp, sizeof(PrefixLength)*tableLength);
-        int longPrefixMapSize;
-        in.read((char*) &longPrefixMapSize, sizeof(longPrefixMapSize));
-        int i;
-        int index, lcpLength;
-        // The rest is stored as a tree, but read and construct this on the fly.
-        for (i = 0; i < longPrefixMapSize; i++) {
-            in.read((char*) &index, sizeof(index));
-            in.read((char*) &lcpLength, sizeof(lcpLength));
-            llongPrefixMap[index] = lcpLength;
-        }
-
-        // Read the rlcp
-        in.read((char*) &longPrefixMapSize, sizeof(longPrefixMapSize));
-        for (i = 0; i < longPrefixMapSize; i++) {
-            in.read((char*) &index, sizeof(index));
-            in.read((char*) &lcpLength, sizeof(lcpLength));
-            rlongPrefixMap[index] = lcpLength;
-        }
+        llcp = ProtectedNew<PrefixLength>(tableLength);
+        rlcp = ProtectedNew<PrefixLength>(tableLength);
+        in.read((char*) llcp, sizeof(PrefixLength)*tableLength);
+        in.read((char*) rlcp, sizeof(PrefixLength)*tableLength);
+        llongPrefixTable.Read(in);
+        rlongPrefixTable.Read(in);
     }
 
 
-    void FillTable(T* data, unsigned int *index) {
+    void FillTable(T* data, unsigned int *index, int nThreads=1) {
         //
         // This assumes that the index table is now in sorted order.
         //
-        FillTable(0, tableLength, data, index);
+        if (tableLength < 2) {
+            return;
+        }
+        LCPArrayBuilder<T, Compare> lcpBuilder;
+        lcpBuilder.BuildPermuted(data, tableLength, index, nThreads);
+        FillTable(0, tableLength - 1, index, lcpBuilder.plcp);
+        llongPrefixTable.Sort();
+        rlongPrefixTable.Sort();
     }
 
-    void FillTable(unsigned int low, unsigned int high, T* data, unsigned int *index) {
-        if (low == high) 
-            return;
+    //
+    // Fill the entries of the midpoints inside (low, high), and return
+    // the LCP of the suffixes at low and high, which is the least LCP
+    // array value in (low, high].  Each LCP array value is read once,
+    // from the permuted array.
+    //
+    int FillTable(unsigned int low, unsigned int high, unsigned int *index,
+        std::vector<DNALength> &plcp) {
+        if (high - low <= 1) {
+            return plcp[index[high]];
+        }
         unsigned int mid = (low + high) / 2;
-        assert (mid != low);
-        SetL(mid, LengthLongestCommonPrefix(&data[index[low]], tableLength - index[low],
-                    &data[index[mid]], tableLength - index[mid]));
-        FillTable(low, mid, data, index);
-        assert(mid != high);
-        SetR(mid, LengthLongestCommonPrefix(&data[index[mid]], tableLength - index[mid],
-                    &data[index[high]], tableLength - index[high]));
-        FillTable(mid+1, high, data, index);
+        int lowMid  = SetL(mid, FillTable(low, mid, index, plcp));
+        int midHigh = SetR(mid, FillTable(mid, high, index, plcp));
+        return std::min(lowMid, midHigh);
     }
 
 };
@@ -13,9 +13,11 @@
 #include "../../pbdata/DNASequence.hpp"
 #include "../../pbdata/NucConversion.hpp"
 #include "LCPTable.hpp"
+#include "EnhancedSuffixArray.hpp"
 #include "../algorithms/compare/CompareStrings.hpp"
 #include "../algorithms/sorting/qsufsort.hpp"
 #include "../algorithms/sorting/LightweightSuffixArray.hpp"
+#include "../algorithms/sorting/ExternalSuffixSort.hpp"
 #include "../tuples/DNATuple.hpp"
 #include "../tuples/CompressedDNATuple.hpp"
 /*
@@ -73,11 +75,25 @@ public:
     TupleMetrics tm;
     unsigned int magicNumber;
     unsigned int ckMagicNumber;
+    //
+    // Files with an LCP table list one more component, and are marked
+    // with this magic number so that older readers reject them rather
+    // than misread them.  Files without one are written as before.
+    //
+    static const unsigned int LCPMagicNumber = 0xacac0002;
     typedef Compare CompareType;
     enum Component { CompArray, CompLookupTable, CompLCPTable};
-    static const int ComponentListLength = 2;
+    static const int ComponentListLength = 3;
     static const int FullSearch = -1;
     int componentList[ComponentListLength];
+    // The number of components listed in the file being read.
+    int fileComponentListLength;
+    LCPTable<T, Compare> lcpTable;
+    //
+    // When loaded, StoreLCPBounds walks the child table instead of
+    // binary searching each character.
+    //
+    EnhancedSuffixArray esa;
 
     // vector<SAIndex> leftBound, rightBound;
 
@@ -98,6 +114,7 @@ public:
         lookupTableLength = 0;
         deleteStructures  = true;
         ckMagicNumber = 0;
+        fileComponentListLength = ComponentListLength - 1;
         length = 0;
         int i;
         for (i = 0; i < ComponentListLength; i++) {
@@ -185,6 +202,17 @@ public:
     }
 
     void BuildLookupTable(T *target, SAIndexLength targetLength, int prefixLengthP) { 
+        BuildLookupTableFromIndex(target, targetLength, prefixLengthP, index);
+    }
+
+    //
+    // Build the lookup table from a suffix array given by anything
+    // with an operator[], such as a SuffixArrayFileReader.  The array
+    // is read once from start to end.
+    //
+    template<typename T_Index>
+    void BuildLookupTableFromIndex(T *target, SAIndexLength targetLength, int prefixLengthP,
+        T_Index &index) {
 
         //
         // pprefixLength is the length used to lookup the index boundaries
@@ -222,8 +250,12 @@ public:
             if (indexPos >= targetLength - lookupPrefixLength + 1) {
                 break;
             }
+            // Skip tuples with N, and suffixes shorter than a tuple that
+            // follow them, which would otherwise start the rows of the
+            // next prefix.
             while (indexPos < targetLength - lookupPrefixLength + 1 and
-                    curPrefix.FromStringLR((Nucleotide*) &target[index[indexPos]], tm) == 0) {
+                    (index[indexPos] + lookupPrefixLength > targetLength or
+                     curPrefix.FromStringLR((Nucleotide*) &target[index[indexPos]], tm) == 0)) {
                 ++indexPos;
             }
 
@@ -271,7 +303,8 @@ public:
         delete[] p;
     }
 
-    void LightweightBuildSuffixArray(T*target, SAIndexLength targetLength, int diffCoverSize=2281) {
+    void LightweightBuildSuffixArray(T*target, SAIndexLength targetLength, int diffCoverSize=2281,
+        int nThreads=1) {
         assert(index == NULL or not deleteStructures);
         index = ProtectedNew<SAIndex>(targetLength+1);
         deleteStructures = true;
@@ -280,13 +313,68 @@ public:
         for (pos = 0; pos < targetLength; pos++) {
             target[pos]++;
         }
-        LightweightSuffixSort(target, targetLength, index, diffCoverSize);
+        LightweightSuffixSort(target, targetLength, index, diffCoverSize, nThreads);
         for (pos = 0; pos < targetLength; pos++) {
             target[pos]--;
         }
 
     }
 
+    //
+    // Write the suffix array of target and its lookup table to
+    // outFileName without holding the array in memory, for references
+    // whose suffix array does not fit.  The array is sorted and written
+    // maxBlockLength suffixes at a time by an ExternalSuffixSort, then
+    // read back in one pass to build the lookup table, which is
+    // appended.  The file is the same as one written by Write after
+    // LightweightBuildSuffixArray and BuildLookupTable.  As there,
+    // target must be followed by diffCoverSize zeros.  Returns false if
+    // the file cannot be written; verbose reports each block sorted.
+    //
+    bool WriteExternal(T *target, SAIndexLength targetLength, std::string &outFileName,
+        int prefixLengthP, SAIndexLength maxBlockLength, int diffCoverSize=2281, int nThreads=1,
+        bool verbose=false) {
+        std::ofstream suffixArrayOut;
+        suffixArrayOut.open(outFileName.c_str(), std::ios::binary);
+        if (!suffixArrayOut.good()) {
+            return false;
+        }
+        length = targetLength;
+        unsigned int fileMagicNumber = magicNumber;
+        suffixArrayOut.write((char*) &fileMagicNumber, sizeof(int));
+        componentList[CompArray] = 1;
+        componentList[CompLookupTable] = 1;
+        componentList[CompLCPTable] = 0;
+        suffixArrayOut.write((char*) componentList, sizeof(int) * (ComponentListLength - 1));
+        suffixArrayOut.write((char*) &length, sizeof(int));
+        std::streamoff arrayOffset = suffixArrayOut.tellp();
+
+        DNALength pos;
+        for (pos = 0; pos < targetLength; pos++) {
+            target[pos]++;
+        }
+        ExternalSuffixSort sorter;
+        sorter.verbose = verbose;
+        bool sorted = sorter.Sort(target, targetLength, suffixArrayOut, maxBlockLength, diffCoverSize,
+            nThreads);
+        for (pos = 0; pos < targetLength; pos++) {
+            target[pos]--;
+        }
+        suffixArrayOut.close();
+        if (!sorted) {
+            return false;
+        }
+
+        SuffixArrayFileReader fileIndex;
+        if (!fileIndex.Initialize(outFileName, arrayOffset, targetLength)) {
+            return false;
+        }
+        BuildLookupTableFromIndex(target, targetLength, prefixLengthP, fileIndex);
+        suffixArrayOut.open(outFileName.c_str(), std::ios::binary|std::ios::app);
+        WriteLookupTable(suffixArrayOut);
+        return suffixArrayOut.good();
+    }
+
     void MMBuildSuffixArray(T* target, SAIndexLength targetLength, Sigma &alphabet) {
         /*
          * Manber and Myers suffix array construction.
@@ -504,13 +592,47 @@ public:
         else
             componentList[CompLookupTable] = 0;
 
-        out.write((char*) componentList, sizeof(int) * ComponentListLength);
+        if (lcpTable.llcp != NULL) {
+            componentList[CompLCPTable] = 1;
+            out.write((char*) componentList, sizeof(int) * ComponentListLength);
+        }
+        else {
+            componentList[CompLCPTable] = 0;
+            out.write((char*) componentList, sizeof(int) * (ComponentListLength - 1));
+        }
     }
 
     void WriteLCPTable(std::ofstream &out) {
-        PB_UNUSED(out);
-        std::cout << "NOT YET IMPLEMENTED." << std::endl;
-        exit(1);
+        lcpTable.WriteLCPTable(out);
+    }
+
+    //
+    // Build the LCP table of the suffix array of target, which is
+    // written and read with the array once it exists.
+    //
+    void BuildLCPTable(T *target, int nThreads=1) {
+        lcpTable.Init(target, length, index, nThreads);
+    }
+
+    //
+    // The enhanced suffix array is kept in a separate file, usually
+    // the suffix array file name with .esa appended, so that it may be
+    // built for an existing suffix array and loaded only when wanted.
+    //
+    void BuildEnhanced(T *target, int nThreads=1) {
+        esa.template Build<T, Compare>(target, length, index, nThreads);
+    }
+
+    void WriteEnhanced(std::string &outFileName) {
+        esa.Write(outFileName);
+    }
+
+    bool ReadEnhanced(std::string &inFileName) {
+        if (!esa.Read(inFileName) or esa.length != length) {
+            esa.Free();
+            return false;
+        }
+        return true;
     }
 
     void Write(std::string &outFileName) {
@@ -539,24 +661,37 @@ public:
         if (componentList[CompLookupTable]) {
             WriteLookupTable(suffixArrayOut);
         }
+        if (componentList[CompLCPTable]) {
+            WriteLCPTable(suffixArrayOut);
+        }
         suffixArrayOut.close();
     }
     void WriteMagicNumber(std::ofstream &out) {
-        out.write((char*) &magicNumber, sizeof(int));
+        unsigned int fileMagicNumber = magicNumber;
+        if (lcpTable.llcp != NULL) {
+            fileMagicNumber = LCPMagicNumber;
+        }
+        out.write((char*) &fileMagicNumber, sizeof(int));
     }
 
     int ReadMagicNumber(std::ifstream &in) {
         in.read((char*) &ckMagicNumber, sizeof(int));
-        if (ckMagicNumber != magicNumber) {
-            return 0;
+        if (ckMagicNumber == magicNumber) {
+            fileComponentListLength = ComponentListLength - 1;
+            return 1;
         }
-        else { 
+        else if (ckMagicNumber == LCPMagicNumber) {
+            fileComponentListLength = ComponentListLength;
             return 1;
         }
+        else { 
+            return 0;
+        }
     }
 
     void ReadComponentList(std::ifstream &in) { 
-        in.read((char*) componentList, sizeof(int) * ComponentListLength);
+        std::fill(componentList, componentList + ComponentListLength, 0);
+        in.read((char*) componentList, sizeof(int) * fileComponentListLength);
     }
 
     void ReadAllocatedArray(std::ifstream &in) {
@@ -599,9 +734,7 @@ public:
     }
 
     void ReadLCPTable(std::ifstream &in) {
-        PB_UNUSED(in);
-        std::cout <<" NOT YET IMPLEMENTED!!!" << std::endl;
-        exit(1);
+        lcpTable.ReadLCPTables(in);
     }
 
     bool LightRead(std::string &inFileName) {
@@ -635,6 +768,9 @@ public:
             if (componentList[CompLookupTable]) {
                 ReadLookupTable(saIn);
             }
+            if (componentList[CompLCPTable]) {
+                ReadLCPTable(saIn);
+            }
             saIn.close();
             return true;
         }
@@ -644,6 +780,11 @@ public:
         }
     }
 
+    //
+    // The bounds are found with the Manber and Myers search when the
+    // LCP table is built or read, and otherwise with a binary search
+    // from the lookup table bounds.
+    //
     int SearchLCP(T* target, T* query, DNALength queryLength, SAIndex &low, SAIndex &high, DNALength &lcpLength, DNALength maxlcp) {
       PB_UNUSED(maxlcp);
         //		cout << "searching lcp with query of length: " << queryLength << endl;
@@ -685,7 +826,12 @@ public:
         // to use this as a comparison in further lcp searches.
         prevLCPLength = lcpLength;
 
-        Search(target, query, queryLength, low, high, low, high, 0);
+        if (lcpTable.llcp != NULL) {
+            LCPSearch(target, query, queryLength, low, high);
+        }
+        else {
+            Search(target, query, queryLength, low, high, low, high, 0);
+        }
 
         DNALength lowLCP = lookupPrefixLength, highLCP = lookupPrefixLength;
         while (lowLCP < queryLength and index[low]+lowLCP < length and 
@@ -750,8 +896,130 @@ public:
         return Search(target, query, queryLength, left, right, low, high, offset);
     }
 
+    //
+    // The Manber and Myers search over lcpTable, which must be built
+    // or read with this array.  low and high are set as by Search over
+    // the whole array, and the return value is the same, but each step
+    // starts comparing where earlier steps left off, so a search
+    // compares about queryLength + log(length) characters rather than
+    // up to queryLength at every step.
+    //
+    int LCPSearch(T *target, T *query, DNALength queryLength, SAIndex &low, SAIndex &high) {
+        low  = LCPSearchBound(target, query, queryLength, false);
+        high = LCPSearchBound(target, query, queryLength, true);
+        return high - low;
+    }
+
+    //
+    // How a suffix compares to the query when compared over the length
+    // of the shorter, as StringLessThan and StringLessThanEqual do.
+    //
+    enum LCPSearchOrder {QueryLess, QueryPrefixEqual, QueryGreater};
+
+    //
+    // Compare the query with the suffix at index[i], knowing that they
+    // share at least prefixLength characters, and set prefixLength to
+    // the length they share.
+    //
+    LCPSearchOrder CompareQuery(T *target, T *query, DNALength queryLength, SAIndex i,
+        DNALength &prefixLength) {
+        DNALength suffixLength = length - index[i];
+        DNALength maxLength = std::min(queryLength, suffixLength);
+        while (prefixLength < maxLength and
+               target[index[i] + prefixLength] == query[prefixLength]) {
+            prefixLength++;
+        }
+        if (prefixLength == maxLength) {
+            return QueryPrefixEqual;
+        }
+        return (((unsigned char) query[prefixLength]) <
+                ((unsigned char) target[index[i] + prefixLength])) ? QueryLess : QueryGreater;
+    }
+
+    //
+    // The result of SearchLow (upper false) or SearchHigh (upper true)
+    // over the whole array.  The steps visit the midpoints the table
+    // was filled for.  llcp and rlcp at a midpoint give its prefix
+    // shared with the bounds, which decides the step without reading
+    // the suffix when the query strictly follows the low bound or
+    // strictly precedes the high bound; otherwise the suffix is
+    // compared from the prefix known to be shared.
+    //
+    long LCPSearchBound(T *target, T *query, DNALength queryLength, bool upper) {
+        if (length == 0) {
+            return upper ? -1 : length;
+        }
+        SAIndex l = 0, r = length - 1;
+        DNALength lLength = 0, rLength = 0;
+        LCPSearchOrder lOrder = CompareQuery(target, query, queryLength, l, lLength);
+        LCPSearchOrder rOrder = CompareQuery(target, query, queryLength, r, rLength);
+        if (!upper and lOrder != QueryGreater) {
+            return l;
+        }
+        if (rOrder == QueryGreater) {
+            return upper ? -1 : length;
+        }
+        while (r - l > 1) {
+            SAIndex m = (l + r) / 2;
+            DNALength mLength;
+            LCPSearchOrder mOrder;
+            if (lLength >= rLength) {
+                DNALength lmLength = lcpTable.GetL(m);
+                if (lOrder == QueryGreater and lmLength > lLength) {
+                    mOrder  = QueryGreater;
+                    mLength = lLength;
+                }
+                else if (lOrder == QueryGreater and lmLength < lLength) {
+                    mOrder  = QueryLess;
+                    mLength = lmLength;
+                }
+                else {
+                    mLength = std::max(rLength, std::min(lmLength, lLength));
+                    mOrder  = CompareQuery(target, query, queryLength, m, mLength);
+                }
+            }
+            else {
+                DNALength mrLength = lcpTable.GetR(m);
+                if (rOrder == QueryLess and mrLength > rLength) {
+                    mOrder  = QueryLess;
+                    mLength = rLength;
+                }
+                else if (rOrder == QueryLess and mrLength < rLength) {
+                    //
+                    // The suffix precedes the high bound, so it is
+                    // less than the query unless it ends where it
+                    // leaves the bound.
+                    //
+                    mLength = mrLength;
+                    mOrder  = (length - index[m] == mrLength) ? QueryPrefixEqual : QueryGreater;
+                }
+                else {
+                    mLength = std::max(lLength, std::min(mrLength, rLength));
+                    mOrder  = CompareQuery(target, query, queryLength, m, mLength);
+                }
+            }
+            if (mOrder == QueryLess or (mOrder == QueryPrefixEqual and !upper)) {
+                r = m;
+                rLength = mLength;
+                rOrder  = mOrder;
+            }
+            else {
+                l = m;
+                lLength = mLength;
+                lOrder  = mOrder;
+            }
+        }
+        return upper ? l : r;
+    }
+
 
-    long SearchLeftBound(T* target, long targetLength, DNALength targetOffset,  T queryChar, long l, long r) {
+    //
+    // The target of the bound searches and of StoreLCPBounds may be a
+    // T* or anything indexed like one, such as the seq of a
+    // TwoBitSequence.
+    //
+    template<typename T_Text>
+    long SearchLeftBound(const T_Text &target, long targetLength, DNALength targetOffset,  T queryChar, long l, long r) {
         long ll, lr;
         ll = l;
         lr = r;
@@ -800,7 +1068,8 @@ public:
         return ll;
     }
 
-    long SearchRightBound(T* target, long targetLength, DNALength targetOffset, 
+    template<typename T_Text>
+    long SearchRightBound(const T_Text &target, long targetLength, DNALength targetOffset, 
             T queryChar, long l, long r) {
         long rl, rr;
         rl = l;
@@ -950,7 +1219,8 @@ public:
     }
 
 
-    int StoreLCPBounds(T *target, long targetLength, // The string which the suffix array is built on.
+    template<typename T_Text>
+    int StoreLCPBounds(const T_Text &target, long targetLength, // The string which the suffix array is built on.
             T *query, DNALength queryLength, // The query string. search starts at pos 0 in this string
             bool useLookupTable,  // Should the indices of the first k bases be determined by a lookup table?
             DNALength  maxMatchLength,  // Stop extending match at lcp length = maxMatchLength,
@@ -1012,6 +1282,12 @@ public:
             }
         }
 
+        if (esa.IsLoaded()) {
+            return StoreEnhancedBounds(target, targetLength, query, queryLength,
+                maxMatchLength, l, r, lcpLength, lcpLeftBounds, lcpRightBounds,
+                stopOnceUnique);
+        }
+
         //
         // Search the suffix array for the longest common prefix between
         // the read and the genome.
@@ -1091,6 +1367,112 @@ public:
     }
 
 
+    //
+    // The search loop of StoreLCPBounds over the enhanced suffix array,
+    // starting from the rows [l, r) that match the first lcpLength bases
+    // of query.  It stores the same bounds, but narrows them by moving
+    // to a child interval, which takes one character comparison per
+    // child, rather than by two binary searches.
+    //
+    // The rows of the lookup table are not always an lcp-interval: the
+    // table leaves out the last rows of the array.  The walk therefore
+    // starts from the interval of the first lcpLength bases found from
+    // the root, and the bounds stored are clipped to [l, r) as those of
+    // the binary search are.
+    //
+    template<typename T_Text>
+    int StoreEnhancedBounds(const T_Text &target, long targetLength, T *query, DNALength queryLength,
+            DNALength maxMatchLength, long l, long r, DNALength lcpLength,
+            std::vector<SAIndex> &lcpLeftBounds, std::vector<SAIndex> &lcpRightBounds,
+            bool stopOnceUnique) {
+        if (l >= r) {
+            return lcpLength;
+        }
+        DNALength i = 0, j = targetLength - 1;
+        DNALength depth;
+        for (depth = 0; depth < lcpLength; depth++) {
+            if (!NarrowEnhancedInterval(target, targetLength, depth, query[depth], i, j)) {
+                return lcpLength;
+            }
+        }
+        DNALength first = l, last = r - 1;
+        while (lcpLength < queryLength) {
+            if (stopOnceUnique and first == last) {
+                break;
+            }
+            if (maxMatchLength and lcpLength >= maxMatchLength) {
+                break;
+            }
+            //
+            // Stop at N's in the genome or the read, as the binary
+            // search does.
+            //
+            if (index[first] + lcpLength < targetLength and
+                    ThreeBit[target[index[first] + lcpLength]] >= 4) {
+                break;
+            }
+            if (ThreeBit[query[lcpLength]] >= 4 or
+                    !NarrowEnhancedInterval(target, targetLength, lcpLength,
+                        query[lcpLength], i, j)) {
+                break;
+            }
+            first = std::max(i, (DNALength) l);
+            last  = std::min(j, (DNALength) r - 1);
+            if (first > last) {
+                break;
+            }
+            lcpLeftBounds.push_back(first);
+            lcpRightBounds.push_back(last + 1);
+            lcpLength++;
+        }
+        return lcpLength;
+    }
+
+    //
+    // Narrow the interval [i..j], whose suffixes share their first depth
+    // characters, to those followed by c.  Returns false if there are
+    // none.
+    //
+    template<typename T_Text>
+    bool NarrowEnhancedInterval(const T_Text &target, long targetLength, DNALength depth, T c,
+            DNALength &i, DNALength &j) {
+        DNALength intervalLCP;
+        if (i < j) {
+            intervalLCP = esa.IntervalLCP(i, j);
+        }
+        else {
+            intervalLCP = targetLength - index[i];
+        }
+        if (depth < intervalLCP) {
+            return Compare::Compare(target[index[i] + depth], c) == 0;
+        }
+        if (i == j) {
+            return false;
+        }
+        //
+        // The interval branches here; find the child that continues
+        // with c.  The first child may be a suffix that ends at depth.
+        //
+        DNALength childStart = i;
+        DNALength nextStart  = esa.FirstLIndex(i, j);
+        while (true) {
+            DNALength childEnd = (nextStart > j) ? j : nextStart - 1;
+            if (index[childStart] + depth < targetLength and
+                    Compare::Compare(target[index[childStart] + depth], c) == 0) {
+                i = childStart;
+                j = childEnd;
+                return true;
+            }
+            if (nextStart > j) {
+                return false;
+            }
+            childStart = nextStart;
+            if (!esa.NextLIndex(childStart, nextStart)) {
+                nextStart = j + 1;
+            }
+        }
+    }
+
     int SearchLow(T *target, T *query, DNALength queryLength, SAIndex l, SAIndex r, SAIndex &low, unsigned int offset=0) {
 
         long midPos;
@@ -1190,6 +1572,7 @@ public:
         //
         high = low;
         //		cout << "search high took: " << numSteps << " steps." << endl;
+        return high;
     }
 };
 
@@ -53,3 +53,15 @@ double LogSumOfThree(double value1, double value2, double value3) {
     return LogSumOfTwo(maxValue, LogSumOfTwo(middleValue, minValue));
 }
 
+
+LogSumTable::LogSumTable() {
+    int nSamples = LOG_SUM_TABLE_RANGE * LOG_SUM_TABLE_SCALE + 2;
+    for (int i = 0; i < nSamples; i++) {
+        correction[i] = log1p(exp(-((double) i) / LOG_SUM_TABLE_SCALE));
+    }
+}
+
+const LogSumTable &LogSumTable::Get() {
+    static const LogSumTable table;
+    return table;
+}
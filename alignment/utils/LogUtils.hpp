@@ -12,4 +12,51 @@ double LogSumOfTwo(double value1, double value2);
 
 double LogSumOfThree(double value1, double value2, double value3); 
 
+//
+// Compute log(exp(a) + exp(b)) for natural log values without calling
+// exp() or log().  The correction log(1 + exp(-d)) for the difference d
+// between the two values is looked up in a table sampled
+// LOG_SUM_TABLE_SCALE times per unit and linearly interpolated, which
+// is accurate to 1e-5.  Past LOG_SUM_TABLE_RANGE the correction is
+// below float precision and the larger value is returned.  Values may
+// be -INFINITY.
+//
+#define LOG_SUM_TABLE_RANGE 16
+#define LOG_SUM_TABLE_SCALE 64
+
+class LogSumTable {
+public:
+    LogSumTable();
+
+    inline float Sum(float value1, float value2) const {
+        float maxValue = value1, minValue = value2;
+        if (maxValue < minValue) {
+            maxValue = value2; minValue = value1;
+        }
+        //
+        // When both values are -INFINITY the difference is NaN, which
+        // also fails this test.
+        //
+        float difference = (maxValue - minValue) * LOG_SUM_TABLE_SCALE;
+        if (!(difference < LOG_SUM_TABLE_RANGE * LOG_SUM_TABLE_SCALE)) {
+            return maxValue;
+        }
+        int i = (int) difference;
+        float frac = difference - i;
+        return maxValue + correction[i] + frac * (correction[i+1] - correction[i]);
+    }
+
+    inline float Sum(float value1, float value2, float value3) const {
+        return Sum(Sum(value1, value2), value3);
+    }
+
+    //
+    // The table is shared by all callers, and built on first use.
+    //
+    static const LogSumTable &Get();
+
+private:
+    float correction[LOG_SUM_TABLE_RANGE * LOG_SUM_TABLE_SCALE + 2];
+};
+
 #endif // _BLASR_UTILS_SUM_OF_LOG_HPP_
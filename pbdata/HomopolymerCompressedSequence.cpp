@@ -0,0 +1,140 @@
+#include <cassert>
+#include <algorithm>
+#include "utils.hpp"
+#include "HomopolymerCompressedSequence.hpp"
+
+HomopolymerCompressedSequence::HomopolymerCompressedSequence() : FASTASequence() {
+}
+
+DNALength HomopolymerCompressedSequence::Compress(DNASequence &source, DNALength start,
+    DNALength compressLength, int binSize) {
+    HomopolymerCompressedSequence::Free();
+    if (compressLength == 0) {
+        compressLength = source.length - start;
+    }
+    DNALength end = start + compressLength;
+
+    DNALength nRuns = 0, i;
+    for (i = start; i < end; i++) {
+        if (i == start or ThreeBit[source.seq[i]] != ThreeBit[source.seq[i-1]]) {
+            nRuns++;
+        }
+    }
+    Allocate(nRuns);
+    runLength.resize(nRuns);
+    index.binSize     = binSize;
+    index.indexLength = nRuns / binSize + 1;
+    index.index       = ProtectedNew<int>(index.indexLength);
+
+    DNALength c = 0;
+    i = start;
+    while (i < end) {
+        DNALength runEnd = i + 1;
+        while (runEnd < end and ThreeBit[source.seq[runEnd]] == ThreeBit[source.seq[i]]) {
+            runEnd++;
+        }
+        if (c % binSize == 0) {
+            index.index[c / binSize] = i;
+        }
+        seq[c] = source.seq[i];
+        DNALength run = runEnd - i;
+        if (run >= HPC_LONG_RUN) {
+            runLength[c] = HPC_LONG_RUN;
+            longRuns.push_back(std::pair<DNALength, DNALength>(c, run));
+        }
+        else {
+            runLength[c] = run;
+        }
+        c++;
+        i = runEnd;
+    }
+    //
+    // The end of the compressed part is needed as the position after
+    // the last run.
+    //
+    if (c % binSize == 0) {
+        index.index[c / binSize] = end;
+    }
+    return length;
+}
+
+DNALength HomopolymerCompressedSequence::RunLength(DNALength cpPos) const {
+    if (runLength[cpPos] < HPC_LONG_RUN) {
+        return runLength[cpPos];
+    }
+    std::vector<std::pair<DNALength, DNALength> >::const_iterator it;
+    it = std::lower_bound(longRuns.begin(), longRuns.end(),
+        std::pair<DNALength, DNALength>(cpPos, 0));
+    assert(it != longRuns.end() and it->first == cpPos);
+    return it->second;
+}
+
+DNALength HomopolymerCompressedSequence::LookupSequencePos(DNALength cpPos) const {
+    DNALength bin = cpPos / index.binSize;
+    DNALength origPos = index.index[bin];
+    DNALength cp;
+    for (cp = bin * index.binSize; cp < cpPos; cp++) {
+        origPos += RunLength(cp);
+    }
+    return origPos;
+}
+
+void HomopolymerCompressedSequence::Write(std::string outFileName) {
+    std::ofstream out;
+    CrucialOpen(outFileName, out, std::ios::binary | std::ios::out);
+    DNALength nLongRuns = longRuns.size();
+    out.write((char*) &titleLength, sizeof(int));
+    if (titleLength > 0) {
+        out.write((char*) title, titleLength);
+    }
+    out.write((char*) &length, sizeof(DNALength));
+    if (length > 0) {
+        out.write((char*) seq, sizeof(Nucleotide) * length);
+        out.write((char*) &runLength[0], sizeof(unsigned char) * length);
+    }
+    out.write((char*) &nLongRuns, sizeof(DNALength));
+    DNALength r;
+    for (r = 0; r < nLongRuns; r++) {
+        out.write((char*) &longRuns[r].first, sizeof(DNALength));
+        out.write((char*) &longRuns[r].second, sizeof(DNALength));
+    }
+    index.Write(out);
+    out.close();
+}
+
+int HomopolymerCompressedSequence::Read(std::string inFileName) {
+    HomopolymerCompressedSequence::Free();
+    std::ifstream in;
+    CrucialOpen(inFileName, in, std::ios::binary | std::ios::in);
+    int inTitleLength;
+    in.read((char*) &inTitleLength, sizeof(int));
+    if (inTitleLength > 0) {
+        std::string inTitle(inTitleLength, '\0');
+        in.read(&inTitle[0], inTitleLength);
+        CopyTitle(inTitle);
+    }
+    DNALength inLength, nLongRuns;
+    in.read((char*) &inLength, sizeof(DNALength));
+    Allocate(inLength);
+    runLength.resize(inLength);
+    if (inLength > 0) {
+        in.read((char*) seq, sizeof(Nucleotide) * inLength);
+        in.read((char*) &runLength[0], sizeof(unsigned char) * inLength);
+    }
+    in.read((char*) &nLongRuns, sizeof(DNALength));
+    longRuns.resize(nLongRuns);
+    DNALength r;
+    for (r = 0; r < nLongRuns; r++) {
+        in.read((char*) &longRuns[r].first, sizeof(DNALength));
+        in.read((char*) &longRuns[r].second, sizeof(DNALength));
+    }
+    index.Read(in);
+    return in.good();
+}
+
+void HomopolymerCompressedSequence::Free() {
+    FASTASequence::Free();
+    runLength.clear();
+    longRuns.clear();
+    index.Free();
+}
@@ -0,0 +1,73 @@
+#ifndef _BLASR_HOMOPOLYMER_COMPRESSED_SEQUENCE_HPP_
+#define _BLASR_HOMOPOLYMER_COMPRESSED_SEQUENCE_HPP_
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Types.h"
+#include "NucConversion.hpp"
+#include "DNASequence.hpp"
+#include "FASTASequence.hpp"
+#include "ReverseCompressIndex.hpp"
+
+//
+// The default number of compressed bases between the positions kept
+// in the reverse index of a HomopolymerCompressedSequence.
+//
+#define HPC_DEFAULT_BIN_SIZE 16
+
+//
+// Runs at least this long are kept in the long run table rather than
+// in the one byte run lengths.
+//
+#define HPC_LONG_RUN 255
+
+//
+// A sequence with every homopolymer run replaced by a single base, and
+// what is needed to map a position in it back to the sequence it was
+// made from.  Unlike CompressedSequence, runs are not limited to 15
+// bases, and the bases are kept as they were (one byte each), so that
+// a SuffixArray or a BWT can be built on a compressed reference, and
+// compressed reads searched against it, as with any other sequence.
+//
+// The original position of every binSize'th compressed base is kept
+// in a ReverseCompressIndex, and the length of each run in a byte, so
+// a lookup adds up fewer than binSize run lengths.  Runs of
+// HPC_LONG_RUN or more, such as stretches of N, are kept in a table
+// sorted by compressed position.
+//
+class HomopolymerCompressedSequence : public FASTASequence {
+public:
+    std::vector<unsigned char> runLength;
+    std::vector<std::pair<DNALength, DNALength> > longRuns;
+    ReverseCompressIndex index;
+
+    HomopolymerCompressedSequence();
+
+    //
+    // Compress source[start, start+compressLength), or to the end of
+    // source when compressLength is 0.  Bases are in the same run when
+    // their ThreeBit codes are equal, so case is ignored.  Positions
+    // are mapped back to positions in source, not relative to start.
+    //
+    DNALength Compress(DNASequence &source, DNALength start=0,
+        DNALength compressLength=0, int binSize=HPC_DEFAULT_BIN_SIZE);
+
+    DNALength RunLength(DNALength cpPos) const;
+
+    //
+    // The position in the original sequence of the first base of the
+    // run at cpPos.  cpPos may be length, which gives the end of the
+    // compressed part of the original sequence.
+    //
+    DNALength LookupSequencePos(DNALength cpPos) const;
+
+    void Write(std::string outFileName);
+
+    int Read(std::string inFileName);
+
+    void Free();
+};
+
+#endif // _BLASR_HOMOPOLYMER_COMPRESSED_SEQUENCE_HPP_
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "utils.hpp"
+#include "TwoBitSequence.hpp"
+
+const DNALength TwoBitSequence::NucsPerWord;
+
+//
+// The ascii bases of each byte of a packed word, lowest bits first.
+//
+class TwoBitByteTable {
+public:
+    char ascii[256][4];
+    TwoBitByteTable() {
+        int b, i;
+        for (b = 0; b < 256; b++) {
+            for (i = 0; i < 4; i++) {
+                ascii[b][i] = TwoBitToAscii[(b >> (2 * i)) & 3];
+            }
+        }
+    }
+};
+
+static const TwoBitByteTable &ByteTable() {
+    static TwoBitByteTable table;
+    return table;
+}
+
+static inline void UnpackWord(TwoBitWord word, Nucleotide *dest) {
+    const TwoBitByteTable &table = ByteTable();
+    int b;
+    for (b = 0; b < 8; b++) {
+        memcpy(dest + 4 * b, table.ascii[(word >> (8 * b)) & 255], 4);
+    }
+}
+
+//
+// Reverse the order of the 32 bases of a word and complement them;
+// complementing a 2 bit code is 3 - code.
+//
+static inline TwoBitWord ReverseComplementWord(TwoBitWord word) {
+    word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+    word = ((word >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((word & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    word = __builtin_bswap64(word);
+    return ~word;
+}
+
+static bool EndsAfter(DNALength pos, const std::pair<DNALength, DNALength> &run) {
+    return pos < run.second;
+}
+
+TwoBitSequence::TwoBitSequence() {
+    length = 0;
+    seq.packed = this;
+}
+
+TwoBitSequence::TwoBitSequence(const TwoBitSequence &rhs) {
+    words  = rhs.words;
+    nWords = rhs.nWords;
+    nRuns  = rhs.nRuns;
+    length = rhs.length;
+    seq.packed = this;
+}
+
+TwoBitSequence &TwoBitSequence::operator=(const TwoBitSequence &rhs) {
+    words  = rhs.words;
+    nWords = rhs.nWords;
+    nRuns  = rhs.nRuns;
+    length = rhs.length;
+    seq.packed = this;
+    return *this;
+}
+
+void TwoBitSequence::Pack(DNASequence &source) {
+    Free();
+    length = source.length;
+    DNALength nPackedWords = CeilOfFraction(length, NucsPerWord);
+    words.assign(nPackedWords, 0);
+    nWords.assign(nPackedWords / 64 + 1, 0);
+    DNALength i;
+    for (i = 0; i < length; i++) {
+        DNALength w = i / NucsPerWord;
+        int code = ThreeBit[source.seq[i]];
+        if (code > 3) {
+            if (!nRuns.empty() and nRuns.back().second == i) {
+                nRuns.back().second++;
+            }
+            else {
+                nRuns.push_back(std::pair<DNALength, DNALength>(i, i + 1));
+            }
+            nWords[w / 64] |= ((TwoBitWord) 1) << (w % 64);
+        }
+        else {
+            words[w] |= ((TwoBitWord) code) << (2 * (i % NucsPerWord));
+        }
+    }
+}
+
+VectorIndex TwoBitSequence::FindNRun(DNALength pos) const {
+    return std::upper_bound(nRuns.begin(), nRuns.end(), pos, EndsAfter) - nRuns.begin();
+}
+
+bool TwoBitSequence::IsN(DNALength pos) const {
+    VectorIndex r = FindNRun(pos);
+    return r < nRuns.size() and nRuns[r].first <= pos;
+}
+
+void TwoBitSequence::Extract(DNALength start, DNALength extractLength, Nucleotide *dest) const {
+    DNALength i;
+    for (i = 0; i + NucsPerWord <= extractLength; i += NucsPerWord) {
+        UnpackWord(Word(start + i), dest + i);
+    }
+    for (; i < extractLength; i++) {
+        DNALength pos = start + i;
+        dest[i] = TwoBitToAscii[(words[pos / NucsPerWord] >> (2 * (pos % NucsPerWord))) & 3];
+    }
+    DNALength end = start + extractLength;
+    VectorIndex r;
+    for (r = FindNRun(start); r < nRuns.size() and nRuns[r].first < end; r++) {
+        DNALength from = std::max(nRuns[r].first, start);
+        DNALength to   = std::min(nRuns[r].second, end);
+        memset(dest + (from - start), 'N', to - from);
+    }
+}
+
+void TwoBitSequence::Extract(DNALength start, DNALength windowLength, DNASequence &window) const {
+    window.Allocate(windowLength);
+    Extract(start, windowLength, window.seq);
+}
+
+void TwoBitSequence::MakeRC(DNASequence &rc, DNALength pos, DNALength rcLength) const {
+    if (rcLength == 0) {
+        rcLength = length - pos;
+    }
+    rc.Allocate(rcLength);
+    DNALength end = pos + rcLength;
+    DNALength i;
+    for (i = 0; i + NucsPerWord <= rcLength; i += NucsPerWord) {
+        UnpackWord(ReverseComplementWord(Word(end - i - NucsPerWord)), rc.seq + i);
+    }
+    for (; i < rcLength; i++) {
+        DNALength p = end - 1 - i;
+        rc.seq[i] = TwoBitToAscii[3 - ((words[p / NucsPerWord] >> (2 * (p % NucsPerWord))) & 3)];
+    }
+    VectorIndex r;
+    for (r = FindNRun(pos); r < nRuns.size() and nRuns[r].first < end; r++) {
+        DNALength from = std::max(nRuns[r].first, pos);
+        DNALength to   = std::min(nRuns[r].second, end);
+        memset(rc.seq + (end - to), 'N', to - from);
+    }
+}
+
+DNALength TwoBitSequence::LongestCommonPrefix(DNALength pos, const Nucleotide *query,
+    DNALength queryLength) const {
+    DNALength limit = std::min(queryLength, length - pos);
+    VectorIndex r = FindNRun(pos);
+    if (r < nRuns.size() and nRuns[r].first < pos + limit) {
+        limit = std::max(nRuns[r].first, pos) - pos;
+    }
+    DNALength lcp = 0;
+    while (lcp < limit) {
+        DNALength n = std::min(NucsPerWord, limit - lcp);
+        TwoBitWord packedQuery = 0;
+        DNALength j;
+        for (j = 0; j < n; j++) {
+            int code = ThreeBit[query[lcp + j]];
+            if (code > 3) {
+                break;
+            }
+            packedQuery |= ((TwoBitWord) code) << (2 * j);
+        }
+        TwoBitWord diff = Word(pos + lcp) ^ packedQuery;
+        if (j < NucsPerWord) {
+            diff &= (((TwoBitWord) 1) << (2 * j)) - 1;
+        }
+        if (diff != 0) {
+            return lcp + __builtin_ctzll(diff) / 2;
+        }
+        lcp += j;
+        if (j < n) {
+            break;
+        }
+    }
+    return lcp;
+}
+
+void TwoBitSequence::Write(std::string outFileName) {
+    std::ofstream out;
+    CrucialOpen(outFileName, out, std::ios::binary | std::ios::out);
+    DNALength nPackedWords = words.size(), nNWords = nWords.size(), nNRuns = nRuns.size();
+    out.write((char*) &length, sizeof(DNALength));
+    out.write((char*) &nPackedWords, sizeof(DNALength));
+    out.write((char*) &nNWords, sizeof(DNALength));
+    out.write((char*) &nNRuns, sizeof(DNALength));
+    if (nPackedWords > 0) {
+        out.write((char*) &words[0], sizeof(TwoBitWord) * nPackedWords);
+    }
+    if (nNWords > 0) {
+        out.write((char*) &nWords[0], sizeof(TwoBitWord) * nNWords);
+    }
+    VectorIndex r;
+    for (r = 0; r < nNRuns; r++) {
+        out.write((char*) &nRuns[r].first, sizeof(DNALength));
+        out.write((char*) &nRuns[r].second, sizeof(DNALength));
+    }
+    out.close();
+}
+
+int TwoBitSequence::Read(std::string inFileName) {
+    Free();
+    std::ifstream in;
+    CrucialOpen(inFileName, in, std::ios::binary | std::ios::in);
+    DNALength inLength, nPackedWords, nNWords, nNRuns;
+    in.read((char*) &inLength, sizeof(DNALength));
+    in.read((char*) &nPackedWords, sizeof(DNALength));
+    in.read((char*) &nNWords, sizeof(DNALength));
+    in.read((char*) &nNRuns, sizeof(DNALength));
+    if (!in.good()) {
+        return 0;
+    }
+    words.resize(nPackedWords);
+    nWords.resize(nNWords);
+    nRuns.resize(nNRuns);
+    if (nPackedWords > 0) {
+        in.read((char*) &words[0], sizeof(TwoBitWord) * nPackedWords);
+    }
+    if (nNWords > 0) {
+        in.read((char*) &nWords[0], sizeof(TwoBitWord) * nNWords);
+    }
+    VectorIndex r;
+    for (r = 0; r < nNRuns; r++) {
+        in.read((char*) &nRuns[r].first, sizeof(DNALength));
+        in.read((char*) &nRuns[r].second, sizeof(DNALength));
+    }
+    if (!in.good()) {
+        Free();
+        return 0;
+    }
+    length = inLength;
+    return 1;
+}
+
+void TwoBitSequence::Free() {
+    std::vector<TwoBitWord>().swap(words);
+    std::vector<TwoBitWord>().swap(nWords);
+    std::vector<std::pair<DNALength, DNALength> >().swap(nRuns);
+    length = 0;
+}
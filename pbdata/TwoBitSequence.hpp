@@ -0,0 +1,135 @@
+#ifndef _BLASR_TWO_BIT_SEQUENCE_HPP_
+#define _BLASR_TWO_BIT_SEQUENCE_HPP_
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Types.h"
+#include "NucConversion.hpp"
+#include "DNASequence.hpp"
+
+typedef uint64_t TwoBitWord;
+
+//
+// A reference held as 2 bits per base, 32 bases to a 64 bit word,
+// with the stretches of N kept apart: about a quarter of the memory of
+// a FASTASequence, so more of it stays in cache during a search.
+//
+// Bases read back as upper case ACGT, or N for any base that is not
+// ACGT.  Each word has a bit that is set when it holds an N; only
+// then is the sorted list of N runs searched.  An N is stored as an A
+// in the packed words.
+//
+// seq is indexed like the seq of a FASTASequence, so a TwoBitSequence
+// may be the reference of MapReadToGenome and the target of
+// SuffixArray::StoreLCPBounds, and compared with
+// DefaultCompareStrings.  Windows are unpacked 32 bases at a time for
+// the aligners, and may be reverse complemented as they are unpacked.
+//
+class TwoBitSequence {
+public:
+    static const DNALength NucsPerWord = 32;
+
+    class Text {
+    public:
+        const TwoBitSequence *packed;
+        Text() {
+            packed = NULL;
+        }
+        Nucleotide operator[](DNALength pos) const {
+            return packed->Get(pos);
+        }
+    };
+
+    std::vector<TwoBitWord> words;
+    std::vector<TwoBitWord> nWords;
+    std::vector<std::pair<DNALength, DNALength> > nRuns;
+    DNALength length;
+    Text seq;
+
+    TwoBitSequence();
+
+    TwoBitSequence(const TwoBitSequence &rhs);
+
+    TwoBitSequence &operator=(const TwoBitSequence &rhs);
+
+    void Pack(DNASequence &source);
+
+    //
+    // The base at pos, or a terminating 0 at or past the end, as the
+    // searches read one past the end of the target.
+    //
+    inline Nucleotide Get(DNALength pos) const;
+
+    //
+    // Whether pos is in a run of N.
+    //
+    bool IsN(DNALength pos) const;
+
+    //
+    // Copy the bases [start, start+extractLength) to dest as ascii.
+    //
+    void Extract(DNALength start, DNALength extractLength, Nucleotide *dest) const;
+
+    //
+    // Set window to a copy of [start, start+windowLength), which it owns.
+    //
+    void Extract(DNALength start, DNALength windowLength, DNASequence &window) const;
+
+    //
+    // Set rc to the reverse complement of [pos, pos+rcLength), or of
+    // the sequence after pos when rcLength is 0, as
+    // DNASequence::MakeRC does.
+    //
+    void MakeRC(DNASequence &rc, DNALength pos=0, DNALength rcLength=0) const;
+
+    //
+    // The number of bases from pos that match query, comparing 32
+    // bases at a time.  An N in either never matches.
+    //
+    DNALength LongestCommonPrefix(DNALength pos, const Nucleotide *query,
+        DNALength queryLength) const;
+
+    void Write(std::string outFileName);
+
+    int Read(std::string inFileName);
+
+    void Free();
+
+private:
+    //
+    // The 32 bases starting at pos, the first in the low bits.  Bases
+    // past the end are 0.
+    //
+    inline TwoBitWord Word(DNALength pos) const;
+
+    //
+    // The first run of N that ends after pos.
+    //
+    VectorIndex FindNRun(DNALength pos) const;
+};
+
+inline Nucleotide TwoBitSequence::Get(DNALength pos) const {
+    if (pos >= length) {
+        return '\0';
+    }
+    DNALength w = pos / NucsPerWord;
+    if ((nWords[w / 64] >> (w % 64)) & 1) {
+        if (IsN(pos)) {
+            return 'N';
+        }
+    }
+    return TwoBitToAscii[(words[w] >> (2 * (pos % NucsPerWord))) & 3];
+}
+
+inline TwoBitWord TwoBitSequence::Word(DNALength pos) const {
+    DNALength w = pos / NucsPerWord, shift = 2 * (pos % NucsPerWord);
+    TwoBitWord word = words[w] >> shift;
+    if (shift > 0 and w + 1 < words.size()) {
+        word |= words[w + 1] << (64 - shift);
+    }
+    return word;
+}
+
+#endif // _BLASR_TWO_BIT_SEQUENCE_HPP_
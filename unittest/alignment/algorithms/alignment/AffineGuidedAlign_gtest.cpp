@@ -0,0 +1,152 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  AffineGuidedAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/AffineGuidedAlign.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "FASTQSequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/GuidedAlign.hpp"
+#include "algorithms/alignment/IDSScoreFunction.hpp"
+#include "algorithms/alignment/AffineGuidedAlign.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+class AffineGuidedAlignTest : public ::testing::Test {
+public:
+    int scoreMat[5][5];
+    AffineGuideBuffers buffers;
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMat[i][j] = (i == j) ? -5 : 6;
+            }
+        }
+    }
+
+    //
+    // Align q, given random quality values and tags, to t along a
+    // banded alignment of the two, with reused and new buffers.  Expect
+    // the same score and alignment from each, and return the first.
+    //
+    int Compare(const string &q, const string &t, int affineOpen, int affineExtend,
+        int bandSize, AlignmentType alignType, bool computeProb, blasr::Alignment &alignment) {
+        DNASequence target;
+        target.Copy(t);
+        FASTQSequence read;
+        MakeRead(q, read);
+
+        IDSScoreFunction<DNASequence, FASTQSequence> scoreFn(scoreMat, 5, 5, 10, 10);
+        scoreFn.substitutionPrior = 20;
+        scoreFn.globalDeletionPrior = 13;
+        scoreFn.affineOpen   = affineOpen;
+        scoreFn.affineExtend = affineExtend;
+
+        //
+        // The guide has its blocks in absolute coordinates.
+        //
+        blasr::Alignment sdpAlignment, guide;
+        GuidedAlign(read, target, scoreFn, 10, 5, 5, 0.15, sdpAlignment, Global, false, 8);
+        guide.blocks = sdpAlignment.blocks;
+        for (size_t b = 0; b < guide.blocks.size(); b++) {
+            guide.blocks[b].qPos += sdpAlignment.qPos;
+            guide.blocks[b].tPos += sdpAlignment.tPos;
+        }
+
+        vector<int> scoreMatrix;
+        vector<Arrow> pathMatrix;
+        vector<double> probMat, optPathProbMat;
+        vector<float> lnSub, lnIns, lnDel, lnMatch;
+        blasr::Alignment allocated;
+        int score = AffineGuidedAlign(read, target, guide, scoreFn,
+            bandSize, alignment, scoreMatrix, pathMatrix, probMat, optPathProbMat,
+            lnSub, lnIns, lnDel, lnMatch, alignType, computeProb, &buffers);
+        int allocatedScore = AffineGuidedAlign(read, target, guide, scoreFn,
+            bandSize, allocated, scoreMatrix, pathMatrix, probMat, optPathProbMat,
+            lnSub, lnIns, lnDel, lnMatch, alignType, computeProb);
+        EXPECT_EQ(score, allocatedScore);
+        EXPECT_EQ(alignment.score, allocated.score);
+        EXPECT_EQ(alignment.probScore, allocated.probScore);
+        ExpectSameAlignment(alignment, allocated);
+        read.Free();
+        target.Free();
+        return score;
+    }
+};
+
+//
+// Scores and alignments from the aligner before its affine scores were
+// stored together in one vector of cells, with the quality values
+// drawn from each case's seed.  Update them only for an intended
+// change.
+//
+TEST_F(AffineGuidedAlignTest, GoldenCases) {
+    const char *t = "ACGTTAGCATGCAGTTTACGATCCAGTAGGCTTAAGTCA";
+    struct {
+        const char *q, *t;
+        int seed, affineOpen, affineExtend, bandSize;
+        AlignmentType alignType;
+        bool computeProb;
+        int score;
+        const char *blocks;
+    } cases[] = {
+        {"ACGTTAGCCATGCAGTTACGATCCAGTAGGCTAAGTCA", t, 1, 0, 0, 0, Global, false,
+            0, "0,0,7 8,7,7 16,16,15 32,33,6"},
+        {"ACGTTAGCCATGCAGTTACGATCCAGTAGGCTAAGTCA", t, 2, 8, 1, 3, Global, true,
+            23, "0,0,7 8,7,7 15,15,16 31,32,7"},
+        // Query bases on either side of the target.
+        {"GGCATTACGTTAGCCATGCAGTTACGATCCAGTAGGCTAAGTCATTG", t, 3, 6, 2, 10, Local, false,
+            24, "6,0,7 14,7,7 21,15,16 37,32,7"},
+        // A four base deletion.
+        {"ACGTTAGCATGCAGTTACGAACCGTAGCTAAGTCA", t, 4, 9, 3, 3, Global, true,
+            65, "0,0,16 16,17,7 23,25,3 26,29,2 28,32,7"},
+        // An N in each sequence.
+        {"ACGTTAGCATGCAGTTACGANCCAGTAGGCTAAGTCA", "ACGTTAGCATGCAGTTTACGATCCAGTANGCTTAAGTCA",
+            5, 4, 1, 10, Local, true, 30, "0,0,14 14,15,6 21,22,6 30,32,7"},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        srand(cases[c].seed);
+        blasr::Alignment alignment;
+        EXPECT_EQ(cases[c].score, Compare(cases[c].q, cases[c].t, cases[c].affineOpen,
+            cases[c].affineExtend, cases[c].bandSize, cases[c].alignType,
+            cases[c].computeProb, alignment)) << "case " << c;
+        EXPECT_EQ(cases[c].blocks, BlockString(alignment)) << "case " << c;
+    }
+}
+
+//
+// Buffers reused from other reads give the same results as new ones.
+//
+TEST_F(AffineGuidedAlignTest, RandomReads) {
+    int bandSizes[] = {0, 3, 10};
+    for (int it = 0; it < 60; it++) {
+        srand(it);
+        int length = 50 + rand() % 800;
+        string t;
+        for (int i = 0; i < length; i++) {
+            t += Bases[rand() % 4];
+        }
+        if (it % 5 == 0) {
+            t[rand() % length] = 'N';
+        }
+        string q = Mutate(t, 0.15);
+        int affineOpen = rand() % 10, affineExtend = rand() % 4;
+        SCOPED_TRACE(it);
+        blasr::Alignment alignment;
+        Compare(q, t, affineOpen, affineExtend, bandSizes[it % 3],
+            (it % 3 == 0) ? Local : Global, it % 2, alignment);
+        EXPECT_LT(0u, alignment.blocks.size());
+    }
+}
@@ -0,0 +1,193 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  AffineKBandAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/AffineKBandAlign.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/AffineKBandAlign.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+//
+// Homopolymer rich, so the homopolymer insertion state is exercised.
+//
+static string RandomTarget(int length) {
+    string t;
+    while ((int) t.size() < length) {
+        t.append(1 + rand() % 3, Bases[rand() % 4]);
+    }
+    return t;
+}
+
+class AffineKBandAlignTest : public ::testing::Test {
+public:
+    int scoreMat[5][5];
+    int hpInsOpen, hpInsExtend, insOpen, insExtend, del;
+    AffineKBandBuffers buffers;
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMat[i][j] = (i == j) ? -5 : 6;
+            }
+        }
+        hpInsOpen = 3; hpInsExtend = 2; insOpen = 5; insExtend = 3; del = 5;
+    }
+
+    //
+    // Align with reused buffers, with new ones, and through the
+    // overload that takes a matrix per state, expect the same score
+    // and alignment from each, and return the first.
+    //
+    int Compare(const string &q, const string &t, int k, AlignmentType alignType,
+        blasr::Alignment &alignment) {
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+        vector<int> s1, s2, s3;
+        vector<Arrow> p1, p2, p3;
+        AffineKBandBuffers freshBuffers;
+        blasr::Alignment fresh, forwarded;
+        int score = AffineKBandAlign(qSeq, tSeq, scoreMat, hpInsOpen,
+            hpInsExtend, insOpen, insExtend, del, k, buffers, alignment, alignType);
+        int freshScore = AffineKBandAlign(qSeq, tSeq, scoreMat, hpInsOpen,
+            hpInsExtend, insOpen, insExtend, del, k, freshBuffers, fresh, alignType);
+        int forwardedScore = AffineKBandAlign(qSeq, tSeq, scoreMat, hpInsOpen,
+            hpInsExtend, insOpen, insExtend, del, k, s1, p1, s2, p2, s3, p3,
+            forwarded, alignType);
+        SCOPED_TRACE("q=" + q + " t=" + t);
+        EXPECT_EQ(score, freshScore);
+        EXPECT_EQ(score, forwardedScore);
+        ExpectSameAlignment(alignment, fresh);
+        ExpectSameAlignment(alignment, forwarded);
+        return score;
+    }
+
+    int Compare(const string &q, const string &t, int k, AlignmentType alignType) {
+        blasr::Alignment alignment;
+        return Compare(q, t, k, alignType, alignment);
+    }
+
+    void ExpectAlignment(const string &q, const string &t, int k, AlignmentType alignType,
+        int score, const char *blocks) {
+        blasr::Alignment alignment;
+        EXPECT_EQ(score, Compare(q, t, k, alignType, alignment)) << "q=" << q << " t=" << t;
+        EXPECT_EQ(blocks, BlockString(alignment)) << "q=" << q << " t=" << t;
+    }
+};
+
+//
+// Scores and alignments from the aligner before its three affine
+// states were fused into one strip, which kept a full matrix for
+// each state.  Update them only for an intended change.
+//
+TEST_F(AffineKBandAlignTest, GoldenCases) {
+    struct {
+        const char *q, *t;
+        int k;
+        AlignmentType alignType;
+        int hpInsOpen, hpInsExtend, insOpen, insExtend;
+        int score;
+        const char *blocks;
+    } cases[] = {
+        // Homopolymer insertion, other insertion, and deletion.
+        {"ACGTTTTACGA",    "ACGTTACGA",      3, Global,    3, 2, 5, 3, -40, "0,0,3 5,3,6"},
+        {"ACGTCAGTACGA",   "ACGTAGTACGA",    3, Global,    3, 2, 5, 3, -52, "0,0,4 5,4,7"},
+        {"ACGTAGTACGA",    "ACGTCAGTACGA",   3, Global,    3, 2, 5, 3, -50, "0,0,4 4,5,7"},
+        {"ACGTACGTAC",     "ACGAACGTAC",     2, Global,    3, 2, 5, 3, -39, "0,0,10"},
+        // A long homopolymer insertion, then one cheaper as insertions.
+        {"ACCCCCCGTA",     "ACCGTA",         4, Global,    3, 2, 5, 3, -21, "0,0,1 5,1,5"},
+        {"ACCCCCCGTA",     "ACCGTA",         4, Global,    0, 6, 2, 1, -30, "0,0,1 5,1,5"},
+        {"GTACCA",         "TTACGTACCATTGA", 8, QueryFit,  3, 2, 5, 3, -10, "0,4,6"},
+        {"TTACGTACCATTGA", "GTACCA",         8, TargetFit, 3, 2, 5, 3,  -7, "1,1,3"},
+        // The shift is wider than the band.
+        {"AAAACCCCGGGG",   "CCCCGGGGTTTT",   2, Global,    3, 2, 5, 3,  31, "0,0,1 3,1,7 10,10,2"},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        hpInsOpen = cases[c].hpInsOpen;
+        hpInsExtend = cases[c].hpInsExtend;
+        insOpen = cases[c].insOpen;
+        insExtend = cases[c].insExtend;
+        ExpectAlignment(cases[c].q, cases[c].t, cases[c].k, cases[c].alignType,
+            cases[c].score, cases[c].blocks);
+    }
+}
+
+//
+// Buffers reused from larger pairs, and the overload with a matrix per
+// state, give the same results as new buffers.
+//
+TEST_F(AffineKBandAlignTest, RandomPairs) {
+    AlignmentType types[] = {Global, QueryFit, TargetFit};
+    for (int it = 0; it < 600; it++) {
+        srand(it);
+        string t = RandomTarget(1 + rand() % (it < 300 ? 40 : 600));
+        string q = Mutate(t, 0.2);
+        if (q.empty()) {
+            q = "A";
+        }
+        AlignmentType alignType = types[it % 3];
+        if (alignType == QueryFit) {
+            q = q.substr(rand() % q.size());
+        }
+        else if (alignType == TargetFit) {
+            q = t;
+            q[rand() % q.size()] = Bases[rand() % 4];
+        }
+        if (it % 7 == 2) {
+            t = t.substr(0, 1 + rand() % t.size());
+        }
+        hpInsOpen = rand() % 8; hpInsExtend = rand() % 6;
+        insOpen = rand() % 10; insExtend = rand() % 6; del = rand() % 8;
+        Compare(q, t, 1 + rand() % 30, alignType);
+    }
+}
+
+TEST_F(AffineKBandAlignTest, BandWidthZero) {
+    ExpectAlignment("ACGTACGT", "ACGTACGT", 0, Global, -40, "0,0,8");
+    ExpectAlignment("ACGTTCGT", "ACGTACGT", 0, Global, -29, "0,0,8");
+    ExpectAlignment("AACCGGTT", "AACCGGTT", 0, QueryFit, -40, "0,0,8");
+}
+
+TEST_F(AffineKBandAlignTest, AllGap) {
+    //
+    // Mismatches cost more than a deletion and an insertion, so the
+    // best alignment has no matched bases, and runs are inserted as
+    // homopolymers.
+    //
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            if (i != j) {
+                scoreMat[i][j] = 100;
+            }
+        }
+    }
+    ExpectAlignment("AAAA", "CCCC", 4, Global, 29, "");
+    ExpectAlignment("GGGGGG", "TTTT", 4, Global, 33, "");
+    ExpectAlignment("AAAAAAAA", "C", 8, Global, 22, "");
+}
+
+TEST_F(AffineKBandAlignTest, SingleBase) {
+    ExpectAlignment("A", "A", 1, Global, -5, "0,0,1");
+    ExpectAlignment("A", "C", 1, Global, 6, "0,0,1");
+    ExpectAlignment("A", "ACGT", 4, QueryFit, -5, "0,0,1");
+}
+
+TEST_F(AffineKBandAlignTest, Empty) {
+    ExpectAlignment("", "ACGT", 4, Global, 20, "");
+    ExpectAlignment("ACGT", "", 4, Global, 17, "");
+    ExpectAlignment("", "", 0, Global, 0, "");
+}
@@ -0,0 +1,438 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  AlignmentBlockStats_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/AlignmentBlockStats.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "NucConversion.hpp"
+#include "SMRTSequence.hpp"
+#include "datastructures/alignment/AlignmentCandidate.hpp"
+#include "datastructures/alignment/AlignmentContext.hpp"
+#include "datastructures/alignmentset/SAMSupplementalQVList.hpp"
+#include "algorithms/alignment/AlignmentUtils.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/AlignmentBlockStats.hpp"
+#include "format/SAMPrinter.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+namespace {
+
+//
+// Random bases for a gap of an alignment.
+//
+string RandomBases(int length) {
+    string s;
+    for (int i = 0; i < length; i++) {
+        s += Bases[rand() % 4];
+    }
+    return s;
+}
+
+//
+// A gap list holding an insertion, a deletion, or both in either
+// order, with the gapped bases appended to q and t.
+//
+void AddGapList(string &q, string &t, DNALength &qRel, DNALength &tRel,
+    blasr::GapList &gapList) {
+    int kind = rand() % 4;
+    for (int g = 0; g < 2; g++) {
+        bool insertion = (kind == 0) or (kind == 2 and g == 0) or (kind == 3 and g == 1);
+        bool deletion  = (kind == 1) or (kind == 2 and g == 1) or (kind == 3 and g == 0);
+        int length = 1 + rand() % 6;
+        if (insertion) {
+            gapList.push_back(blasr::Gap(blasr::Gap::Target, length));
+            q += RandomBases(length);
+            qRel += length;
+        }
+        else if (deletion) {
+            gapList.push_back(blasr::Gap(blasr::Gap::Query, length));
+            t += RandomBases(length);
+            tRel += length;
+        }
+        if (kind < 2) {
+            break;
+        }
+    }
+}
+
+//
+// A random alignment of nBlocks blocks in q and t, after a few
+// unaligned bases, with a gap list between each pair of blocks and
+// sometimes one before the first.  About a tenth of the aligned bases
+// each mismatch, differ only in case, or are N in one or both
+// sequences.  Every gap list but the first holds some gap, as in the
+// alignments blasr prints, so no two blocks are adjacent.
+//
+void MakeAlignment(int nBlocks, string &q, string &t, T_AlignmentCandidate &a) {
+    q = RandomBases(rand() % 5);
+    t = RandomBases(rand() % 5);
+    a.qPos = q.size();
+    a.tPos = t.size();
+    DNALength qRel = 0, tRel = 0;
+    a.gaps.push_back(blasr::GapList());
+    if (rand() % 2) {
+        AddGapList(q, t, qRel, tRel, a.gaps[0]);
+    }
+    for (int b = 0; b < nBlocks; b++) {
+        if (b > 0) {
+            a.gaps.push_back(blasr::GapList());
+            AddGapList(q, t, qRel, tRel, a.gaps.back());
+        }
+        blasr::Block block;
+        block.qPos = qRel;
+        block.tPos = tRel;
+        block.length = 1 + rand() % 40;
+        for (DNALength i = 0; i < block.length; i++) {
+            char tb = Bases[rand() % 4], qb = tb;
+            int x = rand() % 40;
+            if (x < 4) {
+                qb = Bases[(rand() % 3 + 1 + (ThreeBit[(int) tb])) % 4];
+            }
+            else if (x < 8) {
+                (rand() % 2 ? qb : tb) = tolower(tb);
+            }
+            else if (x < 10) {
+                qb = 'N';
+            }
+            else if (x < 12) {
+                tb = (x == 10) ? 'N' : 'n';
+                qb = 'N';
+            }
+            q += qb;
+            t += tb;
+        }
+        qRel += block.length;
+        tRel += block.length;
+        a.blocks.push_back(block);
+    }
+    // The gaps after the last block, which are not part of the alignment.
+    a.gaps.push_back(blasr::GapList());
+    q += RandomBases(rand() % 5);
+    t += RandomBases(rand() % 5);
+    ((DNASequence&) a.qAlignedSeq).Copy(q);
+    a.tAlignedSeq.Copy(t);
+    a.qLength = q.size();
+    a.tLength = t.size();
+}
+
+//
+// The statistics as ComputeAlignmentStats computed them before it
+// used the blocks and gap list: counted from the alignment strings.
+//
+class StringStats {
+public:
+    int nMatch, nMismatch, nIns, nDel, score;
+    float pctSimilarity;
+    string textStr, queryStr;
+
+    StringStats(T_AlignmentCandidate &a, int scoreMatrix[5][5], int ins, int del) {
+        string alignStr;
+        CreateAlignmentStrings(a, a.qAlignedSeq.seq, a.tAlignedSeq.seq, textStr,
+            alignStr, queryStr);
+        nMatch = nMismatch = nIns = nDel = 0;
+        for (size_t i = 0; i < textStr.size(); i++) {
+            if (textStr[i] != '-' and queryStr[i] != '-') {
+                if (ThreeBit[(int) textStr[i]] == ThreeBit[(int) queryStr[i]]) {
+                    nMatch++;
+                }
+                else {
+                    nMismatch++;
+                }
+            }
+            else if (textStr[i] == '-') {
+                nIns++;
+            }
+            else {
+                nDel++;
+            }
+        }
+        pctSimilarity = 0;
+        if (textStr.size() + queryStr.size() > 0) {
+            pctSimilarity = (nMatch*2.0) / (textStr.size() + queryStr.size()) * 100;
+        }
+        DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMatrix, ins, del);
+        score = ComputeAlignmentScore(queryStr, textStr, scoreFn);
+    }
+
+    //
+    // The =/X/I/D operations of the columns, with aligned bases
+    // matching by ThreeBit code or by byte.
+    //
+    string Ops(bool exactBase) {
+        vector<int> opSize;
+        vector<char> opChar;
+        for (size_t i = 0; i < textStr.size(); i++) {
+            char op;
+            if (textStr[i] == '-') {
+                op = 'I';
+            }
+            else if (queryStr[i] == '-') {
+                op = 'D';
+            }
+            else if (exactBase) {
+                op = (textStr[i] == queryStr[i]) ? '=' : 'X';
+            }
+            else {
+                op = (ThreeBit[(int) textStr[i]] == ThreeBit[(int) queryStr[i]]) ? '=' : 'X';
+            }
+            if (!opChar.empty() and opChar.back() == op) {
+                opSize.back()++;
+            }
+            else {
+                opSize.push_back(1);
+                opChar.push_back(op);
+            }
+        }
+        string ops;
+        SAMOutput::CigarOpsToString(opSize, opChar, ops);
+        return ops;
+    }
+
+    //
+    // The MD string of the columns: match run lengths, the target base
+    // of each mismatch, and ^ and the bases of each deletion.
+    //
+    string MD() {
+        stringstream md;
+        int run = 0;
+        bool inDeletion = false;
+        for (size_t i = 0; i < textStr.size(); i++) {
+            if (textStr[i] == '-') {
+                continue;
+            }
+            if (queryStr[i] == '-') {
+                if (!inDeletion) {
+                    md << run << '^';
+                    run = 0;
+                }
+                md << (char) toupper(textStr[i]);
+                inDeletion = true;
+                continue;
+            }
+            inDeletion = false;
+            if (ThreeBit[(int) textStr[i]] == ThreeBit[(int) queryStr[i]]) {
+                run++;
+            }
+            else {
+                md << run << (char) toupper(textStr[i]);
+                run = 0;
+            }
+        }
+        md << run;
+        return md.str();
+    }
+};
+
+//
+// The =/X operations SAMOutput::AddMatchBlockCigarOps made before it
+// used AppendMatchRunOps, one base at a time.
+//
+void PerBaseMatchBlockCigarOps(DNASequence &qSeq, DNASequence &tSeq, blasr::Block &b,
+    DNALength qSeqPos, DNALength tSeqPos, vector<int> &opSize, vector<char> &opChar) {
+    DNALength qPos = qSeqPos + b.qPos, tPos = tSeqPos + b.tPos;
+    bool started = false, prevSeqMatch = false;
+    for (DNALength i = 0; i < b.length; i++) {
+        bool curSeqMatch = (qSeq[qPos + i] == tSeq[tPos + i]);
+        if (started and curSeqMatch == prevSeqMatch) {
+            opSize.back()++;
+        }
+        else {
+            started = true;
+            opSize.push_back(1);
+            opChar.push_back(curSeqMatch ? '=' : 'X');
+        }
+        prevSeqMatch = curSeqMatch;
+    }
+}
+
+bool BasesMatch(char q, char t, BaseMatchRule rule) {
+    if (rule == MatchThreeBit) {
+        return ThreeBit[(int) q] == ThreeBit[(int) t];
+    }
+    else if (rule == MatchTwoBit) {
+        return TwoBit[(int) q] == TwoBit[(int) t];
+    }
+    return q == t;
+}
+
+}
+
+class AlignmentBlockStatsTest : public ::testing::Test {
+public:
+    int scoreMatrix[5][5];
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMatrix[i][j] = (i == j) ? -5 : 6;
+            }
+        }
+    }
+};
+
+//
+// Runs that end in every position of a word, from unaligned starts,
+// under each rule.
+//
+TEST_F(AlignmentBlockStatsTest, MatchRunLengthMatchesPerBase) {
+    srand(39);
+    BaseMatchRule rules[] = {MatchExactBase, MatchThreeBit, MatchTwoBit};
+    for (int it = 0; it < 2000; it++) {
+        string q, t;
+        int length = rand() % 40, offset = rand() % 8;
+        for (int i = 0; i < offset + length; i++) {
+            char b = "ACGTNacgtn"[rand() % 10];
+            t += b;
+            q += (rand() % 12) ? b : "ACGTNacgtn"[rand() % 10];
+        }
+        for (int r = 0; r < 3; r++) {
+            DNALength expected = 0;
+            while ((int) expected < length and
+                BasesMatch(q[offset + expected], t[offset + expected], rules[r])) {
+                expected++;
+            }
+            EXPECT_EQ(expected, MatchRunLength((Nucleotide*) &q[offset],
+                (Nucleotide*) &t[offset], length, rules[r]))
+                << "rule " << r << " q=" << q.substr(offset) << " t=" << t.substr(offset);
+        }
+    }
+}
+
+//
+// Counts, the edit distance blasr prints as NM, identity and score from
+// the blocks and gap list are those counted from the alignment
+// strings, with a uniform and a varying match score.
+//
+TEST_F(AlignmentBlockStatsTest, StatsMatchAlignmentStrings) {
+    srand(40);
+    for (int it = 0; it < 400; it++) {
+        if (it == 200) {
+            scoreMatrix[2][2] = -3;
+            scoreMatrix[4][4] = 0;
+        }
+        T_AlignmentCandidate a;
+        string q, t;
+        MakeAlignment(1 + rand() % 12, q, t, a);
+        StringStats expected(a, scoreMatrix, 4, 7);
+        SCOPED_TRACE(testing::Message() << "it " << it << "\n" << expected.queryStr
+            << "\n" << expected.textStr);
+
+        ComputeAlignmentStats(a, a.qAlignedSeq.seq, a.tAlignedSeq.seq, scoreMatrix, 4, 7);
+        EXPECT_EQ(expected.nMatch, a.nMatch);
+        EXPECT_EQ(expected.nMismatch, a.nMismatch);
+        EXPECT_EQ(expected.nIns, a.nIns);
+        EXPECT_EQ(expected.nDel, a.nDel);
+        EXPECT_EQ(expected.nMismatch + expected.nIns + expected.nDel,
+            a.nMismatch + a.nIns + a.nDel);
+        EXPECT_FLOAT_EQ(expected.pctSimilarity, a.pctSimilarity);
+        EXPECT_EQ(expected.score, a.score);
+
+        AlignmentBlockStats stats;
+        ComputeAlignmentBlockStats(a, a.qAlignedSeq.seq, a.tAlignedSeq.seq, stats,
+            scoreMatrix, 4, 7, true, true);
+        EXPECT_EQ(expected.score, stats.score);
+        string ops;
+        SAMOutput::CigarOpsToString(stats.opSize, stats.opChar, ops);
+        EXPECT_EQ(expected.Ops(false), ops);
+        EXPECT_EQ(expected.MD(), stats.mdString);
+    }
+}
+
+//
+// The =/X/I/D CIGAR of either strand is that of the alignment columns,
+// and each block's operations are those made one base at a time.
+//
+TEST_F(AlignmentBlockStatsTest, CigarMatchesAlignmentStrings) {
+    srand(41);
+    for (int it = 0; it < 300; it++) {
+        T_AlignmentCandidate a;
+        string q, t;
+        MakeAlignment(1 + rand() % 12, q, t, a);
+        StringStats expected(a, scoreMatrix, 4, 7);
+        SCOPED_TRACE(testing::Message() << "it " << it << "\n" << expected.queryStr
+            << "\n" << expected.textStr);
+
+        for (size_t b = 0; b < a.blocks.size(); b++) {
+            vector<int> opSize, expOpSize;
+            vector<char> opChar, expOpChar;
+            SAMOutput::AddMatchBlockCigarOps(a.qAlignedSeq, a.tAlignedSeq, a.blocks[b],
+                a.qPos, a.tPos, opSize, opChar);
+            PerBaseMatchBlockCigarOps(a.qAlignedSeq, a.tAlignedSeq, a.blocks[b],
+                a.qPos, a.tPos, expOpSize, expOpChar);
+            EXPECT_EQ(expOpSize, opSize);
+            EXPECT_EQ(expOpChar, opChar);
+        }
+
+        string expectedOps = expected.Ops(true), ops;
+        vector<int> opSize;
+        vector<char> opChar;
+        SAMOutput::CreateNoClippingCigarOps(a, opSize, opChar, true);
+        SAMOutput::CigarOpsToString(opSize, opChar, ops);
+        EXPECT_EQ(expectedOps, ops);
+
+        a.tStrand = 1;
+        SAMOutput::CreateNoClippingCigarOps(a, opSize, opChar, true);
+        reverse(opSize.begin(), opSize.end());
+        reverse(opChar.begin(), opChar.end());
+        SAMOutput::CigarOpsToString(opSize, opChar, ops);
+        EXPECT_EQ(expectedOps, ops);
+    }
+}
+
+//
+// A SAM record of an alignment with mismatches, case differences, N
+// bases and mixed gaps, on each strand.  These lines are the same as
+// before AddMatchBlockCigarOps used AppendMatchRunOps; update them
+// only for an intended change.
+//
+TEST_F(AlignmentBlockStatsTest, SAMRecordIsPinned) {
+    srand(42);
+    T_AlignmentCandidate a;
+    string q, t;
+    MakeAlignment(4, q, t, a);
+    a.qName = "movie/1/0_100";
+    a.tName = "ref";
+    a.mapQV = 254;
+    ComputeAlignmentStats(a, a.qAlignedSeq.seq, a.tAlignedSeq.seq, scoreMatrix, 4, 7);
+
+    SMRTSequence read;
+    ((DNASequence&) read).Copy(q);
+    AlignmentContext context;
+    context.readGroupId = "rg";
+    context.editDist = a.nMismatch + a.nIns + a.nDel;
+    SupplementalQVList qvList;
+    qvList.clear();
+
+    stringstream forwardRecord, reverseRecord;
+    SAMOutput::PrintAlignment(a, read, forwardRecord, context, qvList, SAMOutput::none, true);
+    a.tStrand = 1;
+    SAMOutput::PrintAlignment(a, read, reverseRecord, context, qvList, SAMOutput::none, true);
+    EXPECT_EQ("movie/1/0_100\t0\tref\t2\t254\t"
+        "4=1X2=2X4=1X5=1X3=1X4=1X1=1X1=1X1=3X2=6I1D2X5=1X3=6D6I1X1=2X1=1X4=1X1=3X1=2D3=1X2=3X"
+        "2=2X1=\t*\t0\t0\t"
+        "CTGCGATNcCCCACCATGTAGAAtACGNTAGCNGGtTGAAATAATCNTAAGCNCAGGAATATATGGANAGACNNTNAAGTTTGTA"
+        "gACAANG\t*\tRG:Z:rg\tAS:i:-91\tXS:i:2\tXE:i:94\tYS:i:0\tYE:i:0\tZM:i:0\tXL:i:95\t"
+        "XT:i:1\tNM:i:39\tFI:i:1\tXQ:i:95\n", forwardRecord.str());
+    EXPECT_EQ("movie/1/0_100\t16\tref\t5\t254\t"
+        "1=2X2=3X2=1X3=2D1=3X1=1X4=1X1=2X1=1X6I6D3=1X5=2X1D6I2=3X1=1X1=1X1=1X4=1X3=1X5=1X4=2X"
+        "2=1X4=\t*\t0\t0\t"
+        "CNTTGTcTACAAACTTNANNGTCTNTCCATATATTCCTGNGCTTANGATTATTTCAaCCNGCTANCGTaTTCTACATGGTGGGgN"
+        "ATCGCAG\t*\tRG:Z:rg\tAS:i:-91\tXS:i:2\tXE:i:94\tYS:i:0\tYE:i:0\tZM:i:0\tXL:i:95\t"
+        "XT:i:1\tNM:i:39\tFI:i:1\tXQ:i:95\n", reverseRecord.str());
+    read.Free();
+}
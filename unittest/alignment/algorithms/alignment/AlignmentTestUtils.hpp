@@ -0,0 +1,109 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  AlignmentTestUtils.hpp
+ *
+ *    Description:  Reads, mutations and alignment comparisons shared by
+ *                  the alignment algorithm tests.
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef _BLASR_UNITTEST_ALIGNMENT_TEST_UTILS_HPP_
+#define _BLASR_UNITTEST_ALIGNMENT_TEST_UTILS_HPP_
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include "gtest/gtest.h"
+#include "FASTQSequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+
+//
+// Each test is its own translation unit, so the helpers are kept out
+// of the combined runner's global namespace.  They are inline so that
+// a test need not use all of them.
+//
+namespace {
+
+const char *const Bases = "ACGT";
+
+//
+// A copy of s with about rate of its bases deleted, substituted, or
+// preceded by a random insertion, in equal parts.
+//
+inline std::string Mutate(const std::string &s, double rate) {
+    std::string r;
+    for (size_t i = 0; i < s.size(); i++) {
+        double x = rand() / (double) RAND_MAX;
+        if (x < rate / 3) {
+            continue;
+        }
+        else if (x < 2 * rate / 3) {
+            r += Bases[rand() % 4];
+            r += s[i];
+        }
+        else if (x < rate) {
+            r += Bases[rand() % 4];
+        }
+        else {
+            r += s[i];
+        }
+    }
+    return r;
+}
+
+//
+// A read of q with random quality values and tags.
+//
+inline void MakeRead(const std::string &q, FASTQSequence &read) {
+    ((DNASequence&) read).Copy(q);
+    read.AllocateQualitySpace(read.length);
+    read.AllocateDeletionQVSpace(read.length);
+    read.AllocateInsertionQVSpace(read.length);
+    read.AllocateSubstitutionQVSpace(read.length);
+    read.AllocateDeletionTagSpace(read.length);
+    read.AllocateSubstitutionTagSpace(read.length);
+    for (DNALength i = 0; i < read.length; i++) {
+        read.qual[i]            = 5 + rand() % 30;
+        read.deletionQV[i]      = 5 + rand() % 20;
+        read.insertionQV[i]     = 5 + rand() % 20;
+        read.substitutionQV[i]  = 5 + rand() % 20;
+        read.deletionTag[i]     = "ACGTN"[rand() % 5];
+        read.substitutionTag[i] = Bases[rand() % 4];
+    }
+}
+
+//
+// The blocks of an alignment as "qPos,tPos,length" triples, in
+// absolute coordinates, to pin expected alignments with.
+//
+inline std::string BlockString(blasr::Alignment &a) {
+    std::stringstream s;
+    for (size_t i = 0; i < a.blocks.size(); i++) {
+        s << (i ? " " : "") << a.qPos + a.blocks[i].qPos << ","
+          << a.tPos + a.blocks[i].tPos << "," << a.blocks[i].length;
+    }
+    return s.str();
+}
+
+//
+// The positions and blocks of two alignments are the same.  Scores
+// are compared by the callers that set them.
+//
+inline void ExpectSameAlignment(blasr::Alignment &a, blasr::Alignment &b) {
+    EXPECT_EQ(a.qPos, b.qPos);
+    EXPECT_EQ(a.tPos, b.tPos);
+    ASSERT_EQ(a.blocks.size(), b.blocks.size());
+    for (size_t i = 0; i < a.blocks.size(); i++) {
+        EXPECT_EQ(a.blocks[i].qPos, b.blocks[i].qPos);
+        EXPECT_EQ(a.blocks[i].tPos, b.blocks[i].tPos);
+        EXPECT_EQ(a.blocks[i].length, b.blocks[i].length);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  AlignmentWorkspace_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/AlignmentWorkspace.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdlib>
+#include <string>
+#include "gtest/gtest.h"
+#include "FASTQSequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/AlignmentWorkspace.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+class AlignmentWorkspaceTest : public ::testing::Test {
+public:
+    int scoreMat[5][5];
+    FASTQSequence query;
+    DNASequence target;
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMat[i][j] = (i == j) ? -5 : 6;
+            }
+        }
+        srand(3);
+        string t, q;
+        for (int i = 0; i < 600; i++) {
+            t += "ACGT"[rand() % 4];
+        }
+        for (size_t i = 0; i < t.size(); i++) {
+            int x = rand() % 20;
+            if (x == 0) {
+                continue;
+            }
+            q += (x == 1) ? "ACGT"[rand() % 4] : t[i];
+            if (x == 2) {
+                q += "ACGT"[rand() % 4];
+            }
+        }
+        target.Copy(t);
+        ((DNASequence&) query).Copy(q);
+    }
+};
+
+TEST_F(AlignmentWorkspaceTest, GuidedAlignUsesWorkspace) {
+    DistanceMatrixScoreFunction<DNASequence, FASTQSequence> scoreFn(scoreMat, 5, 5);
+    AlignmentWorkspace workspace;
+    blasr::Alignment plain, withWorkspace;
+    int plainScore = GuidedAlign(query, target, scoreFn, 10, 5, 5, 0.15, plain);
+    int workspaceScore = GuidedAlign(query, target, scoreFn, 10, 5, 5, 0.15,
+        workspace, withWorkspace);
+    EXPECT_EQ(plainScore, workspaceScore);
+    ExpectSameAlignment(plain, withWorkspace);
+    EXPECT_LT(0, workspace.scoreMat.capacity());
+    EXPECT_LT(0, workspace.sdpFragmentSet.capacity());
+}
+
+TEST_F(AlignmentWorkspaceTest, AffineGuidedAlignUsesAffineBuffers) {
+    DistanceMatrixScoreFunction<DNASequence, FASTQSequence> scoreFn(scoreMat, 5, 5);
+    scoreFn.affineOpen = 8;
+    scoreFn.affineExtend = 1;
+    AlignmentWorkspace workspace;
+    blasr::Alignment plain, withWorkspace;
+    int plainScore = AffineGuidedAlign(query, target, scoreFn, 10, 5, 5, 0.15, plain);
+    EXPECT_EQ(0, workspace.affineGuide.gapScores.capacity());
+    int workspaceScore = AffineGuidedAlign(query, target, scoreFn, 10, 5, 5, 0.15,
+        workspace, withWorkspace);
+    EXPECT_EQ(plainScore, workspaceScore);
+    ExpectSameAlignment(plain, withWorkspace);
+    EXPECT_LT(0, workspace.affineGuide.gapScores.capacity());
+    EXPECT_LT(0, workspace.affineGuide.gapArrows.capacity());
+}
+
+TEST_F(AlignmentWorkspaceTest, PeakBytes) {
+    DistanceMatrixScoreFunction<DNASequence, FASTQSequence> scoreFn(scoreMat, 5, 5);
+    AlignmentWorkspace workspace;
+    EXPECT_EQ(0, workspace.AllocatedBytes());
+    EXPECT_EQ(0, workspace.PeakBytes());
+
+    blasr::Alignment alignment;
+    GuidedAlign(query, target, scoreFn, 10, 5, 5, 0.15, workspace, alignment);
+    size_t allocated = workspace.AllocatedBytes();
+    EXPECT_LT(0, allocated);
+    // Reading the peak does not record a new one.
+    EXPECT_EQ(0, workspace.PeakBytes());
+    EXPECT_EQ(allocated, workspace.UpdatePeakBytes());
+    EXPECT_EQ(allocated, workspace.PeakBytes());
+
+    workspace.Release();
+    EXPECT_EQ(0, workspace.AllocatedBytes());
+    EXPECT_EQ(allocated, workspace.PeakBytes());
+}
@@ -0,0 +1,177 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  ExtendAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/ExtendAlign.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/ExtendAlign.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+static const int Mismatch = 4, Indel = 3;
+
+//
+// The best score of any alignment of a prefix of q to a prefix of t,
+// from a full matrix.
+//
+static int BestPrefixScore(const string &q, const string &t) {
+    vector<vector<int> > f(q.size() + 1, vector<int>(t.size() + 1, 0));
+    int best = 0;
+    for (size_t i = 0; i <= q.size(); i++) {
+        for (size_t j = 0; j <= t.size(); j++) {
+            if (i == 0 and j == 0) {
+                continue;
+            }
+            int score = INF_INT;
+            if (i > 0) {
+                score = min(score, f[i-1][j] + Indel);
+            }
+            if (j > 0) {
+                score = min(score, f[i][j-1] + Indel);
+            }
+            if (i > 0 and j > 0) {
+                score = min(score, f[i-1][j-1] + (q[i-1] == t[j-1] ? -5 : Mismatch));
+            }
+            f[i][j] = score;
+            best = min(best, score);
+        }
+    }
+    return best;
+}
+
+//
+// The score of the blocks of an alignment and the gaps between them.
+//
+static int AlignmentScore(blasr::Alignment &a, DNASequence &qSeq, DNASequence &tSeq) {
+    int score = 0;
+    for (size_t b = 0; b < a.blocks.size(); b++) {
+        for (DNALength i = 0; i < a.blocks[b].length; i++) {
+            score += (qSeq.seq[a.qPos + a.blocks[b].qPos + i] ==
+                      tSeq.seq[a.tPos + a.blocks[b].tPos + i]) ? -5 : Mismatch;
+        }
+        if (b + 1 < a.blocks.size()) {
+            score += (a.blocks[b+1].qPos - a.blocks[b].QEnd()) * Indel +
+                (a.blocks[b+1].tPos - a.blocks[b].TEnd()) * Indel;
+        }
+    }
+    return score;
+}
+
+class ExtendAlignXDropTest : public ::testing::Test {
+public:
+    int scoreMat[5][5];
+    vector<int> scores, rowBounds;
+    vector<Arrow> path;
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMat[i][j] = (i == j) ? -5 : Mismatch;
+            }
+        }
+    }
+};
+
+//
+// With a band and drop that never bind, the extension is the best
+// prefix alignment.  The buffers are shared by every call.
+//
+TEST_F(ExtendAlignXDropTest, UnboundedMatchesFullMatrix) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    for (int it = 0; it < 200; it++) {
+        srand(it);
+        int length = 1 + rand() % (it < 100 ? 50 : 600);
+        string t;
+        for (int i = 0; i < length; i++) {
+            t += Bases[rand() % 4];
+        }
+        string q = Mutate(t, it % 2 ? 0.12 : 0.3);
+        if (q.empty()) {
+            q = "A";
+        }
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+
+        blasr::Alignment forward;
+        int score = ExtendAlignmentForwardXDrop(qSeq, 0, tSeq, 0, 100000, 1000000,
+            scores, path, rowBounds, forward, scoreFn);
+        EXPECT_EQ(BestPrefixScore(q, t), score);
+        if (!forward.blocks.empty()) {
+            // Gaps between the anchor and the first block are charged too.
+            EXPECT_EQ(score, AlignmentScore(forward, qSeq, tSeq) +
+                (forward.qPos + forward.blocks[0].qPos) * Indel +
+                (forward.tPos + forward.blocks[0].tPos) * Indel);
+        }
+
+        blasr::Alignment reverse;
+        score = ExtendAlignmentReverseXDrop(qSeq, qSeq.length, tSeq, tSeq.length,
+            100000, 1000000, scores, path, rowBounds, reverse, scoreFn);
+        string qr(q.rbegin(), q.rend()), tr(t.rbegin(), t.rend());
+        EXPECT_EQ(BestPrefixScore(qr, tr), score);
+        if (!reverse.blocks.empty()) {
+            // The reverse alignment is charged for gaps up to the anchor.
+            EXPECT_EQ(score, AlignmentScore(reverse, qSeq, tSeq) +
+                (qSeq.length - reverse.qPos - reverse.blocks.back().QEnd()) * Indel +
+                (tSeq.length - reverse.tPos - reverse.blocks.back().TEnd()) * Indel);
+        }
+    }
+}
+
+TEST_F(ExtendAlignXDropTest, BuffersDoNotChangeResult) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    srand(7);
+    string t;
+    for (int i = 0; i < 2000; i++) {
+        t += Bases[rand() % 4];
+    }
+    string q = Mutate(t, 0.15);
+    DNASequence qSeq, tSeq;
+    qSeq.Copy(q);
+    tSeq.Copy(t);
+
+    vector<int> freshScores, freshBounds;
+    vector<Arrow> freshPath;
+    // Leave longer rows behind in the buffers, then extend again.
+    blasr::Alignment other, reused, fresh;
+    ExtendAlignmentForwardXDrop(qSeq, 10, tSeq, 10, 30, 200,
+        scores, path, rowBounds, other, scoreFn);
+    int reusedScore = ExtendAlignmentForwardXDrop(qSeq, 0, tSeq, 0, 30, 40,
+        scores, path, rowBounds, reused, scoreFn);
+    int freshScore = ExtendAlignmentForwardXDrop(qSeq, 0, tSeq, 0, 30, 40,
+        freshScores, freshPath, freshBounds, fresh, scoreFn);
+
+    EXPECT_EQ(freshScore, reusedScore);
+    ASSERT_EQ(fresh.blocks.size(), reused.blocks.size());
+    for (size_t b = 0; b < fresh.blocks.size(); b++) {
+        EXPECT_EQ(fresh.blocks[b].qPos, reused.blocks[b].qPos);
+        EXPECT_EQ(fresh.blocks[b].tPos, reused.blocks[b].tPos);
+        EXPECT_EQ(fresh.blocks[b].length, reused.blocks[b].length);
+    }
+}
+
+TEST_F(ExtendAlignXDropTest, AnchorAtEnd) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    DNASequence qSeq, tSeq;
+    qSeq.Copy("ACGT");
+    tSeq.Copy("ACGT");
+    blasr::Alignment alignment;
+    EXPECT_EQ(0, ExtendAlignmentForwardXDrop(qSeq, 4, tSeq, 4, 10, 10,
+        scores, path, rowBounds, alignment, scoreFn));
+    EXPECT_TRUE(alignment.blocks.empty());
+}
@@ -0,0 +1,141 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  FullQVAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/FullQVAlign.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "FASTQSequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/FullQVAlign.hpp"
+
+using namespace std;
+
+static double LogSum(double a, double b) {
+    if (a == -INFINITY) {
+        return b;
+    }
+    if (b == -INFINITY) {
+        return a;
+    }
+    double m = max(a, b);
+    return m + log(exp(a - m) + exp(b - m));
+}
+
+static double P(int qv) {
+    return pow(10, -qv / 10.0);
+}
+
+static bool IsACGT(Nucleotide c) {
+    return TwoBit[c] < 4;
+}
+
+//
+// The recursion of FullQVAlign in log space with a full matrix.  A
+// tagged deletion is scored against the neighbouring base only when
+// that base is ACGT.
+//
+static double ExpectedLogProb(FASTQSequence &query, FASTQSequence &target) {
+    int n = query.length, m = target.length;
+    vector<vector<double> > f(n + 1, vector<double>(m + 1));
+    f[0][0] = 0;
+    for (int t = 1; t <= m; t++) {
+        f[0][t] = f[0][t-1] + log(P(target.GetInsertionQV(t-1)));
+    }
+    for (int q = 1; q <= n; q++) {
+        f[q][0] = f[q-1][0] + log(P(query.GetInsertionQV(q-1)));
+    }
+    for (int q = 1; q <= n; q++) {
+        for (int t = 1; t <= m; t++) {
+            double qs = P(query.GetSubstitutionQV(q-1)), ts = P(target.GetSubstitutionQV(t-1));
+            double match = (query.seq[q-1] == target.seq[t-1]) ?
+                (1 - qs) * (1 - ts) : qs / 3 * (1 - ts) + (1 - qs) * ts / 3;
+            double ins, del;
+            if (target.GetDeletionTag(t-1) != 'N' and q == 1) {
+                ins = P(query.GetInsertionQV(q-1));
+            }
+            else if (target.GetDeletionTag(t-1) != 'N' and IsACGT(query.seq[q-2])) {
+                ins = P(target.GetPreBaseDeletionQV(t-1, query.seq[q-2])) * P(target.GetDeletionQV(t-1))
+                    + P(query.GetInsertionQV(q-1));
+            }
+            else {
+                ins = P(query.GetInsertionQV(q-1)) + P(target.GetDeletionQV(t-1));
+            }
+            if (query.GetDeletionTag(q-1) != 'N' and t == 1) {
+                del = P(target.GetInsertionQV(t-1));
+            }
+            else if (query.GetDeletionTag(q-1) != 'N' and IsACGT(target.seq[t-2])) {
+                del = P(query.GetPreBaseDeletionQV(q-1, target.seq[t-2])) * P(query.GetDeletionQV(q-1))
+                    + P(target.GetInsertionQV(t-1));
+            }
+            else {
+                del = P(target.GetInsertionQV(t-1)) + P(query.GetDeletionQV(q-1));
+            }
+            f[q][t] = LogSum(LogSum(f[q-1][t-1] + log(match), f[q-1][t] + log(ins)),
+                             f[q][t-1] + log(del));
+        }
+    }
+    return f[n][m];
+}
+
+static void MakeSequence(const string &s, FASTQSequence &seq) {
+    ((DNASequence&) seq).Copy(s);
+    seq.AllocateQualitySpace(seq.length);
+    seq.AllocateDeletionQVSpace(seq.length);
+    seq.AllocateInsertionQVSpace(seq.length);
+    seq.AllocateSubstitutionQVSpace(seq.length);
+    seq.AllocatePreBaseDeletionQVSpace(seq.length * 4);
+    seq.AllocateDeletionTagSpace(seq.length);
+    for (DNALength i = 0; i < seq.length; i++) {
+        seq.qual[i]           = 5 + rand() % 30;
+        seq.deletionQV[i]     = 5 + rand() % 20;
+        seq.insertionQV[i]    = 5 + rand() % 20;
+        seq.substitutionQV[i] = 5 + rand() % 20;
+        seq.deletionTag[i]    = "ACGTN"[rand() % 5];
+        for (int b = 0; b < 4; b++) {
+            seq.preBaseDeletionQV[i*4 + b] = 5 + rand() % 20;
+        }
+    }
+}
+
+static string RandomSequence(int length, bool withN) {
+    string s;
+    for (int i = 0; i < length; i++) {
+        s += (withN and rand() % 8 == 0) ? 'N' : "ACGT"[rand() % 4];
+    }
+    return s;
+}
+
+TEST(FullQVAlignTest, LogAlignMatchesRecursion) {
+    FullQVAlignBuffers buffers;
+    for (int it = 0; it < 40; it++) {
+        srand(it);
+        //
+        // Half of the pairs have N's next to tagged deletions in both
+        // sequences.
+        //
+        bool withN = it % 2;
+        FASTQSequence query, target;
+        MakeSequence(RandomSequence(1 + rand() % 120, withN), query);
+        MakeSequence(RandomSequence(1 + rand() % 120, withN), target);
+        FullQVLogProbs queryProbs, targetProbs;
+        queryProbs.Initialize(query);
+        targetProbs.Initialize(target);
+        double expected = ExpectedLogProb(query, target);
+        float full = FullQVLogAlign(query, target, queryProbs, targetProbs, &buffers);
+        SCOPED_TRACE(it);
+        EXPECT_TRUE(std::isfinite(full));
+        EXPECT_NEAR(expected, full, 1e-3 * max(1.0, fabs(expected)));
+    }
+}
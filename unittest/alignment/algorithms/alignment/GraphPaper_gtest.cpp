@@ -0,0 +1,166 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  GraphPaper_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/GraphPaper.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/AlignmentUtils.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/SDPAlign.hpp"
+#include "algorithms/alignment/GraphPaper.hpp"
+
+using namespace std;
+
+namespace {
+
+//
+// n random points over [0, xSpan) x [0, ySpan), with two at opposite
+// corners so that the spans are exact.
+//
+void SpreadPoints(int n, DNALength xSpan, DNALength ySpan, vector<Fragment> &points) {
+    points.clear();
+    points.push_back(Fragment(0, 0));
+    points.push_back(Fragment(xSpan - 1, ySpan - 1));
+    for (int i = 2; i < n; i++) {
+        points.push_back(Fragment(rand() % xSpan, rand() % ySpan));
+    }
+}
+
+void ExpectDimensions(vector<Fragment> &points, int nRows, int nCols) {
+    int rows = 0, cols = 0;
+    GraphPaperDimensions(points, rows, cols);
+    EXPECT_EQ(nRows, rows) << points.size() << " points";
+    EXPECT_EQ(nCols, cols) << points.size() << " points";
+}
+
+}
+
+TEST(GraphPaperTest, DimensionsOfSmallSets) {
+    vector<Fragment> points;
+    ExpectDimensions(points, 10, 10);
+    points.push_back(Fragment(5, 5));
+    ExpectDimensions(points, 10, 10);
+    points.push_back(Fragment(49, 30));
+    ExpectDimensions(points, 10, 10);
+}
+
+TEST(GraphPaperTest, DimensionsFollowDensity) {
+    srand(31);
+    vector<Fragment> points;
+    // 100 points per 100 base cell along a 5 kb path: the old 50x50.
+    SpreadPoints(10000, 5000, 5000, points);
+    ExpectDimensions(points, 50, 50);
+    // Sparse and very skewed: both sides at the minimum.
+    SpreadPoints(1000, 100000, 200, points);
+    ExpectDimensions(points, 10, 10);
+    // Dense and very skewed: the long side is capped, and the short
+    // one held at the minimum.
+    SpreadPoints(200000, 100000, 200, points);
+    ExpectDimensions(points, 1000, 10);
+    // Cells are at least 100 bases, even when very dense.
+    SpreadPoints(50000, 3000, 1200, points);
+    ExpectDimensions(points, 30, 12);
+}
+
+//
+// Points on a diagonal band are kept, and points far from it removed,
+// whether the grids are fresh or reused from a larger grid.
+//
+TEST(GraphPaperTest, RemovesPointsOffThePath) {
+    srand(32);
+    vector<Fragment> diagonal, points;
+    for (int i = 0; i < 1000; i++) {
+        diagonal.push_back(Fragment(i * 10, i * 10 + rand() % 30));
+    }
+    GraphPaperBuffers reused;
+    vector<Fragment> large;
+    SpreadPoints(200000, 100000, 200, large);
+    int nRows, nCols;
+    GraphPaperDimensions(large, nRows, nCols);
+    GraphPaper(large, nRows, nCols, reused);
+
+    for (int pass = 0; pass < 2; pass++) {
+        points = diagonal;
+        for (int i = 0; i < 20; i++) {
+            points.push_back(Fragment(9000 + i, 500 + i));
+            points.push_back(Fragment(300 + i, 8500 + i));
+        }
+        GraphPaperBuffers fresh;
+        GraphPaperBuffers &buffers = pass ? reused : fresh;
+        GraphPaperDimensions(points, nRows, nCols);
+        GraphPaper(points, nRows, nCols, buffers);
+        RemoveOffOpt(points, buffers.onOptPath);
+        ASSERT_EQ(diagonal.size(), points.size()) << "pass " << pass;
+        for (size_t i = 0; i < points.size(); i++) {
+            EXPECT_EQ(diagonal[i].x, points[i].x);
+            EXPECT_EQ(diagonal[i].y, points[i].y);
+        }
+    }
+}
+
+//
+// A 4 kb pair with about 20% errors and a 500 base repeat in the
+// target, aligned with the grid filter on every fragment set.  These
+// values are the same as with the old fixed 50x50 grid and without the
+// filter; update them only for an intended change.
+//
+TEST(GraphPaperTest, SDPAlignResultIsPinned) {
+    int scoreMat[5][5];
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            scoreMat[i][j] = (i == j) ? -5 : 6;
+        }
+    }
+    srand(30);
+    string t, q;
+    for (int i = 0; i < 4000; i++) {
+        t += "ACGT"[rand() % 4];
+    }
+    for (size_t i = 0; i < t.size(); i++) {
+        int x = rand() % 12;
+        if (x == 0) {
+            continue;
+        }
+        q += (x == 1) ? "ACGT"[rand() % 4] : t[i];
+        if (x == 2) {
+            q += "ACGT"[rand() % 4];
+        }
+    }
+    t.replace(3000, 500, t.substr(500, 500));
+    DNASequence query, target;
+    query.Copy(q);
+    target.Copy(t);
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, 5, 5);
+
+    GraphPaperBuffers buffers;
+    for (int fastSDP = 0; fastSDP <= 2; fastSDP++) {
+        blasr::Alignment alignment;
+        int score = SDPAlign(query, target, scoreFn, 8, 5, 5, 0.15, alignment,
+            Global, true, true, 10000, fastSDP > 0, 100, fastSDP == 2 ? &buffers : NULL);
+        EXPECT_EQ(-14553, score) << "fastSDP " << fastSDP;
+        ASSERT_EQ(642u, alignment.blocks.size()) << "fastSDP " << fastSDP;
+        DNALength matched = 0;
+        for (size_t b = 0; b < alignment.blocks.size(); b++) {
+            matched += alignment.blocks[b].length;
+        }
+        EXPECT_EQ(3586u, matched);
+        EXPECT_EQ(0u, alignment.blocks[0].qPos);
+        EXPECT_EQ(0u, alignment.blocks[0].tPos);
+        EXPECT_EQ(3947u, alignment.blocks.back().qPos);
+        EXPECT_EQ(3997u, alignment.blocks.back().tPos);
+    }
+    query.Free();
+    target.Free();
+}
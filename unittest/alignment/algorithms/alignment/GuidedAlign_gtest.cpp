@@ -0,0 +1,198 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  GuidedAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/GuidedAlign.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "FASTQSequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/GuidedAlign.hpp"
+#include "algorithms/alignment/IDSScoreFunction.hpp"
+#include "algorithms/alignment/QualityValueScoreFunction.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+namespace {
+
+//
+// A score function that scores cells against a lowercase copy of the
+// target as the wrapped one scores them against the target.  None of
+// the lowercase bases are in the GuidedAlignCosts tables, so
+// GuidedAlign calls this per cell, and the results show whether the
+// tables give the same scores as the score function.
+//
+template<typename T_ScoreFn>
+class PerCellScoreFn : public T_ScoreFn {
+public:
+    DNASequence &target;
+
+    PerCellScoreFn(const T_ScoreFn &scoreFn, DNASequence &targetP) :
+        T_ScoreFn(scoreFn), target(targetP) {}
+
+    //
+    // GuidedAlign scores cells against its own copy of the lowercase
+    // target, which has the coordinates of the target.  Insertions
+    // before the target are scored at position -1.
+    //
+    DNASequence &Ref(DNASequence &ref, DNALength refPos) {
+        return (refPos < ref.length and islower(ref.seq[refPos])) ? target : ref;
+    }
+    int Match(DNASequence &ref, DNALength refPos, FASTQSequence &query, DNALength queryPos) {
+        return T_ScoreFn::Match(Ref(ref, refPos), refPos, query, queryPos);
+    }
+    int Insertion(DNASequence &ref, DNALength refPos, FASTQSequence &query, DNALength queryPos) {
+        return T_ScoreFn::Insertion(Ref(ref, refPos), refPos, query, queryPos);
+    }
+    int Deletion(DNASequence &ref, DNALength refPos, FASTQSequence &query, DNALength queryPos) {
+        return T_ScoreFn::Deletion(Ref(ref, refPos), refPos, query, queryPos);
+    }
+    float NormalizedMatch(DNASequence &ref, DNALength refPos, FASTQSequence &query,
+        DNALength queryPos) {
+        return T_ScoreFn::NormalizedMatch(Ref(ref, refPos), refPos, query, queryPos);
+    }
+    float NormalizedInsertion(DNASequence &ref, DNALength refPos, FASTQSequence &query,
+        DNALength queryPos) {
+        return T_ScoreFn::NormalizedInsertion(Ref(ref, refPos), refPos, query, queryPos);
+    }
+    float NormalizedDeletion(DNASequence &ref, DNALength refPos, FASTQSequence &query,
+        DNALength queryPos) {
+        return T_ScoreFn::NormalizedDeletion(Ref(ref, refPos), refPos, query, queryPos);
+    }
+};
+
+//
+// GuidedAlign refers to the normalized costs even when it does not
+// compute probabilities, and the quality value score function has
+// none, so it is only used without probabilities.
+//
+class QVScoreFn : public QualityValueScoreFunction<DNASequence, FASTQSequence> {
+public:
+    float NormalizedMatch(DNASequence &, DNALength, FASTQSequence &, DNALength) {
+        ADD_FAILURE() << "no normalized match cost";
+        return 0;
+    }
+    float NormalizedInsertion(DNASequence &, DNALength, FASTQSequence &, DNALength) {
+        ADD_FAILURE() << "no normalized insertion cost";
+        return 0;
+    }
+    float NormalizedDeletion(DNASequence &, DNALength, FASTQSequence &, DNALength) {
+        ADD_FAILURE() << "no normalized deletion cost";
+        return 0;
+    }
+};
+
+}
+
+class GuidedAlignTest : public ::testing::Test {
+public:
+    int scoreMat[5][5];
+    FASTQSequence read;
+    DNASequence target, lowercase;
+    blasr::Alignment guide;
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMat[i][j] = (i == j) ? -5 : 6;
+            }
+        }
+    }
+
+    //
+    // A read of a random target with about rate errors, a few N bases
+    // in each, and a guide in absolute coordinates from the default
+    // banded alignment.
+    //
+    void MakePair(int length, double rate) {
+        TearDown();
+        string t;
+        for (int i = 0; i < length; i++) {
+            t += Bases[rand() % 4];
+        }
+        string q = Mutate(t, rate);
+        for (int n = 0; n < 3; n++) {
+            t[rand() % t.size()] = 'N';
+            q[rand() % q.size()] = 'N';
+        }
+        target.Copy(t);
+        for (size_t i = 0; i < t.size(); i++) {
+            t[i] = tolower(t[i]);
+        }
+        lowercase.Copy(t);
+        MakeRead(q, read);
+
+        IDSScoreFunction<DNASequence, FASTQSequence> scoreFn(scoreMat, 5, 5, 10, 10);
+        blasr::Alignment sdpAlignment;
+        GuidedAlign(read, target, scoreFn, 10, 5, 5, 0.15, sdpAlignment, Global, false, 8);
+        guide = blasr::Alignment();
+        guide.blocks = sdpAlignment.blocks;
+        for (size_t b = 0; b < guide.blocks.size(); b++) {
+            guide.blocks[b].qPos += sdpAlignment.qPos;
+            guide.blocks[b].tPos += sdpAlignment.tPos;
+        }
+    }
+
+    void TearDown() {
+        read.Free();
+        target.Free();
+        lowercase.Free();
+    }
+
+    //
+    // Align the read to the target with the tabulated costs, and to
+    // the lowercase copy with costs from the score function per cell,
+    // and expect the same results.
+    //
+    template<typename T_ScoreFn>
+    void Compare(T_ScoreFn &scoreFn, int bandSize, AlignmentType alignType, bool computeProb) {
+        PerCellScoreFn<T_ScoreFn> perCellScoreFn(scoreFn, target);
+        blasr::Alignment tabulated, perCell;
+        int tabulatedScore = GuidedAlign(read, target, guide, scoreFn, bandSize,
+            tabulated, alignType, computeProb);
+        int perCellScore = GuidedAlign(read, lowercase, guide, perCellScoreFn, bandSize,
+            perCell, alignType, computeProb);
+        EXPECT_EQ(perCellScore, tabulatedScore);
+        EXPECT_EQ(perCell.score, tabulated.score);
+        EXPECT_EQ(perCell.probScore, tabulated.probScore);
+        EXPECT_LT(0u, tabulated.blocks.size());
+        ExpectSameAlignment(perCell, tabulated);
+    }
+};
+
+TEST_F(GuidedAlignTest, IDSCostsMatchScoreFunction) {
+    int bandSizes[] = {0, 3, 10};
+    for (int it = 0; it < 30; it++) {
+        srand(it);
+        MakePair(50 + rand() % 600, (it % 2) ? 0.05 : 0.2);
+        IDSScoreFunction<DNASequence, FASTQSequence> scoreFn(scoreMat, 5, 5, 10, 10);
+        scoreFn.substitutionPrior = 20;
+        scoreFn.globalDeletionPrior = 13;
+        SCOPED_TRACE(it);
+        Compare(scoreFn, bandSizes[it % 3], (it % 4 == 0) ? Local : Global, it % 2);
+    }
+}
+
+TEST_F(GuidedAlignTest, QVCostsMatchScoreFunction) {
+    int bandSizes[] = {0, 3, 10};
+    for (int it = 0; it < 30; it++) {
+        srand(100 + it);
+        MakePair(50 + rand() % 600, (it % 2) ? 0.05 : 0.2);
+        QVScoreFn scoreFn;
+        scoreFn.ins = 4 + rand() % 8;
+        scoreFn.del = 4 + rand() % 8;
+        SCOPED_TRACE(it);
+        Compare(scoreFn, bandSizes[it % 3], (it % 4 == 0) ? Local : Global, false);
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  MyersAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/MyersAlign.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "algorithms/alignment/MyersAlign.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+namespace {
+
+//
+// Unit cost edit distance from the full matrix.  Gaps before and after
+// t are free when freeTEnds is set.  Only A, C, G and T match, each
+// itself.
+//
+int PlainEditDistance(const string &q, const string &t, bool freeTEnds) {
+    size_t m = q.size(), n = t.size(), i, j;
+    vector<vector<int> > d(m + 1, vector<int>(n + 1, 0));
+    for (i = 1; i <= m; i++) {
+        d[i][0] = i;
+    }
+    for (j = 1; j <= n; j++) {
+        d[0][j] = freeTEnds ? 0 : j;
+    }
+    for (i = 1; i <= m; i++) {
+        for (j = 1; j <= n; j++) {
+            bool match = (q[i-1] == t[j-1] and q[i-1] != 'N');
+            d[i][j] = min(d[i-1][j-1] + (match ? 0 : 1), min(d[i-1][j], d[i][j-1]) + 1);
+        }
+    }
+    if (!freeTEnds) {
+        return d[m][n];
+    }
+    return *min_element(d[m].begin(), d[m].end());
+}
+
+int PlainEditDistance(const string &q, const string &t, AlignmentType alignType) {
+    if (alignType == QueryFit) {
+        return PlainEditDistance(q, t, true);
+    }
+    else if (alignType == TargetFit) {
+        return PlainEditDistance(t, q, true);
+    }
+    return PlainEditDistance(q, t, false);
+}
+
+//
+// A sequence of exactly length bases: a mutated copy of s, cut or
+// padded with random bases, and sometimes with an N.
+//
+string Related(const string &s, size_t length) {
+    string r = Mutate(s, 0.15);
+    while (r.size() < length) {
+        r += Bases[rand() % 4];
+    }
+    r.resize(length);
+    if (length > 0 and rand() % 4 == 0) {
+        r[rand() % length] = 'N';
+    }
+    return r;
+}
+
+}
+
+class MyersAlignTest : public ::testing::Test {
+public:
+    MyersBuffers buffers;
+
+    //
+    // Compare the full and banded distances, with new and reused
+    // buffers, to the plain dynamic programming for every alignment
+    // type.
+    //
+    void Compare(const string &q, const string &t) {
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+        AlignmentType types[] = {Global, QueryFit, TargetFit};
+        AlignmentType scoreTypes[] = {ScoreGlobal, ScoreQueryFit, ScoreTargetFit};
+        for (int a = 0; a < 3; a++) {
+            int expected = PlainEditDistance(q, t, types[a]);
+            SCOPED_TRACE(testing::Message() << "type " << types[a] << " q=" << q << " t=" << t);
+            EXPECT_EQ(expected, MyersEditDistance(qSeq, tSeq, types[a]));
+            EXPECT_EQ(expected, MyersEditDistance(qSeq, tSeq, scoreTypes[a], &buffers));
+            int maxDistances[] = {0, 1, expected - 1, expected, expected + 1, 70, 200};
+            for (int k = 0; k < 7; k++) {
+                int maxDistance = maxDistances[k];
+                if (maxDistance < 0) {
+                    continue;
+                }
+                EXPECT_EQ(min(expected, maxDistance + 1),
+                    MyersBandedEditDistance(qSeq, tSeq, maxDistance, types[a], &buffers))
+                    << "maxDistance " << maxDistance;
+            }
+        }
+        qSeq.Free();
+        tSeq.Free();
+    }
+};
+
+//
+// Lengths on either side of one and two words, related and unrelated.
+//
+TEST_F(MyersAlignTest, MatchesPlainDP) {
+    srand(37);
+    size_t lengths[] = {0, 1, 2, 63, 64, 65, 100, 127, 128, 129, 200};
+    for (int l1 = 0; l1 < 11; l1++) {
+        for (int l2 = 0; l2 < 11; l2++) {
+            string t;
+            for (size_t i = 0; i < lengths[l2]; i++) {
+                t += Bases[rand() % 4];
+            }
+            Compare(Related(t, lengths[l1]), t);
+            string q;
+            for (size_t i = 0; i < lengths[l1]; i++) {
+                q += "ACGTN"[rand() % 5];
+            }
+            Compare(q, t);
+        }
+    }
+}
+
+TEST_F(MyersAlignTest, RandomPairs) {
+    srand(38);
+    for (int it = 0; it < 300; it++) {
+        string t;
+        size_t tLength = rand() % 400;
+        for (size_t i = 0; i < tLength; i++) {
+            t += Bases[rand() % 4];
+        }
+        size_t qLength = rand() % 2 ? tLength : rand() % 400;
+        if (it % 3 == 0 and tLength > 0) {
+            // A query from the middle of the target.
+            size_t start = rand() % tLength;
+            qLength = min(qLength, tLength - start);
+            Compare(Related(t.substr(start), qLength), t);
+        }
+        else {
+            Compare(Related(t, qLength), t);
+        }
+    }
+}
+
+TEST_F(MyersAlignTest, Empty) {
+    Compare("", "");
+    Compare("", "ACGT");
+    Compare("ACGT", "");
+    DNASequence empty, target;
+    target.Copy("ACGTACGT");
+    EXPECT_EQ(8, MyersEditDistance(empty, target, Global));
+    EXPECT_EQ(0, MyersEditDistance(empty, target, QueryFit));
+    EXPECT_EQ(8, MyersEditDistance(empty, target, TargetFit));
+    EXPECT_EQ(4, MyersBandedEditDistance(empty, target, 3, Global));
+    target.Free();
+}
+
+TEST_F(MyersAlignTest, NMismatchesEverything) {
+    DNASequence q, t;
+    q.Copy("ACNNT");
+    t.Copy("ACNNT");
+    EXPECT_EQ(2, MyersEditDistance(q, t, Global));
+    q.Free();
+    t.Free();
+    Compare(string(70, 'N'), string(70, 'N'));
+}
+
+TEST_F(MyersAlignTest, UnsupportedArguments) {
+    DNASequence q, t;
+    q.Copy("ACGT");
+    t.Copy("ACGT");
+    EXPECT_EQ(-1, MyersEditDistance(q, t, Local));
+    EXPECT_EQ(-1, MyersBandedEditDistance(q, t, -1, Global));
+    q.Free();
+    t.Free();
+}
@@ -0,0 +1,246 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  OneGapAlignment_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/OneGapAlignment.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/AlignmentWorkspace.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/OneGapAlignment.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+static const int Mismatch = 4, Indel = 3;
+
+//
+// Score an alignment of q against left, distance unaligned bases, and
+// right from its blocks.  The long gap, from a block in the left target
+// to a block in the right target, is free, as is skipping the start of
+// the right target when nothing aligns to the left one.
+//
+static int OneGapScore(blasr::Alignment &a, const string &q, const string &left,
+    DNALength distance, const string &right) {
+    DNALength rightStart = left.size() + distance;
+    string target = left + string(distance, 'N') + right;
+    if (a.blocks.empty()) {
+        return q.size() * Indel + (right.empty() ? left.size() * Indel : 0);
+    }
+    int score = 0;
+    DNALength qFirst = a.qPos + a.blocks[0].qPos, tFirst = a.tPos + a.blocks[0].tPos;
+    score += qFirst * Indel;
+    if (tFirst < rightStart) {
+        score += tFirst * Indel;
+    }
+    for (size_t b = 0; b < a.blocks.size(); b++) {
+        DNALength qb = a.qPos + a.blocks[b].qPos, tb = a.tPos + a.blocks[b].tPos;
+        for (DNALength i = 0; i < a.blocks[b].length; i++) {
+            score += (q[qb + i] == target[tb + i]) ? -5 : Mismatch;
+        }
+        DNALength qEnd = qb + a.blocks[b].length, tEnd = tb + a.blocks[b].length;
+        if (b + 1 < a.blocks.size()) {
+            DNALength qNext = a.qPos + a.blocks[b+1].qPos, tNext = a.tPos + a.blocks[b+1].tPos;
+            score += (qNext - qEnd) * Indel;
+            if (!(tEnd <= left.size() and tNext >= rightStart)) {
+                score += (tNext - tEnd) * Indel;
+            }
+        }
+        else {
+            score += (q.size() - qEnd) * Indel + (target.size() - tEnd) * Indel;
+        }
+    }
+    return score;
+}
+
+class OneGapAlignTest : public ::testing::Test {
+public:
+    int scoreMat[5][5];
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMat[i][j] = (i == j) ? -5 : Mismatch;
+            }
+        }
+    }
+
+    //
+    // A read from genome[0,a) + genome[b,...), with the left target
+    // ending shortly after a and the right target starting shortly
+    // before b.
+    //
+    void MakeSplitRead(int it, string &q, string &left, DNALength &distance,
+        string &right) {
+        srand(it);
+        int g = 1 + rand() % 60;
+        string genome;
+        for (int i = 0; i < 3 * g; i++) {
+            genome += Bases[rand() % 4];
+        }
+        int a = rand() % (g + 1);
+        int b = min((int) genome.size(), a + rand() % (g + 2));
+        int leftEnd = min((int) genome.size(), a + rand() % 20);
+        int rightStart = max(leftEnd, b - rand() % 20);
+        left  = genome.substr(0, leftEnd);
+        right = genome.substr(rightStart);
+        distance = rightStart - leftEnd;
+        q = Mutate(genome.substr(0, a) + genome.substr(b), 0.15);
+        if (q.empty()) {
+            q = "A";
+        }
+    }
+};
+
+//
+// The full matrix version on small reads that each take one of the
+// paths it once scored or traced wrongly.  The left target is ACGTTGCA
+// and the right one GGATCCAT, 100 bases after it.
+//
+TEST_F(OneGapAlignTest, FullMatrixRegressions) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    FlatMatrix2D<int> scores, affineScores;
+    FlatMatrix2D<Arrow> path, affinePath;
+    DNASequence leftSeq, rightSeq;
+    leftSeq.Copy("ACGTTGCA");
+    rightSeq.Copy("GGATCCAT");
+    struct {
+        const char *q;
+        int score;
+        const char *blocks;
+    } cases[] = {
+        // The gap closes on a match inside the right target.  This was
+        // traced as a deletion, shifting the query after it by one.
+        {"ACGTATCCAT", -50, "0,0,4 4,110,6"},
+        // Query bases inserted after the first base of the right
+        // target.  Each insertion there was scored as if it were the
+        // first base of the read.
+        {"GAAGATCCAT", -34, "0,108,1 3,109,7"},
+        // The gap closes on the first base of the right target.  The
+        // target positions after it were not offset by the distance.
+        {"ACGTGGATCCAT", -60, "0,0,4 4,108,8"},
+        // Nothing aligns to the left target, so the gap runs along the
+        // first row.  Neither were these offset.
+        {"ATCCAT", -30, "0,110,6"},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        DNASequence qSeq;
+        qSeq.Copy(cases[c].q);
+        blasr::Alignment alignment;
+        EXPECT_EQ(cases[c].score, OneGapAlign(qSeq, leftSeq, rightSeq, 100, scoreFn,
+            alignment, scores, path, affineScores, affinePath)) << cases[c].q;
+        EXPECT_EQ(cases[c].blocks, BlockString(alignment)) << cases[c].q;
+        qSeq.Free();
+    }
+}
+
+TEST_F(OneGapAlignTest, LinearSpaceMatchesFullMatrix) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    OneGapAlignBuffers buffers;
+    FlatMatrix2D<int> scores, affineScores;
+    FlatMatrix2D<Arrow> path, affinePath;
+    for (int it = 0; it < 400; it++) {
+        string q, left, right;
+        DNALength distance;
+        MakeSplitRead(it, q, left, distance, right);
+        if (left.empty() or right.empty()) {
+            continue;
+        }
+        DNASequence qSeq, leftSeq, rightSeq;
+        qSeq.Copy(q);
+        leftSeq.Copy(left);
+        rightSeq.Copy(right);
+
+        blasr::Alignment linear, full;
+        // A narrow band makes the flanks widen it.
+        int linearScore = OneGapAlign(qSeq, leftSeq, rightSeq, distance, scoreFn,
+            linear, buffers, it % 2 ? 1 : 32);
+        int fullScore = OneGapAlign(qSeq, leftSeq, rightSeq, distance, scoreFn,
+            full, scores, path, affineScores, affinePath);
+        EXPECT_EQ(fullScore, linearScore) << "case " << it;
+        EXPECT_EQ(linearScore, OneGapScore(linear, q, left, distance, right)) << "case " << it;
+        EXPECT_EQ(fullScore, OneGapScore(full, q, left, distance, right)) << "case " << it;
+    }
+}
+
+TEST_F(OneGapAlignTest, OverloadsAgree) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    AlignmentWorkspace workspace;
+    for (int it = 0; it < 50; it++) {
+        string q, left, right;
+        DNALength distance;
+        MakeSplitRead(it, q, left, distance, right);
+        DNASequence qSeq, leftSeq, rightSeq;
+        qSeq.Copy(q);
+        leftSeq.Copy(left);
+        rightSeq.Copy(right);
+
+        blasr::Alignment plain, withWorkspace;
+        int plainScore = OneGapAlign(qSeq, leftSeq, rightSeq, distance, scoreFn, plain);
+        int workspaceScore = OneGapAlign(qSeq, leftSeq, rightSeq, distance, scoreFn,
+            workspace, withWorkspace);
+        EXPECT_EQ(plainScore, workspaceScore);
+        EXPECT_EQ(plainScore, OneGapScore(plain, q, left, distance, right));
+        ASSERT_EQ(plain.blocks.size(), withWorkspace.blocks.size());
+        for (size_t b = 0; b < plain.blocks.size(); b++) {
+            EXPECT_EQ(plain.blocks[b].qPos, withWorkspace.blocks[b].qPos);
+            EXPECT_EQ(plain.blocks[b].tPos, withWorkspace.blocks[b].tPos);
+            EXPECT_EQ(plain.blocks[b].length, withWorkspace.blocks[b].length);
+        }
+    }
+}
+
+TEST_F(OneGapAlignTest, SpansLongGap) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    srand(11);
+    string genome;
+    for (int i = 0; i < 3000; i++) {
+        genome += Bases[rand() % 4];
+    }
+    // The read skips genome[400,2400).
+    string q = genome.substr(0, 400) + genome.substr(2400, 400);
+    string left = genome.substr(0, 450), right = genome.substr(2350, 450);
+    DNALength distance = 2350 - 450;
+    DNASequence qSeq, leftSeq, rightSeq;
+    qSeq.Copy(q);
+    leftSeq.Copy(left);
+    rightSeq.Copy(right);
+
+    blasr::Alignment alignment;
+    int score = OneGapAlign(qSeq, leftSeq, rightSeq, distance, scoreFn, alignment);
+    EXPECT_EQ(-5 * 800, score);
+    ASSERT_EQ(2, alignment.blocks.size());
+    EXPECT_EQ(0, alignment.blocks[0].tPos);
+    EXPECT_EQ(400, alignment.blocks[0].length);
+    EXPECT_EQ(400, alignment.blocks[1].qPos);
+    EXPECT_EQ(2400, alignment.blocks[1].tPos);
+    EXPECT_EQ(400, alignment.blocks[1].length);
+}
+
+TEST_F(OneGapAlignTest, EmptySequences) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, Indel, Indel);
+    DNASequence qSeq, leftSeq, rightSeq, empty;
+    qSeq.Copy("ACGTACGT");
+    leftSeq.Copy("ACGTACGT");
+    rightSeq.Copy("TTTT");
+
+    blasr::Alignment alignment;
+    EXPECT_EQ(0, OneGapAlign(empty, leftSeq, rightSeq, 10, scoreFn, alignment));
+    EXPECT_TRUE(alignment.blocks.empty());
+
+    // With no right target the query is aligned globally to the left.
+    EXPECT_EQ(-40, OneGapAlign(qSeq, leftSeq, empty, 10, scoreFn, alignment));
+    ASSERT_EQ(1, alignment.blocks.size());
+    EXPECT_EQ(8, alignment.blocks[0].length);
+}
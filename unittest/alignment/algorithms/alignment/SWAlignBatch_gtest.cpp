@@ -0,0 +1,160 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SWAlignBatch_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/SWAlignBatch.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/AlignmentUtils.hpp"
+#include "algorithms/alignment/SWAlign.hpp"
+#include "algorithms/alignment/SWAlignBatch.hpp"
+#include "AlignmentTestUtils.hpp"
+
+using namespace std;
+
+class SWAlignBatchTest : public ::testing::Test {
+public:
+    int scoreMat[5][5];
+    vector<DNASequence> qSeqs, tSeqs;
+    vector<DNASequence*> qPtrs, tPtrs;
+    vector<AlignmentType> types;
+
+    void SetUp() {
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j < 5; j++) {
+                scoreMat[i][j] = (i == j) ? -5 : 4;
+            }
+        }
+    }
+
+    //
+    // Random pairs of up to maxLength bases, with the query cut from
+    // the target for QueryFit and padded for TargetFit.
+    //
+    void MakePairs(int nPairs, int maxLength, const AlignmentType *allTypes, int nTypes) {
+        qSeqs.resize(nPairs);
+        tSeqs.resize(nPairs);
+        for (int p = 0; p < nPairs; p++) {
+            AlignmentType type = allTypes[rand() % nTypes];
+            int length = 1 + rand() % maxLength;
+            string t;
+            for (int i = 0; i < length; i++) {
+                t += Bases[rand() % 4];
+            }
+            string q;
+            if (type == QueryFit or type == ScoreQueryFit) {
+                int a = rand() % length;
+                q = Mutate(t.substr(a, 1 + rand() % (length - a)), 0.1);
+            }
+            else {
+                q = Mutate(t, 0.15);
+            }
+            if (type == TargetFit or type == ScoreTargetFit) {
+                for (int k = rand() % 20; k > 0; k--) {
+                    q = Bases[rand() % 4] + q;
+                }
+            }
+            if (q.empty()) {
+                q = "A";
+            }
+            qSeqs[p].Copy(q);
+            tSeqs[p].Copy(t);
+            types.push_back(type);
+        }
+        for (int p = 0; p < nPairs; p++) {
+            qPtrs.push_back(&qSeqs[p]);
+            tPtrs.push_back(&tSeqs[p]);
+        }
+    }
+};
+
+TEST_F(SWAlignBatchTest, MatchesSWAlign) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, 3, 3);
+    AlignmentType allTypes[] = {Global, Local, QueryFit, ScoreGlobal, ScoreLocal, ScoreQueryFit};
+    srand(3);
+    MakePairs(1000, 120, allTypes, 6);
+
+    vector<int> scores;
+    vector<blasr::Alignment> alignments;
+    SWAlignBatchBuffers buffers;
+    SWAlignBatch(qPtrs, tPtrs, types, scoreFn, scores, &alignments, &buffers);
+
+    vector<int> swScores;
+    vector<Arrow> swPath;
+    for (size_t p = 0; p < qSeqs.size(); p++) {
+        blasr::Alignment expected;
+        int expectedScore = SWAlign(qSeqs[p], tSeqs[p], swScores, swPath, expected,
+            scoreFn, types[p]);
+        EXPECT_EQ(expectedScore, scores[p]) << "pair " << p << " type " << types[p];
+        if (types[p] == Global or types[p] == Local or types[p] == QueryFit) {
+            blasr::Alignment &batch = alignments[p];
+            EXPECT_EQ(expected.qPos, batch.qPos) << "pair " << p;
+            EXPECT_EQ(expected.tPos, batch.tPos) << "pair " << p;
+            if (types[p] == Local) {
+                EXPECT_EQ(expected.qLength, batch.qLength) << "pair " << p;
+                EXPECT_EQ(expected.tLength, batch.tLength) << "pair " << p;
+            }
+            ASSERT_EQ(expected.blocks.size(), batch.blocks.size()) << "pair " << p;
+            for (size_t b = 0; b < expected.blocks.size(); b++) {
+                EXPECT_EQ(expected.blocks[b].qPos, batch.blocks[b].qPos);
+                EXPECT_EQ(expected.blocks[b].tPos, batch.blocks[b].tPos);
+                EXPECT_EQ(expected.blocks[b].length, batch.blocks[b].length);
+            }
+        }
+    }
+}
+
+TEST_F(SWAlignBatchTest, LocalReportsCellBeforeBest) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, 3, 3);
+    qSeqs.resize(1);
+    tSeqs.resize(1);
+    qSeqs[0].Copy("TTACGTACGTAAA");
+    tSeqs[0].Copy("GGGACGTACGTCC");
+    qPtrs.push_back(&qSeqs[0]);
+    tPtrs.push_back(&tSeqs[0]);
+    types.push_back(Local);
+
+    vector<int> scores;
+    vector<blasr::Alignment> alignments;
+    SWAlignBatch(qPtrs, tPtrs, types, scoreFn, scores, &alignments);
+    // ACGTACGT scores -40; the reported cell is one match before it.
+    EXPECT_EQ(-35, scores[0]);
+    EXPECT_EQ(2, alignments[0].qPos);
+    EXPECT_EQ(3, alignments[0].tPos);
+    ASSERT_EQ(1, alignments[0].blocks.size());
+    EXPECT_EQ(7, alignments[0].blocks[0].length);
+}
+
+TEST_F(SWAlignBatchTest, ScoresMatchAlignments) {
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMat, 3, 3);
+    AlignmentType allTypes[] = {Global, Local, QueryFit, TargetFit};
+    AlignmentType scoreTypes[] = {ScoreGlobal, ScoreLocal, ScoreQueryFit, ScoreTargetFit};
+    srand(5);
+    MakePairs(500, 80, allTypes, 4);
+
+    vector<int> scores, scoresOnly;
+    vector<blasr::Alignment> alignments;
+    SWAlignBatch(qPtrs, tPtrs, types, scoreFn, scores, &alignments);
+    for (size_t p = 0; p < types.size(); p++) {
+        for (int t = 0; t < 4; t++) {
+            if (types[p] == allTypes[t]) {
+                types[p] = scoreTypes[t];
+            }
+        }
+    }
+    SWAlignBatch(qPtrs, tPtrs, types, scoreFn, scoresOnly,
+        (vector<blasr::Alignment>*) NULL);
+    EXPECT_EQ(scoresOnly, scores);
+}
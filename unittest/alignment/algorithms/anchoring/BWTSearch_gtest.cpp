@@ -0,0 +1,180 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  BWTSearch_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/anchoring/BWTSearch.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+#include "algorithms/anchoring/BWTSearch.hpp"
+#include "alignment/bwt/NaiveBWT.hpp"
+
+using namespace std;
+
+//
+// The SMEMs of read[start,end) found by trying every start position:
+// the longest match from each position that is not contained in the
+// match of an earlier position.
+//
+static vector<pair<int, int> > BruteForceSMEMs(const string &genome, const string &read,
+    int start, int end, int minLength) {
+    vector<pair<int, int> > smems;
+    int maxEnd = -1;
+    for (int i = start; i < end; i++) {
+        int length = 0;
+        for (size_t p = 0; p < genome.size(); p++) {
+            int l = 0;
+            while (i + l < end and p + l < genome.size() and read[i + l] != 'N' and
+                   read[i + l] == genome[p + l]) {
+                l++;
+            }
+            length = max(length, l);
+        }
+        if (length > 0 and i + length > maxEnd and length >= minLength) {
+            smems.push_back(make_pair(i, i + length));
+        }
+        maxEnd = max(maxEnd, i + length);
+    }
+    return smems;
+}
+
+static vector<DNALength> Occurrences(const string &genome, const string &pattern) {
+    vector<DNALength> positions;
+    size_t p = genome.find(pattern);
+    while (p != string::npos) {
+        positions.push_back(p);
+        p = genome.find(pattern, p + 1);
+    }
+    return positions;
+}
+
+class BWTSearchTest : public ::testing::Test {
+public:
+    string genome, reverseGenome;
+    BidirectionalBWT *bwt;
+
+    void SetUp() {
+        bwt = NULL;
+    }
+
+    void TearDown() {
+        delete bwt;
+    }
+
+    //
+    // A random genome with a few copied segments, so that some SMEMs
+    // have several hits.
+    //
+    void MakeGenome(int trial) {
+        srand(trial);
+        int n = 2000 + rand() % 3000;
+        genome.assign(n, 'A');
+        for (int i = 0; i < n; i++) {
+            genome[i] = "ACGT"[rand() % (trial % 3 == 0 ? 2 : 4)];
+        }
+        for (int k = 0; k < 5; k++) {
+            int a = rand() % (n - 200), b = rand() % (n - 200);
+            genome.replace(b, 100, genome.substr(a, 100));
+        }
+        reverseGenome.assign(genome.rbegin(), genome.rend());
+        delete bwt;
+        bwt = new BidirectionalBWT;
+        NaiveBuildBWT(genome, bwt->forward);
+        NaiveBuildBWT(reverseGenome, bwt->reverse);
+    }
+
+    string MakeRead() {
+        int start = rand() % (genome.size() - 300);
+        string read = genome.substr(start, 150 + rand() % 100);
+        for (int m = rand() % 12; m > 0; m--) {
+            read[rand() % read.size()] = "ACGTN"[rand() % 5];
+        }
+        return read;
+    }
+};
+
+TEST_F(BWTSearchTest, FindSMEMsMatchesBruteForce) {
+    SMEMBuffers buffers;
+    for (int trial = 0; trial < 10; trial++) {
+        MakeGenome(trial);
+        for (int it = 0; it < 20; it++) {
+            string read = MakeRead();
+            FASTASequence seq;
+            seq.seq = (Nucleotide*) &read[0];
+            seq.length = read.size();
+            int minLength = 1 + rand() % 15;
+            int start = rand() % 10, end = read.size() - rand() % 10;
+
+            vector<BiInterval> smems;
+            FindSMEMs(*bwt, seq, start, end, minLength, smems, &buffers);
+            vector<pair<int, int> > found;
+            for (size_t s = 0; s < smems.size(); s++) {
+                found.push_back(make_pair((int) smems[s].qStart, (int) smems[s].qEnd));
+            }
+            EXPECT_EQ(BruteForceSMEMs(genome, read, start, end, minLength), found)
+                << "trial " << trial << " read " << it;
+
+            for (size_t s = 0; s < smems.size(); s++) {
+                vector<DNALength> positions;
+                bwt->Locate(smems[s], positions);
+                sort(positions.begin(), positions.end());
+                string pattern = read.substr(smems[s].qStart, smems[s].qEnd - smems[s].qStart);
+                EXPECT_EQ(Occurrences(genome, pattern), positions);
+                EXPECT_EQ(positions.size(), smems[s].size);
+            }
+            seq.seq = NULL;
+        }
+    }
+}
+
+TEST_F(BWTSearchTest, MapReadToGenomeAnchorsSMEMHits) {
+    MakeGenome(4);
+    AnchorParameters params;
+    params.minMatchLength = 12;
+    params.maxAnchorsPerPosition = 3;
+    SMEMBuffers buffers;
+    for (int it = 0; it < 20; it++) {
+        string read = MakeRead();
+        FASTASequence seq;
+        seq.seq = (Nucleotide*) &read[0];
+        seq.length = read.size();
+
+        vector<ChainedMatchPos> anchors;
+        int numBasesAnchored;
+        MapReadToGenome(*bwt, seq, 0, read.size(), anchors, params, numBasesAnchored, &buffers);
+
+        vector<pair<int, int> > smems = BruteForceSMEMs(genome, read, 0, read.size(),
+            params.minMatchLength);
+        size_t expectedAnchors = 0;
+        int covered = 0, coveredEnd = 0;
+        for (size_t s = 0; s < smems.size(); s++) {
+            string pattern = read.substr(smems[s].first, smems[s].second - smems[s].first);
+            size_t nHits = Occurrences(genome, pattern).size();
+            if (nHits >= params.maxAnchorsPerPosition) {
+                continue;
+            }
+            expectedAnchors += nHits;
+            if (smems[s].second > coveredEnd) {
+                covered += smems[s].second - max(smems[s].first, coveredEnd);
+                coveredEnd = smems[s].second;
+            }
+        }
+        EXPECT_EQ(expectedAnchors, anchors.size());
+        EXPECT_EQ(covered, numBasesAnchored);
+        for (size_t a = 0; a < anchors.size(); a++) {
+            EXPECT_EQ(read.substr(anchors[a].q, anchors[a].l),
+                      genome.substr(anchors[a].t, anchors[a].l));
+        }
+        seq.seq = NULL;
+    }
+}
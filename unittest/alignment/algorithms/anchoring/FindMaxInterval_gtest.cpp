@@ -0,0 +1,214 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  FindMaxInterval_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/anchoring/FindMaxInterval.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <pthread.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "gtest/gtest.h"
+#include "FASTASequence.hpp"
+#include "algorithms/anchoring/FindMaxInterval.hpp"
+#include "algorithms/anchoring/LISPValueWeightor.hpp"
+#include "algorithms/anchoring/LISSizeWeightor.hpp"
+
+using namespace std;
+
+namespace {
+
+typedef vector<ChainedMatchPos> MatchList;
+
+//
+// The boundaries of a genome of two contigs, [0, ContigEnd) and
+// [ContigEnd + 1, TwoContigLength), looked up as SeqBoundaryFtr does.
+//
+const DNALength ContigEnd = 120000, TwoContigLength = 200000;
+
+class TwoContigBoundary {
+public:
+    int GetIndex(DNALength pos) {
+        return pos > ContigEnd ? 1 : 0;
+    }
+    int GetStartPos(int index) {
+        DNALength starts[] = {0, ContigEnd + 1, TwoContigLength + 1};
+        return starts[index];
+    }
+    DNALength operator()(DNALength pos) {
+        return GetStartPos(GetIndex(pos));
+    }
+    DNALength Length(DNALength pos) {
+        int index = GetIndex(pos);
+        return GetStartPos(index + 1) - GetStartPos(index) - 1;
+    }
+};
+
+//
+// LISSizeWeightor that counts the calls made to one copy from more
+// than one thread.
+//
+class ThreadCheckedWeightor {
+public:
+    LISSizeWeightor<MatchList> weightor;
+    bool called;
+    pthread_t caller;
+    int *nSharedCalls;
+
+    ThreadCheckedWeightor(int *nSharedCallsP) {
+        called = false;
+        nSharedCalls = nSharedCallsP;
+    }
+    ThreadCheckedWeightor(const ThreadCheckedWeightor &rhs) {
+        called = false;
+        nSharedCalls = rhs.nSharedCalls;
+    }
+    MatchWeight operator()(MatchList &matchList) {
+        if (called and !pthread_equal(caller, pthread_self())) {
+            __sync_fetch_and_add(nSharedCalls, 1);
+        }
+        called = true;
+        caller = pthread_self();
+        return weightor(matchList);
+    }
+};
+
+bool LessByTargetPos(const ChainedMatchPos &a, const ChainedMatchPos &b) {
+    return a.t < b.t or (a.t == b.t and a.q < b.q);
+}
+
+//
+// Anchors along a hit of a 5 kb read at hitPos, one every 60 bases
+// with about one in five missing, and random anchors over the whole
+// genome.
+//
+void MakeAnchors(DNALength hitPos, int nRandom, MatchList &anchors) {
+    anchors.clear();
+    DNALength q;
+    for (q = 0; q + 30 < 5000; q += 60) {
+        if (rand() % 5) {
+            anchors.push_back(ChainedMatchPos(hitPos + q + rand() % 5, q, 12 + rand() % 20, 1));
+        }
+    }
+    for (int i = 0; i < nRandom; i++) {
+        DNALength t = rand() % (TwoContigLength - 100);
+        if (t + 50 < ContigEnd or t > ContigEnd) {
+            anchors.push_back(ChainedMatchPos(t, rand() % 4900, 12 + rand() % 10, 1));
+        }
+    }
+    sort(anchors.begin(), anchors.end(), LessByTargetPos);
+}
+
+class IntervalSearchResult {
+public:
+    WeightedIntervalSet queue;
+    ClusterList clusterList;
+    VarianceAccumulator<float> accumPValue, accumWeight, accumNumAnchorBases;
+    int maxLISSize;
+
+    IntervalSearchResult() : queue(10) {}
+};
+
+void ExpectSameResult(IntervalSearchResult &serial, IntervalSearchResult &parallel) {
+    EXPECT_EQ(serial.maxLISSize, parallel.maxLISSize);
+    ASSERT_EQ(serial.queue.size(), parallel.queue.size());
+    WeightedIntervalSet::iterator s = serial.queue.begin(), p = parallel.queue.begin();
+    for (; s != serial.queue.end(); ++s, ++p) {
+        EXPECT_EQ(s->start, p->start);
+        EXPECT_EQ(s->end, p->end);
+        EXPECT_EQ(s->qStart, p->qStart);
+        EXPECT_EQ(s->qEnd, p->qEnd);
+        EXPECT_EQ(s->readIndex, p->readIndex);
+        EXPECT_EQ(s->pValue, p->pValue);
+        EXPECT_EQ(s->size, p->size);
+        EXPECT_EQ(s->nAnchors, p->nAnchors);
+        EXPECT_EQ(s->matches.size(), p->matches.size());
+    }
+    EXPECT_TRUE(serial.clusterList.numBases == parallel.clusterList.numBases);
+    EXPECT_TRUE(serial.clusterList.numAnchors == parallel.clusterList.numAnchors);
+    EXPECT_TRUE(serial.clusterList.startPos == parallel.clusterList.startPos);
+    EXPECT_EQ(serial.accumPValue.nSamples, parallel.accumPValue.nSamples);
+    EXPECT_EQ(serial.accumPValue.sumVal, parallel.accumPValue.sumVal);
+    EXPECT_EQ(serial.accumWeight.nSamples, parallel.accumWeight.nSamples);
+    EXPECT_EQ(serial.accumWeight.sumVal, parallel.accumWeight.sumVal);
+}
+
+}
+
+class FindMaxIntervalTest : public ::testing::Test {
+public:
+    MatchList forwardAnchors, reverseAnchors;
+    FASTASequence reference, forwardRead, reverseRead;
+    TwoContigBoundary boundary;
+
+    //
+    // The read hits the first contig forward and, less well, the
+    // second one reverse complemented.
+    //
+    void SetUp() {
+        srand(11);
+        MakeAnchors(30000, 400, forwardAnchors);
+        MakeAnchors(150000, 400, reverseAnchors);
+        reverseAnchors.erase(reverseAnchors.begin(), reverseAnchors.begin() + 20);
+        reference.length = TwoContigLength;
+        forwardRead.length = reverseRead.length = 5000;
+    }
+
+    void Search(IntervalSearchParameters &params, bool parallel, IntervalSearchResult &result,
+        int *nSharedCalls) {
+        LISSumOfLogPWeightor<FASTASequence, MatchList> pValueFunction(reference);
+        ThreadCheckedWeightor weightFunction(nSharedCalls);
+        vector<BasicEndpoint<ChainedMatchPos> > forwardBuffer, reverseBuffer;
+        MatchList forwardPos(forwardAnchors), reversePos(reverseAnchors);
+        if (parallel) {
+            result.maxLISSize = FindMaxIncreasingIntervalOnBothStrands(
+                forwardPos, reversePos, 5500, 10, boundary, pValueFunction, weightFunction,
+                result.queue, reference, forwardRead, reverseRead, params,
+                &forwardBuffer, &reverseBuffer, result.clusterList,
+                result.accumPValue, result.accumWeight, result.accumNumAnchorBases);
+        }
+        else {
+            int forwardLIS = FindMaxIncreasingInterval(Forward, forwardPos, 5500, 10, boundary,
+                pValueFunction, weightFunction, result.queue, reference, forwardRead, params,
+                &forwardBuffer, result.clusterList, result.accumPValue, result.accumWeight,
+                result.accumNumAnchorBases);
+            result.clusterList.ResetCoordinates();
+            int reverseLIS = FindMaxIncreasingInterval(Reverse, reversePos, 5500, 10, boundary,
+                pValueFunction, weightFunction, result.queue, reference, reverseRead, params,
+                &forwardBuffer, result.clusterList, result.accumPValue, result.accumWeight,
+                result.accumNumAnchorBases);
+            result.maxLISSize = max(forwardLIS, reverseLIS);
+        }
+    }
+
+    void TearDown() {
+        reference.seq = forwardRead.seq = reverseRead.seq = NULL;
+    }
+};
+
+//
+// The queue, clusters and accumulators of the concurrent search are
+// those of searching the forward and then the reverse strand.
+//
+TEST_F(FindMaxIntervalTest, BothStrandsMatchSerialSearch) {
+    for (int fast = 0; fast <= 1; fast++) {
+        for (int cut = 0; cut <= 1; cut++) {
+            IntervalSearchParameters params;
+            params.fastMaxInterval = fast;
+            params.aggressiveIntervalCut = cut;
+            int nSharedCalls = 0;
+            IntervalSearchResult serial, parallel;
+            Search(params, false, serial, &nSharedCalls);
+            Search(params, true, parallel, &nSharedCalls);
+            ASSERT_GT(serial.queue.size(), (size_t) 1) << "fast " << fast << " cut " << cut;
+            ExpectSameResult(serial, parallel);
+            EXPECT_EQ(0, nSharedCalls);
+        }
+    }
+}
@@ -0,0 +1,197 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  MapByHomopolymerCompression_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/anchoring/MapByHomopolymerCompression.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+#include "SMRTSequence.hpp"
+#include "HomopolymerCompressedSequence.hpp"
+#include "datastructures/anchoring/MatchPos.hpp"
+#include "suffixarray/SuffixArrayTypes.hpp"
+#include "suffixarray/CompressedSuffixArray.hpp"
+#include "algorithms/anchoring/MapByHomopolymerCompression.hpp"
+
+using namespace std;
+
+//
+// Whether l is the shorter of the uncompressed lengths of the first k
+// runs from t in the genome and q in the read, for some k.
+//
+static bool IsShorterRunSpan(const string &genome, DNALength t, const string &read,
+    DNALength q, DNALength l) {
+    DNALength tEnd = t, qEnd = q;
+    while (tEnd < genome.size() and qEnd < read.size() and
+           min(tEnd - t, qEnd - q) <= l) {
+        if (min(tEnd - t, qEnd - q) == l) {
+            return true;
+        }
+        char base = genome[tEnd];
+        while (tEnd < genome.size() and genome[tEnd] == base) {
+            tEnd++;
+        }
+        base = read[qEnd];
+        while (qEnd < read.size() and read[qEnd] == base) {
+            qEnd++;
+        }
+    }
+    return min(tEnd - t, qEnd - q) == l;
+}
+
+class MapByHomopolymerCompressionTest : public ::testing::Test {
+public:
+    string genome;
+    DNASequence genomeSeq;
+    HomopolymerCompressedSequence reference;
+    DNASuffixArray sa;
+    CompressedSuffixArray csa;
+    AnchorParameters params;
+
+    //
+    // Homopolymer runs of A at hpStart in the genome, and of each
+    // length at the same place in the reads.
+    //
+    static const DNALength hpStart = 10000, hpLength = 400;
+
+    void TearDown() {
+        genomeSeq.Free();
+        reference.Free();
+    }
+
+    //
+    // A random genome with a few runs of N, and a homopolymer between
+    // two other bases.  The suffix arrays are of its compression.
+    //
+    void SetUp() {
+        srand(49);
+        DNALength n = 20000, i;
+        genome.assign(n, 'A');
+        for (i = 0; i < n; i++) {
+            genome[i] = "ACGT"[rand() % 4];
+        }
+        for (int r = 0; r < 5; r++) {
+            DNALength p = rand() % (n - 50);
+            genome.replace(p, 1 + rand() % 50, string(50, 'N'), 0, 1 + rand() % 50);
+        }
+        genome.resize(n, 'C');
+        genome.replace(hpStart, hpLength, string(hpLength, 'A'));
+        genome[hpStart - 1] = 'C';
+        genome[hpStart + hpLength] = 'G';
+        genomeSeq.Copy(genome);
+        reference.Compress(genomeSeq);
+
+        DNALength cpLength = reference.length;
+        vector<Nucleotide> codes(cpLength);
+        for (i = 0; i < cpLength; i++) {
+            codes[i] = ThreeBit[reference.seq[i]];
+        }
+        vector<int> alphabet;
+        sa.LarssonBuildSuffixArray(&codes[0], cpLength, alphabet);
+        sa.length = cpLength;
+        sa.BuildLookupTable(reference.seq, cpLength, 8);
+
+        testing::internal::CaptureStderr();
+        csa.Build(reference, 4, 8);
+        testing::internal::GetCapturedStderr();
+
+        params.minMatchLength = 12;
+    }
+
+    //
+    // The anchors of a read from start to end of the genome, with the
+    // homopolymer readHpLength long, against either suffix array.
+    // Every run start of the read far enough from its end is expected
+    // to be anchored where the same run starts in the genome, and
+    // every anchor to start on the same base in both and be as long as
+    // the shorter of the runs it covers in each.
+    //
+    template<typename T_SuffixArray>
+    void CheckRead(T_SuffixArray &index, DNALength start, DNALength end,
+        DNALength readHpLength) {
+        string readString = genome.substr(start, hpStart - start) +
+            string(readHpLength, 'A') + genome.substr(hpStart + hpLength, end - hpStart - hpLength);
+        SMRTSequence read;
+        ((DNASequence&) read).Copy(readString);
+        read.SubreadStart(0).SubreadEnd(read.length);
+        vector<ChainedMatchPos> anchors;
+        MapCompressedReadToGenome(reference, index, read, index.lookupPrefixLength, anchors,
+            params);
+        SCOPED_TRACE(testing::Message() << "read homopolymer " << readHpLength);
+
+        set<pair<DNALength, DNALength> > found;
+        for (size_t a = 0; a < anchors.size(); a++) {
+            DNALength t = anchors[a].t, q = anchors[a].q, l = anchors[a].l;
+            ASSERT_LT(q, readString.size());
+            ASSERT_LE(t + l, genome.size());
+            EXPECT_TRUE(q == 0 or readString[q-1] != readString[q]) << q;
+            EXPECT_TRUE(t == 0 or genome[t-1] != genome[t]) << t;
+            EXPECT_EQ(genome[t], readString[q]) << q;
+            EXPECT_TRUE(IsShorterRunSpan(genome, t, readString, q, l)) << q;
+            found.insert(make_pair(q, t));
+        }
+
+        DNALength readHpStart = hpStart - start;
+        DNALength readHpEnd = readHpStart + readHpLength;
+        //
+        // The search leaves out the end of the read, so the last
+        // anchors are too short to keep; only the runs well before it
+        // are expected.
+        //
+        HomopolymerCompressedSequence compressedRead;
+        compressedRead.Compress(read);
+        DNALength mappedEnd = compressedRead.LookupSequencePos(compressedRead.length -
+            2 * params.minMatchLength), q;
+        compressedRead.Free();
+        for (q = 0; q < mappedEnd; q++) {
+            if (q > 0 and readString[q-1] == readString[q]) {
+                continue;
+            }
+            DNALength t = start + q;
+            if (q >= readHpEnd) {
+                t = q - readHpEnd + hpStart + hpLength;
+            }
+            else if (q >= readHpStart) {
+                t = hpStart;
+            }
+            EXPECT_TRUE(found.count(make_pair(q, t))) << "read run at " << q;
+        }
+
+        //
+        // The anchor of the first run spans the homopolymer in both the
+        // read and the genome, though their runs differ.
+        //
+        DNALength hpEnd = min(readHpEnd, hpStart + hpLength - start);
+        for (size_t a = 0; a < anchors.size(); a++) {
+            if (anchors[a].q == 0) {
+                EXPECT_EQ(start, anchors[a].t);
+                EXPECT_GT(anchors[a].l, hpEnd);
+            }
+        }
+        read.Free();
+    }
+};
+
+TEST_F(MapByHomopolymerCompressionTest, ReadAcrossHomopolymer) {
+    // Start the reads on a run start, as anchors do.
+    DNALength start = 9800;
+    while (genome[start - 1] == genome[start]) {
+        start++;
+    }
+    DNALength readHpLengths[] = {1, 40, hpLength, 700};
+    for (int h = 0; h < 4; h++) {
+        CheckRead(sa, start, 10600, readHpLengths[h]);
+        CheckRead(csa, start, 10600, readHpLengths[h]);
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  PrioritySearchTree_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/anchoring/PrioritySearchTree.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "gtest/gtest.h"
+#include "algorithms/anchoring/BasicEndpoint.hpp"
+#include "algorithms/anchoring/GlobalChain.hpp"
+#include "algorithms/anchoring/PrioritySearchTree.hpp"
+#include "datastructures/anchoring/MatchPos.hpp"
+
+using namespace std;
+
+namespace {
+
+class ScoredPoint {
+public:
+    KeyType key;
+    int score;
+    bool active;
+    ScoredPoint(KeyType keyP, int scoreP) : key(keyP), score(scoreP), active(false) {}
+    KeyType GetKey() { return key; }
+    int GetScore() { return score; }
+    bool operator<(const ScoredPoint &rhs) const { return key < rhs.key; }
+};
+
+//
+// The highest score of the active points with a key below maxKey, or
+// -1 when there are none.
+//
+int LinearMaxScore(vector<ScoredPoint> &points, KeyType maxKey) {
+    int maxScore = -1;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (points[i].active and points[i].key < maxKey) {
+            maxScore = max(maxScore, points[i].score);
+        }
+    }
+    return maxScore;
+}
+
+//
+// Activate the points in a random order, and after each activation
+// query the tree at random keys and at the keys of the points.
+//
+void CheckQueries(vector<ScoredPoint> &points, PrioritySearchTree<ScoredPoint> &pst,
+    KeyType maxKey) {
+    vector<int> order(points.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    random_shuffle(order.begin(), order.end());
+    for (size_t a = 0; a <= order.size(); a++) {
+        if (a > 0) {
+            points[order[a-1]].active = true;
+            pst.Activate(points, order[a-1]);
+        }
+        for (int q = 0; q < 20; q++) {
+            KeyType key = (q % 2 or points.empty()) ? rand() % (maxKey + 2)
+                : points[rand() % points.size()].key;
+            int expected = LinearMaxScore(points, key);
+            int maxPointIndex = -1;
+            int found = pst.FindIndexOfMaxPoint(points, key, maxPointIndex);
+            ASSERT_EQ(expected != -1, found != 0) << "key " << key << " after " << a;
+            if (found) {
+                ASSERT_TRUE(points[maxPointIndex].active);
+                ASSERT_LT(points[maxPointIndex].key, key);
+                ASSERT_EQ(expected, points[maxPointIndex].score) << "key " << key;
+            }
+        }
+    }
+}
+
+void RandomPoints(int n, KeyType maxKey, vector<ScoredPoint> &points) {
+    points.clear();
+    for (int i = 0; i < n; i++) {
+        points.push_back(ScoredPoint(rand() % maxKey, 1 + rand() % 1000));
+    }
+    sort(points.begin(), points.end());
+}
+
+}
+
+TEST(PrioritySearchTreeTest, EmptyTree) {
+    vector<ScoredPoint> points;
+    PrioritySearchTree<ScoredPoint> pst;
+    pst.CreateTree(points);
+    int maxPointIndex = -1;
+    EXPECT_EQ(0, pst.FindIndexOfMaxPoint(points, 100, maxPointIndex));
+}
+
+TEST(PrioritySearchTreeTest, SinglePoint) {
+    vector<ScoredPoint> points;
+    points.push_back(ScoredPoint(10, 5));
+    PrioritySearchTree<ScoredPoint> pst;
+    pst.CreateTree(points);
+    int maxPointIndex = -1;
+    EXPECT_EQ(0, pst.FindIndexOfMaxPoint(points, 11, maxPointIndex));
+    pst.Activate(points, 0);
+    EXPECT_EQ(0, pst.FindIndexOfMaxPoint(points, 10, maxPointIndex));
+    EXPECT_EQ(1, pst.FindIndexOfMaxPoint(points, 11, maxPointIndex));
+    EXPECT_EQ(0, maxPointIndex);
+}
+
+//
+// Distinct keys, many repeated keys, and sizes on either side of a
+// power of two.
+//
+TEST(PrioritySearchTreeTest, MatchesLinearScan) {
+    srand(21);
+    int sizes[] = {2, 3, 7, 8, 9, 100, 257};
+    KeyType maxKeys[] = {10, 1000000};
+    for (int s = 0; s < 7; s++) {
+        for (int k = 0; k < 2; k++) {
+            vector<ScoredPoint> points;
+            RandomPoints(sizes[s], maxKeys[k], points);
+            PrioritySearchTree<ScoredPoint> pst;
+            pst.CreateTree(points);
+            CheckQueries(points, pst, maxKeys[k]);
+        }
+    }
+}
+
+//
+// A tree built in a buffer that held a larger, fully activated tree
+// starts with no active points.
+//
+TEST(PrioritySearchTreeTest, ReusesBuffer) {
+    srand(22);
+    vector<PSTVertex<ScoredPoint> > buffer;
+    int sizes[] = {300, 40, 1, 0, 129};
+    for (int s = 0; s < 5; s++) {
+        vector<ScoredPoint> points;
+        RandomPoints(sizes[s], 5000, points);
+        PrioritySearchTree<ScoredPoint> pst;
+        pst.CreateTree(points, &buffer);
+        CheckQueries(points, pst, 5000);
+    }
+}
+
+//
+// GlobalChain gives the same chains whether or not it keeps its
+// endpoints and tree in buffers between windows.
+//
+TEST(PrioritySearchTreeTest, GlobalChainWithBuffers) {
+    srand(23);
+    vector<ChainedMatchPos> pos;
+    for (int i = 0; i < 600; i++) {
+        DNALength t = rand() % 5000;
+        pos.push_back(ChainedMatchPos(t, (t + rand() % 50) % 3000, 8 + rand() % 20, 1));
+    }
+    sort(pos.begin(), pos.end(), CompareMatchPos<ChainedMatchPos>());
+    typedef BasicEndpoint<ChainedMatchPos> Endpoint;
+    vector<Endpoint> endpointBuffer;
+    vector<PSTVertex<Endpoint> > treeBuffer;
+    for (int w = 0; w < 200; w++) {
+        DNALength start = rand() % pos.size();
+        DNALength end = start + rand() % min(200, (int) (pos.size() - start) + 1);
+        vector<VectorIndex> fresh, buffered;
+        GlobalChain<ChainedMatchPos, Endpoint>(pos, start, end, fresh);
+        GlobalChain<ChainedMatchPos, Endpoint>(pos, start, end, buffered,
+            &endpointBuffer, &treeBuffer);
+        ASSERT_TRUE(fresh == buffered) << "window " << start << " " << end;
+    }
+}
@@ -0,0 +1,162 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SlidingWindowChain_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/anchoring/SlidingWindowChain.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "gtest/gtest.h"
+#include "algorithms/anchoring/GlobalChain.hpp"
+#include "algorithms/anchoring/BasicEndpoint.hpp"
+#include "algorithms/anchoring/SlidingWindowChain.hpp"
+#include "datastructures/anchoring/MatchPos.hpp"
+
+using namespace std;
+
+namespace {
+
+typedef vector<ChainedMatchPos> MatchList;
+
+bool LessByTargetPos(const ChainedMatchPos &a, const ChainedMatchPos &b) {
+    return a.t < b.t or (a.t == b.t and a.q < b.q);
+}
+
+//
+// Whether g may come before f in a chain.
+//
+bool Precedes(const ChainedMatchPos &g, const ChainedMatchPos &f) {
+    return g.t + g.l < f.t and g.q + g.l <= f.q;
+}
+
+//
+// The weight of the heaviest chain in pos[start, end), by dynamic
+// programming over every pair of anchors.
+//
+int BruteForceChainWeight(MatchList &pos, VectorIndex start, VectorIndex end) {
+    vector<int> best(end - start, 0);
+    int maxWeight = 0;
+    VectorIndex f, g;
+    for (f = start; f < end; f++) {
+        best[f - start] = pos[f].l;
+        for (g = start; g < f; g++) {
+            if (Precedes(pos[g], pos[f])) {
+                best[f - start] = max(best[f - start], best[g - start] + (int) pos[f].l);
+            }
+        }
+        maxWeight = max(maxWeight, best[f - start]);
+    }
+    return maxWeight;
+}
+
+//
+// The weight of a chain given by indices relative to start, which
+// must be in order and each able to precede the next.
+//
+int ChainWeight(MatchList &pos, VectorIndex start, VectorIndex end,
+    vector<VectorIndex> &chain) {
+    int weight = 0;
+    VectorIndex c;
+    for (c = 0; c < chain.size(); c++) {
+        EXPECT_LT(start + chain[c], end);
+        if (c > 0) {
+            EXPECT_TRUE(Precedes(pos[start + chain[c-1]], pos[start + chain[c]]))
+                << "window " << start << " " << end << " link " << c;
+        }
+        weight += pos[start + chain[c]].l;
+    }
+    return weight;
+}
+
+//
+// Anchors along a few diagonals with random ones between them, some
+// overlapping and some sharing a target position.
+//
+void MakeAnchors(int n, MatchList &pos) {
+    pos.clear();
+    for (int i = 0; i < n; i++) {
+        DNALength t = rand() % 20000;
+        DNALength q = (rand() % 3) ? (t % 5000) + rand() % 40 : rand() % 5000;
+        pos.push_back(ChainedMatchPos(t, q, 8 + rand() % 30, 1));
+        if (rand() % 10 == 0) {
+            pos.push_back(ChainedMatchPos(t, rand() % 5000, 8 + rand() % 30, 1));
+        }
+    }
+    sort(pos.begin(), pos.end(), LessByTargetPos);
+}
+
+}
+
+//
+// Slide windows of anchors within intervalLength of their first anchor
+// across the list, as the exhaustive interval search does, and compare
+// each chain, and GlobalChain's, with the brute force.
+//
+TEST(SlidingWindowChainTest, MatchesBruteForce) {
+    srand(5);
+    DNALength intervalLengths[] = {300, 2000, 6000};
+    for (int l = 0; l < 3; l++) {
+        MatchList pos;
+        MakeAnchors(1500, pos);
+        SlidingWindowChain<MatchList> windowChain;
+        windowChain.Initialize(pos);
+        VectorIndex start, end = 0;
+        for (start = 0; start < pos.size(); start++) {
+            while (end < pos.size() and pos[end].t - pos[start].t <= intervalLengths[l]) {
+                end++;
+            }
+            vector<VectorIndex> windowIndices, globalIndices;
+            windowChain.Chain(start, end, windowIndices);
+            int expected = BruteForceChainWeight(pos, start, end);
+            ASSERT_EQ(expected, ChainWeight(pos, start, end, windowIndices))
+                << "window " << start << " " << end;
+            GlobalChain<ChainedMatchPos, BasicEndpoint<ChainedMatchPos> >(pos, start, end,
+                globalIndices);
+            ASSERT_EQ(expected, ChainWeight(pos, start, end, globalIndices))
+                << "window " << start << " " << end;
+        }
+    }
+}
+
+//
+// Windows that move back, or skip ahead past the previous one, are
+// chained from scratch.
+//
+TEST(SlidingWindowChainTest, Restarts) {
+    srand(6);
+    MatchList pos;
+    MakeAnchors(400, pos);
+    SlidingWindowChain<MatchList> windowChain;
+    windowChain.Initialize(pos);
+    for (int w = 0; w < 300; w++) {
+        VectorIndex start = rand() % pos.size();
+        VectorIndex end = start + 1 + rand() % min((VectorIndex) 80, (VectorIndex) pos.size() - start);
+        vector<VectorIndex> indices;
+        int size = windowChain.Chain(start, end, indices);
+        ASSERT_EQ((int) indices.size(), size);
+        ASSERT_EQ(BruteForceChainWeight(pos, start, end), ChainWeight(pos, start, end, indices))
+            << "window " << start << " " << end;
+    }
+}
+
+TEST(SlidingWindowChainTest, SingleAnchors) {
+    MatchList pos;
+    pos.push_back(ChainedMatchPos(100, 0, 20, 1));
+    pos.push_back(ChainedMatchPos(110, 5, 30, 1));
+    SlidingWindowChain<MatchList> windowChain;
+    windowChain.Initialize(pos);
+    vector<VectorIndex> indices;
+    EXPECT_EQ(1, windowChain.Chain(0, 1, indices));
+    EXPECT_EQ(0u, indices[0]);
+    indices.clear();
+    // The anchors overlap, so the longer one is the chain.
+    EXPECT_EQ(1, windowChain.Chain(0, 2, indices));
+    EXPECT_EQ(1u, indices[0]);
+}
@@ -0,0 +1,114 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  ExternalSuffixSort_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/sorting/ExternalSuffixSort.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "suffixarray/SuffixArrayTypes.hpp"
+
+using namespace std;
+
+static string ReadFile(const string &fileName) {
+    ifstream in(fileName.c_str(), ios::binary);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+class ExternalSuffixSortTest : public ::testing::Test {
+public:
+    vector<unsigned char> text;
+    UInt textLength;
+
+    //
+    // A random genome with a run of N and a repeat, followed by the
+    // zeros the difference cover sort reads past its end.
+    //
+    void SetUp() {
+        srand(7);
+        textLength = 100000;
+        text.assign(textLength + 2281, 0);
+        UInt i;
+        for (i = 0; i < textLength; i++) {
+            text[i] = "ACGT"[rand() % 4];
+        }
+        for (i = 30000; i < 35000; i++) {
+            text[i] = 'N';
+        }
+        for (i = 0; i < 20000; i++) {
+            text[60000 + i] = text[10000 + i];
+        }
+    }
+};
+
+TEST_F(ExternalSuffixSortTest, MatchesLightweightSort) {
+    DNASuffixArray expected;
+    expected.LightweightBuildSuffixArray(&text[0], textLength);
+    expected.BuildLookupTable(&text[0], textLength, 8);
+    string expectedName = "/tmp/ExternalSuffixSort_gtest.expected.sa";
+    expected.Write(expectedName);
+    string expectedFile = ReadFile(expectedName);
+    remove(expectedName.c_str());
+
+    UInt blockLengths[] = {1000, 65536, 1 << 20};
+    for (int b = 0; b < 3; b++) {
+        DNASuffixArray external;
+        string fileName = "/tmp/ExternalSuffixSort_gtest.sa";
+        testing::internal::CaptureStderr();
+        ASSERT_TRUE(external.WriteExternal(&text[0], textLength, fileName, 8, blockLengths[b],
+            2281, b + 1));
+        // Blocks are only reported when asked for.
+        EXPECT_EQ(string::npos, testing::internal::GetCapturedStderr().find("Wrote block"));
+        EXPECT_TRUE(ReadFile(fileName) == expectedFile) << "block length " << blockLengths[b];
+        remove(fileName.c_str());
+    }
+}
+
+TEST_F(ExternalSuffixSortTest, SortsInBlocks) {
+    vector<UInt> expected(textLength);
+    LightweightSuffixSort(&text[0], textLength, &expected[0], 2281);
+
+    ExternalSuffixSort sorter;
+    stringstream out;
+    ASSERT_TRUE(sorter.Sort(&text[0], textLength, out, 5000));
+    EXPECT_GT(sorter.nBlocks, (UInt) 1);
+    string written = out.str();
+    ASSERT_EQ(textLength * sizeof(UInt), written.size());
+    EXPECT_EQ(0, memcmp(&expected[0], written.c_str(), written.size()));
+
+    //
+    // The array is read back the same through a buffer smaller than it.
+    //
+    string fileName = "/tmp/ExternalSuffixSort_gtest.array";
+    {
+        ofstream arrayOut(fileName.c_str(), ios::binary);
+        arrayOut.write("header", 6);
+        arrayOut.write(written.c_str(), written.size());
+    }
+    SuffixArrayFileReader reader;
+    ASSERT_TRUE(reader.Initialize(fileName, 6, textLength, 1000));
+    UInt i;
+    for (i = 0; i < textLength; i++) {
+        ASSERT_EQ(expected[i], reader[i]) << "entry " << i;
+    }
+    remove(fileName.c_str());
+}
+
+TEST_F(ExternalSuffixSortTest, OpenFailure) {
+    DNASuffixArray external;
+    string fileName = "/nonexistent-directory/ExternalSuffixSort_gtest.sa";
+    EXPECT_FALSE(external.WriteExternal(&text[0], textLength, fileName, 8, 65536));
+}
@@ -0,0 +1,195 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  MultikeyQuicksort_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/sorting/MultikeyQuicksort.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <pthread.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "algorithms/sorting/LightweightSuffixArray.hpp"
+#include "algorithms/sorting/MultikeyQuicksort.hpp"
+
+using namespace std;
+
+namespace {
+
+//
+// The first length characters of the suffix at pos, with zeros past
+// the end of the text.
+//
+string Prefix(const vector<unsigned char> &text, UInt pos, UInt length) {
+    string prefix(length, '\0');
+    UInt i;
+    for (i = 0; i < length and pos + i < text.size(); i++) {
+        prefix[i] = text[pos + i];
+    }
+    return prefix;
+}
+
+class SuffixGroups {
+public:
+    UInt *index;
+    pthread_mutex_t lock;
+    vector<pair<UInt, UInt> > groups;
+
+    SuffixGroups() {
+        pthread_mutex_init(&lock, NULL);
+    }
+    ~SuffixGroups() {
+        pthread_mutex_destroy(&lock);
+    }
+};
+
+void StoreGroup(UInt group[], UInt groupLength, void *data) {
+    SuffixGroups *groups = (SuffixGroups*) data;
+    pthread_mutex_lock(&groups->lock);
+    groups->groups.push_back(make_pair((UInt) (group - groups->index), groupLength));
+    pthread_mutex_unlock(&groups->lock);
+}
+
+//
+// Orders suffixes of the first n characters of text, a suffix before
+// the longer ones it is a prefix of.
+//
+class SuffixLess {
+public:
+    const unsigned char *text;
+    UInt n;
+    SuffixLess(const unsigned char *textP, UInt nP) : text(textP), n(nP) {}
+    bool operator()(UInt a, UInt b) const {
+        int cmp = memcmp(text + a, text + b, n - max(a, b));
+        return cmp < 0 or (cmp == 0 and a > b);
+    }
+};
+
+}
+
+class WordBoundedQuicksortTest : public ::testing::Test {
+public:
+    //
+    // Sort every suffix of text to bound, and check that the prefixes
+    // are in order and that the runs sharing the sorted prefix, which
+    // is bound rounded up to whole words, are each reported once.
+    //
+    void CheckSort(const vector<unsigned char> &text, UInt bound, int nThreads) {
+        UInt n = text.size(), i;
+        vector<UInt> index(n);
+        for (i = 0; i < n; i++) {
+            index[i] = n - 1 - i;
+        }
+        SuffixGroups groups;
+        groups.index = n ? &index[0] : NULL;
+        WordBoundedQuicksort sorter;
+        sorter.Sort(n ? (unsigned char*) &text[0] : NULL, n, groups.index, n, bound,
+            nThreads, StoreGroup, &groups);
+
+        vector<UInt> sorted(index);
+        sort(sorted.begin(), sorted.end());
+        for (i = 0; i < n; i++) {
+            ASSERT_EQ(i, sorted[i]);
+        }
+
+        UInt sortedLength = CeilOfFraction(bound, WordBoundedQuicksort::WordSortChars) *
+            WordBoundedQuicksort::WordSortChars;
+        vector<pair<UInt, UInt> > expected;
+        UInt runStart = 0;
+        for (i = 1; i <= n; i++) {
+            if (i < n) {
+                string prev = Prefix(text, index[i-1], sortedLength);
+                string cur  = Prefix(text, index[i], sortedLength);
+                ASSERT_LE(prev, cur) << "row " << i << " bound " << bound;
+                if (prev == cur) {
+                    continue;
+                }
+            }
+            if (i - runStart > 1) {
+                expected.push_back(make_pair(runStart, i - runStart));
+            }
+            runStart = i;
+        }
+        sort(groups.groups.begin(), groups.groups.end());
+        ASSERT_TRUE(expected == groups.groups) << "bound " << bound << " threads " << nThreads;
+    }
+};
+
+TEST_F(WordBoundedQuicksortTest, RandomText) {
+    srand(1);
+    vector<unsigned char> text(20000);
+    for (size_t i = 0; i < text.size(); i++) {
+        text[i] = "ACGTN"[rand() % 5];
+    }
+    UInt bounds[] = {1, 7, 8, 9, 24};
+    for (int b = 0; b < 5; b++) {
+        CheckSort(text, bounds[b], 1);
+        CheckSort(text, bounds[b], 3);
+    }
+}
+
+//
+// Long runs and repeats leave many suffixes sharing the whole bound,
+// and reach the end of the text.
+//
+TEST_F(WordBoundedQuicksortTest, RunsAndRepeats) {
+    srand(2);
+    vector<unsigned char> text(100000);
+    for (size_t i = 0; i < text.size(); i++) {
+        text[i] = "ACGT"[rand() % 4];
+    }
+    fill(text.begin() + 20000, text.begin() + 30000, 'N');
+    fill(text.begin() + 95000, text.end(), 'A');
+    copy(text.begin() + 40000, text.begin() + 50000, text.begin() + 60000);
+    CheckSort(text, 40, 1);
+    CheckSort(text, 40, 4);
+    CheckSort(text, 300, 2);
+}
+
+TEST_F(WordBoundedQuicksortTest, ShortTexts) {
+    const char *texts[] = {"", "A", "AC", "AAAAAAAAAAAAAAAAAAAA", "ACGTACGTACGTACGTACG"};
+    for (int t = 0; t < 5; t++) {
+        vector<unsigned char> text(texts[t], texts[t] + strlen(texts[t]));
+        CheckSort(text, 8, 1);
+        CheckSort(text, 13, 2);
+    }
+}
+
+//
+// The lightweight suffix sort orders the v-prefixes with the word
+// sort, and must give the same array for every cover size.
+//
+TEST_F(WordBoundedQuicksortTest, LightweightSuffixSort) {
+    srand(3);
+    UInt n = 20000, i;
+    vector<unsigned char> text(n + 2281, 0);
+    for (i = 0; i < n; i++) {
+        text[i] = "ACGT"[rand() % 4];
+    }
+    fill(text.begin() + 5000, text.begin() + 5600, 'N');
+    copy(text.begin() + 1000, text.begin() + 3000, text.begin() + 12000);
+    vector<UInt> expected(n);
+    for (i = 0; i < n; i++) {
+        expected[i] = i;
+    }
+    sort(expected.begin(), expected.end(), SuffixLess(&text[0], n));
+
+    int covers[] = {7, 32, 2281};
+    for (int c = 0; c < 3; c++) {
+        for (int nThreads = 1; nThreads <= 2; nThreads++) {
+            vector<UInt> index(n);
+            testing::internal::CaptureStderr();
+            ASSERT_TRUE(LightweightSuffixSort(&text[0], n, &index[0], covers[c], nThreads));
+            testing::internal::GetCapturedStderr();
+            ASSERT_TRUE(index == expected) << "cover " << covers[c] << " threads " << nThreads;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  BWTBuilder_gtest.cpp
+ *
+ *    Description:  Test alignment/bwt/BWTBuilder.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "bwt/BWTBuilder.hpp"
+#include "suffixarray/SuffixArrayTypes.hpp"
+#include "alignment/bwt/NaiveBWT.hpp"
+
+using namespace std;
+
+static void ExpectSameBWT(BWT &expected, BWT &built) {
+    ASSERT_EQ(expected.bwtSequence.length, built.bwtSequence.length);
+    ASSERT_EQ(expected.bwtSequence.arrayLength, built.bwtSequence.arrayLength);
+    EXPECT_EQ(0, memcmp(expected.bwtSequence.seq, built.bwtSequence.seq,
+        expected.bwtSequence.arrayLength * sizeof(PackedDNAWord)));
+    EXPECT_EQ(0, memcmp(expected.charCount, built.charCount, sizeof(expected.charCount)));
+    EXPECT_EQ(expected.firstCharPos, built.firstCharPos);
+    ASSERT_EQ(expected.occ.numMajorBins, built.occ.numMajorBins);
+    ASSERT_EQ(expected.occ.numMinorBins, built.occ.numMinorBins);
+    EXPECT_EQ(0, memcmp(expected.occ.major.matrix, built.occ.major.matrix,
+        expected.occ.numMajorBins * GbOcc::AlphabetSize * sizeof(expected.occ.major.matrix[0])));
+    EXPECT_EQ(0, memcmp(expected.occ.minor.matrix, built.occ.minor.matrix,
+        expected.occ.numMinorBins * GbOcc::AlphabetSize * sizeof(expected.occ.minor.matrix[0])));
+    EXPECT_EQ(expected.pos.stride, built.pos.stride);
+    EXPECT_TRUE(expected.pos.values == built.pos.values);
+    EXPECT_TRUE(expected.pos.sampled.words == built.pos.sampled.words);
+}
+
+class BWTBuilderTest : public ::testing::Test {
+public:
+    string genome;
+    vector<DNALength> suffixArray;
+    FASTASequence seq;
+    string saFileName;
+
+    //
+    // Long enough for two chunks of rows, so that both threads build
+    // one.  The suffix array is also written to a file.
+    //
+    void SetUp() {
+        srand(3);
+        DNALength n = BWT_BUILD_CHUNK_ROWS + 100000;
+        genome.assign(n, 'A');
+        for (DNALength i = 0; i < n; i++) {
+            genome[i] = (rand() % 100 == 0) ? 'N' : "ACGT"[rand() % 4];
+        }
+        NaiveSuffixArray(genome, suffixArray);
+        seq.seq = (Nucleotide*) &genome[0];
+        seq.length = n;
+
+        saFileName = "/tmp/BWTBuilder_gtest.sa";
+        DNASuffixArray sa;
+        sa.deleteStructures = false;
+        sa.index  = &suffixArray[0];
+        sa.length = n;
+        sa.componentList[sa.CompArray] = 1;
+        sa.Write(saFileName);
+    }
+
+    void TearDown() {
+        seq.seq = NULL;
+        remove(saFileName.c_str());
+    }
+};
+
+TEST_F(BWTBuilderTest, MatchesInitializeFromSuffixArray) {
+    BWT expected;
+    expected.InitializeFromSuffixArray(seq, &suffixArray[0], 0, 8);
+    for (int nThreads = 1; nThreads <= 2; nThreads++) {
+        BWT fromArray, fromFile;
+        SuffixArrayBlockSource arraySource, fileSource;
+        arraySource.SetArray(&suffixArray[0], seq.length);
+        ASSERT_EQ(1, fileSource.OpenFile(saFileName));
+
+        BWTBuilder arrayBuilder, fileBuilder;
+        ASSERT_EQ(1, arrayBuilder.Build(seq, arraySource, fromArray, nThreads, 8));
+        ASSERT_EQ(1, fileBuilder.Build(seq, fileSource, fromFile, nThreads, 8));
+        ExpectSameBWT(expected, fromArray);
+        ExpectSameBWT(expected, fromFile);
+    }
+}
+
+TEST_F(BWTBuilderTest, TruncatedFileFails) {
+    //
+    // Cut the array short in the second chunk, so that only one of the
+    // threads fails to read.
+    //
+    string contents;
+    {
+        ifstream in(saFileName.c_str(), ios::binary);
+        contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    contents.resize(contents.size() - 1000 * sizeof(DNALength));
+    {
+        ofstream out(saFileName.c_str(), ios::binary);
+        out.write(contents.c_str(), contents.size());
+    }
+    for (int nThreads = 1; nThreads <= 2; nThreads++) {
+        SuffixArrayBlockSource source;
+        ASSERT_EQ(1, source.OpenFile(saFileName));
+        BWT bwt;
+        BWTBuilder builder;
+        EXPECT_EQ(0, builder.Build(seq, source, bwt, nThreads, 8));
+    }
+}
@@ -0,0 +1,162 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  BWT_gtest.cpp
+ *
+ *    Description:  Test alignment/bwt/BWT.hpp, Pos.hpp and RankBitVector.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "bwt/BWT.hpp"
+#include "alignment/bwt/NaiveBWT.hpp"
+
+using namespace std;
+
+class BWTLocateTest : public ::testing::Test {
+public:
+    string genome, repeat;
+    vector<DNALength> suffixArray;
+    FASTASequence seq;
+
+    //
+    // A random genome with 100 copies of a repeat, so that some
+    // patterns have many hits.
+    //
+    void SetUp() {
+        srand(9);
+        DNALength n = 200000;
+        genome.assign(n, 'A');
+        for (DNALength i = 0; i < n; i++) {
+            genome[i] = "ACGT"[rand() % 4];
+        }
+        repeat = genome.substr(5000, 300);
+        for (int k = 0; k < 100; k++) {
+            genome.replace(10000 + k * 1500, 300, repeat);
+        }
+        NaiveSuffixArray(genome, suffixArray);
+        seq.seq = (Nucleotide*) &genome[0];
+        seq.length = n;
+    }
+
+    void TearDown() {
+        seq.seq = NULL;
+    }
+};
+
+TEST_F(BWTLocateTest, LocateMatchesSuffixArray) {
+    DNALength strides[] = {4, 8, 32};
+    for (int s = 0; s < 3; s++) {
+        BWT bwt;
+        bwt.InitializeFromSuffixArray(seq, &suffixArray[0], 0, strides[s]);
+
+        vector<DNALength> positions;
+        bwt.LocateRows(1, genome.size(), positions);
+        ASSERT_EQ(genome.size(), positions.size());
+        for (DNALength r = 0; r < genome.size(); r++) {
+            ASSERT_EQ(suffixArray[r], positions[r]) << "stride " << strides[s] << " row " << r;
+        }
+        for (DNALength r = 1; r <= genome.size(); r += 997) {
+            EXPECT_EQ(suffixArray[r - 1], bwt.Locate(r));
+        }
+
+        //
+        // Every hit of a pattern in the repeat is found, in row order.
+        //
+        FASTASequence pattern;
+        pattern.seq = (Nucleotide*) &repeat[10];
+        pattern.length = 40;
+        DNALength sp, ep;
+        bwt.Count(pattern, sp, ep);
+        EXPECT_LE(100, ep - sp + 1);
+        positions.clear();
+        bwt.Locate(sp, ep, positions);
+        vector<DNALength> expected(suffixArray.begin() + sp - 1, suffixArray.begin() + ep);
+        EXPECT_EQ(expected, positions);
+        pattern.seq = NULL;
+    }
+}
+
+TEST_F(BWTLocateTest, PosRoundTrip) {
+    BWT bwt;
+    bwt.InitializeFromSuffixArray(seq, &suffixArray[0], 0, 16);
+    stringstream stream;
+    bwt.pos.Write(stream);
+    Pos<PackedDNASequence> copy;
+    copy.Read(stream);
+    for (DNALength r = 1; r <= genome.size(); r += 13) {
+        DNALength expected = 0, found = 0;
+        int sampled = bwt.pos.Lookup(r, expected);
+        EXPECT_EQ(sampled, copy.Lookup(r, found));
+        EXPECT_EQ(suffixArray[r - 1] % 16 == 0, sampled != 0);
+        if (sampled) {
+            EXPECT_EQ(suffixArray[r - 1], found);
+        }
+    }
+}
+
+TEST_F(BWTLocateTest, ReadsPackedHashPos) {
+    //
+    // Files written before the sampling was configurable store every
+    // eighth position in a PackedHash.
+    //
+    PackedHash hash;
+    hash.Allocate(genome.size());
+    for (DNALength p = 0; p < genome.size(); p++) {
+        if (suffixArray[p] % 8 == 0) {
+            hash.AddValue(p, suffixArray[p]);
+        }
+    }
+    stringstream stream;
+    hash.Write(stream);
+    Pos<PackedDNASequence> pos;
+    pos.Read(stream);
+    for (DNALength r = 1; r <= genome.size(); r++) {
+        DNALength found = 0;
+        int sampled = pos.Lookup(r, found);
+        ASSERT_EQ(suffixArray[r - 1] % 8 == 0, sampled != 0) << "row " << r;
+        if (sampled) {
+            ASSERT_EQ(suffixArray[r - 1], found) << "row " << r;
+        }
+    }
+}
+
+TEST(RankBitVectorTest, RankMatchesCount) {
+    //
+    // Longer than one block of RankBlockWords words, so the block
+    // counts are used.
+    //
+    DNALength length = RankBitVector::RankBlockWords * 64 * 2 + 100;
+    RankBitVector bits;
+    bits.Allocate(length);
+    vector<bool> expected(length, false);
+    srand(5);
+    for (DNALength i = 0; i < length; i++) {
+        if (rand() % 3 == 0) {
+            bits.Set(i);
+            expected[i] = true;
+        }
+    }
+    bits.BuildRank();
+
+    stringstream stream;
+    bits.Write(stream);
+    RankBitVector copy;
+    copy.Read(stream);
+
+    DNALength count = 0;
+    for (DNALength i = 0; i < length; i++) {
+        ASSERT_EQ(count, bits.Rank(i)) << "position " << i;
+        ASSERT_EQ(count, copy.Rank(i)) << "position " << i;
+        ASSERT_EQ(expected[i], bits.Get(i));
+        count += expected[i];
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  NaiveBWT.hpp
+ *
+ *    Description:  Suffix arrays and BWTs built by sorting the suffixes
+ *                  directly, to check the BWT tests against.
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef _BLASR_UNITTEST_NAIVE_BWT_HPP_
+#define _BLASR_UNITTEST_NAIVE_BWT_HPP_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "bwt/BWT.hpp"
+
+//
+// Each test is its own translation unit, so the helpers are kept out
+// of the combined runner's global namespace.
+//
+namespace {
+
+class SuffixLess {
+public:
+    const std::string &text;
+    SuffixLess(const std::string &textP) : text(textP) {}
+    bool operator()(DNALength a, DNALength b) const {
+        return text.compare(a, std::string::npos, text, b, std::string::npos) < 0;
+    }
+};
+
+void NaiveSuffixArray(const std::string &text, std::vector<DNALength> &suffixArray) {
+    suffixArray.resize(text.size());
+    DNALength i;
+    for (i = 0; i < text.size(); i++) {
+        suffixArray[i] = i;
+    }
+    std::sort(suffixArray.begin(), suffixArray.end(), SuffixLess(text));
+}
+
+void NaiveBuildBWT(std::string &text, BWT &bwt) {
+    std::vector<DNALength> suffixArray;
+    NaiveSuffixArray(text, suffixArray);
+    FASTASequence seq;
+    seq.seq = (Nucleotide*) &text[0];
+    seq.length = text.size();
+    bwt.InitializeFromSuffixArray(seq, &suffixArray[0]);
+    seq.seq = NULL;
+}
+
+}
+
+#endif // _BLASR_UNITTEST_NAIVE_BWT_HPP_
@@ -0,0 +1,65 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  MatchPos_gtest.cpp
+ *
+ *    Description:  Test alignment/datastructures/anchoring/MatchPos.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "gtest/gtest.h"
+#include "datastructures/anchoring/MatchPos.hpp"
+
+using namespace std;
+
+static void RandomAnchors(int n, DNALength maxPos, vector<ChainedMatchPos> &anchors) {
+    anchors.clear();
+    for (int i = 0; i < n; i++) {
+        // Few distinct positions, so that many anchors tie.
+        anchors.push_back(ChainedMatchPos(rand() % maxPos, rand() % maxPos, i + 1, 1));
+    }
+}
+
+static bool LessByTargetPos(const ChainedMatchPos &a, const ChainedMatchPos &b) {
+    return a.t < b.t or (a.t == b.t and a.q < b.q);
+}
+
+static void ExpectSameOrder(vector<ChainedMatchPos> &anchors, 
+    vector<ChainedMatchPos> &expected) {
+    ASSERT_EQ(anchors.size(), expected.size());
+    for (size_t i = 0; i < anchors.size(); i++) {
+        EXPECT_EQ(anchors[i].t, expected[i].t);
+        EXPECT_EQ(anchors[i].q, expected[i].q);
+        // l is unique, so this checks that ties keep their order.
+        EXPECT_EQ(anchors[i].l, expected[i].l);
+    }
+}
+
+//
+// Sort with fresh scratch, and with scratch kept from sorting lists
+// of other sizes.
+//
+TEST(MatchPosTest, SortMatchPosListMatchesStableSort) {
+    srand(11);
+    int sizes[] = {0, 1, 2, 32, 33, 100, 255, 256, 5000, 20000, 3};
+    DNALength maxPos[] = {10, 4000000000U};
+    vector<KeyedIndex> keys, buffer;
+    for (int s = 0; s < 11; s++) {
+        for (int p = 0; p < 2; p++) {
+            vector<ChainedMatchPos> anchors, reused, expected;
+            RandomAnchors(sizes[s], maxPos[p], anchors);
+            expected = reused = anchors;
+            stable_sort(expected.begin(), expected.end(), LessByTargetPos);
+            SortMatchPosList(anchors);
+            ExpectSameOrder(anchors, expected);
+            SortMatchPosList(reused, keys, buffer);
+            ExpectSameOrder(reused, expected);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  CompressedSuffixArray_gtest.cpp
+ *
+ *    Description:  Test alignment/suffixarray/CompressedSuffixArray.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "suffixarray/SuffixArrayTypes.hpp"
+#include "suffixarray/CompressedSuffixArray.hpp"
+
+using namespace std;
+
+class CompressedSuffixArrayTest : public ::testing::Test {
+public:
+    string genome;
+    FASTASequence seq;
+    DNASuffixArray sa;
+
+    void TearDown() {
+        seq.seq = NULL;
+    }
+
+    //
+    // The suffix sort reports its progress, which the test drops.
+    //
+    void BuildCompressed(CompressedSuffixArray &csa, DNALength stride) {
+        testing::internal::CaptureStderr();
+        csa.Build(seq, stride, 6);
+        testing::internal::GetCapturedStderr();
+    }
+
+    //
+    // A random genome with runs of N, and its suffix array sorted on
+    // ThreeBit codes as the compressed array's rows are.
+    //
+    void Build(DNALength n, int seed) {
+        srand(seed);
+        genome.assign(n, 'A');
+        DNALength i;
+        for (i = 0; i < n; i++) {
+            genome[i] = "ACGT"[rand() % 4];
+        }
+        for (int r = 0; r < 10; r++) {
+            DNALength p = rand() % (n - 20);
+            DNALength runLength = 1 + rand() % 20;
+            for (i = p; i < p + runLength; i++) {
+                genome[i] = 'N';
+            }
+        }
+        // The genome ends in a run of N as well.
+        for (i = n - 3; i < n; i++) {
+            genome[i] = 'N';
+        }
+        seq.seq = (Nucleotide*) &genome[0];
+        seq.length = n;
+
+        vector<Nucleotide> codes(n);
+        for (i = 0; i < n; i++) {
+            codes[i] = ThreeBit[seq.seq[i]];
+        }
+        vector<int> alphabet;
+        delete[] sa.index;
+        sa.index = NULL;
+        sa.LarssonBuildSuffixArray(&codes[0], n, alphabet);
+        sa.length = n;
+        sa.BuildLookupTable(seq.seq, n, 6);
+    }
+
+    //
+    // A query copied from the genome with a few mismatches and N.
+    //
+    string MakeQuery() {
+        DNALength length = 8 + rand() % 30;
+        DNALength p = rand() % genome.size();
+        string query;
+        for (DNALength k = 0; k < length; k++) {
+            query += (p + k < genome.size() and rand() % 30) ? genome[p + k] : "ACGTN"[rand() % 5];
+        }
+        return query;
+    }
+};
+
+//
+// Every row, sampled or not, is located at its position in the
+// uncompressed array at each sampling rate.
+//
+TEST_F(CompressedSuffixArrayTest, LocateMatchesSuffixArray) {
+    Build(5000, 1);
+    DNALength strides[] = {1, 2, 7, 32, 64};
+    for (int s = 0; s < 5; s++) {
+        CompressedSuffixArray csa;
+        BuildCompressed(csa, strides[s]);
+        ASSERT_EQ(sa.length, csa.length);
+        // Rows whose positions are not multiples of the stride are found
+        // by LF steps.
+        SAIndex row, unsampled = 0;
+        for (row = 0; row < sa.length; row++) {
+            ASSERT_EQ(sa.index[row], csa.index[row]) << "stride " << strides[s] << " row " << row;
+            unsampled += (sa.index[row] % strides[s] != 0);
+        }
+        EXPECT_EQ(sa.length - (sa.length + strides[s] - 1) / strides[s], unsampled);
+    }
+}
+
+//
+// Search gives the rows of the uncompressed array that start with the
+// query, and StoreLCPBounds the bounds it stores, with and without the
+// lookup table.
+//
+TEST_F(CompressedSuffixArrayTest, LookupMatchesSuffixArray) {
+    DNALength strides[] = {3, 32};
+    for (int s = 0; s < 2; s++) {
+        Build(20000, 2 + s);
+        CompressedSuffixArray csa;
+        BuildCompressed(csa, strides[s]);
+        for (int q = 0; q < 2000; q++) {
+            string queryString = MakeQuery();
+            Nucleotide *query = (Nucleotide*) &queryString[0];
+            DNALength queryLength = queryString.size();
+            SCOPED_TRACE(testing::Message() << "stride " << strides[s] << " query " << queryString);
+
+            SAIndex low, high, row;
+            csa.Search(seq.seq, query, queryLength, low, high);
+            SAIndex expectedLow = sa.length, expectedHigh = 0;
+            for (row = 0; row < sa.length; row++) {
+                if (genome.compare(sa.index[row], queryLength, queryString) == 0 and
+                    queryString.find('N') == string::npos) {
+                    expectedLow = min(expectedLow, row);
+                    expectedHigh = row + 1;
+                }
+            }
+            if (expectedHigh == 0) {
+                EXPECT_EQ(low, high);
+            }
+            else {
+                EXPECT_EQ(expectedLow, low);
+                EXPECT_EQ(expectedHigh, high);
+                for (row = low; row < high; row++) {
+                    ASSERT_EQ(sa.index[row], csa.index[row]);
+                }
+            }
+
+            bool useLookupTable = (q % 2 == 0), stopOnceUnique = (q % 3 == 0);
+            DNALength maxMatchLength = (q % 5 == 0) ? 12 : 0;
+            vector<SAIndex> left, right, expectedLeft, expectedRight;
+            int length = csa.StoreLCPBounds(seq.seq, seq.length, query, queryLength,
+                useLookupTable, maxMatchLength, left, right, stopOnceUnique);
+            int expectedLength = sa.StoreLCPBounds(seq.seq, seq.length, query, queryLength,
+                useLookupTable, maxMatchLength, expectedLeft, expectedRight, stopOnceUnique);
+            EXPECT_EQ(expectedLength, length);
+            EXPECT_TRUE(expectedLeft == left);
+            EXPECT_TRUE(expectedRight == right);
+        }
+    }
+}
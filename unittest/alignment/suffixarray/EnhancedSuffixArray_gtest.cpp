@@ -0,0 +1,239 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  EnhancedSuffixArray_gtest.cpp
+ *
+ *    Description:  Test alignment/suffixarray/EnhancedSuffixArray.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "suffixarray/SuffixArrayTypes.hpp"
+
+using namespace std;
+
+//
+// The common prefix in the order of the array, which has lowercase
+// equal to uppercase.
+//
+static DNALength CommonPrefix(const string &text, DNALength a, DNALength b) {
+    DNALength h = 0;
+    while (a + h < text.size() and b + h < text.size() and
+           ThreeBit[(Nucleotide) text[a + h]] == ThreeBit[(Nucleotide) text[b + h]]) {
+        h++;
+    }
+    return h;
+}
+
+class EnhancedSuffixArrayTest : public ::testing::Test {
+public:
+    string genome;
+    DNASuffixArray plain, enhanced;
+
+    //
+    // A random genome, with runs of N and lowercase stretches when it
+    // is masked.
+    //
+    void Build(DNALength n, int seed, bool masked=false) {
+        srand(seed);
+        genome.assign(n, 'A');
+        DNALength i;
+        for (i = 0; i < n; i++) {
+            genome[i] = "ACGT"[rand() % 4];
+        }
+        for (int r = 0; masked and r < n / 3000; r++) {
+            DNALength p = rand() % (n - 300);
+            for (i = p; i < p + 300; i++) {
+                genome[i] = tolower(genome[i]);
+            }
+            p = rand() % (n - 30);
+            DNALength runLength = 1 + rand() % 30;
+            for (i = p; i < p + runLength; i++) {
+                genome[i] = 'N';
+            }
+        }
+        Sort();
+    }
+
+    //
+    // Both arrays are of genome; only enhanced has the child table.
+    // They are sorted on the ThreeBit codes of the genome, the order
+    // the search compares in, so N sorts after T and lowercase with
+    // uppercase.
+    //
+    void Sort() {
+        Nucleotide *text = (Nucleotide*) &genome[0];
+        DNALength n = genome.size(), i;
+        vector<Nucleotide> codes(n);
+        for (i = 0; i < n; i++) {
+            codes[i] = ThreeBit[text[i]];
+        }
+        vector<int> alphabet;
+        delete[] plain.index;
+        delete[] enhanced.index;
+        plain.index = enhanced.index = NULL;
+        plain.LarssonBuildSuffixArray(&codes[0], n, alphabet);
+        plain.length = n;
+        enhanced.LarssonBuildSuffixArray(&codes[0], n, alphabet);
+        enhanced.length = n;
+        enhanced.BuildEnhanced(text);
+    }
+
+    //
+    // Compare the bounds stored by the binary search and the child
+    // table walk for queries copied from the genome with a few
+    // mismatches and N, half of them at its end.
+    //
+    void CompareSearches(bool useLookupTable, int nQueries) {
+        Nucleotide *text = (Nucleotide*) &genome[0];
+        DNALength n = genome.size();
+        for (int q = 0; q < nQueries; q++) {
+            Nucleotide query[40];
+            DNALength queryLength = 12 + rand() % 28;
+            DNALength p = (q % 2) ? n - 1 - rand() % 8 : rand() % n;
+            for (DNALength k = 0; k < queryLength; k++) {
+                query[k] = (p + k < n and rand() % 40) ? text[p + k] : "ACGTN"[rand() % 5];
+            }
+            if (q % 50 == 0) {
+                query[rand() % queryLength] = 'N';
+            }
+            bool stopOnceUnique = (q % 3 == 0);
+            DNALength maxMatchLength = (q % 5 == 0) ? 20 : 0;
+            vector<SAIndex> plainLeft, plainRight, enhancedLeft, enhancedRight;
+            int plainLength = plain.StoreLCPBounds(text, n, query, queryLength, useLookupTable,
+                maxMatchLength, plainLeft, plainRight, stopOnceUnique);
+            int enhancedLength = enhanced.StoreLCPBounds(text, n, query, queryLength, useLookupTable,
+                maxMatchLength, enhancedLeft, enhancedRight, stopOnceUnique);
+            string queryString((char*) query, queryLength);
+            ASSERT_EQ(plainLength, enhancedLength) << queryString;
+            ASSERT_TRUE(plainLeft == enhancedLeft) << queryString;
+            ASSERT_TRUE(plainRight == enhancedRight) << queryString;
+        }
+    }
+
+    //
+    // Every row the lookup table gives for a tuple starts with it.
+    //
+    void CheckLookupTable() {
+        Nucleotide *text = (Nucleotide*) &genome[0];
+        for (SAIndexLength t = 0; t < plain.lookupTableLength; t++) {
+            for (SAIndex row = plain.startPosTable[t]; row < plain.endPosTable[t]; row++) {
+                ASSERT_LE(plain.index[row] + plain.lookupPrefixLength, genome.size()) << row;
+                DNATuple prefix;
+                prefix.FromStringLR(&text[plain.index[row]], plain.tm);
+                ASSERT_EQ(t, (SAIndexLength) prefix.tuple) << row;
+            }
+        }
+    }
+
+    //
+    // Every child listed for an lcp-interval starts where the LCP array
+    // falls to the interval's lcp.
+    //
+    void CheckChildIntervals() {
+        EnhancedSuffixArray &esa = enhanced.esa;
+        vector<pair<DNALength, DNALength> > intervals(1, make_pair(0, genome.size() - 1));
+        while (!intervals.empty()) {
+            DNALength i = intervals.back().first, j = intervals.back().second;
+            intervals.pop_back();
+            if (i == j) {
+                continue;
+            }
+            DNALength lcp = genome.size(), k;
+            for (k = i + 1; k <= j; k++) {
+                lcp = min(lcp, CommonPrefix(genome, enhanced.index[k-1], enhanced.index[k]));
+            }
+            ASSERT_EQ(lcp, esa.IntervalLCP(i, j));
+            vector<DNALength> starts, expected(1, i);
+            esa.ChildIntervals(i, j, starts);
+            for (k = i + 1; k <= j; k++) {
+                if (CommonPrefix(genome, enhanced.index[k-1], enhanced.index[k]) == lcp) {
+                    expected.push_back(k);
+                }
+            }
+            ASSERT_TRUE(starts == expected) << "interval " << i << " " << j;
+            for (k = 0; k < starts.size(); k++) {
+                intervals.push_back(make_pair(starts[k], k + 1 < starts.size() ? starts[k+1] - 1 : j));
+            }
+        }
+    }
+};
+
+TEST_F(EnhancedSuffixArrayTest, ChildIntervals) {
+    Build(3000, 1);
+    CheckChildIntervals();
+}
+
+TEST_F(EnhancedSuffixArrayTest, MatchesBinarySearch) {
+    Build(100000, 2);
+    CompareSearches(false, 20000);
+}
+
+//
+// The lookup table rows of a prefix are not always an lcp-interval,
+// as the table leaves out the last rows of the array.
+//
+TEST_F(EnhancedSuffixArrayTest, MatchesBinarySearchWithLookupTable) {
+    for (int seed = 3; seed < 6; seed++) {
+        Build(100000, seed);
+        Nucleotide *text = (Nucleotide*) &genome[0];
+        plain.BuildLookupTable(text, genome.size(), 6);
+        enhanced.BuildLookupTable(text, genome.size(), 6);
+        CompareSearches(true, 20000);
+    }
+}
+
+//
+// The child intervals and the binary search break on N and ignore
+// case alike, with and without the lookup table, whose tuples have
+// neither N nor case, and which must not give short suffixes after N
+// for the next tuple.
+//
+TEST_F(EnhancedSuffixArrayTest, MaskedGenome) {
+    Build(6000, 7, true);
+    CheckChildIntervals();
+    for (int seed = 8; seed < 11; seed++) {
+        Build(100000, seed, true);
+        CompareSearches(false, 20000);
+        Nucleotide *text = (Nucleotide*) &genome[0];
+        plain.BuildLookupTable(text, genome.size(), 6);
+        enhanced.BuildLookupTable(text, genome.size(), 6);
+        CheckLookupTable();
+        CompareSearches(true, 20000);
+    }
+}
+
+//
+// GT at the end of the genome sorts after the tuples with N that
+// start with G, and is too short to be a tuple itself.
+//
+TEST_F(EnhancedSuffixArrayTest, LookupTableSkipsShortSuffixes) {
+    genome = "ACGGNNTTGACGGTCAGT";
+    Sort();
+    Nucleotide *text = (Nucleotide*) &genome[0];
+    plain.BuildLookupTable(text, genome.size(), 3);
+    CheckLookupTable();
+}
+
+TEST_F(EnhancedSuffixArrayTest, WriteAndRead) {
+    Build(20000, 6);
+    string fileName = "/tmp/EnhancedSuffixArray_gtest.esa";
+    enhanced.WriteEnhanced(fileName);
+    DNASuffixArray loaded;
+    loaded.deleteStructures = false;
+    loaded.index  = enhanced.index;
+    loaded.length = enhanced.length;
+    ASSERT_TRUE(loaded.ReadEnhanced(fileName));
+    remove(fileName.c_str());
+    EXPECT_TRUE(loaded.esa.lcp == enhanced.esa.lcp);
+    EXPECT_TRUE(loaded.esa.child == enhanced.esa.child);
+    EXPECT_TRUE(loaded.esa.longLCP.entries == enhanced.esa.longLCP.entries);
+}
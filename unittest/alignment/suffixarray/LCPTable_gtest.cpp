@@ -0,0 +1,211 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  LCPTable_gtest.cpp
+ *
+ *    Description:  Test alignment/suffixarray/LCPTable.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "suffixarray/SuffixArrayTypes.hpp"
+
+using namespace std;
+
+static DNALength CommonPrefix(const string &text, DNALength a, DNALength b) {
+    DNALength h = 0;
+    while (a + h < text.size() and b + h < text.size() and text[a + h] == text[b + h]) {
+        h++;
+    }
+    return h;
+}
+
+class LCPTableTest : public ::testing::Test {
+public:
+    string text;
+    DNASuffixArray sa;
+    int nChecked, nLong;
+
+    void Build(const string &textP) {
+        text = textP;
+        vector<int> alphabet;
+        sa.LarssonBuildSuffixArray((Nucleotide*) &text[0], text.size(), alphabet);
+        sa.length = text.size();
+    }
+
+    //
+    // Check the midpoints of the intervals the search visits, every
+    // one of the wide intervals and every stride'th of the rest, whose
+    // LCPs may be long.
+    //
+    template<typename T_Table>
+    void CheckMidpoints(T_Table &table, unsigned int low, unsigned int high,
+        unsigned int stride) {
+        if (high - low <= 1) {
+            return;
+        }
+        unsigned int mid = (low + high) / 2;
+        if (high - low > 64 or mid % stride == 0) {
+            DNALength lowMid  = CommonPrefix(text, sa.index[low], sa.index[mid]);
+            DNALength midHigh = CommonPrefix(text, sa.index[mid], sa.index[high]);
+            ASSERT_EQ(lowMid, (DNALength) table.GetL(mid)) << "mid " << mid;
+            ASSERT_EQ(midHigh, (DNALength) table.GetR(mid)) << "mid " << mid;
+            nChecked++;
+            nLong += (lowMid > 65535 or midHigh > 65535);
+        }
+        CheckMidpoints(table, low, mid, stride);
+        CheckMidpoints(table, mid, high, stride);
+    }
+
+    void CheckTable(LCPTable<Nucleotide> &table, unsigned int stride) {
+        nChecked = nLong = 0;
+        CheckMidpoints(table, 0, text.size() - 1, stride);
+    }
+};
+
+TEST_F(LCPTableTest, SmallTexts) {
+    const char *texts[] = {"AC", "AAA", "ACGTTGCAACGTAC", "GATTACAGATTACAGATTACA"};
+    for (int t = 0; t < 4; t++) {
+        Build(texts[t]);
+        sa.BuildLCPTable((Nucleotide*) &text[0]);
+        CheckTable(sa.lcpTable, 1);
+
+        vector<DNALength> lcp(text.size());
+        LCPArrayBuilder<Nucleotide> builder;
+        builder.Build((Nucleotide*) &text[0], text.size(), sa.index, &lcp[0]);
+        EXPECT_EQ(0, lcp[0]);
+        for (DNALength i = 1; i < text.size(); i++) {
+            EXPECT_EQ(CommonPrefix(text, sa.index[i-1], sa.index[i]), lcp[i]) << texts[t];
+        }
+        sa.lcpTable.Free();
+        delete[] sa.index;
+        sa.index = NULL;
+    }
+}
+
+TEST_F(LCPTableTest, RunOfOneBase) {
+    Build(string(5000, 'A'));
+    sa.BuildLCPTable((Nucleotide*) &text[0]);
+    CheckTable(sa.lcpTable, 1);
+}
+
+//
+// Long enough that the LCP array is built in two blocks, with a repeat
+// whose LCPs do not fit in the 16 bit entries.
+//
+TEST_F(LCPTableTest, LongRepeatAndBlocks) {
+    srand(3);
+    string genome(LCP_ARRAY_BLOCK_SIZE + 200000, 'A');
+    for (DNALength i = 0; i < genome.size(); i++) {
+        genome[i] = "ACGT"[rand() % 4];
+    }
+    genome.replace(900000, 70000, genome, 100000, 70000);
+    Build(genome);
+
+    vector<DNALength> lcp(text.size()), threadedLcp(text.size());
+    LCPArrayBuilder<Nucleotide> builder;
+    builder.Build((Nucleotide*) &text[0], text.size(), sa.index, &lcp[0], 1);
+    builder.Build((Nucleotide*) &text[0], text.size(), sa.index, &threadedLcp[0], 2);
+    EXPECT_TRUE(lcp == threadedLcp);
+    for (DNALength i = 1; i < text.size(); i += 1009) {
+        ASSERT_EQ(CommonPrefix(text, sa.index[i-1], sa.index[i]), lcp[i]) << "row " << i;
+    }
+
+    sa.BuildLCPTable((Nucleotide*) &text[0], 2);
+    CheckTable(sa.lcpTable, 1009);
+    EXPECT_GT(nLong, 0);
+
+    //
+    // The table is written and read with the suffix array.
+    //
+    string fileName = "/tmp/LCPTable_gtest.sa";
+    sa.Write(fileName);
+    DNASuffixArray copy;
+    ASSERT_TRUE(copy.Read(fileName));
+    remove(fileName.c_str());
+    EXPECT_TRUE(copy.componentList[copy.CompLCPTable]);
+    CheckTable(copy.lcpTable, 1009);
+    EXPECT_GT(nLong, 0);
+}
+
+//
+// LCPSearch gives the bounds and count of the binary search over the
+// whole array for substrings of the text, mutated substrings, suffixes
+// that run off the end of the text, and random queries.  Without a
+// lookup table, SearchLCP gives the same results with and without the
+// LCP table.
+//
+TEST_F(LCPTableTest, SearchMatchesBinarySearch) {
+    srand(44);
+    for (int it = 0; it < 6; it++) {
+        DNALength textLength = (it < 3) ? 50 + rand() % 200 : 20000 + rand() % 20000;
+        string genome;
+        for (DNALength i = 0; i < textLength; i++) {
+            genome += "ACGT"[rand() % ((it % 3 == 0) ? 2 : 4)];
+        }
+        if (it % 2) {
+            genome.replace(textLength / 2, textLength / 4, genome, 0, textLength / 4);
+        }
+        Build(genome);
+        Nucleotide *target = (Nucleotide*) &text[0];
+        DNASuffixArray withTable;
+        vector<int> alphabet;
+        withTable.LarssonBuildSuffixArray(target, text.size(), alphabet);
+        withTable.length = text.size();
+        withTable.BuildLCPTable(target);
+
+        for (int q = 0; q < 500; q++) {
+            DNALength start = rand() % text.size();
+            DNALength queryLength = 1 + rand() % 40;
+            string query = text.substr(start, queryLength);
+            if (q % 4 == 1 and query.size() > 1) {
+                query[rand() % query.size()] = "ACGT"[rand() % 4];
+            }
+            else if (q % 4 == 2) {
+                query = text.substr(text.size() - 1 - rand() % 10) + "ACGT"[rand() % 4];
+            }
+            else if (q % 4 == 3) {
+                query = "";
+                for (DNALength i = 0; i < queryLength; i++) {
+                    query += "ACGT"[rand() % 4];
+                }
+            }
+            Nucleotide *queryPtr = (Nucleotide*) &query[0];
+            SCOPED_TRACE(testing::Message() << "text " << it << " query " << query);
+
+            SAIndex low, high, lcpLow, lcpHigh;
+            int count = withTable.Search(target, queryPtr, query.size(), 0,
+                text.size() - 1, low, high);
+            int lcpCount = withTable.LCPSearch(target, queryPtr, query.size(), lcpLow, lcpHigh);
+            EXPECT_EQ(low, lcpLow);
+            EXPECT_EQ(high, lcpHigh);
+            EXPECT_EQ(count, lcpCount);
+
+            //
+            // SearchLCP reads the suffixes at the bounds, so it is only
+            // given queries in the text.
+            //
+            if (count < 0) {
+                continue;
+            }
+            DNALength lcpLength, tableLcpLength;
+            int length = sa.SearchLCP(target, queryPtr, query.size(), low, high,
+                lcpLength, 0);
+            int tableLength = withTable.SearchLCP(target, queryPtr, query.size(), lcpLow,
+                lcpHigh, tableLcpLength, 0);
+            EXPECT_EQ(length, tableLength);
+            EXPECT_EQ(low, lcpLow);
+            EXPECT_EQ(high, lcpHigh);
+            EXPECT_EQ(lcpLength, tableLcpLength);
+        }
+        delete[] sa.index;
+        sa.index = NULL;
+    }
+}
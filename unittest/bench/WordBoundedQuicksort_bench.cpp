@@ -0,0 +1,165 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  WordBoundedQuicksort_bench.cpp
+ *
+ *    Description:  Time the v-prefix sort of the lightweight suffix sort
+ *                  (alignment/algorithms/sorting/MultikeyQuicksort.hpp),
+ *                  a word at a time against a character at a time.
+ *
+ *                  usage: libblasr-sort-bench [-t nThreads] [genome.fasta ...]
+ *
+ *                  Each synthetic genome and each FASTA file given, with
+ *                  its sequences joined, is sorted to the 2281 cover size.
+ *                  Run it with "make bench"; the times only mean
+ *                  something if the libraries are optimized (make all-opt).
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "FASTAReader.hpp"
+#include "FASTASequence.hpp"
+#include "algorithms/sorting/LightweightSuffixArray.hpp"
+#include "algorithms/sorting/MultikeyQuicksort.hpp"
+
+using namespace std;
+
+static const UInt Bound = 2281;
+
+class BenchGenome {
+public:
+    string name;
+    //
+    // The text is followed by Bound zeros, which the character at a
+    // time sort reads past its end.
+    //
+    vector<unsigned char> text;
+    UInt length;
+
+    void Allocate(string nameP, UInt lengthP) {
+        name   = nameP;
+        length = lengthP;
+        text.assign(length + Bound, 0);
+    }
+};
+
+//
+// Random DNA with a 5 kb run of N, and optionally a repeat copied from
+// the first third of the genome into the second.
+//
+static void MakeRandomGenome(BenchGenome &genome, string name, UInt length, UInt repeatLength) {
+    genome.Allocate(name, length);
+    UInt i;
+    for (i = 0; i < length; i++) {
+        genome.text[i] = "ACGT"[rand() % 4];
+    }
+    for (i = length / 2; i < length / 2 + 5000 and i < length; i++) {
+        genome.text[i] = 'N';
+    }
+    for (i = 0; i < repeatLength and length / 3 + repeatLength + i < length; i++) {
+        genome.text[length / 3 + repeatLength + i] = genome.text[length / 3 + i];
+    }
+}
+
+static bool ReadGenome(BenchGenome &genome, string fileName) {
+    FASTAReader reader;
+    if (!reader.Init(fileName)) {
+        return false;
+    }
+    string all;
+    FASTASequence seq;
+    while (reader.GetNext(seq)) {
+        all.append((char*) seq.seq, seq.length);
+        seq.Free();
+    }
+    reader.Close();
+    genome.Allocate(fileName, all.size());
+    UInt i;
+    for (i = 0; i < genome.length; i++) {
+        genome.text[i] = toupper(all[i]);
+    }
+    return true;
+}
+
+static double Seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void Bench(BenchGenome &genome, int nThreads) {
+    unsigned char *text = &genome.text[0];
+    UInt n = genome.length, i;
+    vector<UInt> byWord(n), byChar(n);
+    for (i = 0; i < n; i++) {
+        byWord[i] = byChar[i] = i;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    WordBoundedQuicksort sorter;
+    sorter.Sort(text, n, &byWord[0], n, Bound, nThreads);
+    double wordSeconds = Seconds(start);
+
+    start = chrono::steady_clock::now();
+    MediankeyBoundedQuicksort(text, &byChar[0], n, 0, n, 0, Bound);
+    double charSeconds = Seconds(start);
+
+    //
+    // Suffixes that share Bound characters are left in any order, so
+    // only the prefixes in each row must agree.
+    //
+    UInt nDiffer = 0;
+    for (i = 0; i < n; i++) {
+        if (NCompareSuffices(text, byWord[i], byChar[i], Bound) != 0) {
+            nDiffer++;
+        }
+    }
+
+    cout << left << setw(40) << genome.name << right << setw(12) << n
+         << fixed << setprecision(2) << setw(10) << charSeconds << setw(10) << wordSeconds
+         << setw(9) << charSeconds / wordSeconds << "x"
+         << (nDiffer ? "  ORDER DIFFERS" : "") << endl;
+}
+
+int main(int argc, char *argv[]) {
+    int nThreads = 1;
+    vector<string> fastaFiles;
+    int argi;
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "-t") == 0 and argi + 1 < argc) {
+            nThreads = atoi(argv[++argi]);
+        }
+        else {
+            fastaFiles.push_back(argv[argi]);
+        }
+    }
+
+    cout << left << setw(40) << "genome" << right << setw(12) << "length"
+         << setw(10) << "char s" << setw(10) << "word s" << setw(10) << "speedup" << endl;
+
+    srand(1);
+    BenchGenome genome;
+    MakeRandomGenome(genome, "random 3 Mb", 3000000, 0);
+    Bench(genome, nThreads);
+    MakeRandomGenome(genome, "random 10 Mb", 10000000, 0);
+    Bench(genome, nThreads);
+    MakeRandomGenome(genome, "random 3 Mb, 300 kb repeat", 3000000, 300000);
+    Bench(genome, nThreads);
+
+    VectorIndex f;
+    for (f = 0; f < fastaFiles.size(); f++) {
+        if (!ReadGenome(genome, fastaFiles[f])) {
+            cerr << "Could not read " << fastaFiles[f] << endl;
+            return 1;
+        }
+        Bench(genome, nThreads);
+    }
+    return 0;
+}
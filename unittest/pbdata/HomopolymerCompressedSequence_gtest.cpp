@@ -0,0 +1,127 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  HomopolymerCompressedSequence_gtest.cpp
+ *
+ *    Description:  Test pbdata/HomopolymerCompressedSequence.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "gtest/gtest.h"
+#include "HomopolymerCompressedSequence.hpp"
+
+using namespace std;
+
+class HomopolymerCompressedSequenceTest : public ::testing::Test {
+public:
+    DNASequence source;
+    HomopolymerCompressedSequence hpc;
+
+    void TearDown() {
+        source.Free();
+        hpc.Free();
+    }
+
+    //
+    // Compress text[start, start+compressLength), then expand every
+    // run back and look up where each one starts, and expect the text.
+    //
+    void CheckRoundTrip(const string &text, DNALength start, DNALength compressLength,
+        int binSize) {
+        source.Free();
+        source.Copy(text);
+        hpc.Compress(source, start, compressLength, binSize);
+        string expected = text.substr(start, compressLength ? compressLength : string::npos);
+        string expanded;
+        DNALength c;
+        for (c = 0; c < hpc.length; c++) {
+            if (c > 0) {
+                EXPECT_NE(ThreeBit[hpc.seq[c-1]], ThreeBit[hpc.seq[c]]) << c;
+            }
+            ASSERT_EQ(start + expanded.size(), hpc.LookupSequencePos(c)) << c;
+            expanded.append(hpc.RunLength(c), hpc.seq[c]);
+        }
+        EXPECT_EQ(start + expanded.size(), hpc.LookupSequencePos(hpc.length));
+        ASSERT_EQ(expected.size(), expanded.size());
+        for (c = 0; c < expected.size(); c++) {
+            // The case of a run is that of its first base.
+            ASSERT_EQ(ThreeBit[(Nucleotide) expected[c]], ThreeBit[(Nucleotide) expanded[c]]) << c;
+        }
+    }
+};
+
+TEST_F(HomopolymerCompressedSequenceTest, RunsAtEnds) {
+    source.Copy("AAAACGTTTT");
+    hpc.Compress(source, 0, 0, 2);
+    ASSERT_EQ(4u, hpc.length);
+    EXPECT_EQ("ACGT", string((char*) hpc.seq, hpc.length));
+    DNALength runs[] = {4, 1, 1, 4}, starts[] = {0, 4, 5, 6, 10};
+    for (DNALength c = 0; c < 4; c++) {
+        EXPECT_EQ(runs[c], hpc.RunLength(c));
+        EXPECT_EQ(starts[c], hpc.LookupSequencePos(c));
+    }
+    EXPECT_EQ(starts[4], hpc.LookupSequencePos(4));
+
+    // Part of the sequence keeps its positions in the whole.
+    CheckRoundTrip("AAAACGTTTT", 2, 6, 1);
+    EXPECT_EQ(2u, hpc.LookupSequencePos(0));
+    EXPECT_EQ(2u, hpc.RunLength(0));
+    EXPECT_EQ(8u, hpc.LookupSequencePos(hpc.length));
+
+    CheckRoundTrip("A", 0, 0, 16);
+    CheckRoundTrip("TTTTTTTT", 0, 0, 3);
+    CheckRoundTrip("aAAacgtTTt", 0, 0, 16);
+}
+
+//
+// Runs of every length up to a few hundred, so that some are in the
+// long run table, with stretches of N and lowercase, at the ends of
+// the sequence and between bins of every size.
+//
+TEST_F(HomopolymerCompressedSequenceTest, RoundTrip) {
+    int binSizes[] = {1, 2, 5, 16, 100};
+    for (int it = 0; it < 40; it++) {
+        srand(it);
+        string text;
+        int nRuns = 1 + rand() % 200;
+        for (int r = 0; r < nRuns; r++) {
+            char base = "ACGTN"[rand() % 5];
+            int length = (rand() % 10 == 0) ? 200 + rand() % 400 : 1 + rand() % 6;
+            string run(length, base);
+            if (rand() % 4 == 0) {
+                run[rand() % length] = tolower(base);
+            }
+            text += run;
+        }
+        SCOPED_TRACE(testing::Message() << "it " << it);
+        CheckRoundTrip(text, 0, 0, binSizes[it % 5]);
+        DNALength start = rand() % text.size();
+        CheckRoundTrip(text, start, 1 + rand() % (text.size() - start), binSizes[(it + 1) % 5]);
+    }
+}
+
+TEST_F(HomopolymerCompressedSequenceTest, WriteAndRead) {
+    string text = string(300, 'N') + "ACCGGGTTTT" + string(1000, 'A') + "CGN";
+    CheckRoundTrip(text, 0, 0, 4);
+    string fileName = "/tmp/HomopolymerCompressedSequence_gtest.hpc";
+    hpc.Write(fileName);
+    HomopolymerCompressedSequence loaded;
+    ASSERT_TRUE(loaded.Read(fileName));
+    remove(fileName.c_str());
+    ASSERT_EQ(hpc.length, loaded.length);
+    EXPECT_EQ(string((char*) hpc.seq, hpc.length), string((char*) loaded.seq, loaded.length));
+    for (DNALength c = 0; c <= hpc.length; c++) {
+        if (c < hpc.length) {
+            EXPECT_EQ(hpc.RunLength(c), loaded.RunLength(c));
+        }
+        EXPECT_EQ(hpc.LookupSequencePos(c), loaded.LookupSequencePos(c));
+    }
+    loaded.Free();
+}
@@ -0,0 +1,142 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  TwoBitSequence_gtest.cpp
+ *
+ *    Description:  Test pbdata/TwoBitSequence.hpp
+ *
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "gtest/gtest.h"
+#include "TwoBitSequence.hpp"
+
+using namespace std;
+
+class TwoBitSequenceTest : public ::testing::Test {
+public:
+    string bases;
+    DNASequence source;
+    TwoBitSequence packed;
+
+    //
+    // Random bases, some of them lower case, with runs of N at the
+    // start, across a word boundary, and in a word of their own.
+    //
+    void Pack(DNALength length, int seed) {
+        srand(seed);
+        bases.assign(length, 'A');
+        DNALength i;
+        for (i = 0; i < length; i++) {
+            bases[i] = "ACGTacgt"[rand() % 8];
+        }
+        DNALength nRuns[][2] = {{0, 3}, {30, 35}, {64, 96}, {200, 201}};
+        for (int r = 0; r < 4; r++) {
+            for (i = nRuns[r][0]; i < nRuns[r][1] and i < length; i++) {
+                bases[i] = 'N';
+            }
+        }
+        source.Copy(bases);
+        packed.Pack(source);
+        for (i = 0; i < length; i++) {
+            bases[i] = toupper(bases[i]);
+        }
+    }
+
+    ~TwoBitSequenceTest() {
+        source.Free();
+    }
+};
+
+TEST_F(TwoBitSequenceTest, Get) {
+    DNALength lengths[] = {1, 31, 32, 100, 4096};
+    for (int l = 0; l < 5; l++) {
+        Pack(lengths[l], l);
+        ASSERT_EQ(lengths[l], packed.length);
+        DNALength i;
+        for (i = 0; i < packed.length; i++) {
+            ASSERT_EQ(bases[i], packed.seq[i]) << "length " << lengths[l] << " pos " << i;
+            ASSERT_EQ(bases[i] == 'N', packed.IsN(i));
+        }
+        //
+        // The end reads as a terminator, even when it is at the start
+        // of a word that is not stored.
+        //
+        EXPECT_EQ(0, packed.Get(packed.length));
+        EXPECT_EQ(0, packed.seq[packed.length + 40]);
+    }
+}
+
+TEST_F(TwoBitSequenceTest, Extract) {
+    Pack(300, 7);
+    DNALength starts[] = {0, 1, 29, 64, 150};
+    DNALength lengths[] = {0, 5, 32, 70, 150};
+    for (int s = 0; s < 5; s++) {
+        for (int l = 0; l < 5; l++) {
+            DNASequence window;
+            packed.Extract(starts[s], lengths[l], window);
+            EXPECT_EQ(bases.substr(starts[s], lengths[l]),
+                string((char*) window.seq, window.length));
+            window.Free();
+        }
+    }
+}
+
+TEST_F(TwoBitSequenceTest, MakeRC) {
+    Pack(300, 8);
+    DNASequence upper, expected, rc;
+    upper.Copy(bases);
+    DNALength starts[] = {0, 3, 33, 100};
+    DNALength lengths[] = {0, 1, 31, 64, 97};
+    for (int s = 0; s < 4; s++) {
+        for (int l = 0; l < 5; l++) {
+            upper.MakeRC(expected, starts[s], lengths[l]);
+            packed.MakeRC(rc, starts[s], lengths[l]);
+            EXPECT_EQ(string((char*) expected.seq, expected.length),
+                string((char*) rc.seq, rc.length)) << starts[s] << " " << lengths[l];
+            expected.Free();
+            rc.Free();
+        }
+    }
+    upper.Free();
+}
+
+TEST_F(TwoBitSequenceTest, LongestCommonPrefix) {
+    Pack(500, 9);
+    for (int q = 0; q < 2000; q++) {
+        DNALength pos = rand() % packed.length;
+        DNALength queryLength = rand() % 100;
+        string query = bases.substr(pos, queryLength);
+        query.resize(queryLength, 'A');
+        if (queryLength > 0 and q % 2) {
+            query[rand() % queryLength] = "ACGTN"[rand() % 5];
+        }
+        DNALength expected = 0;
+        while (expected < queryLength and pos + expected < packed.length and
+               query[expected] != 'N' and query[expected] == bases[pos + expected]) {
+            expected++;
+        }
+        ASSERT_EQ(expected, packed.LongestCommonPrefix(pos, (Nucleotide*) query.c_str(),
+            queryLength)) << pos << " " << query;
+    }
+}
+
+TEST_F(TwoBitSequenceTest, WriteAndRead) {
+    Pack(1000, 10);
+    string fileName = "/tmp/TwoBitSequence_gtest.2bit";
+    packed.Write(fileName);
+    TwoBitSequence loaded;
+    ASSERT_EQ(1, loaded.Read(fileName));
+    remove(fileName.c_str());
+    ASSERT_EQ(packed.length, loaded.length);
+    DNALength i;
+    for (i = 0; i < loaded.length; i++) {
+        ASSERT_EQ(bases[i], loaded.seq[i]);
+    }
+    EXPECT_EQ(0, loaded.Get(loaded.length));
+}